@@ -0,0 +1,12 @@
+// Per-frame data, shared by all programs (see FrameData_ in main/main.cpp).
+//
+// Written once per frame into a uniform buffer (UniformBuffer, see
+// support/uniform_buffer.hpp) at binding kFrameBufferBinding. The block is
+// std140; matrices are stored row-major, like Mat44f. This file is not a
+// complete shader; include it with #include "frame.glsl".
+
+layout( std140, row_major, binding = 2 ) uniform Frame
+{
+	mat4 uProjCameraWorld;
+	vec4 uLightDir; // xyz: towards the light, normalized
+};
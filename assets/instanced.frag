@@ -0,0 +1,37 @@
+#version 430
+
+// Instanced meshes, see assets/instanced.vert. Simple directional light.
+//
+// Permutations (see main.cpp):
+//  - SHOW_NORMALS: visualize the normals instead of the materials
+
+#include "frame.glsl"
+#include "materials.glsl"
+
+in vec3 vNormal;
+in vec2 vTexCoord;
+in vec4 vTint;
+flat in uint vMaterialIndex;
+
+// Texture unit kBaseColorTextureUnit (main.cpp); multiplies the diffuse and
+// ambient material colors
+layout( binding = 0 ) uniform sampler2D uBaseColor;
+
+layout( location = 0 ) out vec4 oColor;
+
+void main()
+{
+	vec3 normal = normalize( vNormal );
+	float nDotL = max( 0.0, dot( normal, uLightDir.xyz ) );
+
+#	if defined(SHOW_NORMALS)
+	// Lightly shaded, such that the shape remains visible
+	oColor = vec4( (0.5 * normal + 0.5) * (0.5 + 0.5 * nDotL), 1.0 );
+#	else
+	Material mat = materials[vMaterialIndex];
+	vec3 base = texture( uBaseColor, vTexCoord ).rgb;
+
+	vec3 color = base * (0.1 * mat.ambient + nDotL * mat.diffuse) + mat.emissive;
+	oColor = vec4( color * vTint.rgb, vTint.a );
+#	endif
+}
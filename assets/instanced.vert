@@ -0,0 +1,67 @@
+#version 430
+
+// Instanced meshes, see InstancedRenderer (main/instanced_renderer.hpp).
+// The material index is forwarded as described in assets/materials.glsl.
+//
+// Permutations (see main.cpp):
+//  - COMPRESSED_VERTICES: VertexLayout::kCompressed (main/simple_mesh.hpp)
+
+#if defined(COMPRESSED_VERTICES)
+#	include "packing.glsl"
+
+layout( location = 0 ) in vec3 iPosition; // unorm16, see uPosition*
+layout( location = 1 ) in vec2 iNormal; // octahedral, snorm16
+layout( location = 2 ) in vec2 iTexCoord; // half floats
+
+// kPositionMinUniform and kPositionExtentUniform; set per mesh
+layout( location = 0 ) uniform vec3 uPositionMin;
+layout( location = 1 ) uniform vec3 uPositionExtent;
+#else
+layout( location = 0 ) in vec3 iPosition;
+layout( location = 1 ) in vec3 iNormal;
+layout( location = 2 ) in vec2 iTexCoord;
+#endif
+
+layout( location = 3 ) in uint iMaterialIndex;
+
+#include "frame.glsl"
+
+// Must match InstanceData. The model matrix is row-major; see the block's
+// layout below.
+struct Instance
+{
+	mat4 model;
+	vec4 tint;
+};
+
+// Binding kInstanceBufferBinding
+layout( std430, row_major, binding = 1 ) readonly buffer Instances
+{
+	Instance instances[];
+};
+
+out vec3 vNormal;
+out vec2 vTexCoord;
+out vec4 vTint;
+flat out uint vMaterialIndex;
+
+void main()
+{
+	Instance inst = instances[gl_InstanceID];
+
+#	if defined(COMPRESSED_VERTICES)
+	vec3 position = dequantize_position( iPosition, uPositionMin, uPositionExtent );
+	vec3 normal = oct_decode( iNormal );
+#	else
+	vec3 position = iPosition;
+	vec3 normal = iNormal;
+#	endif
+
+	// Assumes uniform scaling
+	vNormal = mat3( inst.model ) * normal;
+	vTexCoord = iTexCoord;
+	vTint = inst.tint;
+	vMaterialIndex = iMaterialIndex;
+
+	gl_Position = uProjCameraWorld * (inst.model * vec4( position, 1.0 ));
+}
@@ -0,0 +1,32 @@
+// Material access for models drawn with MeshRenderer (see main/mesh_renderer.hpp
+// and meshlib/mesh_draw.hpp).
+//
+// All submeshes of a model are drawn with a single glMultiDrawElementsIndirect().
+// The material parameters of the model are stored in a shader storage buffer;
+// each draw finds its material index in an instanced vertex attribute, which
+// is constant over the draw. This file is not a complete shader; include it
+// with #include "materials.glsl" (see support/shader_preprocess.hpp).
+
+// Must match GpuMaterial in meshlib/mesh_draw.hpp
+struct Material
+{
+	vec3 ambient;
+	float shininess;
+	vec3 diffuse;
+	vec3 specular;
+	vec3 emissive;
+};
+
+// Binding kMaterialBufferBinding
+layout( std430, binding = 0 ) readonly buffer Materials
+{
+	Material materials[];
+};
+
+// The material index is an attribute at location kDrawMaterialAttribute.
+// Vertex shaders declare it and forward it to the fragment shader with a
+// flat varying:
+//   layout( location = 3 ) in uint iMaterialIndex;
+//   flat out uint vMaterialIndex;
+//   ...
+//   vMaterialIndex = iMaterialIndex;
@@ -0,0 +1,32 @@
+// Decode helpers for the compressed vertex formats (see vmlib/packing.hpp and
+// VertexLayout::kCompressed in main/simple_mesh.hpp).
+//
+// Most of the formats are decoded by GL when the attribute is fetched:
+//  - half floats (GL_HALF_FLOAT)
+//  - normalized 16-bit integers, including the quantized positions; these
+//    still need the mesh's positionTransform, which is folded into the model
+//    matrix on the CPU side
+//  - 10_10_10_2 (GL_INT_2_10_10_10_REV with normalized = GL_TRUE)
+//
+// Octahedral normals are the exception and need oct_decode(). This file is
+// not a complete shader; include it with #include "packing.glsl" (see
+// support/shader_preprocess.hpp).
+
+// Inverse of oct_encode(). aEncoded is in [-1,1]^2, as delivered by a
+// normalized GL_SHORT attribute.
+vec3 oct_decode( vec2 aEncoded )
+{
+	vec3 n = vec3( aEncoded.xy, 1.0 - abs( aEncoded.x ) - abs( aEncoded.y ) );
+
+	float t = clamp( -n.z, 0.0, 1.0 );
+	n.xy += mix( vec2( t ), vec2( -t ), greaterThanEqual( n.xy, vec2( 0.0 ) ) );
+
+	return normalize( n );
+}
+
+// Quantized position to model space, for shaders that get the AABB as
+// uniforms instead of via the model matrix.
+vec3 dequantize_position( vec3 aQuantized, vec3 aBoundsMin, vec3 aBoundsExtent )
+{
+	return aBoundsMin + aQuantized * aBoundsExtent;
+}
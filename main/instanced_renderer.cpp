@@ -0,0 +1,139 @@
+#include "instanced_renderer.hpp"
+
+#include <utility>
+#include <algorithm>
+
+#include <cstring>
+
+#include "../support/error.hpp"
+
+InstancedRenderer::InstancedRenderer() noexcept = default;
+
+InstancedRenderer::~InstancedRenderer()
+{
+	for( auto const& mesh : mMeshes )
+		glDeleteBuffers( 1, &mesh.buffer );
+}
+
+InstancedRenderer::InstancedRenderer( InstancedRenderer&& aOther ) noexcept
+	: mMeshes( std::exchange( aOther.mMeshes, {} ) )
+{}
+InstancedRenderer& InstancedRenderer::operator= (InstancedRenderer&& aOther) noexcept
+{
+	std::swap( mMeshes, aOther.mMeshes );
+	return *this;
+}
+
+InstancedRenderer::MeshId InstancedRenderer::addMesh( MeshCache const& aCache, VertexLayout aLayout )
+{
+	Mesh_ mesh;
+	mesh.renderer = MeshRenderer( aCache, aLayout );
+	glGenBuffers( 1, &mesh.buffer );
+
+	mMeshes.emplace_back( std::move(mesh) );
+	return mMeshes.size()-1;
+}
+
+InstancedRenderer::InstanceId InstancedRenderer::addInstance( MeshId aMesh, Mat44f const& aModel, Vec4f aTint )
+{
+	if( aMesh >= mMeshes.size() )
+		throw Error( "InstancedRenderer: unknown mesh %zu", aMesh );
+
+	auto& mesh = mMeshes[aMesh];
+	mesh.instances.emplace_back( InstanceData{ aModel, aTint } );
+	mesh.dirty = true;
+	return mesh.instances.size()-1;
+}
+
+void InstancedRenderer::setInstance( MeshId aMesh, InstanceId aInstance, Mat44f const& aModel, Vec4f aTint )
+{
+	if( aMesh >= mMeshes.size() || aInstance >= mMeshes[aMesh].instances.size() )
+		throw Error( "InstancedRenderer: unknown instance %zu of mesh %zu", aInstance, aMesh );
+
+	auto& mesh = mMeshes[aMesh];
+	mesh.instances[aInstance] = InstanceData{ aModel, aTint };
+	mesh.dirty = true;
+}
+
+void InstancedRenderer::clearInstances( MeshId aMesh )
+{
+	if( aMesh >= mMeshes.size() )
+		throw Error( "InstancedRenderer: unknown mesh %zu", aMesh );
+
+	mMeshes[aMesh].instances.clear();
+	mMeshes[aMesh].dirty = true;
+}
+
+std::size_t InstancedRenderer::meshCount() const noexcept
+{
+	return mMeshes.size();
+}
+std::size_t InstancedRenderer::instanceCount( MeshId aMesh ) const noexcept
+{
+	return aMesh < mMeshes.size() ? mMeshes[aMesh].instances.size() : 0;
+}
+
+InstanceData const& InstancedRenderer::instance( MeshId aMesh, InstanceId aInstance ) const
+{
+	if( aMesh >= mMeshes.size() || aInstance >= mMeshes[aMesh].instances.size() )
+		throw Error( "InstancedRenderer: unknown instance %zu of mesh %zu", aInstance, aMesh );
+
+	return mMeshes[aMesh].instances[aInstance];
+}
+
+InstancedRenderer::DrawStats InstancedRenderer::draw( GLStateCache& aState, std::size_t aLod, RingBuffer* aStream )
+{
+	DrawStats ret{ 0, 0, 0 };
+	for( auto& mesh : mMeshes )
+	{
+		if( mesh.instances.empty() )
+			continue;
+
+		if( aStream )
+		{
+			// The mesh's own buffer stays dirty (if it is), and is updated
+			// if the mesh is drawn without a stream later.
+			std::size_t const bytes = mesh.instances.size() * sizeof(InstanceData);
+			auto const range = aStream->allocate( bytes );
+			std::memcpy( range.data, mesh.instances.data(), bytes );
+			aStream->flush();
+
+			range.bind( GL_SHADER_STORAGE_BUFFER, kInstanceBufferBinding );
+		}
+		else
+		{
+			if( mesh.dirty )
+				upload_( mesh );
+
+			glBindBufferBase( GL_SHADER_STORAGE_BUFFER, kInstanceBufferBinding, mesh.buffer );
+		}
+
+		auto const lod = std::min( aLod, mesh.renderer.lodCount()-1 );
+		auto const stats = mesh.renderer.draw( aState, lod, std::uint32_t(mesh.instances.size()) );
+
+		ret.calls += stats.calls;
+		ret.instances += mesh.instances.size();
+		ret.triangles += stats.triangles;
+	}
+
+	return ret;
+}
+
+void InstancedRenderer::upload_( Mesh_& aMesh )
+{
+	auto const bytes = GLsizeiptr(aMesh.instances.size() * sizeof(InstanceData));
+
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, aMesh.buffer );
+	if( aMesh.instances.size() > aMesh.capacity )
+	{
+		// Grow geometrically, such that adding instances one at a time does
+		// not reallocate every frame.
+		aMesh.capacity = std::max( aMesh.instances.size(), 2*aMesh.capacity );
+		glBufferData( GL_SHADER_STORAGE_BUFFER, GLsizeiptr(aMesh.capacity * sizeof(InstanceData)), nullptr, GL_DYNAMIC_DRAW );
+	}
+
+	glBufferSubData( GL_SHADER_STORAGE_BUFFER, 0, bytes, aMesh.instances.data() );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+	aMesh.dirty = false;
+}
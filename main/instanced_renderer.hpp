@@ -0,0 +1,116 @@
+#ifndef INSTANCED_RENDERER_HPP_279ED5F6_7851_4857_9F8A_FCD6D211AB53
+#define INSTANCED_RENDERER_HPP_279ED5F6_7851_4857_9F8A_FCD6D211AB53
+
+#include <glad.h>
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/mat44.hpp"
+
+#include "../meshlib/mesh_cache.hpp"
+
+#include "../support/ring_buffer.hpp"
+
+#include "mesh_renderer.hpp"
+
+// Shader interface, see assets/instanced.vert
+constexpr GLuint kInstanceBufferBinding = 1;
+
+/** InstanceData: per-instance data
+ *
+ * Element of the instance buffer; std430 layout. The model matrix is stored
+ * row-major, like Mat44f (the shader declares it as such).
+ */
+struct InstanceData
+{
+	Mat44f model;
+	Vec4f tint; // multiplies the material colors
+};
+
+static_assert( sizeof(InstanceData) == 80 );
+
+/** InstancedRenderer: draws many copies of a few meshes
+ *
+ * Meshes are registered once with addMesh(); instances (a model transform
+ * and a tint) are then added to them. draw() submits all instances of a mesh
+ * with a single instanced glMultiDrawElementsIndirect() (see MeshRenderer),
+ * i.e., the number of draw calls does not depend on the number of
+ * instances. The instance data is kept in a shader storage buffer at
+ * kInstanceBufferBinding, indexed with gl_InstanceID; it is re-uploaded only
+ * if instances were added or changed since the last draw().
+ *
+ * The caller is responsible for the shader program (e.g. assets/instanced.*)
+ * and its uniforms. All meshes drawn with one program must use the same
+ * VertexLayout. For VertexLayout::kCompressed, the program must be built with
+ * COMPRESSED_VERTICES; the dequantization uniforms are set per mesh by
+ * MeshRenderer::draw(). Requires a current OpenGL context for all operations
+ * except the instance modifications.
+ */
+class InstancedRenderer final
+{
+	public:
+		using MeshId = std::size_t;
+		using InstanceId = std::size_t;
+
+		struct DrawStats
+		{
+			std::size_t calls; // GL draw calls
+			std::size_t instances;
+			std::size_t triangles;
+		};
+
+	public:
+		InstancedRenderer() noexcept;
+
+		~InstancedRenderer();
+
+		InstancedRenderer( InstancedRenderer const& ) = delete;
+		InstancedRenderer& operator= (InstancedRenderer const&) = delete;
+
+		InstancedRenderer( InstancedRenderer&& ) noexcept;
+		InstancedRenderer& operator= (InstancedRenderer&&) noexcept;
+
+	public:
+		MeshId addMesh( MeshCache const&, VertexLayout = VertexLayout::kFloat32 );
+
+		InstanceId addInstance( MeshId, Mat44f const& aModel, Vec4f aTint = { 1.f, 1.f, 1.f, 1.f } );
+		void setInstance( MeshId, InstanceId, Mat44f const& aModel, Vec4f aTint );
+		void clearInstances( MeshId );
+
+		std::size_t meshCount() const noexcept;
+		std::size_t instanceCount( MeshId ) const noexcept;
+
+		InstanceData const& instance( MeshId, InstanceId ) const;
+
+		// Draws all instances of all meshes with level of detail aLod (or the
+		// coarsest available level, if a mesh has fewer levels).
+		//
+		// With aStream, the instance data of all meshes is written to the
+		// ring buffer instead, and read from there. This is meant for
+		// instances that change every frame: it avoids updating buffers that
+		// the GPU may still be reading from. aStream must be between its
+		// beginFrame() and endFrame().
+		DrawStats draw( GLStateCache&, std::size_t aLod = 0, RingBuffer* aStream = nullptr );
+
+	private:
+		struct Mesh_
+		{
+			MeshRenderer renderer;
+			std::vector<InstanceData> instances;
+
+			GLuint buffer = 0;
+			std::size_t capacity = 0; // instances
+			bool dirty = false;
+		};
+
+		void upload_( Mesh_& );
+
+	private:
+		std::vector<Mesh_> mMeshes;
+};
+
+#endif // INSTANCED_RENDERER_HPP_279ED5F6_7851_4857_9F8A_FCD6D211AB53
@@ -1,31 +1,111 @@
 #include <glad.h>
 #include <GLFW/glfw3.h>
 
+#include <cmath>
+#include <future>
+#include <optional>
+#include <vector>
+#include <algorithm>
 #include <typeinfo>
 #include <stdexcept>
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include "../support/error.hpp"
 #include "../support/program.hpp"
+#include "../support/program_cache.hpp"
+#include "../support/shader_permutations.hpp"
+#include "../support/uniform_buffer.hpp"
+#include "../support/gl_state.hpp"
+#include "../support/ring_buffer.hpp"
+#include "../support/file_watcher.hpp"
 #include "../support/checkpoint.hpp"
 #include "../support/debug_output.hpp"
 
 #include "../vmlib/vec4.hpp"
 #include "../vmlib/mat44.hpp"
+#include "../vmlib/bounds.hpp"
 
+#include "../meshlib/terrain.hpp"
+
+#include "texture.hpp"
 #include "defaults.hpp"
+#include "simple_mesh.hpp"
+#include "mesh_renderer.hpp"
+#include "instanced_renderer.hpp"
+#include "startup_timings.hpp"
+#include "profiler.hpp"
 
 
 namespace
 {
 	constexpr char const* kWindowTitle = "COMP3811 - CW2";
+
+	constexpr char const* kLandingPadPath = "assets/landingpad.obj";
+	constexpr char const* kDefaultTexturePath = "assets/white.png";
+
+	// Linked shader programs are cached here (see support/program_cache.hpp)
+	constexpr char const* kProgramCacheDir = "assets/.program-cache";
+
+	// Shaders in this directory are reloaded when they are modified
+	constexpr char const* kShaderDir = "assets";
+
+	// Copies of the landing pad in the scene, unless overridden with --stress
+	constexpr std::size_t kDefaultLandingPads = 2;
+
+	// Interval for the frame time reports in stress mode
+	constexpr Secondsf kStressReportInterval{ 2.f };
+
+	// Written when P is pressed, see Profiler
+	constexpr char const* kTracePath = "trace.json";
+
+	// Rotation speed of the instances with --animate (radians per second)
+	constexpr float kAnimationSpeed = 0.5f;
 	
 	void glfw_callback_error_( int, char const* );
 
 	void glfw_callback_key_( GLFWwindow*, int, int, int, int );
 
+	// Per-frame data, see assets/frame.glsl
+	constexpr GLuint kFrameBufferBinding = 2;
+
+	struct FrameData_
+	{
+		Mat44f projCameraWorld;
+		Vec4f lightDir; // xyz: towards the light, normalized
+	};
+
+	static_assert( sizeof(FrameData_) == 80 );
+
+	// Base color texture of the props, see assets/instanced.frag. The landing
+	// pad's materials have no textures; white.png stands in for them.
+	constexpr GLuint kBaseColorTextureUnit = 0;
+
+	// State modified by the GLFW callbacks (via the window user pointer)
+	struct State_
+	{
+		bool showNormals = false; // toggled with N
+		bool dumpProfile = false; // set by P, cleared by the main loop
+	};
+
+	struct Options_
+	{
+		std::size_t stressInstances = 0; // 0 = off
+		bool animate = false;
+		bool programCache = true;
+		bool asyncGLDebug = false; // debug builds only, see GLDebugOptions
+		bool compressedVertices = false; // VertexLayout::kCompressed for the props
+	};
+
+	Options_ parse_options_( int aArgc, char* aArgv[] );
+
+	// Places aCount copies of a mesh with bounds aBounds on a square grid in
+	// the XZ plane, centered on the origin, with varying tints. Returns the
+	// half-size of the grid.
+	float place_instances_( InstancedRenderer&, InstancedRenderer::MeshId, Aabb3f const& aBounds, std::size_t aCount );
+
 	struct GLFWCleanupHelper
 	{
 		~GLFWCleanupHelper();
@@ -37,9 +117,30 @@ namespace
 	};
 }
 
-int main() try
+int main( int aArgc, char* aArgv[] ) try
 {
+	StartupTimings timings;
+
+	Options_ const options = parse_options_( aArgc, aArgv );
+
+	// Start loading assets on worker threads. Parsing meshes and decoding
+	// images doesn't require an OpenGL context, so this overlaps with the
+	// window and context creation below. Only the final upload to the GPU
+	// waits for the context (and for the workers).
+	//
+	// Note: if anything throws before the results are collected, the
+	// std::future destructors wait for the workers to finish.
+	auto landingPadFuture = std::async( std::launch::async, [&timings] {
+		auto const stage_ = timings.stage( "load landingpad.obj" );
+		return load_mesh_cached( kLandingPadPath );
+	} );
+	auto defaultTextureFuture = std::async( std::launch::async, [&timings] {
+		auto const stage_ = timings.stage( "load white.png" );
+		return load_texture_cached( kDefaultTexturePath, TextureCacheFormat::kBc7Srgb );
+	} );
+
 	// Initialize GLFW
+	auto const glfwInitBegin = Clock::now();
 	if( GLFW_TRUE != glfwInit() )
 	{
 		char const* msg = nullptr;
@@ -47,6 +148,8 @@ int main() try
 		throw Error( "glfwInit() failed with '%s' (%d)", msg, ecode );
 	}
 
+	timings.record( "glfwInit", glfwInitBegin, Clock::now() );
+
 	// Ensure that we call glfwTerminate() at the end of the program.
 	GLFWCleanupHelper cleanupHelper;
 
@@ -72,6 +175,7 @@ int main() try
 	glfwWindowHint( GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE );
 #	endif // ~ !NDEBUG
 
+	auto const windowBegin = Clock::now();
 	GLFWwindow* window = glfwCreateWindow(
 		1280,
 		720,
@@ -88,20 +192,32 @@ int main() try
 
 	GLFWWindowDeleter windowDeleter{ window };
 
+	timings.record( "glfwCreateWindow", windowBegin, Clock::now() );
+
 	// Set up event handling
 	// TODO: Additional event handling setup
 
+	State_ state;
+	glfwSetWindowUserPointer( window, &state );
+
 	glfwSetKeyCallback( window, &glfw_callback_key_ );
 
 	// Set up drawing stuff
 	glfwMakeContextCurrent( window );
 	glfwSwapInterval( 1 ); // V-Sync is on.
 
+	// Stress mode reports frame times; V-Sync would hide them.
+	if( options.stressInstances )
+		glfwSwapInterval( 0 );
+
 	// Initialize GLAD
 	// This will load the OpenGL API. We mustn't make any OpenGL calls before this!
+	auto const gladBegin = Clock::now();
 	if( !gladLoadGLLoader( (GLADloadproc)&glfwGetProcAddress ) )
 		throw Error( "gladLoaDGLLoader() failed - cannot load GL API!" );
 
+	timings.record( "gladLoadGLLoader", gladBegin, Clock::now() );
+
 	std::printf( "RENDERER %s\n", glGetString( GL_RENDERER ) );
 	std::printf( "VENDOR %s\n", glGetString( GL_VENDOR ) );
 	std::printf( "VERSION %s\n", glGetString( GL_VERSION ) );
@@ -109,13 +225,20 @@ int main() try
 
 	// Ddebug output
 #	if !defined(NDEBUG)
-	setup_gl_debug_output();
+	GLDebugOptions debugOptions;
+	debugOptions.asynchronous = options.asyncGLDebug;
+	setup_gl_debug_output( debugOptions );
 #	endif // ~ !NDEBUG
 
 	// Global GL state
 	OGL_CHECKPOINT_ALWAYS();
 
-	// TODO: global GL setup goes here
+	// Draw-time state changes go through the cache, which skips redundant
+	// ones (see support/gl_state.hpp).
+	GLStateCache glState;
+
+	glState.enable( GL_FRAMEBUFFER_SRGB );
+	glClearColor( 0.2f, 0.2f, 0.2f, 1.f );
 
 	OGL_CHECKPOINT_ALWAYS();
 
@@ -133,9 +256,117 @@ int main() try
 	
 	// TODO: global GL setup goes here
 
+	ProgramBinaryCache programCache( kProgramCacheDir );
+	ProgramBinaryCache* const programCachePtr = options.programCache ? &programCache : nullptr;
+
+	// Both permutations for the selected vertex layout are built up front,
+	// so that toggling between them at run time doesn't stall.
+	ShaderPermutations instancedShaders( {
+		{ GL_VERTEX_SHADER, "assets/instanced.vert" },
+		{ GL_FRAGMENT_SHADER, "assets/instanced.frag" }
+	}, { "SHOW_NORMALS", "COMPRESSED_VERTICES" }, programCachePtr );
+
+	VertexLayout const propLayout = options.compressedVertices ? VertexLayout::kCompressed : VertexLayout::kFloat32;
+
+	auto const kBaseKey = options.compressedVertices ? instancedShaders.feature( "COMPRESSED_VERTICES" ) : 0;
+	auto const kShowNormals = kBaseKey | instancedShaders.feature( "SHOW_NORMALS" );
+	{
+		auto const stage_ = timings.stage( "shader programs" );
+		instancedShaders.prepare( kBaseKey );
+		instancedShaders.prepare( kShowNormals );
+	}
+
+	// Camera and light parameters, shared by all programs
+	UniformBuffer<FrameData_> frameData( kFrameBufferBinding );
+	frameData.validate( instancedShaders.program( kBaseKey ).reflection(), "Frame" );
+	frameData.validate( instancedShaders.program( kShowNormals ).reflection(), "Frame" );
+
+	if( programCachePtr )
+	{
+		auto const stats = programCache.stats();
+		std::printf( "Program cache: %zu hit(s), %zu miss(es) (%zu rejected), %zu stored\n",
+			stats.hits,
+			stats.misses,
+			stats.rejected,
+			stats.stores
+		);
+	}
+
+	// Upload assets. This waits for the workers started at the beginning of
+	// main(). The OBJ is only parsed (and the image only decoded) if the
+	// binary cache is missing or out of date; see meshlib/mesh_cache.hpp and
+	// texlib/texture_cache.hpp.
+	InstancedRenderer props;
+	InstancedRenderer::MeshId landingPad = 0;
+	Aabb3f landingPadBounds = kEmptyAabb3f;
+	std::optional<MeshCache> landingPadCache; // kept for select_mesh_lod()
+	GLuint defaultTexture = 0;
+	{
+		auto const waitBegin = Clock::now();
+		landingPadCache.emplace( landingPadFuture.get() );
+		TextureCache const defaultTextureCache = defaultTextureFuture.get();
+		timings.record( "wait for workers", waitBegin, Clock::now() );
+
+		auto const stage_ = timings.stage( "GPU upload" );
+		landingPad = props.addMesh( *landingPadCache, propLayout );
+		landingPadBounds = landingPadCache->bounds();
+		defaultTexture = create_texture_2d( defaultTextureCache );
+	}
+
+	std::size_t const padCount = options.stressInstances ? options.stressInstances : kDefaultLandingPads;
+	float const sceneRadius = place_instances_( props, landingPad, landingPadBounds, padCount );
+
+	// Loading binds vertex arrays and textures directly
+	glState.invalidate();
+
+	// With --animate, the instances change every frame. Their data is then
+	// streamed through a persistently mapped ring buffer (which holds one
+	// copy of all instances per frame in flight).
+	std::vector<InstanceData> baseInstances;
+	RingBuffer instanceStream;
+	if( options.animate )
+	{
+		for( std::size_t i = 0; i < padCount; ++i )
+			baseInstances.emplace_back( props.instance( landingPad, i ) );
+
+		instanceStream = RingBuffer( padCount * sizeof(InstanceData) + 4096 );
+		if( !instanceStream.persistent() )
+			std::fprintf( stderr, "Note: glBufferStorage() requires OpenGL 4.4 or ARB_buffer_storage; streaming via glBufferSubData()\n" );
+	}
+
 	OGL_CHECKPOINT_ALWAYS();
 
+	// Fixed camera that overlooks all instances
+	float const camDistance = 1.5f * sceneRadius + 2.f * length( extents( landingPadBounds ) );
+	Vec3f const camPosition{ 0.f, 0.7f * camDistance, camDistance };
+	Mat44f const world2camera = make_rotation_x( std::atan2( camPosition.y, camPosition.z ) ) * make_translation( -camPosition );
+
+	Vec3f const lightDir = normalize( Vec3f{ 0.3f, 1.f, 0.5f } );
+
+	// Reload shaders when they change. This is a development aid, so failing
+	// to set it up is not fatal.
+	std::optional<FileWatcher> shaderWatcher;
+	try
+	{
+		shaderWatcher.emplace( kShaderDir );
+	}
+	catch( Error const& eErr )
+	{
+		std::fprintf( stderr, "Note: shader hot reload disabled: %s\n", eErr.what() );
+	}
+
 	// Main loop
+	bool firstFrame = true;
+
+	auto const animationBegin = Clock::now();
+
+	auto reportBegin = Clock::now();
+	std::size_t reportFrames = 0;
+	InstancedRenderer::DrawStats drawStats{};
+	GLStateCache::Stats stateStats{};
+
+	Profiler profiler;
+
 	while( !glfwWindowShouldClose( window ) )
 	{
 		// Let GLFW process events
@@ -159,26 +390,213 @@ int main() try
 					glfwWaitEvents();
 					glfwGetFramebufferSize( window, &nwidth, &nheight );
 				} while( 0 == nwidth || 0 == nheight );
+
+				fbwidth = float(nwidth);
+				fbheight = float(nheight);
 			}
 
 			glViewport( 0, 0, nwidth, nheight );
 		}
 
+		profiler.beginFrame();
+
 		// Update state
 		//TODO: update state
 
+		// Reload modified shaders. The reload is asynchronous; the old program
+		// is used until the new one is ready (or if the new one fails).
+		try
+		{
+			auto const zone_ = profiler.cpuZone( "shader reload" );
+
+			if( shaderWatcher )
+			{
+				for( auto const& path : shaderWatcher->poll() )
+				{
+					if( instancedShaders.usesFile( path ) )
+					{
+						std::printf( "Reloading shaders ('%s' changed)\n", path.c_str() );
+						instancedShaders.reloadAsync();
+					}
+				}
+			}
+
+			if( instancedShaders.poll() )
+			{
+				std::printf( "Shaders reloaded\n" );
+
+				// The reloaded programs are already in use at this point, so
+				// the previous ones can't be kept.
+				try
+				{
+					frameData.validate( instancedShaders.program( kBaseKey ).reflection(), "Frame" );
+					frameData.validate( instancedShaders.program( kShowNormals ).reflection(), "Frame" );
+				}
+				catch( Error const& eErr )
+				{
+					std::fprintf( stderr, "Note: reloaded program has an incompatible Frame block:\n%s\n", eErr.what() );
+				}
+			}
+		}
+		catch( Error const& eErr )
+		{
+			std::fprintf( stderr, "Note: shader reload failed, keeping the previous program:\n%s\n", eErr.what() );
+		}
+
 		// Draw scene
 		OGL_CHECKPOINT_DEBUG();
 
 		//TODO: draw frame
+		{
+			auto const zone_ = profiler.gpuZone( "clear" );
+			glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+		}
+
+		float const fovY = 60.f * kPif / 180.f;
+		Mat44f const projection = make_perspective_projection( 
+			fovY,
+			fbwidth / fbheight,
+			0.1f, 4.f * camDistance
+		);
+		Mat44f const projCameraWorld = projection * world2camera;
+
+		frameData.update( FrameData_{ projCameraWorld, Vec4f{ lightDir.x, lightDir.y, lightDir.z, 0.f } } );
+
+		// State for opaque geometry. This is set per pass; the cache
+		// filters out the calls that don't change anything.
+		glState.enable( GL_DEPTH_TEST );
+		glState.enable( GL_CULL_FACE );
+		glState.disable( GL_BLEND );
+		glState.depthMask( true );
+
+		// All props share one level of detail, chosen for the nearest
+		// possible instance.
+		float const propDistance = std::max( camDistance - sceneRadius, 0.1f );
+		std::size_t const propLod = select_mesh_lod( *landingPadCache, propDistance, terrain_error_scale( fovY, fbheight ) );
+
+		auto const& instancedProg = instancedShaders.program( state.showNormals ? kShowNormals : kBaseKey );
+		glState.useProgram( instancedProg.programId() );
+		glState.bindTexture( kBaseColorTextureUnit, GL_TEXTURE_2D, defaultTexture );
+
+		{
+			auto const zone_ = profiler.gpuZone( "instanced props" );
+
+			if( options.animate )
+			{
+				// The time since startup grows without bound; keep it in double
+				// precision (see Secondsf), and wrap the angle before converting
+				// it to float.
+				constexpr double kTwoPi = 2.0 * 3.14159265358979323846;
+				std::chrono::duration<double> const time = Clock::now() - animationBegin;
+				float const baseAngle = float(std::fmod( double(kAnimationSpeed) * time.count(), kTwoPi ));
+
+				for( std::size_t i = 0; i < baseInstances.size(); ++i )
+				{
+					float const angle = baseAngle + 0.1f * float(i);
+					props.setInstance( landingPad, i, baseInstances[i].model * make_rotation_y( angle ), baseInstances[i].tint );
+				}
+
+				instanceStream.beginFrame();
+				drawStats = props.draw( glState, propLod, &instanceStream );
+				instanceStream.endFrame();
+			}
+			else
+			{
+				drawStats = props.draw( glState, propLod );
+			}
+		}
 
 		OGL_CHECKPOINT_DEBUG();
 
+		// Once per frame. Catches errors from deferred checkpoints (release
+		// builds) and from code without checkpoints.
+		flush_gl_checkpoints();
+
+#		if !defined(NDEBUG)
+		glState.verify();
+#		endif // ~ !NDEBUG
+
+		stateStats = glState.stats();
+		glState.resetStats();
+
 		// Display results
-		glfwSwapBuffers( window );
+		{
+			auto const zone_ = profiler.cpuZone( "swap buffers" );
+			glfwSwapBuffers( window );
+		}
+
+		profiler.endFrame();
+
+		if( state.dumpProfile )
+		{
+			state.dumpProfile = false;
+
+			try
+			{
+				profiler.writeChromeTrace( kTracePath );
+				std::printf( "Wrote '%s'\n", kTracePath );
+			}
+			catch( Error const& eErr )
+			{
+				std::fprintf( stderr, "Note: unable to write profile:\n%s\n", eErr.what() );
+			}
+
+			profiler.printSummary( stdout );
+		}
+
+		if( firstFrame )
+		{
+			// "elapsed" is the time to first frame
+			timings.print( stdout );
+			firstFrame = false;
+		}
+
+		if( options.stressInstances )
+		{
+			++reportFrames;
+
+			auto const now = Clock::now();
+			Secondsf const elapsed = now - reportBegin;
+			if( elapsed >= kStressReportInterval )
+			{
+				float const frameMs = 1000.f * elapsed.count() / float(reportFrames);
+				std::printf( "Stress: %zu instances, %zu draw call(s), %zu triangles, %zu state change(s) (%zu skipped): %.3f ms/frame (%.1f FPS)\n",
+					drawStats.instances,
+					drawStats.calls,
+					drawStats.triangles,
+					stateStats.issued,
+					stateStats.skipped,
+					double(frameMs),
+					double(1000.f / frameMs)
+				);
+
+				if( options.animate )
+				{
+					auto const streamStats = instanceStream.stats();
+					std::printf( "Stream: %zu frame(s), %zu stall(s), %zu bytes/frame peak\n",
+						streamStats.frames,
+						streamStats.stalls,
+						streamStats.peakBytes
+					);
+				}
+
+				print_gl_checkpoint_stats( stdout );
+
+				reportBegin = now;
+				reportFrames = 0;
+			}
+		}
 	}
 
 	// Cleanup.
+	props = InstancedRenderer();
+	instanceStream = RingBuffer();
+	glDeleteTextures( 1, &defaultTexture );
+
+#	if !defined(NDEBUG)
+	shutdown_gl_debug_output();
+#	endif // ~ !NDEBUG
+
 	//TODO: additional cleanup
 	
 	return 0;
@@ -194,6 +612,68 @@ catch( std::exception const& eErr )
 
 namespace
 {
+	Options_ parse_options_( int aArgc, char* aArgv[] )
+	{
+		Options_ ret;
+		for( int i = 1; i < aArgc; ++i )
+		{
+			if( 0 == std::strcmp( aArgv[i], "--stress" ) && i+1 < aArgc )
+			{
+				int const count = std::atoi( aArgv[++i] );
+				if( count <= 0 )
+					throw Error( "--stress: expected a positive instance count, got '%s'", aArgv[i] );
+
+				ret.stressInstances = std::size_t(count);
+			}
+			else if( 0 == std::strcmp( aArgv[i], "--animate" ) )
+			{
+				ret.animate = true;
+			}
+			else if( 0 == std::strcmp( aArgv[i], "--no-program-cache" ) )
+			{
+				ret.programCache = false;
+			}
+			else if( 0 == std::strcmp( aArgv[i], "--compressed-vertices" ) )
+			{
+				ret.compressedVertices = true;
+			}
+			else if( 0 == std::strcmp( aArgv[i], "--gl-debug-async" ) )
+			{
+				ret.asyncGLDebug = true;
+			}
+			else
+			{
+				throw Error( "Unknown argument '%s'\nUsage: %s [--stress N] [--animate] [--no-program-cache] [--compressed-vertices] [--gl-debug-async]", aArgv[i], aArgv[0] );
+			}
+		}
+
+		return ret;
+	}
+
+	float place_instances_( InstancedRenderer& aRenderer, InstancedRenderer::MeshId aMesh, Aabb3f const& aBounds, std::size_t aCount )
+	{
+		auto const side = std::size_t(std::ceil( std::sqrt( double(aCount) ) ));
+
+		Vec3f const ext = extents( aBounds );
+		Vec3f const mid = center( aBounds );
+		float const spacing = 2.5f * std::max( ext.x, ext.z );
+		float const offset = 0.5f * float(side-1) * spacing;
+
+		for( std::size_t i = 0; i < aCount; ++i )
+		{
+			float const x = float(i % side) * spacing - offset;
+			float const z = float(i / side) * spacing - offset;
+
+			// Cheap, deterministic variation
+			float const t = float(i % 7) / 6.f;
+			Vec4f const tint{ 1.f - 0.4f*t, 0.8f + 0.2f*t, 0.6f + 0.4f*t, 1.f };
+
+			aRenderer.addInstance( aMesh, make_translation( Vec3f{ x - mid.x, -mid.y, z - mid.z } ), tint );
+		}
+
+		return offset + spacing;
+	}
+
 	void glfw_callback_error_( int aErrNum, char const* aErrDesc )
 	{
 		std::fprintf( stderr, "GLFW error: %s (%d)\n", aErrDesc, aErrNum );
@@ -206,6 +686,12 @@ namespace
 			glfwSetWindowShouldClose( aWindow, GLFW_TRUE );
 			return;
 		}
+
+		auto* state = static_cast<State_*>(glfwGetWindowUserPointer( aWindow ));
+		if( state && GLFW_KEY_N == aKey && GLFW_PRESS == aAction )
+			state->showNormals = !state->showNormals;
+		if( state && GLFW_KEY_P == aKey && GLFW_PRESS == aAction )
+			state->dumpProfile = true;
 	}
 
 }
@@ -0,0 +1,151 @@
+#include "mesh_renderer.hpp"
+
+#include <limits>
+#include <utility>
+
+namespace
+{
+	// Divisor for the material index attribute. The attribute is fetched
+	// from element baseInstance + gl_InstanceID / divisor, i.e., from
+	// baseInstance for all instances.
+	constexpr GLuint kConstantDivisor_ = GLuint(std::numeric_limits<GLint>::max());
+
+	template< typename tType >
+	GLuint create_buffer_( GLenum aTarget, std::vector<tType> const& aData )
+	{
+		GLuint ret = 0;
+		glGenBuffers( 1, &ret );
+		glBindBuffer( aTarget, ret );
+		glBufferData( aTarget, GLsizeiptr(aData.size() * sizeof(tType)), aData.data(), GL_STATIC_DRAW );
+		return ret;
+	}
+}
+
+MeshRenderer::MeshRenderer() noexcept
+	: mIndirectBuffer( 0 )
+	, mDrawMaterialBuffer( 0 )
+	, mMaterialBuffer( 0 )
+	, mInstanceCount( 1 )
+{}
+
+MeshRenderer::MeshRenderer( MeshCache const& aCache, VertexLayout aLayout )
+	: mMesh( create_vao( aCache, aLayout ) )
+	, mInstanceCount( 1 )
+{
+	auto batch = make_draw_batch( aCache );
+	mLodFirstCommand = batch.lodFirstCommand;
+
+	for( std::size_t l = 0; l+1 < mLodFirstCommand.size(); ++l )
+	{
+		std::size_t tris = 0;
+		for( std::size_t i = mLodFirstCommand[l]; i < mLodFirstCommand[l+1]; ++i )
+			tris += batch.commands[i].count / 3;
+		mLodTriangles.emplace_back( tris );
+	}
+
+	mIndirectBuffer = create_buffer_( GL_DRAW_INDIRECT_BUFFER, batch.commands );
+	mMaterialBuffer = create_buffer_( GL_SHADER_STORAGE_BUFFER, batch.materials );
+
+	// The material index attribute is part of the VAO state.
+	glBindVertexArray( mMesh.vao );
+	mDrawMaterialBuffer = create_buffer_( GL_ARRAY_BUFFER, batch.drawMaterials );
+	glVertexAttribIPointer( kDrawMaterialAttribute, 1, GL_UNSIGNED_INT, 0, nullptr );
+	glVertexAttribDivisor( kDrawMaterialAttribute, kConstantDivisor_ );
+	glEnableVertexAttribArray( kDrawMaterialAttribute );
+	glBindVertexArray( 0 );
+
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+	glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+	mCommands = std::move(batch.commands);
+}
+
+MeshRenderer::~MeshRenderer()
+{
+	destroy_vao( mMesh );
+
+	GLuint const buffers[] = { mIndirectBuffer, mDrawMaterialBuffer, mMaterialBuffer };
+	glDeleteBuffers( 3, buffers );
+}
+
+MeshRenderer::MeshRenderer( MeshRenderer&& aOther ) noexcept
+	: mMesh( std::exchange( aOther.mMesh, GpuMesh{} ) )
+	, mIndirectBuffer( std::exchange( aOther.mIndirectBuffer, 0 ) )
+	, mDrawMaterialBuffer( std::exchange( aOther.mDrawMaterialBuffer, 0 ) )
+	, mMaterialBuffer( std::exchange( aOther.mMaterialBuffer, 0 ) )
+	, mCommands( std::move(aOther.mCommands) )
+	, mInstanceCount( aOther.mInstanceCount )
+	, mLodFirstCommand( std::move(aOther.mLodFirstCommand) )
+	, mLodTriangles( std::move(aOther.mLodTriangles) )
+{}
+MeshRenderer& MeshRenderer::operator= (MeshRenderer&& aOther) noexcept
+{
+	std::swap( mMesh, aOther.mMesh );
+	std::swap( mIndirectBuffer, aOther.mIndirectBuffer );
+	std::swap( mDrawMaterialBuffer, aOther.mDrawMaterialBuffer );
+	std::swap( mMaterialBuffer, aOther.mMaterialBuffer );
+	std::swap( mCommands, aOther.mCommands );
+	std::swap( mInstanceCount, aOther.mInstanceCount );
+	std::swap( mLodFirstCommand, aOther.mLodFirstCommand );
+	std::swap( mLodTriangles, aOther.mLodTriangles );
+	return *this;
+}
+
+MeshRenderer::DrawStats MeshRenderer::draw( GLStateCache& aState, std::size_t aLod, std::uint32_t aInstanceCount )
+{
+	if( aLod >= lodCount() || 0 == aInstanceCount )
+		return DrawStats{ 0, 0, 0 };
+
+	std::uint32_t const first = mLodFirstCommand[aLod];
+	std::uint32_t const count = mLodFirstCommand[aLod+1] - first;
+	if( 0 == count )
+		return DrawStats{ 0, 0, 0 };
+
+	aState.bindVertexArray( mMesh.vao );
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer );
+
+	if( aInstanceCount != mInstanceCount )
+	{
+		for( auto& cmd : mCommands )
+			cmd.instanceCount = aInstanceCount;
+
+		glBufferSubData( GL_DRAW_INDIRECT_BUFFER, 0, GLsizeiptr(mCommands.size() * sizeof(DrawElementsIndirectCommand)), mCommands.data() );
+		mInstanceCount = aInstanceCount;
+	}
+	glBindBufferBase( GL_SHADER_STORAGE_BUFFER, kMaterialBufferBinding, mMaterialBuffer );
+
+	if( VertexLayout::kCompressed == mMesh.layout )
+	{
+		// positionTransform is translation( min ) * scaling( extent )
+		auto const& deq = mMesh.positionTransform;
+		glUniform3f( kPositionMinUniform, deq(0,3), deq(1,3), deq(2,3) );
+		glUniform3f( kPositionExtentUniform, deq(0,0), deq(1,1), deq(2,2) );
+	}
+
+	glMultiDrawElementsIndirect( 
+		GL_TRIANGLES, 
+		mMesh.indexType, 
+		reinterpret_cast<void const*>(std::size_t(first) * sizeof(DrawElementsIndirectCommand)), 
+		GLsizei(count), 
+		0 
+	);
+
+	glBindBuffer( GL_DRAW_INDIRECT_BUFFER, 0 );
+
+	return DrawStats{ 1, count, mLodTriangles[aLod] * aInstanceCount };
+}
+
+std::size_t MeshRenderer::lodCount() const noexcept
+{
+	return mLodTriangles.size();
+}
+
+VertexLayout MeshRenderer::layout() const noexcept
+{
+	return mMesh.layout;
+}
+Mat44f const& MeshRenderer::positionTransform() const noexcept
+{
+	return mMesh.positionTransform;
+}
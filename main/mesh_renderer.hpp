@@ -0,0 +1,97 @@
+#ifndef MESH_RENDERER_HPP_88EABBB3_C20E_4F9F_BF7D_3FAC660E905F
+#define MESH_RENDERER_HPP_88EABBB3_C20E_4F9F_BF7D_3FAC660E905F
+
+#include <glad.h>
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../meshlib/mesh_draw.hpp"
+#include "../meshlib/mesh_cache.hpp"
+
+#include "../support/gl_state.hpp"
+
+#include "simple_mesh.hpp"
+
+// Shader interface, see assets/materials.glsl
+constexpr GLuint kMaterialBufferBinding = 0;
+constexpr GLuint kDrawMaterialAttribute = 3;
+
+// VertexLayout::kCompressed only: bounds of the quantized positions, see
+// assets/instanced.vert
+constexpr GLint kPositionMinUniform = 0;
+constexpr GLint kPositionExtentUniform = 1;
+
+/** MeshRenderer: draws all submeshes of a model with one call
+ *
+ * Uploads the vertices and indices of a mesh cache, the materials (as a
+ * shader storage buffer) and the draw commands of all levels of detail (see
+ * make_draw_batch()). draw() then submits one level with a single
+ * glMultiDrawElementsIndirect(), independently of the number of materials.
+ * With aInstanceCount > 1, each submesh is drawn that many times; the
+ * shader distinguishes the copies by gl_InstanceID (see InstancedRenderer).
+ *
+ * The caller is responsible for the shader program and its remaining
+ * uniforms. The vertex layout is chosen at construction (see VertexLayout),
+ * plus the material index at kDrawMaterialAttribute. For
+ * VertexLayout::kCompressed, the program must decode the vertices (e.g.
+ * assets/instanced.vert built with COMPRESSED_VERTICES); draw() sets the
+ * dequantization uniforms (kPositionMinUniform and kPositionExtentUniform).
+ *
+ * draw() binds the vertex array through the GLStateCache and leaves it bound.
+ * Construction binds the vertex array directly; invalidate the cache
+ * afterwards.
+ *
+ * A default-constructed MeshRenderer is empty and draws nothing. Requires a
+ * current OpenGL context for construction, draw() and destruction.
+ */
+class MeshRenderer final
+{
+	public:
+		struct DrawStats
+		{
+			std::size_t calls; // GL draw calls
+			std::size_t commands; // submeshes
+			std::size_t triangles;
+		};
+
+	public:
+		MeshRenderer() noexcept;
+		explicit MeshRenderer( MeshCache const&, VertexLayout = VertexLayout::kFloat32 );
+
+		~MeshRenderer();
+
+		MeshRenderer( MeshRenderer const& ) = delete;
+		MeshRenderer& operator= (MeshRenderer const&) = delete;
+
+		MeshRenderer( MeshRenderer&& ) noexcept;
+		MeshRenderer& operator= (MeshRenderer&&) noexcept;
+
+	public:
+		// aLod is an index into MeshCache::lods(); see select_mesh_lod().
+		DrawStats draw( GLStateCache&, std::size_t aLod = 0, std::uint32_t aInstanceCount = 1 );
+
+		std::size_t lodCount() const noexcept;
+
+		VertexLayout layout() const noexcept;
+		Mat44f const& positionTransform() const noexcept; // see GpuMesh
+
+	private:
+		GpuMesh mMesh;
+
+		GLuint mIndirectBuffer;
+		GLuint mDrawMaterialBuffer;
+		GLuint mMaterialBuffer;
+
+		// Copy of the indirect buffer. Its instanceCount fields are updated
+		// when draw() is called with a different number of instances.
+		std::vector<DrawElementsIndirectCommand> mCommands;
+		std::uint32_t mInstanceCount;
+
+		std::vector<std::uint32_t> mLodFirstCommand;
+		std::vector<std::size_t> mLodTriangles;
+};
+
+#endif // MESH_RENDERER_HPP_88EABBB3_C20E_4F9F_BF7D_3FAC660E905F
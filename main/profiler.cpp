@@ -0,0 +1,321 @@
+#include "profiler.hpp"
+
+#include <chrono>
+#include <algorithm>
+#include <string_view>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	// Queries are allocated in batches of this many
+	constexpr std::size_t kQueryBatch_ = 32;
+
+	double to_us_( Clock::duration aDuration ) noexcept
+	{
+		return std::chrono::duration<double, std::micro>( aDuration ).count();
+	}
+
+	bool results_available_( std::vector<GLuint> const& aQueries, std::size_t aUsed )
+	{
+		if( 0 == aUsed )
+			return true;
+
+		// Timestamps complete in order; if the last one is available, so are
+		// all others.
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv( aQueries[aUsed-1], GL_QUERY_RESULT_AVAILABLE, &available );
+		return GL_FALSE != available;
+	}
+
+	void write_json_string_( std::FILE* aOut, char const* aString )
+	{
+		std::fputc( '"', aOut );
+		for( char const* ptr = aString; *ptr; ++ptr )
+		{
+			auto const c = static_cast<unsigned char>(*ptr);
+			if( '"' == c || '\\' == c )
+				std::fprintf( aOut, "\\%c", c );
+			else if( c < 0x20 )
+				std::fprintf( aOut, "\\u%04x", unsigned(c) );
+			else
+				std::fputc( c, aOut );
+		}
+		std::fputc( '"', aOut );
+	}
+}
+
+Profiler::Zone::Zone( Profiler& aOwner, char const* aName, bool aGpu )
+	: mOwner( aOwner )
+	, mRecord( aOwner.begin_( aName, aGpu ) )
+	, mGpu( aGpu )
+{}
+
+Profiler::Zone::~Zone()
+{
+	mOwner.end_( mRecord, mGpu );
+}
+
+
+Profiler::Profiler()
+	: mOrigin( Clock::now() )
+	, mCurrent( kFramesInFlight-1 ) // first beginFrame() moves to slot 0
+	, mFrame( 0 )
+	, mDepth( 0 )
+	, mCollected( 0 )
+	, mDropped( 0 )
+{}
+
+Profiler::~Profiler()
+{
+	for( auto& slot : mSlots )
+	{
+		if( !slot.queries.empty() )
+			glDeleteQueries( GLsizei(slot.queries.size()), slot.queries.data() );
+	}
+}
+
+void Profiler::beginFrame()
+{
+	mCurrent = (mCurrent + 1) % kFramesInFlight;
+	++mFrame;
+
+	auto& slot = mSlots[mCurrent];
+	if( slot.pending )
+	{
+		// Never wait for results
+		if( results_available_( slot.queries, slot.usedQueries ) )
+			collect_( slot );
+		else
+		{
+			slot.pending = false;
+			++mDropped;
+		}
+	}
+
+	slot.frame = mFrame;
+	slot.records.clear();
+	slot.usedQueries = 0;
+	mDepth = 0;
+
+	// Relation between the GPU clock and Clock. Querying GL_TIMESTAMP
+	// returns the GPU's current time without waiting for pending commands.
+	GLint64 gpuNs = 0;
+	glGetInteger64v( GL_TIMESTAMP, &gpuNs );
+
+	auto const cpuNs = std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - mOrigin ).count();
+	slot.gpuOffsetNs = std::int64_t(cpuNs) - std::int64_t(gpuNs);
+}
+
+void Profiler::endFrame()
+{
+	mSlots[mCurrent].pending = true;
+
+	// Collect all frames whose results have arrived, oldest first.
+	for( std::size_t i = 1; i <= kFramesInFlight; ++i )
+	{
+		auto& slot = mSlots[(mCurrent + i) % kFramesInFlight];
+		if( !slot.pending )
+			continue;
+
+		if( !results_available_( slot.queries, slot.usedQueries ) )
+			break;
+
+		collect_( slot );
+	}
+}
+
+Profiler::Zone Profiler::cpuZone( char const* aName )
+{
+	return Zone( *this, aName, false );
+}
+Profiler::Zone Profiler::gpuZone( char const* aName )
+{
+	return Zone( *this, aName, true );
+}
+
+void Profiler::writeChromeTrace( char const* aPath ) const
+{
+	std::FILE* out = std::fopen( aPath, "wb" );
+	if( !out )
+		throw Error( "Profiler: unable to open '%s' for writing", aPath );
+
+	std::fprintf( out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	std::fprintf( out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n" );
+	std::fprintf( out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}" );
+
+	for( auto const& frame : mFrames )
+	{
+		for( auto const& event : frame.events )
+		{
+			std::fprintf( out, ",\n{\"name\":" );
+			write_json_string_( out, event.name );
+			std::fprintf( out, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+				event.gpu ? "gpu" : "cpu",
+				event.gpu ? 2 : 1,
+				event.beginUs,
+				event.durationUs,
+				static_cast<unsigned long long>(frame.frame)
+			);
+		}
+	}
+
+	std::fprintf( out, "\n]}\n" );
+
+	bool const failed = 0 != std::ferror( out );
+	std::fclose( out );
+
+	if( failed )
+		throw Error( "Profiler: error while writing '%s'", aPath );
+}
+
+void Profiler::printSummary( std::FILE* aOut ) const
+{
+	struct Sum_
+	{
+		char const* name;
+		std::uint32_t depth;
+		double cpuUs = 0.0, gpuUs = 0.0;
+		std::size_t gpuCount = 0;
+	};
+
+	// Zones are identified by name; there are only a few, so a linear
+	// search is fine.
+	std::vector<Sum_> sums;
+	for( auto const& frame : mFrames )
+	{
+		for( auto const& event : frame.events )
+		{
+			Sum_* sum = nullptr;
+			for( auto& s : sums )
+			{
+				if( std::string_view( s.name ) == event.name )
+				{
+					sum = &s;
+					break;
+				}
+			}
+
+			if( !sum )
+			{
+				sums.emplace_back();
+				sum = &sums.back();
+				sum->name = event.name;
+				sum->depth = event.depth;
+			}
+
+			if( event.gpu )
+			{
+				sum->gpuUs += event.durationUs;
+				++sum->gpuCount;
+			}
+			else
+			{
+				sum->cpuUs += event.durationUs;
+			}
+		}
+	}
+
+	double const frames = double(std::max( mFrames.size(), std::size_t(1) ));
+
+	std::fprintf( aOut, "Profile (average over %zu frame(s), %zu dropped), ms:\n", mFrames.size(), mDropped );
+	std::fprintf( aOut, "  %8s %8s  %s\n", "cpu", "gpu", "zone" );
+	for( auto const& sum : sums )
+	{
+		char gpu[16] = "-";
+		if( sum.gpuCount )
+			std::snprintf( gpu, sizeof(gpu), "%8.3f", sum.gpuUs / frames / 1000.0 );
+
+		std::fprintf( aOut, "  %8.3f %8s  %*s%s\n", sum.cpuUs / frames / 1000.0, gpu, int(2*sum.depth), "", sum.name );
+	}
+}
+
+std::size_t Profiler::collectedFrames() const noexcept
+{
+	return mCollected;
+}
+std::size_t Profiler::droppedFrames() const noexcept
+{
+	return mDropped;
+}
+
+std::size_t Profiler::begin_( char const* aName, bool aGpu )
+{
+	auto& slot = mSlots[mCurrent];
+
+	Record_ rec{ aName, mDepth++, Clock::now(), {}, -1 };
+
+	if( aGpu )
+	{
+		if( slot.usedQueries + 2 > slot.queries.size() )
+		{
+			std::size_t const old = slot.queries.size();
+			slot.queries.resize( old + kQueryBatch_ );
+			glGenQueries( GLsizei(kQueryBatch_), slot.queries.data() + old );
+		}
+
+		rec.query = std::int32_t(slot.usedQueries);
+		slot.usedQueries += 2;
+
+		glQueryCounter( slot.queries[rec.query], GL_TIMESTAMP );
+		glPushDebugGroup( GL_DEBUG_SOURCE_APPLICATION, 0, -1, aName );
+	}
+
+	slot.records.emplace_back( rec );
+	return slot.records.size()-1;
+}
+
+void Profiler::end_( std::size_t aRecord, bool aGpu )
+{
+	auto& slot = mSlots[mCurrent];
+	auto& rec = slot.records[aRecord];
+
+	if( aGpu )
+	{
+		glPopDebugGroup();
+		glQueryCounter( slot.queries[rec.query+1], GL_TIMESTAMP );
+	}
+
+	rec.cpuEnd = Clock::now();
+	--mDepth;
+}
+
+void Profiler::collect_( Slot_& aSlot )
+{
+	Frame_ frame;
+	frame.frame = aSlot.frame;
+	frame.events.reserve( 2*aSlot.records.size() );
+
+	for( auto const& rec : aSlot.records )
+	{
+		frame.events.emplace_back( Event_{
+			rec.name,
+			rec.depth,
+			false,
+			to_us_( rec.cpuBegin - mOrigin ),
+			to_us_( rec.cpuEnd - rec.cpuBegin )
+		} );
+
+		if( rec.query >= 0 )
+		{
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v( aSlot.queries[rec.query], GL_QUERY_RESULT, &begin );
+			glGetQueryObjectui64v( aSlot.queries[rec.query+1], GL_QUERY_RESULT, &end );
+
+			frame.events.emplace_back( Event_{
+				rec.name,
+				rec.depth,
+				true,
+				double(std::int64_t(begin) + aSlot.gpuOffsetNs) / 1000.0,
+				double(end - begin) / 1000.0
+			} );
+		}
+	}
+
+	aSlot.pending = false;
+	++mCollected;
+
+	mFrames.emplace_back( std::move(frame) );
+	if( mFrames.size() > kMaxKeptFrames )
+		mFrames.pop_front();
+}
@@ -0,0 +1,150 @@
+#ifndef PROFILER_HPP_A93DAF3A_6554_4BFF_A9D8_2A46FC91C0FE
+#define PROFILER_HPP_A93DAF3A_6554_4BFF_A9D8_2A46FC91C0FE
+
+#include <glad.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+#include "defaults.hpp"
+
+/** Profiler: CPU and GPU zones per frame
+ *
+ * Zones are RAII scopes that measure the code (CPU zones) or the GL
+ * commands (GPU zones) issued while they exist. Zones nest. Example:
+ *
+ *	profiler.beginFrame();
+ *	{
+ *		auto const zone_ = profiler.gpuZone( "opaque pass" );
+ *		...
+ *		OGL_CHECKPOINT_DEBUG();
+ *	}
+ *	profiler.endFrame();
+ *
+ * CPU zones use Clock (see defaults.hpp). GPU zones additionally record a
+ * GL_TIMESTAMP query at their beginning and end (GL_TIME_ELAPSED queries
+ * cannot nest), and wrap their commands in glPushDebugGroup()/
+ * glPopDebugGroup(), so that they show up in tools such as RenderDoc.
+ *
+ * Queries are taken from a pool with kFramesInFlight frames. Results are
+ * collected when they are available, without ever waiting for them. If a
+ * frame's results are still not available when its part of the pool is
+ * needed again, that frame is dropped (see droppedFrames()).
+ *
+ * Collected frames are kept for the Chrome trace export (writeChromeTrace(),
+ * load the result in chrome://tracing or https://ui.perfetto.dev) and for
+ * the per-zone summary (printSummary()).
+ *
+ * Requires a current OpenGL context. Not thread safe.
+ */
+class Profiler final
+{
+	public:
+		static constexpr std::size_t kFramesInFlight = 4;
+
+		// Collected frames kept for the trace export
+		static constexpr std::size_t kMaxKeptFrames = 600;
+
+		class Zone final
+		{
+			public:
+				~Zone();
+
+				Zone( Zone const& ) = delete;
+				Zone& operator= (Zone const&) = delete;
+
+			private:
+				friend class Profiler;
+				Zone( Profiler&, char const* aName, bool aGpu );
+
+				Profiler& mOwner;
+				std::size_t mRecord;
+				bool mGpu;
+		};
+
+	public:
+		Profiler();
+		~Profiler();
+
+		Profiler( Profiler const& ) = delete;
+		Profiler& operator= (Profiler const&) = delete;
+
+	public:
+		void beginFrame();
+		void endFrame();
+
+		// aName must outlive the Profiler (string literals are fine).
+		Zone cpuZone( char const* aName );
+		Zone gpuZone( char const* aName );
+
+		// Writes all kept frames in the Chrome trace_event format. Throws an
+		// Error if the file cannot be written.
+		void writeChromeTrace( char const* aPath ) const;
+
+		// Average CPU and GPU time per zone (by name) over the kept frames.
+		void printSummary( std::FILE* ) const;
+
+		std::size_t collectedFrames() const noexcept;
+		std::size_t droppedFrames() const noexcept;
+
+	private:
+		struct Record_
+		{
+			char const* name;
+			std::uint32_t depth;
+			Clock::time_point cpuBegin, cpuEnd;
+			std::int32_t query; // index of the first of two queries, or -1
+		};
+
+		struct Slot_
+		{
+			std::uint64_t frame = 0;
+			bool pending = false;
+
+			// GPU time = CPU time - offset (both in ns, CPU relative to
+			// mOrigin). Measured at the beginning of the frame.
+			std::int64_t gpuOffsetNs = 0;
+
+			std::vector<Record_> records;
+			std::vector<GLuint> queries;
+			std::size_t usedQueries = 0;
+		};
+
+		struct Event_
+		{
+			char const* name;
+			std::uint32_t depth;
+			bool gpu;
+			double beginUs, durationUs; // relative to mOrigin
+		};
+
+		struct Frame_
+		{
+			std::uint64_t frame;
+			std::vector<Event_> events;
+		};
+
+		std::size_t begin_( char const* aName, bool aGpu );
+		void end_( std::size_t aRecord, bool aGpu );
+
+		void collect_( Slot_& );
+
+	private:
+		Clock::time_point mOrigin;
+
+		Slot_ mSlots[kFramesInFlight];
+		std::size_t mCurrent;
+		std::uint64_t mFrame;
+		std::uint32_t mDepth;
+
+		std::deque<Frame_> mFrames;
+		std::size_t mCollected;
+		std::size_t mDropped;
+};
+
+#endif // PROFILER_HPP_A93DAF3A_6554_4BFF_A9D8_2A46FC91C0FE
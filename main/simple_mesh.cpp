@@ -0,0 +1,238 @@
+#include "simple_mesh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../support/error.hpp"
+
+#include "../vmlib/packing.hpp"
+
+namespace
+{
+	struct Float32Vertex_
+	{
+		Vec3f position;
+		Vec3f normal;
+		Vec2f texcoord;
+	};
+
+	static_assert( sizeof(Float32Vertex_) == sizeof(MeshVertex) );
+	static_assert( offsetof(Float32Vertex_,normal) == offsetof(MeshVertex,normal) );
+	static_assert( offsetof(Float32Vertex_,texcoord) == offsetof(MeshVertex,texcoord) );
+
+	struct CompressedVertex_
+	{
+		std::uint16_t position[3];
+		std::uint16_t pad;
+		std::uint32_t normal;
+		std::uint16_t texcoord[2];
+	};
+
+	static_assert( sizeof(CompressedVertex_) == 16 );
+
+	Vec3f normal_( SimpleMeshData const& aMesh, std::size_t aI ) noexcept
+	{
+		return aI < aMesh.normals.size() ? aMesh.normals[aI] : Vec3f{ 0.f, 0.f, 1.f };
+	}
+	Vec2f texcoord_( SimpleMeshData const& aMesh, std::size_t aI ) noexcept
+	{
+		return aI < aMesh.texcoords.size() ? aMesh.texcoords[aI] : Vec2f{ 0.f, 0.f };
+	}
+
+	void upload_( GpuMesh& aMesh, void const* aVertices, std::size_t aBytes )
+	{
+		glGenBuffers( 1, &aMesh.vbo );
+		glBindBuffer( GL_ARRAY_BUFFER, aMesh.vbo );
+		glBufferData( GL_ARRAY_BUFFER, GLsizeiptr(aBytes), aVertices, GL_STATIC_DRAW );
+
+		glGenVertexArrays( 1, &aMesh.vao );
+		glBindVertexArray( aMesh.vao );
+	}
+	template< typename tVertex >
+	void upload_( GpuMesh& aMesh, std::vector<tVertex> const& aVertices )
+	{
+		upload_( aMesh, aVertices.data(), aVertices.size() * sizeof(tVertex) );
+	}
+
+	void* offset_( std::size_t aOffset ) noexcept
+	{
+		return reinterpret_cast<void*>(aOffset);
+	}
+
+	void setup_float32_attribs_()
+	{
+		GLsizei const stride = sizeof(Float32Vertex_);
+		glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, stride, offset_( offsetof(Float32Vertex_,position) ) );
+		glVertexAttribPointer( 1, 3, GL_FLOAT, GL_FALSE, stride, offset_( offsetof(Float32Vertex_,normal) ) );
+		glVertexAttribPointer( 2, 2, GL_FLOAT, GL_FALSE, stride, offset_( offsetof(Float32Vertex_,texcoord) ) );
+	}
+	void setup_compressed_attribs_()
+	{
+		GLsizei const stride = sizeof(CompressedVertex_);
+		glVertexAttribPointer( 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, offset_( offsetof(CompressedVertex_,position) ) );
+		glVertexAttribPointer( 1, 2, GL_SHORT, GL_TRUE, stride, offset_( offsetof(CompressedVertex_,normal) ) );
+		glVertexAttribPointer( 2, 2, GL_HALF_FLOAT, GL_FALSE, stride, offset_( offsetof(CompressedVertex_,texcoord) ) );
+	}
+
+	// Uploads aCount vertices in aLayout and sets up the attributes (but
+	// does not enable them). aVertex(i) returns the i-th Float32Vertex_.
+	template< typename tGetVertex >
+	void upload_vertices_( GpuMesh& aMesh, std::size_t aCount, VertexLayout aLayout, tGetVertex&& aVertex )
+	{
+		aMesh.layout = aLayout;
+
+		switch( aLayout )
+		{
+			case VertexLayout::kFloat32: {
+				std::vector<Float32Vertex_> verts( aCount );
+				for( std::size_t i = 0; i < aCount; ++i )
+					verts[i] = aVertex( i );
+
+				upload_( aMesh, verts );
+				setup_float32_attribs_();
+			} break;
+
+			case VertexLayout::kCompressed: {
+				Aabb3f bounds = kEmptyAabb3f;
+				for( std::size_t i = 0; i < aCount; ++i )
+					bounds = expand( bounds, aVertex( i ).position );
+
+				std::vector<CompressedVertex_> verts( aCount );
+				for( std::size_t i = 0; i < aCount; ++i )
+				{
+					Float32Vertex_ const v = aVertex( i );
+					auto const qp = quantize_position( v.position, bounds );
+
+					verts[i] = CompressedVertex_{
+						{ qp.x, qp.y, qp.z }, 0,
+						pack_normal_oct16( v.normal ),
+						{ float_to_half( v.texcoord.x ), float_to_half( v.texcoord.y ) }
+					};
+				}
+
+				if( aCount )
+					aMesh.positionTransform = make_dequantization_transform( bounds );
+
+				upload_( aMesh, verts );
+				setup_compressed_attribs_();
+			} break;
+
+			default:
+				throw Error( "create_vao(): unknown vertex layout %d", int(aLayout) );
+		}
+	}
+
+	Float32Vertex_ to_float32_( MeshVertex const& aVertex ) noexcept
+	{
+		return Float32Vertex_{ aVertex.position, aVertex.normal, aVertex.texcoord };
+	}
+}
+
+SimpleMeshData concatenate( SimpleMeshData aM, SimpleMeshData const& aN )
+{
+	aM.positions.insert( aM.positions.end(), aN.positions.begin(), aN.positions.end() );
+	aM.normals.insert( aM.normals.end(), aN.normals.begin(), aN.normals.end() );
+	aM.texcoords.insert( aM.texcoords.end(), aN.texcoords.begin(), aN.texcoords.end() );
+	return aM;
+}
+
+GpuMesh create_vao( SimpleMeshData const& aMeshData, VertexLayout aLayout )
+{
+	GpuMesh ret;
+	ret.vertexCount = GLsizei(aMeshData.positions.size());
+
+	upload_vertices_( ret, aMeshData.positions.size(), aLayout, [&aMeshData] (std::size_t aI) {
+		return Float32Vertex_{ aMeshData.positions[aI], normal_( aMeshData, aI ), texcoord_( aMeshData, aI ) };
+	} );
+
+	glEnableVertexAttribArray( 0 );
+	glEnableVertexAttribArray( 1 );
+	glEnableVertexAttribArray( 2 );
+
+	glBindVertexArray( 0 );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+	return ret;
+}
+
+GpuMesh create_vao( MeshCache const& aCache, VertexLayout aLayout )
+{
+	GpuMesh ret;
+	ret.vertexCount = GLsizei(aCache.header().vertexCount);
+	ret.indexCount = GLsizei(aCache.header().indexCount);
+	ret.indexType = 2 == aCache.indexSize() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	if( VertexLayout::kFloat32 == aLayout )
+	{
+		// Straight from the memory-mapped file
+		ret.layout = aLayout;
+		upload_( ret, aCache.vertexData(), aCache.vertexBytes() );
+		setup_float32_attribs_();
+	}
+	else
+	{
+		auto const* verts = static_cast<MeshVertex const*>(aCache.vertexData());
+		upload_vertices_( ret, aCache.header().vertexCount, aLayout, [verts] (std::size_t aI) {
+			return to_float32_( verts[aI] );
+		} );
+	}
+
+	glEnableVertexAttribArray( 0 );
+	glEnableVertexAttribArray( 1 );
+	glEnableVertexAttribArray( 2 );
+
+	// The element array binding is part of the VAO state.
+	glGenBuffers( 1, &ret.ebo );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ret.ebo );
+	glBufferData( GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(aCache.indexBytes()), aCache.indexData(), GL_STATIC_DRAW );
+
+	glBindVertexArray( 0 );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+
+	return ret;
+}
+
+GpuMesh create_vao( TerrainData const& aTerrain, VertexLayout aLayout )
+{
+	GpuMesh ret;
+	ret.vertexCount = GLsizei(aTerrain.vertices.size());
+	ret.indexCount = GLsizei(aTerrain.indices.size());
+	ret.indexType = GL_UNSIGNED_SHORT;
+
+	if( VertexLayout::kFloat32 == aLayout )
+	{
+		ret.layout = aLayout;
+		upload_( ret, aTerrain.vertices );
+		setup_float32_attribs_();
+	}
+	else
+	{
+		upload_vertices_( ret, aTerrain.vertices.size(), aLayout, [&aTerrain] (std::size_t aI) {
+			return to_float32_( aTerrain.vertices[aI] );
+		} );
+	}
+
+	glEnableVertexAttribArray( 0 );
+	glEnableVertexAttribArray( 1 );
+	glEnableVertexAttribArray( 2 );
+
+	glGenBuffers( 1, &ret.ebo );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, ret.ebo );
+	glBufferData( GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(aTerrain.indices.size() * sizeof(std::uint16_t)), aTerrain.indices.data(), GL_STATIC_DRAW );
+
+	glBindVertexArray( 0 );
+	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+
+	return ret;
+}
+
+void destroy_vao( GpuMesh& aMesh ) noexcept
+{
+	glDeleteVertexArrays( 1, &aMesh.vao );
+	glDeleteBuffers( 1, &aMesh.vbo );
+	glDeleteBuffers( 1, &aMesh.ebo );
+
+	aMesh = GpuMesh{};
+}
@@ -0,0 +1,76 @@
+#ifndef SIMPLE_MESH_HPP_C4B0C6A8_2E57_4F9B_9D61_0E3A1B9B7F22
+#define SIMPLE_MESH_HPP_C4B0C6A8_2E57_4F9B_9D61_0E3A1B9B7F22
+
+#include <glad.h>
+
+#include <vector>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/bounds.hpp"
+
+#include "../meshlib/terrain.hpp"
+#include "../meshlib/mesh_cache.hpp"
+
+struct SimpleMeshData
+{
+	std::vector<Vec3f> positions;
+	std::vector<Vec3f> normals;
+	std::vector<Vec2f> texcoords;
+};
+
+SimpleMeshData concatenate( SimpleMeshData, SimpleMeshData const& );
+
+/* Vertex layouts for uploading SimpleMeshData
+ *
+ * Both layouts use interleaved vertices with the same attribute locations:
+ *   0 - position
+ *   1 - normal
+ *   2 - texture coordinate
+ *
+ * kFloat32 stores everything as floats (32 bytes per vertex).
+ *
+ * kCompressed uses 16 bytes per vertex:
+ *  - positions as unorm16, quantized relative to the mesh's AABB. The vertex
+ *    shader sees values in [0,1] and must map them back with the min and
+ *    extent from GpuMesh::positionTransform, see dequantize_position() in
+ *    assets/packing.glsl.
+ *  - normals as octahedral snorm16x2. The vertex shader sees a vec2 and must
+ *    decode it with oct_decode() from assets/packing.glsl.
+ *  - texture coordinates as half floats. These are decoded by GL.
+ * See vmlib/packing.hpp for details.
+ */
+enum class VertexLayout
+{
+	kFloat32,
+	kCompressed
+};
+
+struct GpuMesh
+{
+	GLuint vao = 0;
+	GLuint vbo = 0;
+	GLuint ebo = 0; // 0 for non-indexed meshes
+	GLsizei vertexCount = 0;
+	GLsizei indexCount = 0;
+	GLenum indexType = GL_UNSIGNED_INT;
+
+	VertexLayout layout = VertexLayout::kFloat32;
+
+	// Maps positions as seen by the vertex shader to the mesh's original
+	// (model) space. Identity for VertexLayout::kFloat32.
+	Mat44f positionTransform = kIdentity44f;
+};
+
+GpuMesh create_vao( SimpleMeshData const&, VertexLayout = VertexLayout::kFloat32 );
+
+// Indexed; see GpuMesh::indexType
+GpuMesh create_vao( MeshCache const&, VertexLayout = VertexLayout::kFloat32 );
+
+// All chunks; indices are relative to each chunk's baseVertex
+GpuMesh create_vao( TerrainData const&, VertexLayout = VertexLayout::kFloat32 );
+
+void destroy_vao( GpuMesh& ) noexcept;
+
+#endif // SIMPLE_MESH_HPP_C4B0C6A8_2E57_4F9B_9D61_0E3A1B9B7F22
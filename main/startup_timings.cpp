@@ -0,0 +1,83 @@
+#include "startup_timings.hpp"
+
+#include <algorithm>
+
+StartupTimings::Stage::Stage( StartupTimings& aOwner, char const* aName )
+	: mOwner( aOwner )
+	, mName( aName )
+	, mBegin( Clock::now() )
+{}
+
+StartupTimings::Stage::~Stage()
+{
+	mOwner.record( mName, mBegin, Clock::now() );
+}
+
+
+StartupTimings::StartupTimings()
+	: mOrigin( Clock::now() )
+	, mMainThread( std::this_thread::get_id() )
+{}
+
+StartupTimings::Stage StartupTimings::stage( char const* aName )
+{
+	return Stage( *this, aName );
+}
+
+void StartupTimings::record( char const* aName, Clock::time_point aBegin, Clock::time_point aEnd )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mRecords.emplace_back( Record_{ aName, aBegin, aEnd, std::this_thread::get_id() } );
+}
+
+void StartupTimings::print( std::FILE* aOut ) const
+{
+	auto const now = Clock::now();
+
+	std::vector<Record_> records;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		records = mRecords;
+	}
+
+	std::sort( records.begin(), records.end(), [] (Record_ const& aA, Record_ const& aB) {
+		return aA.begin < aB.begin;
+	} );
+
+	// Number the worker threads in order of appearance
+	std::vector<std::thread::id> workers;
+
+	auto const ms = [] (Clock::duration aDuration) {
+		return std::chrono::duration<double, std::milli>( aDuration ).count();
+	};
+
+	std::fprintf( aOut, "Startup timings (ms):\n" );
+	std::fprintf( aOut, "  %8s %8s %8s  %-8s  %s\n", "begin", "end", "duration", "thread", "stage" );
+
+	double sum = 0.0;
+	for( auto const& rec : records )
+	{
+		char thread[16] = "main";
+		if( rec.thread != mMainThread )
+		{
+			auto it = std::find( workers.begin(), workers.end(), rec.thread );
+			if( workers.end() == it )
+				it = workers.insert( workers.end(), rec.thread );
+
+			std::snprintf( thread, sizeof(thread), "worker%d", int(it - workers.begin()) );
+		}
+
+		double const duration = ms( rec.end - rec.begin );
+		sum += duration;
+
+		std::fprintf( aOut, "  %8.2f %8.2f %8.2f  %-8s  %s\n", 
+			ms( rec.begin - mOrigin ),
+			ms( rec.end - mOrigin ),
+			duration,
+			thread,
+			rec.name
+		);
+	}
+
+	std::fprintf( aOut, "  Sum of stages: %.2f ms, elapsed: %.2f ms\n", sum, ms( now - mOrigin ) );
+}
@@ -0,0 +1,75 @@
+#ifndef STARTUP_TIMINGS_HPP_2E8B5C61_49D7_4A0F_8F13_6C7A9D0B3E25
+#define STARTUP_TIMINGS_HPP_2E8B5C61_49D7_4A0F_8F13_6C7A9D0B3E25
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cstdio>
+
+#include "defaults.hpp"
+
+/** StartupTimings: per-stage timing breakdown
+ *
+ * Records named stages (begin/end time and thread) relative to the time the
+ * StartupTimings object was created. Stages may be recorded concurrently
+ * from multiple threads. Example:
+ *
+ *	StartupTimings timings;
+ *	{
+ *		auto const stage_ = timings.stage( "glfwInit" );
+ *		...
+ *	}
+ *	timings.print( stdout );
+ */
+class StartupTimings final
+{
+	public:
+		class Stage final
+		{
+			public:
+				Stage( StartupTimings&, char const* aName );
+				~Stage();
+
+				Stage( Stage const& ) = delete;
+				Stage& operator= (Stage const&) = delete;
+
+			private:
+				StartupTimings& mOwner;
+				char const* mName;
+				Clock::time_point mBegin;
+		};
+
+	public:
+		StartupTimings();
+
+		StartupTimings( StartupTimings const& ) = delete;
+		StartupTimings& operator= (StartupTimings const&) = delete;
+
+	public:
+		// aName must outlive the StartupTimings (string literals are fine).
+		Stage stage( char const* aName );
+
+		void record( char const* aName, Clock::time_point aBegin, Clock::time_point aEnd );
+
+		// Prints all stages (sorted by begin time), the sum of their
+		// durations and the time elapsed until now.
+		void print( std::FILE* ) const;
+
+	private:
+		struct Record_
+		{
+			char const* name;
+			Clock::time_point begin, end;
+			std::thread::id thread;
+		};
+
+		Clock::time_point mOrigin;
+		std::thread::id mMainThread;
+
+		mutable std::mutex mMutex;
+		std::vector<Record_> mRecords;
+};
+
+#endif // STARTUP_TIMINGS_HPP_2E8B5C61_49D7_4A0F_8F13_6C7A9D0B3E25
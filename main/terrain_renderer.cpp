@@ -0,0 +1,89 @@
+#include "terrain_renderer.hpp"
+
+#include <utility>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	VertexLayout check_layout_( VertexLayout aLayout )
+	{
+		// No terrain shader decodes the compressed layout; its positions
+		// would end up in [0,1]^3.
+		if( VertexLayout::kCompressed == aLayout )
+			throw Error( "TerrainRenderer: VertexLayout::kCompressed is not supported" );
+
+		return aLayout;
+	}
+}
+
+TerrainRenderer::TerrainRenderer( TerrainData aData, VertexLayout aLayout )
+	: mData( std::move(aData) )
+	, mMesh( create_vao( mData, check_layout_( aLayout ) ) )
+{}
+
+TerrainRenderer::~TerrainRenderer()
+{
+	destroy_vao( mMesh );
+}
+
+TerrainRenderer::TerrainRenderer( TerrainRenderer&& aOther ) noexcept
+	: mData( std::move(aOther.mData) )
+	, mMesh( std::exchange( aOther.mMesh, GpuMesh{} ) )
+{}
+TerrainRenderer& TerrainRenderer::operator= (TerrainRenderer&& aOther) noexcept
+{
+	std::swap( mData, aOther.mData );
+	std::swap( mMesh, aOther.mMesh );
+	return *this;
+}
+
+TerrainRenderer::DrawStats TerrainRenderer::draw( GLStateCache& aState, TerrainView const& aView )
+{
+	mSelection.clear();
+	select_terrain_chunks( mData, aView, mSelection );
+
+	mCounts.clear();
+	mOffsets.clear();
+	mBaseVertices.clear();
+
+	DrawStats ret{ mSelection.size(), 0 };
+	for( auto const index : mSelection )
+	{
+		auto const& chunk = mData.chunks[index];
+		mCounts.push_back( GLsizei(chunk.indexCount) );
+		mOffsets.push_back( reinterpret_cast<void const*>(std::size_t(chunk.firstIndex) * sizeof(std::uint16_t)) );
+		mBaseVertices.push_back( GLint(chunk.baseVertex) );
+
+		ret.triangles += chunk.indexCount / 3;
+	}
+
+	if( mSelection.empty() )
+		return ret;
+
+	aState.bindVertexArray( mMesh.vao );
+	glMultiDrawElementsBaseVertex( 
+		GL_TRIANGLES, 
+		mCounts.data(), 
+		GL_UNSIGNED_SHORT, 
+		mOffsets.data(), 
+		GLsizei(mSelection.size()), 
+		mBaseVertices.data() 
+	);
+
+	return ret;
+}
+
+TerrainData const& TerrainRenderer::data() const noexcept
+{
+	return mData;
+}
+
+VertexLayout TerrainRenderer::layout() const noexcept
+{
+	return mMesh.layout;
+}
+Mat44f const& TerrainRenderer::positionTransform() const noexcept
+{
+	return mMesh.positionTransform;
+}
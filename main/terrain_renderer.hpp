@@ -0,0 +1,69 @@
+#ifndef TERRAIN_RENDERER_HPP_B83E6D15_27C4_4A9F_8D02_E5C17F4A9B36
+#define TERRAIN_RENDERER_HPP_B83E6D15_27C4_4A9F_8D02_E5C17F4A9B36
+
+#include <glad.h>
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../meshlib/terrain.hpp"
+
+#include "../support/gl_state.hpp"
+
+#include "simple_mesh.hpp"
+
+/** TerrainRenderer: draws a chunked LOD terrain
+ *
+ * Owns the terrain data and its GPU buffers (one vertex and one index
+ * buffer for all chunks). Each call to draw() selects the chunks for the
+ * current view (see select_terrain_chunks()) and draws them with a single
+ * glMultiDrawElementsBaseVertex(). The caller is responsible for the shader
+ * program and its uniforms; the vertex layout is chosen at construction.
+ * Only VertexLayout::kFloat32 is supported, kCompressed throws an Error.
+ * The vertex array is bound through the GLStateCache and left bound.
+ *
+ * Requires a current OpenGL context for construction, draw() and
+ * destruction.
+ */
+class TerrainRenderer final
+{
+	public:
+		struct DrawStats
+		{
+			std::size_t chunks;
+			std::size_t triangles;
+		};
+
+	public:
+		explicit TerrainRenderer( TerrainData, VertexLayout = VertexLayout::kFloat32 );
+
+		~TerrainRenderer();
+
+		TerrainRenderer( TerrainRenderer const& ) = delete;
+		TerrainRenderer& operator= (TerrainRenderer const&) = delete;
+
+		TerrainRenderer( TerrainRenderer&& ) noexcept;
+		TerrainRenderer& operator= (TerrainRenderer&&) noexcept;
+
+	public:
+		DrawStats draw( GLStateCache&, TerrainView const& );
+
+		TerrainData const& data() const noexcept;
+
+		VertexLayout layout() const noexcept;
+		Mat44f const& positionTransform() const noexcept; // see GpuMesh
+
+	private:
+		TerrainData mData;
+		GpuMesh mMesh;
+
+		// Per-frame scratch space, kept to avoid reallocating
+		std::vector<std::uint32_t> mSelection;
+		std::vector<GLsizei> mCounts;
+		std::vector<void const*> mOffsets;
+		std::vector<GLint> mBaseVertices;
+};
+
+#endif // TERRAIN_RENDERER_HPP_B83E6D15_27C4_4A9F_8D02_E5C17F4A9B36
@@ -0,0 +1,165 @@
+#include "texture.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <stb_image.h>
+
+#include "../support/error.hpp"
+
+#include "../texlib/block_compress.hpp"
+
+// The S3TC sRGB formats are from EXT_texture_sRGB, which the glad loader
+// was not generated with. The values are fixed by the extension.
+#if !defined(GL_COMPRESSED_SRGB_S3TC_DXT1_EXT)
+#	define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+
+namespace
+{
+	GLenum gl_internal_format_( TextureCacheFormat aFormat )
+	{
+		switch( aFormat )
+		{
+			case TextureCacheFormat::kRgba8Srgb: return GL_SRGB8_ALPHA8;
+			case TextureCacheFormat::kBc1Srgb: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+			case TextureCacheFormat::kBc7Srgb: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		}
+
+		throw Error( "Unknown texture cache format %u", unsigned(aFormat) );
+	}
+
+	bool has_extension_( char const* aName )
+	{
+		GLint count = 0;
+		glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+
+		for( GLint i = 0; i < count; ++i )
+		{
+			auto const* ext = reinterpret_cast<char const*>(glGetStringi( GL_EXTENSIONS, GLuint(i) ));
+			if( 0 == std::strcmp( ext, aName ) )
+				return true;
+		}
+
+		return false;
+	}
+}
+
+void ImageRGBA8::Free_::operator()( std::uint8_t* aPixels ) const noexcept
+{
+	stbi_image_free( aPixels );
+}
+
+ImageRGBA8 load_image( char const* aPath )
+{
+	// Use the per-thread setting; the global one would race with other
+	// threads decoding images at the same time.
+	stbi_set_flip_vertically_on_load_thread( 1 );
+
+	ImageRGBA8 ret;
+	int channels = 0;
+	ret.pixels.reset( stbi_load( aPath, &ret.width, &ret.height, &channels, 4 ) );
+
+	if( !ret.pixels )
+		throw Error( "Unable to load image '%s': %s", aPath, stbi_failure_reason() );
+
+	return ret;
+}
+
+GLuint create_texture_2d( ImageRGBA8 const& aImage )
+{
+	GLuint tex = 0;
+	glGenTextures( 1, &tex );
+	glBindTexture( GL_TEXTURE_2D, tex );
+
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_SRGB8_ALPHA8, aImage.width, aImage.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, aImage.pixels.get() );
+
+	glGenerateMipmap( GL_TEXTURE_2D );
+
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+
+	glBindTexture( GL_TEXTURE_2D, 0 );
+	return tex;
+}
+
+bool is_texture_format_supported( TextureCacheFormat aFormat )
+{
+	// The results are cached; this assumes a single context (or contexts
+	// that support the same extensions).
+	switch( aFormat )
+	{
+		case TextureCacheFormat::kRgba8Srgb:
+			return true;
+
+		case TextureCacheFormat::kBc1Srgb:
+		{
+			static bool const available = has_extension_( "GL_EXT_texture_compression_s3tc" )
+				&& (has_extension_( "GL_EXT_texture_sRGB" ) || has_extension_( "GL_EXT_texture_compression_s3tc_srgb" ))
+			;
+			return available;
+		}
+
+		case TextureCacheFormat::kBc7Srgb:
+		{
+			static bool const available = GLAD_GL_VERSION_4_2 || has_extension_( "GL_ARB_texture_compression_bptc" );
+			return available;
+		}
+	}
+
+	return false;
+}
+
+GLuint create_texture_2d( TextureCache const& aCache )
+{
+	auto const format = aCache.format();
+
+	// Fall back to uncompressed sRGB (i.e., kRgba8Srgb) if the driver can't
+	// sample the cached format. This decodes every level on the CPU.
+	bool const decompress = !is_texture_format_supported( format );
+	if( decompress )
+		std::fprintf( stderr, "Note: texture format '%s' is not supported, decompressing to rgba8\n", to_string( format ) );
+
+	GLenum const internalFormat = decompress ? GL_SRGB8_ALPHA8 : gl_internal_format_( format );
+
+	GLuint tex = 0;
+	glGenTextures( 1, &tex );
+	glBindTexture( GL_TEXTURE_2D, tex );
+
+	auto const levelCount = GLsizei(aCache.levelCount());
+	glTexStorage2D( GL_TEXTURE_2D, levelCount, internalFormat, GLsizei(aCache.width()), GLsizei(aCache.height()) );
+
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	for( GLsizei i = 0; i < levelCount; ++i )
+	{
+		auto const& level = aCache.levels()[i];
+		void const* data = aCache.levelData( std::size_t(i) );
+
+		if( TextureCacheFormat::kRgba8Srgb == format )
+		{
+			glTexSubImage2D( GL_TEXTURE_2D, i, 0, 0, GLsizei(level.width), GLsizei(level.height), GL_RGBA, GL_UNSIGNED_BYTE, data );
+		}
+		else if( decompress )
+		{
+			BlockFormat const bf = TextureCacheFormat::kBc1Srgb == format ? BlockFormat::kBc1 : BlockFormat::kBc7;
+			auto const rgba = decompress_image( static_cast<std::uint8_t const*>(data), level.width, level.height, bf );
+			glTexSubImage2D( GL_TEXTURE_2D, i, 0, 0, GLsizei(level.width), GLsizei(level.height), GL_RGBA, GL_UNSIGNED_BYTE, rgba.data() );
+		}
+		else
+		{
+			glCompressedTexSubImage2D( GL_TEXTURE_2D, i, 0, 0, GLsizei(level.width), GLsizei(level.height), internalFormat, GLsizei(level.size), data );
+		}
+	}
+
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount-1 );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT );
+
+	glBindTexture( GL_TEXTURE_2D, 0 );
+	return tex;
+}
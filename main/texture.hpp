@@ -0,0 +1,48 @@
+#ifndef TEXTURE_HPP_7A1C3E95_0B2D_4F68_9E47_5D8C2A6B1F03
+#define TEXTURE_HPP_7A1C3E95_0B2D_4F68_9E47_5D8C2A6B1F03
+
+#include <glad.h>
+
+#include <memory>
+
+#include <cstdint>
+
+#include "../texlib/texture_cache.hpp"
+
+/** ImageRGBA8: decoded image in CPU memory
+ *
+ * Decoding (load_image()) does not require an OpenGL context and can run on
+ * a worker thread; only create_texture_2d() must be called on the thread
+ * with the context.
+ */
+struct ImageRGBA8
+{
+	int width = 0;
+	int height = 0;
+
+	struct Free_ { void operator()( std::uint8_t* ) const noexcept; };
+	std::unique_ptr<std::uint8_t, Free_> pixels;
+};
+
+// Decodes an image with stb_image, always returning four channels. Rows
+// are flipped, such that the first row is the bottom of the image (as
+// expected by OpenGL). Throws Error on failure.
+ImageRGBA8 load_image( char const* aPath );
+
+// Creates a GL_SRGB8_ALPHA8 texture with a full mipmap chain.
+GLuint create_texture_2d( ImageRGBA8 const& );
+
+// Checks whether the current context can sample textures in the given
+// format: kBc1Srgb requires EXT_texture_compression_s3tc and the sRGB
+// variants (EXT_texture_sRGB), kBc7Srgb OpenGL 4.2 or
+// ARB_texture_compression_bptc.
+bool is_texture_format_supported( TextureCacheFormat );
+
+// Creates a texture from a precomputed mip chain (see texlib/
+// texture_cache.hpp). Uses immutable storage; each level is uploaded
+// directly from the mapped cache file, without decoding or mipmap
+// generation. Compressed formats that the context does not support (see
+// is_texture_format_supported()) are decoded to GL_SRGB8_ALPHA8 instead.
+GLuint create_texture_2d( TextureCache const& );
+
+#endif // TEXTURE_HPP_7A1C3E95_0B2D_4F68_9E47_5D8C2A6B1F03
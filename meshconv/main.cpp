@@ -0,0 +1,143 @@
+#include <string>
+#include <algorithm>
+#include <typeinfo>
+#include <exception>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+#include "../meshlib/mesh.hpp"
+#include "../meshlib/mesh_cache.hpp"
+#include "../meshlib/mesh_optimize.hpp"
+#include "../meshlib/mesh_simplify.hpp"
+
+/* meshconv: offline mesh cache generation
+ *
+ * Converts OBJ files into the binary mesh cache format (see
+ * meshlib/mesh_cache.hpp). main generates missing caches on demand; this
+ * tool allows doing so ahead of time, e.g. as a build step.
+ *
+ * With --lods, the cache additionally contains simplified levels of detail
+ * (see meshlib/mesh_simplify.hpp and select_mesh_lod()).
+ */
+
+namespace
+{
+	void print_usage_( char const* aProgram )
+	{
+		std::fprintf( stderr, "Usage: %s [options] <input.obj> [output.meshcache]\n", aProgram );
+		std::fprintf( stderr, "  --force          regenerate the cache even if it is up to date\n" );
+		std::fprintf( stderr, "  --lods N         number of levels of detail, including the original (default: 1)\n" );
+		std::fprintf( stderr, "  --lod-ratio R    fraction of triangles kept per level (default: 0.5)\n" );
+		std::fprintf( stderr, "  --max-error E    maximal simplification error, in model units (default: none)\n" );
+		std::fprintf( stderr, "The output defaults to <input.obj>.meshcache. Only the default\n" );
+		std::fprintf( stderr, "location is picked up automatically by main.\n" );
+	}
+}
+
+int main( int aArgc, char* aArgv[] ) try
+{
+	bool force = false;
+	LodChainOptions lodOptions;
+	lodOptions.maxLevels = 1;
+
+	char const* input = nullptr;
+	char const* output = nullptr;
+
+	for( int i = 1; i < aArgc; ++i )
+	{
+		if( 0 == std::strcmp( aArgv[i], "--force" ) )
+			force = true;
+		else if( 0 == std::strcmp( aArgv[i], "--lods" ) && i+1 < aArgc )
+			lodOptions.maxLevels = std::size_t(std::max( std::atoi( aArgv[++i] ), 1 ));
+		else if( 0 == std::strcmp( aArgv[i], "--lod-ratio" ) && i+1 < aArgc )
+			lodOptions.ratio = float(std::atof( aArgv[++i] ));
+		else if( 0 == std::strcmp( aArgv[i], "--max-error" ) && i+1 < aArgc )
+			lodOptions.maxError = float(std::atof( aArgv[++i] ));
+		else if( 0 == std::strcmp( aArgv[i], "--help" ) || 0 == std::strcmp( aArgv[i], "-h" ) )
+		{
+			print_usage_( aArgv[0] );
+			return 0;
+		}
+		else if( !input )
+			input = aArgv[i];
+		else if( !output )
+			output = aArgv[i];
+		else
+		{
+			print_usage_( aArgv[0] );
+			return 2;
+		}
+	}
+
+	if( !input || !(lodOptions.ratio > 0.f && lodOptions.ratio < 1.f) )
+	{
+		print_usage_( aArgv[0] );
+		return 2;
+	}
+
+	std::string const outPath = output ? std::string(output) : mesh_cache_path( input );
+
+	if( !force )
+	{
+		try
+		{
+			if( is_mesh_cache_current( MeshCache( outPath.c_str() ) ) )
+			{
+				std::printf( "%s: up to date\n", outPath.c_str() );
+				return 0;
+			}
+		}
+		catch( Error const& )
+		{
+			// Missing or invalid; regenerate below.
+		}
+	}
+
+	auto const deps = make_obj_dependencies( input, outPath.c_str() );
+	auto mesh = load_wavefront_obj( input );
+	std::size_t const soupVertices = mesh.vertices.size();
+	float const soupAcmr = compute_acmr( mesh );
+
+	// Simplify before optimizing; the optimizations handle all levels.
+	deduplicate_vertices( mesh );
+	if( lodOptions.maxLevels > 1 )
+		build_lod_chain( mesh, lodOptions );
+
+	optimize_vertex_cache( mesh );
+	optimize_vertex_fetch( mesh );
+	write_mesh_cache( outPath.c_str(), mesh, deps );
+
+	std::printf( "%s: %zu vertices (%zu before deduplication), %zu indices, %zu submeshes, %zu materials\n", 
+		outPath.c_str(),
+		mesh.vertices.size(),
+		soupVertices,
+		mesh.indices.size(),
+		mesh.submeshes.size(),
+		mesh.materials.size()
+	);
+	std::printf( "  ACMR (FIFO, %zu entries): %.3f -> %.3f\n", kDefaultAcmrCacheSize, soupAcmr, compute_acmr( mesh ) );
+
+	for( std::size_t i = 0; i < mesh.lods.size(); ++i )
+	{
+		auto const& lod = mesh.lods[i];
+
+		std::size_t indices = 0;
+		for( std::size_t s = lod.firstSubmesh; s < lod.firstSubmesh + lod.submeshCount; ++s )
+			indices += mesh.submeshes[s].indexCount;
+
+		std::printf( "  LOD %zu: %zu triangles, error %g\n", i, indices / 3, double(lod.error) );
+	}
+
+	return 0;
+}
+catch( std::exception const& eErr )
+{
+	std::fprintf( stderr, "Top-level Exception (%s):\n", typeid(eErr).name() );
+	std::fprintf( stderr, "%s\n", eErr.what() );
+	std::fprintf( stderr, "Bye.\n" );
+	return 1;
+}
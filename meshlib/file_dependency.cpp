@@ -0,0 +1,133 @@
+#include "file_dependency.hpp"
+
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	// Returns false if the time can't be read (e.g., the file was removed).
+	bool mtime_( fs::path const& aPath, std::int64_t& aMtime ) noexcept
+	{
+		std::error_code ec;
+		auto const mtime = fs::last_write_time( aPath, ec );
+		if( ec )
+			return false;
+
+		aMtime = std::int64_t(mtime.time_since_epoch().count());
+		return true;
+	}
+
+	fs::path cache_dir_( char const* aCachePath )
+	{
+		return fs::path( aCachePath ).parent_path();
+	}
+}
+
+std::uint64_t hash_fnv1a( void const* aData, std::size_t aSize ) noexcept
+{
+	auto const* bytes = static_cast<unsigned char const*>(aData);
+
+	std::uint64_t hash = 14695981039346656037ull;
+	for( std::size_t i = 0; i < aSize; ++i )
+	{
+		hash ^= std::uint64_t(bytes[i]);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+FileDependency make_file_dependency( char const* aPath, char const* aCachePath )
+{
+	MappedFile const contents( aPath );
+	return make_file_dependency( aPath, aCachePath, contents );
+}
+
+FileDependency make_file_dependency( char const* aPath, char const* aCachePath, MappedFile const& aContents )
+{
+	std::string const rel = fs::proximate( fs::absolute( aPath ), fs::absolute( aCachePath ).parent_path() ).generic_string();
+	if( rel.size() >= sizeof(FileDependency::path) )
+		throw Error( "Dependency path '%s' is too long (max %zu characters)", rel.c_str(), sizeof(FileDependency::path)-1 );
+
+	FileDependency ret{};
+	std::memcpy( ret.path, rel.data(), rel.size() );
+	ret.size = aContents.size();
+	if( !mtime_( aPath, ret.mtime ) )
+		ret.mtime = 0; // never matches; the hash is checked instead
+	ret.hash = hash_fnv1a( aContents.data(), aContents.size() );
+	return ret;
+}
+
+FileDependencyState check_file_dependency( FileDependency const& aDep, char const* aCachePath )
+{
+	fs::path const path = cache_dir_( aCachePath ) / aDep.path;
+
+	std::error_code ec;
+	auto const size = fs::file_size( path, ec );
+	if( ec || size != aDep.size )
+		return FileDependencyState::kChanged;
+
+	std::int64_t mtime = 0;
+	if( !mtime_( path, mtime ) )
+		return FileDependencyState::kChanged;
+
+	if( mtime == aDep.mtime )
+		return FileDependencyState::kUnchanged;
+
+	MappedFile const file( path.string().c_str() );
+	if( hash_fnv1a( file.data(), file.size() ) != aDep.hash )
+		return FileDependencyState::kChanged;
+
+	return FileDependencyState::kTouched;
+}
+
+bool check_file_dependencies( FileDependency const* aDependencies, std::size_t aCount, char const* aCachePath, std::vector<std::size_t>& aTouched )
+{
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		switch( check_file_dependency( aDependencies[i], aCachePath ) )
+		{
+			case FileDependencyState::kUnchanged: break;
+			case FileDependencyState::kTouched: aTouched.emplace_back( i ); break;
+			case FileDependencyState::kChanged: return false;
+		}
+	}
+
+	return true;
+}
+
+void refresh_file_dependencies( char const* aCachePath, std::uint64_t aTableOffset, std::size_t aCount, std::vector<std::size_t> const& aTouched )
+{
+	fs::path const dir = cache_dir_( aCachePath );
+
+	// Read the dependency table before modifying the file.
+	std::vector<FileDependency> deps( aCount );
+
+	std::fstream file( aCachePath, std::ios::in | std::ios::out | std::ios::binary );
+	file.seekg( std::streamoff(aTableOffset) );
+	file.read( reinterpret_cast<char*>(deps.data()), std::streamsize(deps.size() * sizeof(FileDependency)) );
+
+	for( auto const idx : aTouched )
+	{
+		std::error_code ec;
+		auto const mtime = fs::last_write_time( dir / deps[idx].path, ec );
+		if( ec )
+			continue;
+
+		std::int64_t const ticks = std::int64_t(mtime.time_since_epoch().count());
+
+		auto const offset = aTableOffset + idx * sizeof(FileDependency) + offsetof(FileDependency, mtime);
+		file.seekp( std::streamoff(offset) );
+		file.write( reinterpret_cast<char const*>(&ticks), sizeof(ticks) );
+	}
+
+	if( !file )
+		std::fprintf( stderr, "Note: unable to update dependencies in '%s'\n", aCachePath );
+}
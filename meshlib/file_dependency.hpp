@@ -0,0 +1,66 @@
+#ifndef FILE_DEPENDENCY_HPP_3D9A61F7_B2C4_4E85_A0E3_71F5C8B42D96
+#define FILE_DEPENDENCY_HPP_3D9A61F7_B2C4_4E85_A0E3_71F5C8B42D96
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mapped_file.hpp"
+
+/* Source file tracking for generated caches
+ *
+ * Caches (see mesh_cache.hpp, and texlib's texture_cache.hpp) store a table
+ * of FileDependency records for the files that they were generated from.
+ * A dependency whose size and modification time match is considered
+ * unchanged. If only the modification time differs (e.g. after a fresh
+ * checkout), the file's contents are hashed and compared; such dependencies
+ * are "touched", and their stored modification time should be refreshed
+ * (refresh_file_dependencies()) such that the hashing is skipped next time.
+ */
+
+struct FileDependency
+{
+	char path[232]; // relative to the cache file's directory
+	std::uint64_t size;
+	std::int64_t mtime; // std::filesystem::file_time_type ticks
+	std::uint64_t hash; // FNV-1a (64 bit) of the contents
+};
+
+static_assert( sizeof(FileDependency) == 256 );
+
+enum class FileDependencyState
+{
+	kUnchanged,
+	kTouched, // same contents, different modification time
+	kChanged
+};
+
+std::uint64_t hash_fnv1a( void const* aData, std::size_t aSize ) noexcept;
+
+FileDependency make_file_dependency( char const* aPath, char const* aCachePath );
+FileDependency make_file_dependency( char const* aPath, char const* aCachePath, MappedFile const& aContents );
+
+FileDependencyState check_file_dependency( FileDependency const&, char const* aCachePath );
+
+// Returns false if any dependency changed. Otherwise, the indices of touched
+// dependencies are appended to aTouched.
+bool check_file_dependencies( 
+	FileDependency const* aDependencies, 
+	std::size_t aCount, 
+	char const* aCachePath,
+	std::vector<std::size_t>& aTouched
+);
+
+// Updates the modification times of the touched dependencies in the table
+// at aTableOffset of the cache file. The file must not be mapped (Windows
+// does not permit writing to mapped files). Failures are not fatal (the
+// cache remains valid), and only reported to stderr.
+void refresh_file_dependencies(
+	char const* aCachePath,
+	std::uint64_t aTableOffset,
+	std::size_t aCount,
+	std::vector<std::size_t> const& aTouched
+);
+
+#endif // FILE_DEPENDENCY_HPP_3D9A61F7_B2C4_4E85_A0E3_71F5C8B42D96
@@ -0,0 +1,155 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#include "../support/error.hpp"
+
+#if defined(_WIN32)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else // POSIX
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif // ~ _WIN32
+
+MappedFile::MappedFile() noexcept
+	: mData( nullptr )
+	, mSize( 0 )
+#	if defined(_WIN32)
+	, mFile( nullptr )
+	, mMapping( nullptr )
+#	endif // ~ _WIN32
+{}
+
+#if defined(_WIN32)
+MappedFile::MappedFile( char const* aPath )
+	: MappedFile()
+{
+	HANDLE file = CreateFileA( aPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+	if( INVALID_HANDLE_VALUE == file )
+		throw Error( "MappedFile: unable to open '%s' (error %lu)", aPath, GetLastError() );
+
+	mFile = file;
+
+	LARGE_INTEGER size;
+	if( !GetFileSizeEx( file, &size ) )
+	{
+		release_();
+		throw Error( "MappedFile: unable to query size of '%s' (error %lu)", aPath, GetLastError() );
+	}
+
+	mSize = std::size_t(size.QuadPart);
+	if( 0 == mSize )
+		return; // Can't map empty files. Not an error.
+
+	mMapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( !mMapping )
+	{
+		release_();
+		throw Error( "MappedFile: unable to map '%s' (error %lu)", aPath, GetLastError() );
+	}
+
+	mData = static_cast<std::byte const*>(MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 ));
+	if( !mData )
+	{
+		release_();
+		throw Error( "MappedFile: unable to map view of '%s' (error %lu)", aPath, GetLastError() );
+	}
+}
+
+void MappedFile::release_() noexcept
+{
+	if( mData )
+		UnmapViewOfFile( mData );
+	if( mMapping )
+		CloseHandle( mMapping );
+	if( mFile )
+		CloseHandle( mFile );
+
+	mData = nullptr;
+	mSize = 0;
+	mMapping = nullptr;
+	mFile = nullptr;
+}
+
+#else // POSIX
+MappedFile::MappedFile( char const* aPath )
+	: MappedFile()
+{
+	int const fd = open( aPath, O_RDONLY );
+	if( -1 == fd )
+		throw Error( "MappedFile: unable to open '%s'", aPath );
+
+	struct stat st;
+	if( 0 != fstat( fd, &st ) )
+	{
+		close( fd );
+		throw Error( "MappedFile: unable to stat '%s'", aPath );
+	}
+
+	mSize = std::size_t(st.st_size);
+	if( 0 == mSize )
+	{
+		close( fd );
+		return; // Can't map empty files. Not an error.
+	}
+
+	void* ptr = mmap( nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+	// The mapping keeps its own reference to the file.
+	close( fd );
+
+	if( MAP_FAILED == ptr )
+	{
+		mSize = 0;
+		throw Error( "MappedFile: unable to map '%s'", aPath );
+	}
+
+	mData = static_cast<std::byte const*>(ptr);
+}
+
+void MappedFile::release_() noexcept
+{
+	if( mData )
+		munmap( const_cast<std::byte*>(mData), mSize );
+
+	mData = nullptr;
+	mSize = 0;
+}
+#endif // ~ _WIN32
+
+MappedFile::~MappedFile()
+{
+	release_();
+}
+
+MappedFile::MappedFile( MappedFile&& aOther ) noexcept
+	: mData( std::exchange( aOther.mData, nullptr ) )
+	, mSize( std::exchange( aOther.mSize, 0 ) )
+#	if defined(_WIN32)
+	, mFile( std::exchange( aOther.mFile, nullptr ) )
+	, mMapping( std::exchange( aOther.mMapping, nullptr ) )
+#	endif // ~ _WIN32
+{}
+MappedFile& MappedFile::operator= (MappedFile&& aOther) noexcept
+{
+	std::swap( mData, aOther.mData );
+	std::swap( mSize, aOther.mSize );
+#	if defined(_WIN32)
+	std::swap( mFile, aOther.mFile );
+	std::swap( mMapping, aOther.mMapping );
+#	endif // ~ _WIN32
+	return *this;
+}
+
+std::byte const* MappedFile::data() const noexcept
+{
+	return mData;
+}
+std::size_t MappedFile::size() const noexcept
+{
+	return mSize;
+}
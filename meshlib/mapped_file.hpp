@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_HPP_6B0D8D5E_3F0B_4D55_9C0C_7A9E3A3B21D4
+#define MAPPED_FILE_HPP_6B0D8D5E_3F0B_4D55_9C0C_7A9E3A3B21D4
+
+#include <cstddef>
+
+/** MappedFile: read-only memory mapping of a whole file
+ *
+ * Uses mmap() on POSIX systems and file mappings on Windows. The contents
+ * are paged in on demand by the OS, so opening a large file is cheap, and
+ * the data can be handed directly to e.g. glBufferData() without an extra
+ * copy. The mapping starts at a page boundary.
+ */
+class MappedFile final
+{
+	public:
+		MappedFile() noexcept;
+		explicit MappedFile( char const* aPath );
+
+		~MappedFile();
+
+		MappedFile( MappedFile const& ) = delete;
+		MappedFile& operator= (MappedFile const&) = delete;
+
+		MappedFile( MappedFile&& ) noexcept;
+		MappedFile& operator= (MappedFile&&) noexcept;
+
+	public:
+		std::byte const* data() const noexcept;
+		std::size_t size() const noexcept;
+
+	private:
+		void release_() noexcept;
+
+	private:
+		std::byte const* mData;
+		std::size_t mSize;
+
+#		if defined(_WIN32)
+		void* mFile;
+		void* mMapping;
+#		endif // ~ _WIN32
+};
+
+#endif // MAPPED_FILE_HPP_6B0D8D5E_3F0B_4D55_9C0C_7A9E3A3B21D4
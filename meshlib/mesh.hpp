@@ -0,0 +1,87 @@
+#ifndef MESH_HPP_0F6E1D43_95A8_4B7C_A3D1_2C8E7B514F0A
+#define MESH_HPP_0F6E1D43_95A8_4B7C_A3D1_2C8E7B514F0A
+
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/bounds.hpp"
+
+/** MeshVertex: interleaved vertex
+ *
+ * The layout matches VertexLayout::kFloat32 (see main/simple_mesh.hpp), so
+ * arrays of MeshVertex can be uploaded to GL as-is.
+ */
+struct MeshVertex
+{
+	Vec3f position;
+	Vec3f normal;
+	Vec2f texcoord;
+};
+
+static_assert( sizeof(MeshVertex) == 32 );
+
+/** MeshSubmesh: range of indices drawn with a single material
+ */
+struct MeshSubmesh
+{
+	std::uint32_t firstIndex;
+	std::uint32_t indexCount;
+	std::uint32_t materialIndex;
+};
+
+struct MeshMaterial
+{
+	std::string name;
+
+	Vec3f ambient;
+	Vec3f diffuse;
+	Vec3f specular;
+	Vec3f emissive;
+	float shininess;
+
+	std::string diffuseTexture; // relative to the .obj file; may be empty
+};
+
+/** MeshLod: level of detail of a mesh
+ *
+ * A range of MeshData::submeshes. error is the (estimated) geometric error
+ * of the level, in model units; see simplify_mesh().
+ */
+struct MeshLod
+{
+	std::uint32_t firstSubmesh;
+	std::uint32_t submeshCount;
+	float error;
+};
+
+/** MeshData: indexed triangle mesh
+ *
+ * Triangles are sorted by material; each submesh references a contiguous
+ * range of indices.
+ *
+ * Meshes may have several levels of detail that share the vertices (see
+ * build_lod_chain()). If lods is empty, all submeshes form a single level.
+ * Otherwise, lods[0] is the full-detail level and the following levels are
+ * increasingly coarse.
+ */
+struct MeshData
+{
+	std::vector<MeshVertex> vertices;
+	std::vector<std::uint32_t> indices;
+
+	std::vector<MeshSubmesh> submeshes;
+	std::vector<MeshMaterial> materials;
+	std::vector<MeshLod> lods;
+
+	Aabb3f bounds = kEmptyAabb3f;
+};
+
+// Loads a Wavefront OBJ file (and its material libraries). Faces are
+// triangulated. Throws Error on failure.
+MeshData load_wavefront_obj( char const* aPath );
+
+#endif // MESH_HPP_0F6E1D43_95A8_4B7C_A3D1_2C8E7B514F0A
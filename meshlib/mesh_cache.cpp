@@ -0,0 +1,398 @@
+#include "mesh_cache.hpp"
+
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+#include "mesh_optimize.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr char kMagic_[8] = { 'V', 'M', 'L', 'M', 'E', 'S', 'H', '\0' };
+
+	std::uint64_t align_( std::uint64_t aOffset ) noexcept
+	{
+		return (aOffset + kMeshCacheAlignment-1) & ~std::uint64_t(kMeshCacheAlignment-1);
+	}
+
+	template< std::size_t tSize >
+	void copy_string_( char (&aOut)[tSize], std::string const& aIn, char const* aWhat )
+	{
+		if( aIn.size() >= tSize )
+			throw Error( "Mesh cache: %s '%s' is too long (max %zu characters)", aWhat, aIn.c_str(), tSize-1 );
+
+		std::memset( aOut, 0, tSize );
+		std::memcpy( aOut, aIn.data(), aIn.size() );
+	}
+
+	bool check_dependencies_( MeshCache const& aCache, std::vector<std::size_t>& aTouched )
+	{
+		return check_file_dependencies( aCache.dependencies(), aCache.dependencyCount(), aCache.path().c_str(), aTouched );
+	}
+}
+
+MeshCache::MeshCache( char const* aPath )
+	: mFile( aPath )
+	, mPath( aPath )
+{
+	if( mFile.size() < sizeof(MeshCacheHeader) )
+		throw Error( "Mesh cache '%s': file too small", aPath );
+
+	auto const& head = header();
+	if( 0 != std::memcmp( head.magic, kMagic_, sizeof(kMagic_) ) )
+		throw Error( "Mesh cache '%s': not a mesh cache", aPath );
+	if( kMeshCacheVersion != head.version || sizeof(MeshCacheHeader) != head.headerSize )
+		throw Error( "Mesh cache '%s': version %u (expected %u)", aPath, head.version, kMeshCacheVersion );
+	if( sizeof(MeshVertex) != head.vertexStride )
+		throw Error( "Mesh cache '%s': unexpected vertex stride %u", aPath, head.vertexStride );
+	if( mFile.size() != head.fileSize )
+		throw Error( "Mesh cache '%s': truncated", aPath );
+
+	auto const check_range = [&] (std::uint64_t aOffset, std::uint64_t aCount, std::size_t aSize) {
+		if( aOffset % kMeshCacheAlignment || aOffset > head.fileSize || aCount * aSize > head.fileSize - aOffset )
+			throw Error( "Mesh cache '%s': corrupt", aPath );
+	};
+
+	check_range( head.dependencyOffset, head.dependencyCount, sizeof(FileDependency) );
+	for( std::size_t i = 0; i < head.dependencyCount; ++i )
+	{
+		// The paths are used as C strings, see check_file_dependency()
+		auto const& dep = dependencies()[i];
+		if( !std::memchr( dep.path, '\0', sizeof(dep.path) ) )
+			throw Error( "Mesh cache '%s': corrupt", aPath );
+	}
+
+	check_range( head.submeshOffset, head.submeshCount, sizeof(MeshCacheSubmesh) );
+	check_range( head.lodOffset, head.lodCount, sizeof(MeshCacheLod) );
+	check_range( head.materialOffset, head.materialCount, sizeof(MeshCacheMaterial) );
+	check_range( head.vertexOffset, head.vertexCount, sizeof(MeshVertex) );
+	if( 2 != head.indexSize && 4 != head.indexSize )
+		throw Error( "Mesh cache '%s': unexpected index size %u", aPath, head.indexSize );
+
+	check_range( head.indexOffset, head.indexCount, head.indexSize );
+
+	if( 0 == head.lodCount )
+		throw Error( "Mesh cache '%s': no levels of detail", aPath );
+
+	for( std::size_t i = 0; i < head.lodCount; ++i )
+	{
+		auto const& lod = lods()[i];
+		if( lod.firstSubmesh > head.submeshCount || lod.submeshCount > head.submeshCount - lod.firstSubmesh )
+			throw Error( "Mesh cache '%s': corrupt", aPath );
+	}
+}
+
+MeshCacheHeader const& MeshCache::header() const noexcept
+{
+	return *reinterpret_cast<MeshCacheHeader const*>(mFile.data());
+}
+
+void const* MeshCache::vertexData() const noexcept
+{
+	return at_<MeshVertex>( header().vertexOffset );
+}
+std::size_t MeshCache::vertexBytes() const noexcept
+{
+	return std::size_t(header().vertexCount) * sizeof(MeshVertex);
+}
+
+void const* MeshCache::indexData() const noexcept
+{
+	return at_<std::byte>( header().indexOffset );
+}
+std::size_t MeshCache::indexBytes() const noexcept
+{
+	return std::size_t(header().indexCount) * header().indexSize;
+}
+std::size_t MeshCache::indexSize() const noexcept
+{
+	return header().indexSize;
+}
+
+MeshCacheSubmesh const* MeshCache::submeshes() const noexcept
+{
+	return at_<MeshCacheSubmesh>( header().submeshOffset );
+}
+std::size_t MeshCache::submeshCount() const noexcept
+{
+	return header().submeshCount;
+}
+
+MeshCacheLod const* MeshCache::lods() const noexcept
+{
+	return at_<MeshCacheLod>( header().lodOffset );
+}
+std::size_t MeshCache::lodCount() const noexcept
+{
+	return header().lodCount;
+}
+
+MeshCacheMaterial const* MeshCache::materials() const noexcept
+{
+	return at_<MeshCacheMaterial>( header().materialOffset );
+}
+std::size_t MeshCache::materialCount() const noexcept
+{
+	return header().materialCount;
+}
+
+FileDependency const* MeshCache::dependencies() const noexcept
+{
+	return at_<FileDependency>( header().dependencyOffset );
+}
+std::size_t MeshCache::dependencyCount() const noexcept
+{
+	return header().dependencyCount;
+}
+
+Aabb3f MeshCache::bounds() const noexcept
+{
+	auto const& head = header();
+	return Aabb3f{
+		Vec3f{ head.boundsMin[0], head.boundsMin[1], head.boundsMin[2] },
+		Vec3f{ head.boundsMax[0], head.boundsMax[1], head.boundsMax[2] }
+	};
+}
+
+std::string const& MeshCache::path() const noexcept
+{
+	return mPath;
+}
+
+template< typename tType >
+tType const* MeshCache::at_( std::uint64_t aOffset ) const noexcept
+{
+	return reinterpret_cast<tType const*>(mFile.data() + aOffset);
+}
+
+
+std::string mesh_cache_path( char const* aObjPath )
+{
+	return std::string(aObjPath) + ".meshcache";
+}
+
+std::vector<FileDependency> make_obj_dependencies( char const* aObjPath, char const* aCachePath )
+{
+	fs::path const dir = fs::path( aObjPath ).parent_path();
+
+	std::vector<FileDependency> ret;
+
+	MappedFile const obj( aObjPath );
+	ret.emplace_back( make_file_dependency( aObjPath, aCachePath, obj ) );
+
+	// Find "mtllib" statements. rapidobj resolves these relative to the OBJ.
+	char const* it = reinterpret_cast<char const*>(obj.data());
+	char const* const end = it + obj.size();
+	while( it != end )
+	{
+		char const* eol = std::find( it, end, '\n' );
+
+		constexpr char kMtllib[] = "mtllib";
+		constexpr std::size_t kMtllibLen = sizeof(kMtllib)-1;
+		if( std::size_t(eol - it) > kMtllibLen && 0 == std::memcmp( it, kMtllib, kMtllibLen ) && (' ' == it[kMtllibLen] || '\t' == it[kMtllibLen]) )
+		{
+			char const* nameBeg = it + kMtllibLen;
+			char const* nameEnd = eol;
+			while( nameBeg != nameEnd && (' ' == *nameBeg || '\t' == *nameBeg) )
+				++nameBeg;
+			while( nameEnd != nameBeg && (' ' == nameEnd[-1] || '\t' == nameEnd[-1] || '\r' == nameEnd[-1]) )
+				--nameEnd;
+
+			std::string const name( nameBeg, nameEnd );
+			if( !name.empty() && fs::exists( dir / name ) )
+			{
+				ret.emplace_back( make_file_dependency( (dir / name).string().c_str(), aCachePath ) );
+			}
+		}
+
+		it = eol == end ? end : eol+1;
+	}
+
+	return ret;
+}
+
+void write_mesh_cache( char const* aCachePath, MeshData const& aMesh, std::vector<FileDependency> const& aDependencies )
+{
+	MeshCacheHeader head{};
+	std::memcpy( head.magic, kMagic_, sizeof(kMagic_) );
+	head.version = kMeshCacheVersion;
+	head.headerSize = sizeof(MeshCacheHeader);
+
+	head.vertexStride = sizeof(MeshVertex);
+	head.vertexCount = std::uint32_t(aMesh.vertices.size());
+	head.indexCount = std::uint32_t(aMesh.indices.size());
+	head.submeshCount = std::uint32_t(aMesh.submeshes.size());
+	head.lodCount = std::uint32_t(std::max<std::size_t>( aMesh.lods.size(), 1 ));
+	head.materialCount = std::uint32_t(aMesh.materials.size());
+	head.dependencyCount = std::uint32_t(aDependencies.size());
+	head.indexSize = aMesh.vertices.size() <= 0xffffu ? 2 : 4;
+
+	head.dependencyOffset = align_( sizeof(MeshCacheHeader) );
+	head.submeshOffset = align_( head.dependencyOffset + head.dependencyCount * sizeof(FileDependency) );
+	head.lodOffset = align_( head.submeshOffset + head.submeshCount * sizeof(MeshCacheSubmesh) );
+	head.materialOffset = align_( head.lodOffset + head.lodCount * sizeof(MeshCacheLod) );
+	head.vertexOffset = align_( head.materialOffset + head.materialCount * sizeof(MeshCacheMaterial) );
+	head.indexOffset = align_( head.vertexOffset + head.vertexCount * sizeof(MeshVertex) );
+	head.fileSize = align_( head.indexOffset + std::uint64_t(head.indexCount) * head.indexSize );
+
+	head.boundsMin[0] = aMesh.bounds.min.x;
+	head.boundsMin[1] = aMesh.bounds.min.y;
+	head.boundsMin[2] = aMesh.bounds.min.z;
+	head.boundsMax[0] = aMesh.bounds.max.x;
+	head.boundsMax[1] = aMesh.bounds.max.y;
+	head.boundsMax[2] = aMesh.bounds.max.z;
+
+	std::vector<MeshCacheSubmesh> submeshes;
+	for( auto const& sm : aMesh.submeshes )
+		submeshes.emplace_back( MeshCacheSubmesh{ sm.firstIndex, sm.indexCount, sm.materialIndex, 0 } );
+
+	std::vector<MeshCacheLod> lods;
+	for( auto const& lod : aMesh.lods )
+		lods.emplace_back( MeshCacheLod{ lod.firstSubmesh, lod.submeshCount, lod.error, 0 } );
+	if( lods.empty() )
+		lods.emplace_back( MeshCacheLod{ 0, head.submeshCount, 0.f, 0 } );
+
+	std::vector<std::uint16_t> indices16;
+	if( 2 == head.indexSize )
+		indices16.assign( aMesh.indices.begin(), aMesh.indices.end() );
+
+	std::vector<MeshCacheMaterial> materials;
+	for( auto const& mat : aMesh.materials )
+	{
+		MeshCacheMaterial out{};
+		copy_string_( out.name, mat.name, "material name" );
+		copy_string_( out.diffuseTexture, mat.diffuseTexture, "texture path" );
+
+		Vec3f const* const src[] = { &mat.ambient, &mat.diffuse, &mat.specular, &mat.emissive };
+		float* const dst[] = { out.ambient, out.diffuse, out.specular, out.emissive };
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			dst[i][0] = src[i]->x;
+			dst[i][1] = src[i]->y;
+			dst[i][2] = src[i]->z;
+		}
+
+		out.shininess = mat.shininess;
+		materials.emplace_back( out );
+	}
+
+	std::string const tmpPath = std::string(aCachePath) + ".tmp";
+
+	{
+		std::ofstream file( tmpPath, std::ios::binary | std::ios::trunc );
+		if( !file )
+			throw Error( "Unable to create mesh cache '%s'", tmpPath.c_str() );
+
+		auto const write_at = [&] (std::uint64_t aOffset, void const* aData, std::size_t aSize) {
+			// Zero padding up to aOffset
+			static constexpr char kZeros[kMeshCacheAlignment] = {};
+			auto const pos = std::uint64_t(file.tellp());
+			file.write( kZeros, std::streamsize(aOffset - pos) );
+
+			if( aSize )
+				file.write( static_cast<char const*>(aData), std::streamsize(aSize) );
+		};
+
+		write_at( 0, &head, sizeof(head) );
+		write_at( head.dependencyOffset, aDependencies.data(), aDependencies.size() * sizeof(FileDependency) );
+		write_at( head.submeshOffset, submeshes.data(), submeshes.size() * sizeof(MeshCacheSubmesh) );
+		write_at( head.lodOffset, lods.data(), lods.size() * sizeof(MeshCacheLod) );
+		write_at( head.materialOffset, materials.data(), materials.size() * sizeof(MeshCacheMaterial) );
+		write_at( head.vertexOffset, aMesh.vertices.data(), aMesh.vertices.size() * sizeof(MeshVertex) );
+		if( 2 == head.indexSize )
+			write_at( head.indexOffset, indices16.data(), indices16.size() * sizeof(std::uint16_t) );
+		else
+			write_at( head.indexOffset, aMesh.indices.data(), aMesh.indices.size() * sizeof(std::uint32_t) );
+		write_at( head.fileSize, nullptr, 0 );
+
+		if( !file )
+			throw Error( "Unable to write mesh cache '%s'", tmpPath.c_str() );
+	}
+
+	std::error_code ec;
+	fs::rename( tmpPath, aCachePath, ec );
+	if( ec )
+	{
+		fs::remove( tmpPath, ec );
+		throw Error( "Unable to replace mesh cache '%s'", aCachePath );
+	}
+}
+
+bool is_mesh_cache_current( MeshCache const& aCache )
+{
+	std::vector<std::size_t> touched;
+	return check_dependencies_( aCache, touched );
+}
+
+std::size_t select_mesh_lod( MeshCache const& aCache, float aDistance, float aErrorScale, float aMaxScreenError ) noexcept
+{
+	// Errors increase with the level (see build_lod_chain()).
+	float const maxError = aMaxScreenError * std::max( aDistance, 0.f ) / aErrorScale;
+
+	std::size_t ret = 0;
+	while( ret+1 < aCache.lodCount() && aCache.lods()[ret+1].error <= maxError )
+		++ret;
+
+	return ret;
+}
+
+MeshCache load_mesh_cached( char const* aObjPath, bool* aRebuilt )
+{
+	std::string const cachePath = mesh_cache_path( aObjPath );
+
+	if( aRebuilt )
+		*aRebuilt = false;
+
+	std::error_code ec;
+	if( fs::exists( cachePath, ec ) )
+	{
+		try
+		{
+			std::vector<std::size_t> touched;
+			MeshCacheHeader head;
+			{
+				MeshCache cache( cachePath.c_str() );
+				if( !check_dependencies_( cache, touched ) )
+					throw Error( "'%s' is out of date", cachePath.c_str() );
+
+				if( touched.empty() )
+					return cache;
+
+				head = cache.header();
+			}
+
+			// Contents are unchanged. Store the new modification times, such
+			// that the hashing is skipped next time. (The file is unmapped
+			// first; Windows does not permit writing to mapped files.)
+			refresh_file_dependencies( cachePath.c_str(), head.dependencyOffset, head.dependencyCount, touched );
+			return MeshCache( cachePath.c_str() );
+		}
+		catch( Error const& eErr )
+		{
+			std::fprintf( stderr, "Note: ignoring mesh cache: %s\n", eErr.what() );
+		}
+		catch( fs::filesystem_error const& eErr )
+		{
+			std::fprintf( stderr, "Note: ignoring mesh cache: %s\n", eErr.what() );
+		}
+	}
+
+	std::fprintf( stderr, "Note: generating mesh cache '%s'\n", cachePath.c_str() );
+
+	auto const deps = make_obj_dependencies( aObjPath, cachePath.c_str() );
+	auto mesh = load_wavefront_obj( aObjPath );
+	optimize_mesh( mesh );
+	write_mesh_cache( cachePath.c_str(), mesh, deps );
+
+	if( aRebuilt )
+		*aRebuilt = true;
+
+	return MeshCache( cachePath.c_str() );
+}
@@ -0,0 +1,176 @@
+#ifndef MESH_CACHE_HPP_5A3B7F52_1C47_4E2D_8B8E_94B1F0C6D3A7
+#define MESH_CACHE_HPP_5A3B7F52_1C47_4E2D_8B8E_94B1F0C6D3A7
+
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh.hpp"
+#include "mapped_file.hpp"
+#include "file_dependency.hpp"
+
+/* Binary mesh cache
+ *
+ * Parsing OBJ files is slow. The first time a mesh is loaded via
+ * load_mesh_cached(), the parsed MeshData is written to a binary cache file
+ * next to the OBJ ("foo.obj" -> "foo.obj.meshcache"). Later loads memory-map
+ * the cache; vertex and index data can then be passed to glBufferData()
+ * directly, without copying or parsing.
+ *
+ * File layout (little endian, all blobs aligned to kMeshCacheAlignment):
+ *   MeshCacheHeader
+ *   FileDependency[dependencyCount]       - source files (OBJ, MTL)
+ *   MeshCacheSubmesh[submeshCount]
+ *   MeshCacheLod[lodCount]                - at least one; see MeshData::lods
+ *   MeshCacheMaterial[materialCount]
+ *   MeshVertex[vertexCount]               - interleaved vertices
+ *   indices[indexCount]                   - 16 or 32 bit, see indexSize
+ *
+ * A cache is current if all its dependencies are unchanged; see
+ * file_dependency.hpp.
+ *
+ * Meshes are processed with optimize_mesh() before they are cached. Indices
+ * are stored as 16 bit values if all vertices can be addressed that way.
+ *
+ * Bump kMeshCacheVersion whenever the format or the contents (e.g. the
+ * vertex processing in load_wavefront_obj() or optimize_mesh()) change.
+ */
+
+constexpr std::uint32_t kMeshCacheVersion = 4;
+constexpr std::size_t kMeshCacheAlignment = 64;
+
+struct MeshCacheHeader
+{
+	char magic[8]; // "VMLMESH\0"
+	std::uint32_t version;
+	std::uint32_t headerSize;
+
+	std::uint32_t vertexStride;
+	std::uint32_t vertexCount;
+	std::uint32_t indexCount;
+	std::uint32_t submeshCount;
+	std::uint32_t materialCount;
+	std::uint32_t dependencyCount;
+	std::uint32_t indexSize; // 2 or 4 bytes
+	std::uint32_t lodCount;
+
+	std::uint64_t dependencyOffset;
+	std::uint64_t submeshOffset;
+	std::uint64_t lodOffset;
+	std::uint64_t materialOffset;
+	std::uint64_t vertexOffset;
+	std::uint64_t indexOffset;
+	std::uint64_t fileSize;
+
+	float boundsMin[3];
+	float boundsMax[3];
+};
+
+struct MeshCacheSubmesh
+{
+	std::uint32_t firstIndex;
+	std::uint32_t indexCount;
+	std::uint32_t materialIndex;
+	std::uint32_t reserved;
+};
+
+struct MeshCacheLod
+{
+	std::uint32_t firstSubmesh;
+	std::uint32_t submeshCount;
+	float error; // model units
+	std::uint32_t reserved;
+};
+
+struct MeshCacheMaterial
+{
+	char name[64];
+	char diffuseTexture[192];
+
+	float ambient[3];
+	float diffuse[3];
+	float specular[3];
+	float emissive[3];
+	float shininess;
+};
+
+static_assert( std::is_trivially_copyable_v<MeshCacheHeader> );
+static_assert( sizeof(MeshCacheMaterial) == 308 );
+
+/** MeshCache: memory-mapped mesh cache file
+ *
+ * The constructor maps the file and validates its structure (but not
+ * whether it is current; see is_mesh_cache_current()). Throws Error if the
+ * file is missing or malformed. All returned pointers refer directly to the
+ * mapped file and remain valid for the lifetime of the MeshCache.
+ */
+class MeshCache final
+{
+	public:
+		explicit MeshCache( char const* aPath );
+
+	public:
+		MeshCacheHeader const& header() const noexcept;
+
+		void const* vertexData() const noexcept;
+		std::size_t vertexBytes() const noexcept;
+
+		void const* indexData() const noexcept;
+		std::size_t indexBytes() const noexcept;
+		std::size_t indexSize() const noexcept; // 2 or 4
+
+		MeshCacheSubmesh const* submeshes() const noexcept;
+		std::size_t submeshCount() const noexcept;
+
+		MeshCacheLod const* lods() const noexcept;
+		std::size_t lodCount() const noexcept;
+
+		MeshCacheMaterial const* materials() const noexcept;
+		std::size_t materialCount() const noexcept;
+
+		FileDependency const* dependencies() const noexcept;
+		std::size_t dependencyCount() const noexcept;
+
+		Aabb3f bounds() const noexcept;
+
+		std::string const& path() const noexcept;
+
+	private:
+		template< typename tType >
+		tType const* at_( std::uint64_t ) const noexcept;
+
+	private:
+		MappedFile mFile;
+		std::string mPath;
+};
+
+// "foo.obj" -> "foo.obj.meshcache"
+std::string mesh_cache_path( char const* aObjPath );
+
+// Collects the dependencies of an OBJ file: the file itself and the
+// material libraries that it references via "mtllib". Paths are stored
+// relative to the directory of aCachePath.
+std::vector<FileDependency> make_obj_dependencies( char const* aObjPath, char const* aCachePath );
+
+// Writes a cache file. aMesh is stored as-is; see optimize_mesh(). The file
+// is written to a temporary first and then
+// renamed, so a partially written cache is never observed.
+void write_mesh_cache( char const* aCachePath, MeshData const&, std::vector<FileDependency> const& );
+
+bool is_mesh_cache_current( MeshCache const& );
+
+// Picks the coarsest level of detail whose error, projected to the screen,
+// stays below aMaxScreenError pixels at aDistance. aErrorScale converts
+// model-space errors at unit distance to pixels (see terrain_error_scale()),
+// and includes the model's scale, if any. Returns an index into lods().
+std::size_t select_mesh_lod( MeshCache const&, float aDistance, float aErrorScale, float aMaxScreenError = 1.f ) noexcept;
+
+// Loads the cache for aObjPath. If the cache is missing, malformed or out of
+// date, the OBJ is parsed, optimized and the cache is (re-)generated first. If
+// aRebuilt is non-null, it is set to indicate whether that happened.
+MeshCache load_mesh_cached( char const* aObjPath, bool* aRebuilt = nullptr );
+
+#endif // MESH_CACHE_HPP_5A3B7F52_1C47_4E2D_8B8E_94B1F0C6D3A7
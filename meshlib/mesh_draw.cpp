@@ -0,0 +1,50 @@
+#include "mesh_draw.hpp"
+
+#include "../support/error.hpp"
+
+GpuMaterial make_gpu_material( MeshCacheMaterial const& aMaterial ) noexcept
+{
+	GpuMaterial ret{};
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		ret.ambient[i] = aMaterial.ambient[i];
+		ret.diffuse[i] = aMaterial.diffuse[i];
+		ret.specular[i] = aMaterial.specular[i];
+		ret.emissive[i] = aMaterial.emissive[i];
+	}
+
+	ret.shininess = aMaterial.shininess;
+	return ret;
+}
+
+MeshDrawBatch make_draw_batch( MeshCache const& aCache )
+{
+	MeshDrawBatch ret;
+
+	for( std::size_t i = 0; i < aCache.materialCount(); ++i )
+		ret.materials.emplace_back( make_gpu_material( aCache.materials()[i] ) );
+
+	auto const* submeshes = aCache.submeshes();
+	for( std::size_t l = 0; l < aCache.lodCount(); ++l )
+	{
+		ret.lodFirstCommand.emplace_back( std::uint32_t(ret.commands.size()) );
+
+		auto const& lod = aCache.lods()[l];
+		for( std::size_t s = lod.firstSubmesh; s < lod.firstSubmesh + lod.submeshCount; ++s )
+		{
+			auto const& sm = submeshes[s];
+			if( 0 == sm.indexCount )
+				continue;
+
+			if( sm.materialIndex >= aCache.materialCount() )
+				throw Error( "Mesh cache '%s': submesh %zu references material %u (of %zu)", aCache.path().c_str(), s, sm.materialIndex, aCache.materialCount() );
+
+			auto const index = std::uint32_t(ret.commands.size());
+			ret.commands.emplace_back( DrawElementsIndirectCommand{ sm.indexCount, 1, sm.firstIndex, 0, index } );
+			ret.drawMaterials.emplace_back( sm.materialIndex );
+		}
+	}
+
+	ret.lodFirstCommand.emplace_back( std::uint32_t(ret.commands.size()) );
+	return ret;
+}
@@ -0,0 +1,76 @@
+#ifndef MESH_DRAW_HPP_F7BA810C_A1AC_4EFA_94D4_2AD62656AB50
+#define MESH_DRAW_HPP_F7BA810C_A1AC_4EFA_94D4_2AD62656AB50
+
+#include <vector>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh_cache.hpp"
+
+/* Draw data for multi-draw indirect rendering
+ *
+ * A model with N materials would naively be drawn with N draw calls, each
+ * preceded by uniform updates for the material. Instead, all submeshes share
+ * one vertex and one index buffer (as stored in the mesh cache), the
+ * material parameters live in a shader storage buffer, and the whole model
+ * (or one of its levels of detail) is submitted with a single
+ * glMultiDrawElementsIndirect().
+ *
+ * Each draw command selects its material through baseInstance: the command
+ * at index i has baseInstance = i, and drawMaterials[i] holds its material
+ * index. The latter is fed to the vertex shader as an instanced attribute
+ * with a very large divisor, such that every instance of the draw sees
+ * element baseInstance. (gl_DrawID would be simpler, but requires GL 4.6 or
+ * ARB_shader_draw_parameters.) See MeshRenderer and assets/materials.glsl.
+ *
+ * The structures below match the GL/std430 layouts and are uploaded as-is.
+ */
+
+// Matches GL's DrawElementsIndirectCommand
+struct DrawElementsIndirectCommand
+{
+	std::uint32_t count;
+	std::uint32_t instanceCount;
+	std::uint32_t firstIndex;
+	std::int32_t baseVertex;
+	std::uint32_t baseInstance;
+};
+
+// Element of the material buffer; std430 layout, see assets/materials.glsl.
+// vec3s are padded to 16 bytes, so the scalars fill the gaps.
+struct GpuMaterial
+{
+	float ambient[3]; // Ka
+	float shininess; // Ns
+	float diffuse[3]; // Kd
+	float pad0;
+	float specular[3]; // Ks
+	float pad1;
+	float emissive[3]; // Ke
+	float pad2;
+};
+
+static_assert( sizeof(DrawElementsIndirectCommand) == 20 );
+static_assert( sizeof(GpuMaterial) == 64 );
+static_assert( std::is_trivially_copyable_v<GpuMaterial> );
+
+GpuMaterial make_gpu_material( MeshCacheMaterial const& ) noexcept;
+
+struct MeshDrawBatch
+{
+	// Commands for all levels of detail; the commands of level l are
+	// [lodFirstCommand[l], lodFirstCommand[l+1]).
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<std::uint32_t> lodFirstCommand;
+
+	std::vector<std::uint32_t> drawMaterials; // per command
+	std::vector<GpuMaterial> materials;
+};
+
+// One command per non-empty submesh. Submeshes are already sorted by
+// material (see MeshData).
+MeshDrawBatch make_draw_batch( MeshCache const& );
+
+#endif // MESH_DRAW_HPP_F7BA810C_A1AC_4EFA_94D4_2AD62656AB50
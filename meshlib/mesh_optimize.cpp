@@ -0,0 +1,298 @@
+#include "mesh_optimize.hpp"
+
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include <cmath>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+	// Forsyth's tuning constants. The simulated cache is LRU, which is only
+	// used to score vertices; it does not have to match the hardware.
+	constexpr std::size_t kCacheSize_ = 32;
+	constexpr float kCacheDecayPower_ = 1.5f;
+	constexpr float kLastTriScore_ = 0.75f;
+	constexpr float kValenceBoostScale_ = 2.f;
+	constexpr float kValenceBoostPower_ = 0.5f;
+
+	constexpr std::uint32_t kNone_ = std::numeric_limits<std::uint32_t>::max();
+
+	struct VertexHash_
+	{
+		std::size_t operator()( MeshVertex const& aVertex ) const noexcept
+		{
+			// FNV-1a over the raw bytes. Vertices from the same OBJ index
+			// tuple are bitwise identical, so this is sufficient.
+			unsigned char bytes[sizeof(MeshVertex)];
+			std::memcpy( bytes, &aVertex, sizeof(MeshVertex) );
+
+			std::uint64_t hash = 14695981039346656037ull;
+			for( auto const b : bytes )
+			{
+				hash ^= b;
+				hash *= 1099511628211ull;
+			}
+			return std::size_t(hash);
+		}
+	};
+	struct VertexEqual_
+	{
+		bool operator()( MeshVertex const& aLeft, MeshVertex const& aRight ) const noexcept
+		{
+			return 0 == std::memcmp( &aLeft, &aRight, sizeof(MeshVertex) );
+		}
+	};
+
+	float vertex_score_( std::uint32_t aCachePos, std::uint32_t aRemaining ) noexcept
+	{
+		if( 0 == aRemaining )
+			return -1.f; // no triangles left; never pick
+
+		float score = 0.f;
+		if( kNone_ != aCachePos )
+		{
+			if( aCachePos < 3 )
+			{
+				// Used by the last triangle. Fixed score, such that the exact
+				// order within the triangle does not matter.
+				score = kLastTriScore_;
+			}
+			else
+			{
+				float const scale = 1.f / float(kCacheSize_ - 3);
+				score = std::pow( 1.f - float(aCachePos - 3) * scale, kCacheDecayPower_ );
+			}
+		}
+
+		// Boost vertices with few remaining triangles, to get rid of lone
+		// triangles early.
+		score += kValenceBoostScale_ * std::pow( float(aRemaining), -kValenceBoostPower_ );
+		return score;
+	}
+
+	// Reorders the triangles in aIndices[0..aCount).
+	void forsyth_( std::uint32_t* aIndices, std::size_t aCount, std::size_t aVertexCount )
+	{
+		std::size_t const triCount = aCount / 3;
+		if( triCount < 2 )
+			return;
+
+		// Vertex -> triangle adjacency (CSR). Triangles are removed from a
+		// vertex's list when they are emitted.
+		std::vector<std::uint32_t> remaining( aVertexCount, 0 );
+		for( std::size_t i = 0; i < aCount; ++i )
+			++remaining[aIndices[i]];
+
+		std::vector<std::uint32_t> offsets( aVertexCount+1, 0 );
+		for( std::size_t v = 0; v < aVertexCount; ++v )
+			offsets[v+1] = offsets[v] + remaining[v];
+
+		std::vector<std::uint32_t> adjacency( aCount );
+		{
+			std::vector<std::uint32_t> fill( offsets.begin(), offsets.end()-1 );
+			for( std::size_t i = 0; i < aCount; ++i )
+				adjacency[fill[aIndices[i]]++] = std::uint32_t(i / 3);
+		}
+
+		std::vector<std::uint32_t> cachePos( aVertexCount, kNone_ );
+		std::vector<float> vertexScore( aVertexCount );
+		for( std::size_t v = 0; v < aVertexCount; ++v )
+			vertexScore[v] = vertex_score_( kNone_, remaining[v] );
+
+		std::vector<float> triScore( triCount );
+		std::vector<bool> emitted( triCount, false );
+		for( std::size_t t = 0; t < triCount; ++t )
+		{
+			triScore[t] = vertexScore[aIndices[t*3+0]]
+				+ vertexScore[aIndices[t*3+1]]
+				+ vertexScore[aIndices[t*3+2]]
+			;
+		}
+
+		std::vector<std::uint32_t> output;
+		output.reserve( aCount );
+
+		std::uint32_t cache[kCacheSize_ + 3];
+		std::size_t cacheCount = 0;
+
+		std::size_t scanCursor = 0; // for when no cached vertex has triangles left
+		std::uint32_t best = kNone_;
+
+		while( output.size() < aCount )
+		{
+			if( kNone_ == best )
+			{
+				// Find the best remaining triangle. Full scans are rare (they
+				// only happen when the cache runs dry), so start from the
+				// first unemitted triangle and take the best in a window.
+				while( scanCursor < triCount && emitted[scanCursor] )
+					++scanCursor;
+
+				assert( scanCursor < triCount );
+				best = std::uint32_t(scanCursor);
+				for( std::size_t t = scanCursor+1; t < triCount && t < scanCursor + 256; ++t )
+				{
+					if( !emitted[t] && triScore[t] > triScore[best] )
+						best = std::uint32_t(t);
+				}
+			}
+
+			// Emit triangle
+			std::uint32_t const tri[3] = { aIndices[best*3+0], aIndices[best*3+1], aIndices[best*3+2] };
+			output.insert( output.end(), tri, tri+3 );
+			emitted[best] = true;
+
+			for( auto const v : tri )
+			{
+				auto* const beg = adjacency.data() + offsets[v];
+				auto* const end = beg + remaining[v];
+				auto* const it = std::find( beg, end, best );
+				assert( it != end );
+				*it = end[-1];
+				--remaining[v];
+			}
+
+			// Update cache: the triangle's vertices move to the front.
+			std::uint32_t newCache[kCacheSize_ + 3];
+			std::size_t newCount = 0;
+			for( auto const v : tri )
+				newCache[newCount++] = v;
+			for( std::size_t i = 0; i < cacheCount; ++i )
+			{
+				auto const v = cache[i];
+				if( v != tri[0] && v != tri[1] && v != tri[2] )
+					newCache[newCount++] = v;
+			}
+
+			// Vertices beyond kCacheSize_ are evicted, but still need their
+			// scores updated.
+			for( std::size_t i = 0; i < newCount; ++i )
+			{
+				auto const v = newCache[i];
+				cachePos[v] = i < kCacheSize_ ? std::uint32_t(i) : kNone_;
+				vertexScore[v] = vertex_score_( cachePos[v], remaining[v] );
+			}
+
+			cacheCount = std::min( newCount, kCacheSize_ );
+			std::copy( newCache, newCache + cacheCount, cache );
+
+			// Rescore triangles touching the updated vertices, and pick the
+			// best one as the next candidate.
+			best = kNone_;
+			float bestScore = -1.f;
+			for( std::size_t i = 0; i < newCount; ++i )
+			{
+				auto const v = newCache[i];
+				for( std::uint32_t j = 0; j < remaining[v]; ++j )
+				{
+					auto const t = adjacency[offsets[v] + j];
+					float const score = vertexScore[aIndices[t*3+0]]
+						+ vertexScore[aIndices[t*3+1]]
+						+ vertexScore[aIndices[t*3+2]]
+					;
+					triScore[t] = score;
+
+					if( score > bestScore )
+					{
+						bestScore = score;
+						best = t;
+					}
+				}
+			}
+		}
+
+		std::copy( output.begin(), output.end(), aIndices );
+	}
+}
+
+void deduplicate_vertices( MeshData& aMesh )
+{
+	std::unordered_map<MeshVertex, std::uint32_t, VertexHash_, VertexEqual_> unique;
+	unique.reserve( aMesh.vertices.size() );
+
+	std::vector<MeshVertex> vertices;
+	std::vector<std::uint32_t> remap( aMesh.vertices.size() );
+	for( std::size_t i = 0; i < aMesh.vertices.size(); ++i )
+	{
+		auto const [it, inserted] = unique.emplace( aMesh.vertices[i], std::uint32_t(vertices.size()) );
+		if( inserted )
+			vertices.emplace_back( aMesh.vertices[i] );
+
+		remap[i] = it->second;
+	}
+
+	for( auto& idx : aMesh.indices )
+		idx = remap[idx];
+
+	aMesh.vertices = std::move(vertices);
+}
+
+void optimize_vertex_cache( MeshData& aMesh )
+{
+	// Submeshes are drawn separately; optimize each on its own. Triangles
+	// never move between submeshes.
+	for( auto const& sm : aMesh.submeshes )
+		forsyth_( aMesh.indices.data() + sm.firstIndex, sm.indexCount, aMesh.vertices.size() );
+}
+
+void optimize_vertex_fetch( MeshData& aMesh )
+{
+	std::vector<std::uint32_t> remap( aMesh.vertices.size(), kNone_ );
+	std::vector<MeshVertex> vertices;
+	vertices.reserve( aMesh.vertices.size() );
+
+	for( auto& idx : aMesh.indices )
+	{
+		if( kNone_ == remap[idx] )
+		{
+			remap[idx] = std::uint32_t(vertices.size());
+			vertices.emplace_back( aMesh.vertices[idx] );
+		}
+
+		idx = remap[idx];
+	}
+
+	aMesh.vertices = std::move(vertices);
+}
+
+void optimize_mesh( MeshData& aMesh )
+{
+	deduplicate_vertices( aMesh );
+	optimize_vertex_cache( aMesh );
+	optimize_vertex_fetch( aMesh );
+}
+
+
+float compute_acmr( std::uint32_t const* aIndices, std::size_t aIndexCount, std::size_t aVertexCount, std::size_t aCacheSize )
+{
+	std::size_t const triCount = aIndexCount / 3;
+	if( 0 == triCount )
+		return 0.f;
+
+	// FIFO cache; a vertex is in the cache if it was inserted less than
+	// aCacheSize insertions ago.
+	std::vector<std::size_t> insertedAt( aVertexCount, 0 );
+	std::size_t insertions = 0, misses = 0;
+
+	for( std::size_t i = 0; i < aIndexCount; ++i )
+	{
+		auto const v = aIndices[i];
+		if( 0 == insertedAt[v] || insertions - insertedAt[v] >= aCacheSize )
+		{
+			++misses;
+			++insertions;
+			insertedAt[v] = insertions; // 1-based; 0 = never
+		}
+	}
+
+	return float(misses) / float(triCount);
+}
+
+float compute_acmr( MeshData const& aMesh, std::size_t aCacheSize )
+{
+	return compute_acmr( aMesh.indices.data(), aMesh.indices.size(), aMesh.vertices.size(), aCacheSize );
+}
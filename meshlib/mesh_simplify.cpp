@@ -0,0 +1,520 @@
+#include "mesh_simplify.hpp"
+
+#include <tuple>
+#include <limits>
+#include <algorithm>
+
+#include <cmath>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	constexpr std::uint32_t kNone_ = std::numeric_limits<std::uint32_t>::max();
+	constexpr std::uint32_t kMulti_ = kNone_ - 1;
+
+	// Weight of the planes that keep borders and seams in place, relative to
+	// the (area weighted) triangle planes.
+	constexpr double kEdgeWeight_ = 2.0;
+
+	// Lower bound for the number of candidates considered per pass, relative
+	// to the number of triangles; avoids many nearly empty passes close to
+	// the target.
+	constexpr std::size_t kMinCandidatesPerPassDiv_ = 256;
+
+	enum class VertexKind_ : std::uint8_t
+	{
+		kManifold,
+		kBorder,
+		kSeam,
+		kLocked
+	};
+
+	// Symmetric 4x4 matrix, upper triangle: xx xy xz xw yy yz yw zz zw ww
+	struct Quadric_
+	{
+		double m[10] = {};
+		double weight = 0.0;
+	};
+
+	void add_plane_( Quadric_& aQ, double aX, double aY, double aZ, double aD, double aWeight ) noexcept
+	{
+		double const p[4] = { aX, aY, aZ, aD };
+
+		std::size_t k = 0;
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			for( std::size_t j = i; j < 4; ++j )
+				aQ.m[k++] += aWeight * p[i] * p[j];
+		}
+	}
+
+	void add_( Quadric_& aQ, Quadric_ const& aOther ) noexcept
+	{
+		for( std::size_t i = 0; i < 10; ++i )
+			aQ.m[i] += aOther.m[i];
+		aQ.weight += aOther.weight;
+	}
+
+	float error_( Quadric_ const& aQ, Vec3f aP ) noexcept
+	{
+		double const v[4] = { aP.x, aP.y, aP.z, 1.0 };
+
+		double sum = 0.0;
+		std::size_t k = 0;
+		for( std::size_t i = 0; i < 4; ++i )
+		{
+			for( std::size_t j = i; j < 4; ++j, ++k )
+				sum += (i == j ? 1.0 : 2.0) * aQ.m[k] * v[i] * v[j];
+		}
+
+		double const weight = aQ.weight > 0.0 ? aQ.weight : 1.0;
+		return float(std::sqrt( std::max( sum, 0.0 ) / weight ));
+	}
+
+	// Assigns ids to distinct positions (bitwise comparison).
+	std::vector<std::uint32_t> position_ids_( std::vector<MeshVertex> const& aVertices, std::vector<Vec3f>& aPositions )
+	{
+		auto const key = [&] (std::uint32_t aV) {
+			std::uint32_t bits[3];
+			std::memcpy( bits, &aVertices[aV].position, sizeof(bits) );
+			return std::make_tuple( bits[0], bits[1], bits[2] );
+		};
+
+		std::vector<std::uint32_t> order( aVertices.size() );
+		for( std::uint32_t i = 0; i < order.size(); ++i )
+			order[i] = i;
+		std::sort( order.begin(), order.end(), [&] (std::uint32_t aA, std::uint32_t aB) { return key( aA ) < key( aB ); } );
+
+		std::vector<std::uint32_t> ret( aVertices.size() );
+		for( std::size_t i = 0; i < order.size(); ++i )
+		{
+			if( 0 == i || key( order[i-1] ) != key( order[i] ) )
+				aPositions.push_back( aVertices[order[i]].position );
+			ret[order[i]] = std::uint32_t(aPositions.size()-1);
+		}
+		return ret;
+	}
+
+	// Half-edges without a twin (in terms of vertex indices, i.e., including
+	// attribute seams). aOut/aIn receive the single open edge leaving/
+	// entering each vertex, kNone_, or kMulti_.
+	void find_open_edges_( std::vector<std::uint32_t> const& aIndices, std::size_t aVertexCount, std::vector<std::uint32_t>& aOut, std::vector<std::uint32_t>& aIn )
+	{
+		// Outgoing edges per vertex (CSR)
+		std::vector<std::uint32_t> offsets( aVertexCount+1, 0 ), targets( aIndices.size() );
+		for( std::size_t i = 0; i < aIndices.size(); ++i )
+			++offsets[aIndices[i]+1];
+		for( std::size_t v = 0; v < aVertexCount; ++v )
+			offsets[v+1] += offsets[v];
+
+		{
+			auto fill = offsets;
+			for( std::size_t t = 0; t < aIndices.size(); t += 3 )
+			{
+				for( std::size_t e = 0; e < 3; ++e )
+					targets[fill[aIndices[t+e]]++] = aIndices[t+(e+1)%3];
+			}
+		}
+
+		aOut.assign( aVertexCount, kNone_ );
+		aIn.assign( aVertexCount, kNone_ );
+		for( std::uint32_t a = 0; a < aVertexCount; ++a )
+		{
+			for( std::uint32_t k = offsets[a]; k < offsets[a+1]; ++k )
+			{
+				std::uint32_t const b = targets[k];
+
+				auto const beg = targets.begin() + offsets[b], end = targets.begin() + offsets[b+1];
+				if( std::find( beg, end, a ) != end )
+					continue;
+
+				aOut[a] = kNone_ == aOut[a] ? b : kMulti_;
+				aIn[b] = kNone_ == aIn[b] ? a : kMulti_;
+			}
+		}
+	}
+
+	bool is_single_( std::uint32_t aV ) noexcept
+	{
+		return kNone_ != aV && kMulti_ != aV;
+	}
+
+	Vec3f triangle_normal_( Vec3f aP0, Vec3f aP1, Vec3f aP2 ) noexcept
+	{
+		return cross( aP1 - aP0, aP2 - aP0 );
+	}
+
+	struct Collapse_
+	{
+		float error;
+		std::uint32_t from, to;
+		std::uint32_t fromSibling, toSibling; // for seams; kNone_ otherwise
+	};
+}
+
+SimplifyResult simplify_mesh( MeshData const& aMesh, SimplifyOptions const& aOptions )
+{
+	std::size_t const vertexCount = aMesh.vertices.size();
+
+	// Triangles of the full-detail level, with their submesh
+	std::size_t const submeshCount = aMesh.lods.empty() ? aMesh.submeshes.size() : aMesh.lods.front().submeshCount;
+
+	std::vector<std::uint32_t> indices, triSubmesh;
+	for( std::size_t s = 0; s < submeshCount; ++s )
+	{
+		auto const& sm = aMesh.submeshes[s];
+		indices.insert( indices.end(), aMesh.indices.begin() + sm.firstIndex, aMesh.indices.begin() + sm.firstIndex + sm.indexCount );
+		triSubmesh.insert( triSubmesh.end(), sm.indexCount / 3, std::uint32_t(s) );
+	}
+
+	std::vector<Vec3f> positions;
+	auto const posId = position_ids_( aMesh.vertices, positions );
+	std::size_t const positionCount = positions.size();
+
+	// Quadrics: planes of the adjacent triangles (area weighted), and
+	// perpendicular planes along borders and seams.
+	std::vector<Quadric_> quadrics( positionCount );
+	{
+		std::vector<std::uint32_t> openOut, openIn;
+		find_open_edges_( indices, vertexCount, openOut, openIn );
+
+		for( std::size_t t = 0; t < indices.size(); t += 3 )
+		{
+			Vec3f const p[3] = { positions[posId[indices[t]]], positions[posId[indices[t+1]]], positions[posId[indices[t+2]]] };
+			Vec3f const n = triangle_normal_( p[0], p[1], p[2] );
+			float const len = length( n );
+			if( len <= 0.f )
+				continue;
+
+			Vec3f const un = n / len;
+			double const area = 0.5 * len;
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				auto& q = quadrics[posId[indices[t+e]]];
+				add_plane_( q, un.x, un.y, un.z, -dot( un, p[0] ), area );
+				q.weight += area;
+			}
+
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				std::uint32_t const a = indices[t+e], b = indices[t+(e+1)%3];
+				if( openOut[a] != b && kMulti_ != openOut[a] )
+					continue;
+
+				Vec3f const edge = p[(e+1)%3] - p[e];
+				Vec3f const m = cross( edge, un );
+				float const mlen = length( m );
+				if( mlen <= 0.f )
+					continue;
+
+				Vec3f const um = m / mlen;
+				double const w = kEdgeWeight_ * dot( edge, edge );
+				add_plane_( quadrics[posId[a]], um.x, um.y, um.z, -dot( um, p[e] ), w );
+				add_plane_( quadrics[posId[b]], um.x, um.y, um.z, -dot( um, p[e] ), w );
+			}
+		}
+	}
+
+	std::size_t triCount = indices.size() / 3;
+	std::size_t const target = std::size_t(double(triCount) * std::clamp( double(aOptions.targetRatio), 0.0, 1.0 ));
+
+	float maxError = 0.f;
+
+	std::vector<std::uint32_t> openOut, openIn, remap( vertexCount );
+	std::vector<std::uint32_t> posMaterial, posFirst, posSecond, posCount;
+	std::vector<std::uint32_t> adjOffset, adjTris;
+	std::vector<VertexKind_> kind( vertexCount );
+	std::vector<std::uint8_t> lockedPos;
+	std::vector<Collapse_> best, collapses;
+
+	std::size_t widen = 1;
+
+	while( triCount > target )
+	{
+		find_open_edges_( indices, vertexCount, openOut, openIn );
+
+		// Vertices (with the same position) per position, and materials
+		posMaterial.assign( positionCount, kNone_ );
+		posFirst.assign( positionCount, kNone_ );
+		posSecond.assign( positionCount, kNone_ );
+		posCount.assign( positionCount, 0 );
+		adjOffset.assign( positionCount+1, 0 );
+
+		for( std::size_t t = 0; t < indices.size(); t += 3 )
+		{
+			std::uint32_t const material = aMesh.submeshes[triSubmesh[t/3]].materialIndex;
+			for( std::size_t e = 0; e < 3; ++e )
+			{
+				std::uint32_t const p = posId[indices[t+e]];
+				posMaterial[p] = kNone_ == posMaterial[p] || material == posMaterial[p] ? material : kMulti_;
+				++adjOffset[p+1];
+			}
+		}
+
+		std::fill( kind.begin(), kind.end(), VertexKind_::kLocked );
+		for( std::size_t t = 0; t < indices.size(); ++t )
+		{
+			std::uint32_t const v = indices[t], p = posId[v];
+			if( v == posFirst[p] || v == posSecond[p] )
+				continue;
+
+			++posCount[p];
+			(kNone_ == posFirst[p] ? posFirst[p] : posSecond[p]) = v;
+		}
+
+		for( std::size_t p = 0; p < positionCount; ++p )
+		{
+			if( 0 == posCount[p] || kMulti_ == posMaterial[p] )
+				continue;
+
+			std::uint32_t const v = posFirst[p];
+			if( 1 == posCount[p] )
+			{
+				if( kNone_ == openOut[v] && kNone_ == openIn[v] )
+					kind[v] = VertexKind_::kManifold;
+				else if( is_single_( openOut[v] ) && is_single_( openIn[v] ) )
+					kind[v] = VertexKind_::kBorder;
+			}
+			else if( 2 == posCount[p] )
+			{
+				// Seam: the open edges of the two vertices are twins in terms
+				// of positions.
+				std::uint32_t const w = posSecond[p];
+				if( is_single_( openOut[v] ) && is_single_( openIn[v] ) && is_single_( openOut[w] ) && is_single_( openIn[w] )
+					&& posId[openOut[v]] == posId[openIn[w]] && posId[openIn[v]] == posId[openOut[w]] )
+				{
+					kind[v] = kind[w] = VertexKind_::kSeam;
+				}
+			}
+		}
+
+		// Triangles per position
+		for( std::size_t p = 0; p < positionCount; ++p )
+			adjOffset[p+1] += adjOffset[p];
+
+		adjTris.resize( adjOffset.back() );
+		{
+			auto fill = adjOffset;
+			for( std::size_t t = 0; t < indices.size(); t += 3 )
+			{
+				for( std::size_t e = 0; e < 3; ++e )
+					adjTris[fill[posId[indices[t+e]]]++] = std::uint32_t(t/3);
+			}
+		}
+
+		// Cheapest collapse of each vertex, sorted by error
+		best.assign( vertexCount, Collapse_{ std::numeric_limits<float>::infinity(), kNone_, kNone_, kNone_, kNone_ } );
+		for( std::size_t t = 0; t < indices.size(); t += 3 )
+		{
+			for( std::size_t e = 0; e < 6; ++e )
+			{
+				std::uint32_t const a = indices[t + e%3], b = indices[t + (e < 3 ? (e+1)%3 : (e+2)%3)];
+
+				Collapse_ c{ 0.f, a, b, kNone_, kNone_ };
+				bool const alongOpen = openOut[a] == b || openIn[a] == b;
+				switch( kind[a] )
+				{
+					case VertexKind_::kManifold:
+						break;
+					case VertexKind_::kBorder:
+						if( !alongOpen )
+							continue;
+						break;
+					case VertexKind_::kSeam:
+					{
+						if( !alongOpen )
+							continue;
+
+						std::uint32_t const a2 = posFirst[posId[a]] == a ? posSecond[posId[a]] : posFirst[posId[a]];
+						if( is_single_( openOut[a2] ) && posId[openOut[a2]] == posId[b] )
+							c.toSibling = openOut[a2];
+						else if( is_single_( openIn[a2] ) && posId[openIn[a2]] == posId[b] )
+							c.toSibling = openIn[a2];
+						else
+							continue;
+
+						c.fromSibling = a2;
+						break;
+					}
+					case VertexKind_::kLocked:
+						continue;
+				}
+
+				c.error = error_( quadrics[posId[a]], positions[posId[b]] );
+				if( c.error < best[a].error && c.error <= aOptions.maxError )
+					best[a] = c;
+			}
+		}
+
+		collapses.clear();
+		for( auto const& c : best )
+		{
+			if( kNone_ != c.from )
+				collapses.emplace_back( c );
+		}
+
+		// Each collapse removes about two triangles. Only consider as many
+		// candidates as are needed to reach the target; otherwise, expensive
+		// collapses would be performed while cheaper ones (that only become
+		// available in the next pass) remain.
+		// If none of these can be performed, the limit is raised instead.
+		std::size_t const goal = std::max<std::size_t>( (triCount - target) / 2, triCount / kMinCandidatesPerPassDiv_ + 1 ) * widen;
+		bool const truncated = collapses.size() > goal;
+		if( truncated )
+		{
+			std::nth_element( collapses.begin(), collapses.begin() + std::ptrdiff_t(goal), collapses.end(), [] (Collapse_ const& aA, Collapse_ const& aB) { return aA.error < aB.error; } );
+			collapses.resize( goal );
+		}
+
+		std::sort( collapses.begin(), collapses.end(), [] (Collapse_ const& aA, Collapse_ const& aB) { return aA.error < aB.error; } );
+
+		// Apply as many as possible. Both ends of a collapse are locked for
+		// the rest of the pass, so remap[] never needs to be followed more
+		// than once; the checks below look at the triangles through remap[].
+		for( std::uint32_t i = 0; i < vertexCount; ++i )
+			remap[i] = i;
+
+		lockedPos.assign( positionCount, 0 );
+
+		std::size_t applied = 0;
+		for( auto const& c : collapses )
+		{
+			if( triCount <= target )
+				break;
+
+			std::uint32_t const pa = posId[c.from], pb = posId[c.to];
+			if( pa == pb || lockedPos[pa] || lockedPos[pb] )
+				continue;
+
+			std::size_t removed = 0;
+			bool ok = true;
+			for( std::uint32_t k = adjOffset[pa]; k < adjOffset[pa+1] && ok; ++k )
+			{
+				std::size_t const t = std::size_t(adjTris[k]) * 3;
+				std::uint32_t const tp[3] = { posId[remap[indices[t]]], posId[remap[indices[t+1]]], posId[remap[indices[t+2]]] };
+				if( tp[0] == tp[1] || tp[1] == tp[2] || tp[0] == tp[2] )
+					continue; // removed by an earlier collapse
+
+				if( tp[0] == pb || tp[1] == pb || tp[2] == pb )
+				{
+					++removed;
+					continue;
+				}
+
+				Vec3f const n0 = triangle_normal_( positions[tp[0]], positions[tp[1]], positions[tp[2]] );
+				Vec3f const n1 = triangle_normal_( 
+					positions[tp[0] == pa ? pb : tp[0]],
+					positions[tp[1] == pa ? pb : tp[1]],
+					positions[tp[2] == pa ? pb : tp[2]]
+				);
+
+				// Reject flips, large rotations and slivers
+				float const l0 = dot( n0, n0 ), l1 = dot( n1, n1 );
+				if( l1 <= 1e-6f * l0 || dot( n0, n1 ) < 0.25f * std::sqrt( l0 * l1 ) )
+					ok = false;
+			}
+
+			if( !ok )
+				continue;
+
+			remap[c.from] = c.to;
+			if( kNone_ != c.fromSibling )
+				remap[c.fromSibling] = c.toSibling;
+
+			add_( quadrics[pb], quadrics[pa] );
+
+			lockedPos[pa] = lockedPos[pb] = 1;
+
+			triCount -= removed;
+			maxError = std::max( maxError, c.error );
+			++applied;
+		}
+
+		if( 0 == applied )
+		{
+			if( !truncated )
+				break;
+
+			widen *= 4;
+			continue;
+		}
+
+		widen = 1;
+
+		// Rewrite the indices and drop degenerate triangles
+		std::size_t out = 0;
+		for( std::size_t t = 0; t < indices.size(); t += 3 )
+		{
+			std::uint32_t const a = remap[indices[t]], b = remap[indices[t+1]], c = remap[indices[t+2]];
+			if( posId[a] == posId[b] || posId[b] == posId[c] || posId[a] == posId[c] )
+				continue;
+
+			indices[out+0] = a;
+			indices[out+1] = b;
+			indices[out+2] = c;
+			triSubmesh[out/3] = triSubmesh[t/3];
+			out += 3;
+		}
+
+		indices.resize( out );
+		triSubmesh.resize( out/3 );
+		triCount = out/3;
+	}
+
+	// Triangles are still grouped by submesh
+	SimplifyResult ret;
+	ret.indices = std::move(indices);
+	ret.error = maxError;
+
+	for( std::size_t t = 0; t < triSubmesh.size(); ++t )
+	{
+		if( 0 == t || triSubmesh[t] != triSubmesh[t-1] )
+			ret.submeshes.emplace_back( MeshSubmesh{ std::uint32_t(t*3), 0, aMesh.submeshes[triSubmesh[t]].materialIndex } );
+		ret.submeshes.back().indexCount += 3;
+	}
+
+	return ret;
+}
+
+void build_lod_chain( MeshData& aMesh, LodChainOptions const& aOptions )
+{
+	if( !aMesh.lods.empty() )
+		throw Error( "build_lod_chain(): mesh already has LODs" );
+
+	std::size_t prevTris = 0;
+	for( auto const& sm : aMesh.submeshes )
+		prevTris += sm.indexCount / 3;
+
+	aMesh.lods.emplace_back( MeshLod{ 0, std::uint32_t(aMesh.submeshes.size()), 0.f } );
+
+	float ratio = 1.f;
+	for( std::size_t level = 1; level < aOptions.maxLevels; ++level )
+	{
+		ratio *= aOptions.ratio;
+
+		SimplifyOptions opts;
+		opts.targetRatio = ratio;
+		opts.maxError = aOptions.maxError;
+
+		auto const res = simplify_mesh( aMesh, opts );
+
+		std::size_t const tris = res.indices.size() / 3;
+		if( 0 == tris || double(tris) > double(prevTris) * (1.0 - aOptions.minReduction) )
+			break;
+
+		auto const offset = std::uint32_t(aMesh.indices.size());
+		aMesh.indices.insert( aMesh.indices.end(), res.indices.begin(), res.indices.end() );
+
+		MeshLod lod{ std::uint32_t(aMesh.submeshes.size()), std::uint32_t(res.submeshes.size()), std::max( res.error, aMesh.lods.back().error ) };
+		for( auto sm : res.submeshes )
+		{
+			sm.firstIndex += offset;
+			aMesh.submeshes.emplace_back( sm );
+		}
+
+		aMesh.lods.emplace_back( lod );
+		prevTris = tris;
+	}
+}
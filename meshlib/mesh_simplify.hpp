@@ -0,0 +1,73 @@
+#ifndef MESH_SIMPLIFY_HPP_1D6C8E42_A7F3_4B90_95E1_C24B8F3D7A06
+#define MESH_SIMPLIFY_HPP_1D6C8E42_A7F3_4B90_95E1_C24B8F3D7A06
+
+#include <limits>
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh.hpp"
+
+/* Mesh simplification
+ *
+ * simplify_mesh() reduces the triangle count of an indexed mesh (see
+ * deduplicate_vertices()) with quadric error metrics (M. Garland and P.
+ * Heckbert, "Surface Simplification Using Quadric Error Metrics"). Edges are
+ * collapsed in order of increasing error; a collapse moves one vertex onto
+ * the other (a "half-edge" collapse), so no new vertices are created and
+ * the vertex buffer can be shared between the original and simplified
+ * meshes.
+ *
+ * Vertices are classified before each round of collapses:
+ *  - interior vertices can collapse onto any neighbour;
+ *  - vertices on an open border, or on an attribute seam (e.g. where the
+ *    texture coordinates or normals are discontinuous, which appears as two
+ *    vertices at the same position), only collapse along the border/seam.
+ *    Seam vertices collapse together with their counterpart on the other
+ *    side, so the seam stays closed.
+ *  - vertices shared by more than one material, and vertices with more
+ *    complex topology, are locked.
+ * Collapses that would flip a triangle are rejected.
+ *
+ * The reported error is an estimate of the geometric deviation, in model
+ * units: the RMS distance to the planes of the original triangles around
+ * each collapsed vertex (area weighted), maximized over all collapses.
+ */
+
+struct SimplifyOptions
+{
+	// Stop when this fraction of the triangles remains...
+	float targetRatio = 0.5f;
+	// ...or when the next collapse would exceed this error (model units).
+	float maxError = std::numeric_limits<float>::max();
+};
+
+struct SimplifyResult
+{
+	std::vector<std::uint32_t> indices;
+	std::vector<MeshSubmesh> submeshes; // same materials as the input, into indices
+	float error;
+};
+
+// Simplifies the full-detail level of aMesh (see MeshData::lods). Indices
+// refer to aMesh.vertices.
+SimplifyResult simplify_mesh( MeshData const& aMesh, SimplifyOptions const& = {} );
+
+struct LodChainOptions
+{
+	std::size_t maxLevels = 4; // including the full-detail level
+	float ratio = 0.5f; // triangles kept per level, relative to the previous
+	float maxError = std::numeric_limits<float>::max();
+
+	// Stop early if a level removes less than this fraction of the previous
+	// level's triangles (e.g. because most vertices are locked).
+	float minReduction = 0.1f;
+};
+
+// Appends simplified levels to aMesh (see MeshData::lods). Each level is
+// simplified from the full-detail mesh, targeting ratio^level of its
+// triangles. aMesh must not have LODs yet.
+void build_lod_chain( MeshData& aMesh, LodChainOptions const& = {} );
+
+#endif // MESH_SIMPLIFY_HPP_1D6C8E42_A7F3_4B90_95E1_C24B8F3D7A06
@@ -0,0 +1,413 @@
+#include "terrain.hpp"
+
+#include <limits>
+#include <algorithm>
+
+#include <cmath>
+
+#include "../support/error.hpp"
+
+namespace
+{
+	constexpr float kMissing_ = -std::numeric_limits<float>::infinity();
+
+	// Chunk extents in samples; only needed while building.
+	struct ChunkRange_
+	{
+		std::uint32_t x0, z0, x1, z1;
+		std::uint32_t stride;
+	};
+
+	// Sample coordinates of a chunk's grid lines: aBegin, aBegin+aStride, ...,
+	// always ending with aEnd (the last step may be shorter).
+	std::vector<std::uint32_t> grid_lines_( std::uint32_t aBegin, std::uint32_t aEnd, std::uint32_t aStride )
+	{
+		std::vector<std::uint32_t> ret;
+		for( std::uint32_t i = aBegin; i < aEnd; i += aStride )
+			ret.push_back( i );
+		ret.push_back( aEnd );
+		return ret;
+	}
+
+	// Finds the grid cell containing aSample, and the position within it.
+	void locate_( std::vector<std::uint32_t> const& aLines, std::uint32_t aSample, std::size_t& aCell, float& aT ) noexcept
+	{
+		auto const it = std::upper_bound( aLines.begin(), aLines.end(), aSample );
+		aCell = std::min( std::size_t(it - aLines.begin()), aLines.size()-1 ) - 1;
+		aT = float(aSample - aLines[aCell]) / float(aLines[aCell+1] - aLines[aCell]);
+	}
+
+	// Height of the chunk surface. Quads are split along the (0,0)-(1,1)
+	// diagonal, matching the indices emitted by emit_chunk_().
+	float interpolate_( float aH00, float aH10, float aH01, float aH11, float aU, float aV ) noexcept
+	{
+		if( aU >= aV )
+			return aH00 + aU * (aH10 - aH00) + aV * (aH11 - aH10);
+		return aH00 + aV * (aH01 - aH00) + aU * (aH11 - aH01);
+	}
+
+	float chunk_error_( HeightField const& aField, ChunkRange_ const& aRange )
+	{
+		if( 1 == aRange.stride )
+			return 0.f;
+
+		auto const xs = grid_lines_( aRange.x0, aRange.x1, aRange.stride );
+		auto const zs = grid_lines_( aRange.z0, aRange.z1, aRange.stride );
+
+		float ret = 0.f;
+		for( std::uint32_t z = aRange.z0; z <= aRange.z1; ++z )
+		{
+			std::size_t j;
+			float v;
+			locate_( zs, z, j, v );
+
+			for( std::uint32_t x = aRange.x0; x <= aRange.x1; ++x )
+			{
+				std::size_t i;
+				float u;
+				locate_( xs, x, i, u );
+
+				float const approx = interpolate_(
+					aField.at( xs[i], zs[j] ), aField.at( xs[i+1], zs[j] ),
+					aField.at( xs[i], zs[j+1] ), aField.at( xs[i+1], zs[j+1] ),
+					u, v
+				);
+				ret = std::max( ret, std::abs( aField.at( x, z ) - approx ) );
+			}
+		}
+
+		return ret;
+	}
+
+	std::uint32_t build_node_( HeightField const& aField, std::uint32_t aLevel, std::uint32_t aLevelCount, std::uint32_t aX0, std::uint32_t aZ0, std::uint32_t aChunkQuads, std::vector<TerrainChunk>& aChunks, std::vector<ChunkRange_>& aRanges )
+	{
+		if( aX0 >= aField.width-1 || aZ0 >= aField.depth-1 )
+			return kNoTerrainChunk;
+
+		std::uint32_t const stride = 1u << (aLevelCount-1 - aLevel);
+		std::uint32_t const span = aChunkQuads * stride;
+
+		ChunkRange_ const range{ 
+			aX0, aZ0, 
+			std::min( aX0 + span, aField.width-1 ), 
+			std::min( aZ0 + span, aField.depth-1 ), 
+			stride
+		};
+
+		auto const index = std::uint32_t(aChunks.size());
+		aChunks.emplace_back();
+		aRanges.emplace_back( range );
+
+		TerrainChunk chunk{};
+		chunk.level = aLevel;
+		chunk.geometricError = chunk_error_( aField, range );
+		std::fill_n( chunk.children, 4, kNoTerrainChunk );
+
+		if( aLevel+1 < aLevelCount )
+		{
+			std::uint32_t const half = span / 2;
+			for( std::uint32_t c = 0; c < 4; ++c )
+			{
+				std::uint32_t const child = build_node_( aField, aLevel+1, aLevelCount, aX0 + (c & 1) * half, aZ0 + (c >> 1) * half, aChunkQuads, aChunks, aRanges );
+				chunk.children[c] = child;
+
+				if( kNoTerrainChunk != child )
+					chunk.geometricError = std::max( chunk.geometricError, aChunks[child].geometricError );
+			}
+		}
+
+		aChunks[index] = chunk;
+		return index;
+	}
+
+	Vec3f field_normal_( HeightField const& aField, std::uint32_t aX, std::uint32_t aZ ) noexcept
+	{
+		std::uint32_t const xl = aX > 0 ? aX-1 : aX, xr = std::min( aX+1, aField.width-1 );
+		std::uint32_t const zl = aZ > 0 ? aZ-1 : aZ, zr = std::min( aZ+1, aField.depth-1 );
+
+		float const dhdx = (aField.at( xr, aZ ) - aField.at( xl, aZ )) / (float(xr - xl) * aField.spacingX);
+		float const dhdz = (aField.at( aX, zr ) - aField.at( aX, zl )) / (float(zr - zl) * aField.spacingZ);
+
+		return normalize( Vec3f{ -dhdx, 1.f, -dhdz } );
+	}
+
+	void emit_chunk_( HeightField const& aField, ChunkRange_ const& aRange, float aSkirtDepth, TerrainChunk& aChunk, TerrainData& aOut )
+	{
+		auto const xs = grid_lines_( aRange.x0, aRange.x1, aRange.stride );
+		auto const zs = grid_lines_( aRange.z0, aRange.z1, aRange.stride );
+		std::size_t const nx = xs.size(), nz = zs.size(); // vertices per row/column
+
+		aChunk.baseVertex = std::uint32_t(aOut.vertices.size());
+		aChunk.firstIndex = std::uint32_t(aOut.indices.size());
+		aChunk.bounds = kEmptyAabb3f;
+
+		auto const emit_vertex = [&] (std::uint32_t aX, std::uint32_t aZ, float aDrop) {
+			Vec3f const pos{ 
+				aField.originX + float(aX) * aField.spacingX, 
+				aField.at( aX, aZ ) - aDrop, 
+				aField.originZ + float(aZ) * aField.spacingZ 
+			};
+			Vec2f const uv{ float(aX) / float(aField.width-1), float(aZ) / float(aField.depth-1) };
+
+			aOut.vertices.emplace_back( MeshVertex{ pos, field_normal_( aField, aX, aZ ), uv } );
+			aChunk.bounds = expand( aChunk.bounds, pos );
+		};
+
+		// Grid
+		for( std::size_t j = 0; j < nz; ++j )
+		{
+			for( std::size_t i = 0; i < nx; ++i )
+				emit_vertex( xs[i], zs[j], 0.f );
+		}
+
+		auto const grid = [&] (std::size_t aI, std::size_t aJ) {
+			return std::uint16_t(aJ*nx + aI);
+		};
+
+		for( std::size_t j = 0; j+1 < nz; ++j )
+		{
+			for( std::size_t i = 0; i+1 < nx; ++i )
+			{
+				// Counter-clockwise when seen from above (+y)
+				aOut.indices.insert( aOut.indices.end(), { grid( i, j ), grid( i, j+1 ), grid( i+1, j+1 ) } );
+				aOut.indices.insert( aOut.indices.end(), { grid( i, j ), grid( i+1, j+1 ), grid( i+1, j ) } );
+			}
+		}
+
+		// Skirts. Walk the perimeter such that the skirt triangles face
+		// outwards: +z along the x0 edge, +x along z1, -z along x1 and -x
+		// along z0.
+		std::vector<std::uint16_t> loop;
+		for( std::size_t j = 0; j+1 < nz; ++j )
+			loop.push_back( grid( 0, j ) );
+		for( std::size_t i = 0; i+1 < nx; ++i )
+			loop.push_back( grid( i, nz-1 ) );
+		for( std::size_t j = nz-1; j > 0; --j )
+			loop.push_back( grid( nx-1, j ) );
+		for( std::size_t i = nx-1; i > 0; --i )
+			loop.push_back( grid( i, 0 ) );
+
+		auto const skirtBase = std::uint16_t(nx*nz);
+		for( auto const v : loop )
+			emit_vertex( xs[v % nx], zs[v / nx], aSkirtDepth );
+
+		for( std::size_t k = 0; k < loop.size(); ++k )
+		{
+			std::size_t const l = (k+1) % loop.size();
+			auto const top0 = loop[k], top1 = loop[l];
+			auto const bot0 = std::uint16_t(skirtBase + k), bot1 = std::uint16_t(skirtBase + l);
+
+			aOut.indices.insert( aOut.indices.end(), { top0, bot0, bot1 } );
+			aOut.indices.insert( aOut.indices.end(), { top0, bot1, top1 } );
+		}
+
+		aChunk.vertexCount = std::uint32_t(aOut.vertices.size()) - aChunk.baseVertex;
+		aChunk.indexCount = std::uint32_t(aOut.indices.size()) - aChunk.firstIndex;
+	}
+}
+
+HeightField make_height_field( MeshData const& aMesh, std::uint32_t aResolution )
+{
+	if( aResolution < 2 )
+		throw Error( "make_height_field(): resolution must be at least 2 (got %u)", aResolution );
+	if( aMesh.indices.empty() )
+		throw Error( "make_height_field(): empty mesh" );
+
+	Aabb3f bounds = kEmptyAabb3f;
+	for( auto const& v : aMesh.vertices )
+		bounds = expand( bounds, v.position );
+
+	float const extX = std::max( bounds.max.x - bounds.min.x, 1e-6f );
+	float const extZ = std::max( bounds.max.z - bounds.min.z, 1e-6f );
+	float const longer = std::max( extX, extZ );
+
+	HeightField ret;
+	ret.width = std::max( 2u, std::uint32_t(std::lround( extX / longer * float(aResolution-1) )) + 1 );
+	ret.depth = std::max( 2u, std::uint32_t(std::lround( extZ / longer * float(aResolution-1) )) + 1 );
+	ret.originX = bounds.min.x;
+	ret.originZ = bounds.min.z;
+	ret.spacingX = extX / float(ret.width-1);
+	ret.spacingZ = extZ / float(ret.depth-1);
+	ret.heights.assign( std::size_t(ret.width) * ret.depth, kMissing_ );
+
+	// Rasterize the triangles from above
+	for( std::size_t t = 0; t+2 < aMesh.indices.size(); t += 3 )
+	{
+		Vec3f const p[3] = {
+			aMesh.vertices[aMesh.indices[t+0]].position,
+			aMesh.vertices[aMesh.indices[t+1]].position,
+			aMesh.vertices[aMesh.indices[t+2]].position
+		};
+
+		// Twice the signed area in the xz plane; skip vertical triangles.
+		float const area = (p[1].x - p[0].x) * (p[2].z - p[0].z) - (p[2].x - p[0].x) * (p[1].z - p[0].z);
+		if( std::abs( area ) < 1e-12f )
+			continue;
+
+		float const minX = std::min( { p[0].x, p[1].x, p[2].x } ), maxX = std::max( { p[0].x, p[1].x, p[2].x } );
+		float const minZ = std::min( { p[0].z, p[1].z, p[2].z } ), maxZ = std::max( { p[0].z, p[1].z, p[2].z } );
+
+		auto const first = [] (float aValue, float aOrigin, float aSpacing, std::uint32_t aCount) {
+			return std::uint32_t(std::clamp( std::ceil( (aValue - aOrigin) / aSpacing ), 0.f, float(aCount-1) ));
+		};
+		auto const last = [] (float aValue, float aOrigin, float aSpacing, std::uint32_t aCount) {
+			return std::uint32_t(std::clamp( std::floor( (aValue - aOrigin) / aSpacing ), 0.f, float(aCount-1) ));
+		};
+
+		std::uint32_t const x0 = first( minX, ret.originX, ret.spacingX, ret.width ), x1 = last( maxX, ret.originX, ret.spacingX, ret.width );
+		std::uint32_t const z0 = first( minZ, ret.originZ, ret.spacingZ, ret.depth ), z1 = last( maxZ, ret.originZ, ret.spacingZ, ret.depth );
+
+		// Samples exactly on a shared edge belong to both triangles; a small
+		// tolerance avoids dropping them due to rounding.
+		float const eps = -1e-5f;
+		for( std::uint32_t z = z0; z <= z1; ++z )
+		{
+			float const sz = ret.originZ + float(z) * ret.spacingZ;
+			for( std::uint32_t x = x0; x <= x1; ++x )
+			{
+				float const sx = ret.originX + float(x) * ret.spacingX;
+
+				float const w0 = ((p[1].x - sx) * (p[2].z - sz) - (p[2].x - sx) * (p[1].z - sz)) / area;
+				float const w1 = ((p[2].x - sx) * (p[0].z - sz) - (p[0].x - sx) * (p[2].z - sz)) / area;
+				float const w2 = 1.f - w0 - w1;
+				if( w0 < eps || w1 < eps || w2 < eps )
+					continue;
+
+				float& h = ret.heights[std::size_t(z)*ret.width + x];
+				h = std::max( h, w0 * p[0].y + w1 * p[1].y + w2 * p[2].y );
+			}
+		}
+	}
+
+	// Fill holes by repeatedly averaging the known neighbours.
+	bool missing = true;
+	while( missing )
+	{
+		missing = false;
+		bool progress = false;
+
+		auto next = ret.heights;
+		for( std::uint32_t z = 0; z < ret.depth; ++z )
+		{
+			for( std::uint32_t x = 0; x < ret.width; ++x )
+			{
+				if( kMissing_ != ret.at( x, z ) )
+					continue;
+
+				float sum = 0.f;
+				int count = 0;
+				auto const add = [&] (std::uint32_t aX, std::uint32_t aZ) {
+					float const h = ret.at( aX, aZ );
+					if( kMissing_ != h )
+					{
+						sum += h;
+						++count;
+					}
+				};
+
+				if( x > 0 ) add( x-1, z );
+				if( x+1 < ret.width ) add( x+1, z );
+				if( z > 0 ) add( x, z-1 );
+				if( z+1 < ret.depth ) add( x, z+1 );
+
+				if( count )
+				{
+					next[std::size_t(z)*ret.width + x] = sum / float(count);
+					progress = true;
+				}
+				else
+					missing = true;
+			}
+		}
+
+		ret.heights.swap( next );
+
+		if( missing && !progress )
+			throw Error( "make_height_field(): no triangle covers any sample" );
+	}
+
+	return ret;
+}
+
+TerrainData build_terrain( HeightField const& aField, std::uint32_t aChunkQuads )
+{
+	if( aField.width < 2 || aField.depth < 2 )
+		throw Error( "build_terrain(): height field must be at least 2x2 samples" );
+	// 16-bit indices: (q+1)^2 grid vertices plus 4q skirt vertices
+	if( aChunkQuads < 1 || aChunkQuads > 128 || (aChunkQuads & (aChunkQuads-1)) )
+		throw Error( "build_terrain(): chunk size must be a power of two in [1,128] (got %u)", aChunkQuads );
+
+	TerrainData ret;
+
+	std::uint32_t const span = std::max( aField.width, aField.depth ) - 1;
+	ret.levelCount = 1;
+	while( std::uint64_t(aChunkQuads) << (ret.levelCount-1) < span )
+		++ret.levelCount;
+
+	std::vector<ChunkRange_> ranges;
+	build_node_( aField, 0, ret.levelCount, 0, 0, aChunkQuads, ret.chunks, ranges );
+
+	// Skirts must cover the gap to any neighbour: the two edges deviate from
+	// the true surface by at most the respective errors. select_terrain_
+	// chunks() refines each chunk independently, so a neighbour may be any
+	// number of levels coarser. Errors never decrease towards the root, so
+	// the root's error bounds all of them. A small minimum depth covers the
+	// slivers at T-junctions on flat areas.
+	float const coarsest = ret.chunks.front().geometricError;
+	float const minDepth = 0.25f * std::min( aField.spacingX, aField.spacingZ );
+	for( std::size_t i = 0; i < ret.chunks.size(); ++i )
+	{
+		auto& chunk = ret.chunks[i];
+		emit_chunk_( aField, ranges[i], chunk.geometricError + coarsest + minDepth, chunk, ret );
+
+		ret.bounds = merge( ret.bounds, chunk.bounds );
+	}
+
+	ret.fullResolutionTriangles = std::size_t(aField.width-1) * (aField.depth-1) * 2;
+	return ret;
+}
+
+float terrain_error_scale( float aFovY, float aViewportHeight ) noexcept
+{
+	return aViewportHeight / (2.f * std::tan( 0.5f * aFovY ));
+}
+
+void select_terrain_chunks( TerrainData const& aTerrain, TerrainView const& aView, std::vector<std::uint32_t>& aChunks )
+{
+	if( aTerrain.chunks.empty() )
+		return;
+
+	Vec3f const cam = aView.cameraPosition;
+
+	std::vector<std::uint32_t> stack{ 0 };
+	while( !stack.empty() )
+	{
+		std::uint32_t const index = stack.back();
+		stack.pop_back();
+
+		auto const& chunk = aTerrain.chunks[index];
+		if( aView.frustum && !is_visible( *aView.frustum, chunk.bounds ) )
+			continue;
+
+		// Distance to the closest point of the chunk's bounds
+		float const dx = std::max( { chunk.bounds.min.x - cam.x, 0.f, cam.x - chunk.bounds.max.x } );
+		float const dy = std::max( { chunk.bounds.min.y - cam.y, 0.f, cam.y - chunk.bounds.max.y } );
+		float const dz = std::max( { chunk.bounds.min.z - cam.z, 0.f, cam.z - chunk.bounds.max.z } );
+		float const dist = std::max( std::sqrt( dx*dx + dy*dy + dz*dz ), 1e-4f );
+
+		float const screenError = chunk.geometricError * aView.errorScale / dist;
+
+		bool const leaf = std::all_of( std::begin( chunk.children ), std::end( chunk.children ), [] (std::uint32_t aC) { return kNoTerrainChunk == aC; } );
+		if( leaf || screenError <= aView.maxScreenError )
+		{
+			aChunks.push_back( index );
+			continue;
+		}
+
+		for( auto const child : chunk.children )
+		{
+			if( kNoTerrainChunk != child )
+				stack.push_back( child );
+		}
+	}
+}
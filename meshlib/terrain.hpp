@@ -0,0 +1,128 @@
+#ifndef TERRAIN_HPP_4F8A2C61_D93E_47B5_8E1C_07B6A3D95E28
+#define TERRAIN_HPP_4F8A2C61_D93E_47B5_8E1C_07B6A3D95E28
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mesh.hpp"
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/bounds.hpp"
+#include "../vmlib/frustum.hpp"
+
+/* Chunked quadtree terrain LOD
+ *
+ * Large terrains (e.g. parlahti.obj) are resampled into a regular
+ * HeightField, which is then split into a quadtree of chunks (see
+ * build_terrain()). All chunks have (up to) the same number of quads; the
+ * root covers the whole terrain at a coarse sample spacing, and each level
+ * below halves the spacing, down to the full resolution at the leaves. Each
+ * chunk is thus a precomputed LOD of its region.
+ *
+ * Every chunk stores its geometric error: the largest vertical distance
+ * between its surface and the full-resolution surface (including the error
+ * of its descendants, such that the error never decreases towards the root).
+ * Each frame, select_terrain_chunks() walks the tree and refines a chunk
+ * only if its error, projected to the screen, exceeds a threshold in
+ * pixels. The number of drawn triangles therefore depends on the view and
+ * threshold, not on the size of the data set.
+ *
+ * Neighbouring chunks at different levels do not share all edge vertices,
+ * which leaves small cracks. These are hidden by skirts: vertical strips
+ * hanging down from each chunk's edges, deep enough to reach down to any
+ * coarser neighbour (i.e., by the root's error).
+ */
+
+constexpr std::uint32_t kDefaultTerrainChunkQuads = 32;
+constexpr std::uint32_t kNoTerrainChunk = ~std::uint32_t(0);
+
+/** HeightField: regularly sampled terrain heights
+ *
+ * Sample (x,z) lies at origin + (x * spacingX, heights[z*width+x], z *
+ * spacingZ).
+ */
+struct HeightField
+{
+	std::uint32_t width = 0;
+	std::uint32_t depth = 0;
+
+	float originX = 0.f, originZ = 0.f;
+	float spacingX = 1.f, spacingZ = 1.f;
+
+	std::vector<float> heights;
+
+	float at( std::uint32_t aX, std::uint32_t aZ ) const noexcept
+	{
+		return heights[std::size_t(aZ)*width + aX];
+	}
+};
+
+/** TerrainChunk: node of the terrain quadtree
+ *
+ * Vertices and indices refer into TerrainData. The (16 bit) indices are
+ * relative to baseVertex, see glDrawElementsBaseVertex().
+ */
+struct TerrainChunk
+{
+	Aabb3f bounds; // including skirts
+	float geometricError;
+	std::uint32_t level; // 0 = root
+
+	std::uint32_t baseVertex;
+	std::uint32_t vertexCount;
+	std::uint32_t firstIndex;
+	std::uint32_t indexCount;
+
+	std::uint32_t children[4]; // kNoTerrainChunk for leaves
+};
+
+struct TerrainData
+{
+	std::vector<MeshVertex> vertices;
+	std::vector<std::uint16_t> indices;
+
+	std::vector<TerrainChunk> chunks; // chunks[0] is the root
+	Aabb3f bounds = kEmptyAabb3f;
+
+	std::uint32_t levelCount = 0;
+	std::size_t fullResolutionTriangles = 0; // without chunking/LOD
+};
+
+// Resamples a terrain mesh into a height field with aResolution samples
+// along the longer horizontal axis. The mesh is viewed from above (+y);
+// where several triangles overlap, the highest one wins. Samples that no
+// triangle covers are filled from their neighbours.
+HeightField make_height_field( MeshData const&, std::uint32_t aResolution );
+
+// Builds the quadtree. aChunkQuads (a power of two) is the number of quads
+// along each side of a chunk. The normals are computed from the full-
+// resolution height field for all levels. Texture coordinates map [0,1]^2
+// to the whole terrain (e.g. for an orthophoto).
+TerrainData build_terrain( HeightField const&, std::uint32_t aChunkQuads = kDefaultTerrainChunkQuads );
+
+/** TerrainView: parameters for select_terrain_chunks()
+ *
+ * errorScale converts a world-space error at distance 1 to pixels; see
+ * terrain_error_scale(). Chunks outside of the (optional) frustum are
+ * skipped.
+ */
+struct TerrainView
+{
+	Vec3f cameraPosition;
+	float errorScale;
+	float maxScreenError = 2.f; // pixels
+
+	Frustum const* frustum = nullptr;
+};
+
+// aViewportHeight / (2 tan(aFovY/2)), for a perspective projection with the
+// vertical field of view aFovY (in radians).
+float terrain_error_scale( float aFovY, float aViewportHeight ) noexcept;
+
+// Appends the chunks to draw to aChunks. The selection never includes a
+// chunk together with one of its ancestors.
+void select_terrain_chunks( TerrainData const&, TerrainView const&, std::vector<std::uint32_t>& aChunks );
+
+#endif // TERRAIN_HPP_4F8A2C61_D93E_47B5_8E1C_07B6A3D95E28
@@ -0,0 +1,114 @@
+#include "mesh.hpp"
+
+#include <rapidobj/rapidobj.hpp>
+
+#include "../support/error.hpp"
+
+MeshData load_wavefront_obj( char const* aPath )
+{
+	auto result = rapidobj::ParseFile( aPath );
+	if( result.error )
+		throw Error( "Unable to load OBJ file '%s': %s", aPath, result.error.code.message().c_str() );
+
+	rapidobj::Triangulate( result );
+	if( result.error )
+		throw Error( "Unable to triangulate OBJ file '%s': %s", aPath, result.error.code.message().c_str() );
+
+	auto const& attrib = result.attributes;
+
+	MeshData ret;
+
+	// Materials. Faces without a material use an additional default one.
+	for( auto const& mat : result.materials )
+	{
+		ret.materials.emplace_back( MeshMaterial{
+			mat.name,
+			Vec3f{ mat.ambient[0], mat.ambient[1], mat.ambient[2] },
+			Vec3f{ mat.diffuse[0], mat.diffuse[1], mat.diffuse[2] },
+			Vec3f{ mat.specular[0], mat.specular[1], mat.specular[2] },
+			Vec3f{ mat.emission[0], mat.emission[1], mat.emission[2] },
+			mat.shininess,
+			mat.diffuse_texname
+		} );
+	}
+
+	std::uint32_t const defaultMaterial = std::uint32_t(ret.materials.size());
+
+	// Gather triangles per material. Vertices are not shared between faces;
+	// every face corner becomes a new vertex. (optimize_mesh() takes care of
+	// that.)
+	std::vector<std::vector<MeshVertex>> perMaterial( ret.materials.size()+1 );
+	for( auto const& shape : result.shapes )
+	{
+		auto const& mesh = shape.mesh;
+		for( std::size_t face = 0; face < mesh.num_face_vertices.size(); ++face )
+		{
+			auto const matId = face < mesh.material_ids.size() ? mesh.material_ids[face] : -1;
+			auto& out = perMaterial[matId >= 0 ? std::size_t(matId) : defaultMaterial];
+
+			for( std::size_t j = 0; j < 3; ++j )
+			{
+				auto const& idx = mesh.indices[face*3+j];
+
+				MeshVertex v{};
+				v.position = Vec3f{
+					attrib.positions[idx.position_index*3+0],
+					attrib.positions[idx.position_index*3+1],
+					attrib.positions[idx.position_index*3+2]
+				};
+
+				if( idx.normal_index >= 0 )
+				{
+					v.normal = Vec3f{
+						attrib.normals[idx.normal_index*3+0],
+						attrib.normals[idx.normal_index*3+1],
+						attrib.normals[idx.normal_index*3+2]
+					};
+				}
+
+				if( idx.texcoord_index >= 0 )
+				{
+					v.texcoord = Vec2f{
+						attrib.texcoords[idx.texcoord_index*2+0],
+						attrib.texcoords[idx.texcoord_index*2+1]
+					};
+				}
+
+				ret.bounds = expand( ret.bounds, v.position );
+				out.emplace_back( v );
+			}
+		}
+	}
+
+	if( !perMaterial[defaultMaterial].empty() )
+	{
+		ret.materials.emplace_back( MeshMaterial{
+			"default",
+			Vec3f{ 0.8f, 0.8f, 0.8f },
+			Vec3f{ 0.8f, 0.8f, 0.8f },
+			Vec3f{ 0.f, 0.f, 0.f },
+			Vec3f{ 0.f, 0.f, 0.f },
+			1.f,
+			{}
+		} );
+	}
+
+	// Flatten
+	for( std::size_t m = 0; m < perMaterial.size(); ++m )
+	{
+		auto const& verts = perMaterial[m];
+		if( verts.empty() )
+			continue;
+
+		auto const first = std::uint32_t(ret.indices.size());
+		for( auto const& v : verts )
+		{
+			ret.indices.emplace_back( std::uint32_t(ret.vertices.size()) );
+			ret.vertices.emplace_back( v );
+		}
+
+		ret.submeshes.emplace_back( MeshSubmesh{ first, std::uint32_t(verts.size()), std::uint32_t(m) } );
+	}
+
+	return ret;
+}
@@ -84,6 +84,8 @@ project "main"
 
 	files( sources )
 
+	links "texlib"
+	links "meshlib"
 	links "vmlib"
 	links "support"
 
@@ -100,7 +102,8 @@ project "main-shaders"
 		"assets/*.geom",
 		"assets/*.tesc",
 		"assets/*.tese",
-		"assets/*.comp"
+		"assets/*.comp",
+		"assets/*.glsl"
 	}
 
 	kind "Utility"
@@ -134,7 +137,85 @@ project "vmlib"
 
 	files( sources )
 
+project "meshlib"
+	-- Mesh loading and processing. Kept free of OpenGL, such that the offline
+	-- tools (e.g. meshconv) can use it.
+	local sources = { 
+		"meshlib/**.cpp",
+		"meshlib/**.hpp",
+		"meshlib/**.hxx",
+		"meshlib/**.inl"
+	}
+
+	kind "StaticLib"
+	location "meshlib"
+
+	files( sources )
+
+project "meshconv"
+	-- Converts OBJ files to the binary mesh cache, e.g.:
+	--   bin/meshconv-release-x64-gcc.exe assets/landingpad.obj
+	local sources = { 
+		"meshconv/**.cpp",
+		"meshconv/**.hpp",
+		"meshconv/**.hxx",
+		"meshconv/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "meshconv"
+
+	files( sources )
+
+	links "meshlib"
+	links "vmlib"
+	links "support"
+
+	files( sources )
+
+project "texlib"
+	-- Texture baking: sRGB-correct mip chains, block compression and the
+	-- texture cache. Like meshlib, kept free of OpenGL. Uses meshlib's
+	-- MappedFile and FileDependency.
+	local sources = { 
+		"texlib/**.cpp",
+		"texlib/**.hpp",
+		"texlib/**.hxx",
+		"texlib/**.inl"
+	}
+
+	kind "StaticLib"
+	location "texlib"
+
+	files( sources )
+
+project "texbake"
+	-- Converts images to the texture cache format, e.g.:
+	--   bin/texbake-release-x64-gcc.exe --format bc7 assets/white.png
+	local sources = { 
+		"texbake/**.cpp",
+		"texbake/**.hpp",
+		"texbake/**.hxx",
+		"texbake/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "texbake"
+
+	files( sources )
+
+	links "texlib"
+	links "meshlib"
+	links "vmlib"
+	links "support"
+
+	links "x-stb"
+
+	files( sources )
+
 project "vmlib-test"
+	-- Unit tests (Catch2). Despite the name, this also covers meshlib and
+	-- texlib, which are linked in; there are no separate test projects.
 	local sources = { 
 		"vmlib-test/**.cpp",
 		"vmlib-test/**.hpp",
@@ -147,9 +228,41 @@ project "vmlib-test"
 
 	files( sources )
 
+	links "texlib"
+	links "meshlib"
+	links "vmlib"
+	links "support"
+	links "x-stb"
+	links "x-catch2"
+
+	files( sources )
+
+project "vmlib-bench"
+	-- Micro-benchmarks for vmlib, and for meshlib and texlib (both linked in),
+	-- using Catch2's BENCHMARK facility. Build the release configuration and
+	-- use Catch2's XML reporter for machine-readable results, e.g.:
+	--   bin/vmlib-bench-release-x64-gcc.exe --reporter XML --out vmlib-bench.xml
+	local sources = { 
+		"vmlib-bench/**.cpp",
+		"vmlib-bench/**.hpp",
+		"vmlib-bench/**.hxx",
+		"vmlib-bench/**.inl"
+	}
+
+	kind "ConsoleApp"
+	location "vmlib-bench"
+
+	files( sources )
+
+	links "texlib"
+	links "meshlib"
 	links "vmlib"
+	links "support"
+	links "x-stb"
 	links "x-catch2"
 
+	debugargs { "--reporter", "XML", "--out", "vmlib-bench.xml" }
+
 	files( sources )
 
 --EOF
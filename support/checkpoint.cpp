@@ -2,6 +2,8 @@
 
 #include <glad.h>
 
+#include <cstdio>
+
 #include "error.hpp"
 
 namespace
@@ -23,6 +25,15 @@ namespace
 
 		return "<unknown error value>";
 	}
+
+	// GL keeps one flag per error type, so a few calls to glGetError() drain
+	// them. The limit protects against drivers that keep returning errors
+	// (e.g., after the context was lost).
+	constexpr std::size_t kMaxErrorsPerFlush_ = 16;
+
+	detail::CheckpointSite* gSites_ = nullptr;
+	std::uint64_t gFlushes_ = 0;
+	std::uint64_t gUnattributed_ = 0;
 }
 
 namespace detail
@@ -35,4 +46,80 @@ namespace detail
 			throw Error( "(%s:%d) glGetError() returned %s (%d)", aSourceFile, aSourceLine, error_string_(res), res );
 		}
 	}
+
+	CheckpointSite* gFirstCheckpoint = nullptr;
+	CheckpointSite* gLastCheckpoint = nullptr;
+
+	CheckpointSite::CheckpointSite( char const* aFile, int aLine ) noexcept
+		: file( aFile )
+		, line( aLine )
+		, next( gSites_ )
+	{
+		gSites_ = this;
+	}
+
+	CheckpointSite const* last_gl_checkpoint() noexcept
+	{
+		return gLastCheckpoint;
+	}
+}
+
+
+std::size_t flush_gl_checkpoints()
+{
+	std::size_t errors = 0;
+	for( ; errors < kMaxErrorsPerFlush_; ++errors )
+	{
+		auto const res = glGetError();
+		if( GL_NO_ERROR == res )
+			break;
+
+		auto* const site = detail::gFirstCheckpoint ? detail::gLastCheckpoint : nullptr;
+		if( !site )
+		{
+			if( 0 == gUnattributed_++ )
+				std::fprintf( stderr, "Note: glGetError() returned %s (%d) before any deferred checkpoint was reached\n", error_string_(res), res );
+			continue;
+		}
+
+		if( 0 == site->errors++ )
+		{
+			site->firstError = res;
+			site->firstErrorFrame = gFlushes_;
+			site->firstErrorFrom = detail::gFirstCheckpoint;
+
+			std::fprintf( stderr, "Note: (%s:%d) glGetError() returned %s (%d) in frame %llu; checkpoints reached since %s:%d\n",
+				site->file, site->line,
+				error_string_(res), res,
+				static_cast<unsigned long long>(gFlushes_),
+				detail::gFirstCheckpoint->file, detail::gFirstCheckpoint->line
+			);
+		}
+	}
+
+	detail::gFirstCheckpoint = nullptr;
+	++gFlushes_;
+
+	return errors;
+}
+
+void print_gl_checkpoint_stats( std::FILE* aOut )
+{
+	std::fprintf( aOut, "Checkpoints after %llu flush(es):\n", static_cast<unsigned long long>(gFlushes_) );
+	for( auto const* site = gSites_; site; site = site->next )
+	{
+		std::fprintf( aOut, "  %s:%d: %llu hit(s), %llu error(s)", site->file, site->line, static_cast<unsigned long long>(site->hits), static_cast<unsigned long long>(site->errors) );
+		if( site->errors )
+		{
+			std::fprintf( aOut, ", first %s (%u) in frame %llu since %s:%d",
+				error_string_(site->firstError), site->firstError,
+				static_cast<unsigned long long>(site->firstErrorFrame),
+				site->firstErrorFrom->file, site->firstErrorFrom->line
+			);
+		}
+		std::fprintf( aOut, "\n" );
+	}
+
+	if( gUnattributed_ )
+		std::fprintf( aOut, "  %llu unattributed error(s)\n", static_cast<unsigned long long>(gUnattributed_) );
 }
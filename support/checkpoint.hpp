@@ -1,21 +1,97 @@
 #ifndef CHECKPOINT_HPP_3DFDA796_469C_4D37_B904_1C8D8FAE207B
 #define CHECKPOINT_HPP_3DFDA796_469C_4D37_B904_1C8D8FAE207B
 
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+/* OpenGL error checkpoints
+ *
+ * OGL_CHECKPOINT_ALWAYS() calls glGetError() and throws an Error if GL has
+ * recorded an error. glGetError() forces the CPU to wait for the driver, so
+ * these are best kept out of per-frame code.
+ *
+ * OGL_CHECKPOINT_DEFERRED() only records that the call site was reached
+ * (a counter increment). Errors are collected by flush_gl_checkpoints(),
+ * which should be called once per frame. GL only keeps an error flag, so
+ * the flush knows that some call since the previous flush failed, but not
+ * which. The error is counted against the last deferred checkpoint reached
+ * before the flush, and reported together with the first checkpoint
+ * reached in that interval. In debug builds, the GL debug callback reports
+ * the most recently reached checkpoint with each error as it happens (see
+ * debug_output.cpp).
+ *
+ * OGL_CHECKPOINT_DEBUG() is immediate in debug builds and deferred in
+ * release builds. Define OGL_CHECKPOINT_DEFER to make it deferred in debug
+ * builds as well (the debug callback then provides the exact location).
+ */
 #define OGL_CHECKPOINT_ALWAYS() do {                                \
 		::detail::check_gl_error( __FILE__, __LINE__ );             \
 	} while(0)                                                      \
 	/*ENDM*/
 
-#if defined(NDEBUG)
-#	define OGL_CHECKPOINT_DEBUG()   do {} while(0)
+#define OGL_CHECKPOINT_DEFERRED() do {                              \
+		static ::detail::CheckpointSite checkpointSite_( __FILE__, __LINE__ ); \
+		::detail::reach_gl_checkpoint( checkpointSite_ );           \
+	} while(0)                                                      \
+	/*ENDM*/
+
+#if defined(NDEBUG) || defined(OGL_CHECKPOINT_DEFER)
+#	define OGL_CHECKPOINT_DEBUG()   OGL_CHECKPOINT_DEFERRED()
 #else
 #	define OGL_CHECKPOINT_DEBUG()   OGL_CHECKPOINT_ALWAYS()
 #endif
 
+// Collects pending GL errors and attributes them to the deferred checkpoints
+// reached since the previous flush. Reports each site's first failure on
+// stderr; errors do not throw. Returns the number of errors collected.
+std::size_t flush_gl_checkpoints();
+
+// Per-site hit and error counts for all deferred checkpoints reached so far.
+void print_gl_checkpoint_stats( std::FILE* );
+
 namespace detail
 {
 	void check_gl_error( char const*, int );
+
+	struct CheckpointSite
+	{
+		CheckpointSite( char const* aFile, int aLine ) noexcept;
+
+		CheckpointSite( CheckpointSite const& ) = delete;
+		CheckpointSite& operator= (CheckpointSite const&) = delete;
+
+		char const* file;
+		int line;
+
+		std::uint64_t hits = 0;
+		std::uint64_t errors = 0;
+
+		// First failure: error code, frame (number of flushes before it)
+		// and the first checkpoint reached in that frame.
+		unsigned firstError = 0;
+		std::uint64_t firstErrorFrame = 0;
+		CheckpointSite const* firstErrorFrom = nullptr;
+
+		CheckpointSite* next; // all sites, see CheckpointSite()
+	};
+
+	// First and last checkpoint reached since the last flush
+	extern CheckpointSite* gFirstCheckpoint;
+	extern CheckpointSite* gLastCheckpoint;
+
+	inline
+	void reach_gl_checkpoint( CheckpointSite& aSite ) noexcept
+	{
+		++aSite.hits;
+		if( !gFirstCheckpoint )
+			gFirstCheckpoint = &aSite;
+		gLastCheckpoint = &aSite;
+	}
+
+	// Most recently reached deferred checkpoint (possibly before the last
+	// flush), or null
+	CheckpointSite const* last_gl_checkpoint() noexcept;
 }
 
 #endif // CHECKPOINT_HPP_3DFDA796_469C_4D37_B904_1C8D8FAE207B
-
@@ -1,7 +1,15 @@
 #include "debug_output.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
 #include <cstdio>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 
 #include <glad.h>
 #include <GLFW/glfw3.h>
@@ -14,10 +22,154 @@ namespace
 	// Debug callback
 #	if !defined(NDEBUG)
 	void GLAPIENTRY callback_gldebug_( GLenum, GLenum, GLuint, GLenum, GLsizei, GLchar const*, void const* );
+	void GLAPIENTRY callback_gldebug_async_( GLenum, GLenum, GLuint, GLenum, GLsizei, GLchar const*, void const* );
+
+	class AsyncLogger_;
+	AsyncLogger_* gAsyncLogger_ = nullptr;
+#	endif // ~ !NDEBUG
+}
+
+namespace
+{
+#	if !defined(NDEBUG)
+	// Bounded multi-producer queue (D. Vyukov's bounded MPMC queue, used with
+	// a single consumer). The driver may call the callback from several
+	// threads in asynchronous mode. Pushing never blocks; it fails if the
+	// queue is full.
+	class MessageQueue_ final
+	{
+		public:
+			static constexpr std::size_t kCapacity = 1024; // power of two
+			static constexpr std::size_t kMaxLength = 480; // incl. terminator
+
+			struct Message
+			{
+				GLenum source, type, severity;
+				GLuint id;
+				char text[kMaxLength];
+			};
+
+		public:
+			MessageQueue_() noexcept
+			{
+				for( std::size_t i = 0; i < kCapacity; ++i )
+					mSlots[i].sequence.store( i, std::memory_order_relaxed );
+			}
+
+			bool push( GLenum aSource, GLenum aType, GLuint aId, GLenum aSeverity, GLsizei aLength, GLchar const* aMessage ) noexcept
+			{
+				std::size_t pos = mTail.load( std::memory_order_relaxed );
+				Slot_* slot;
+				for( ;; )
+				{
+					slot = &mSlots[pos % kCapacity];
+					std::size_t const seq = slot->sequence.load( std::memory_order_acquire );
+					auto const diff = std::intptr_t(seq) - std::intptr_t(pos);
+					if( 0 == diff )
+					{
+						if( mTail.compare_exchange_weak( pos, pos+1, std::memory_order_relaxed ) )
+							break;
+					}
+					else if( diff < 0 )
+					{
+						return false; // full
+					}
+					else
+					{
+						pos = mTail.load( std::memory_order_relaxed );
+					}
+				}
+
+				auto& msg = slot->message;
+				msg.source = aSource;
+				msg.type = aType;
+				msg.id = aId;
+				msg.severity = aSeverity;
+
+				// aLength may be negative (null-terminated message)
+				std::size_t len = aLength >= 0 ? std::size_t(aLength) : std::strlen( aMessage );
+				if( len >= kMaxLength )
+					len = kMaxLength-1;
+				std::memcpy( msg.text, aMessage, len );
+				msg.text[len] = '\0';
+
+				slot->sequence.store( pos+1, std::memory_order_release );
+				return true;
+			}
+
+			bool pop( Message& aMessage ) noexcept
+			{
+				auto& slot = mSlots[mHead % kCapacity];
+				if( slot.sequence.load( std::memory_order_acquire ) != mHead+1 )
+					return false;
+
+				aMessage = slot.message;
+				slot.sequence.store( mHead + kCapacity, std::memory_order_release );
+				++mHead;
+				return true;
+			}
+
+		private:
+			struct Slot_
+			{
+				std::atomic<std::size_t> sequence;
+				Message message;
+			};
+
+			Slot_ mSlots[kCapacity];
+			alignas(64) std::atomic<std::size_t> mTail{ 0 };
+			alignas(64) std::size_t mHead = 0; // consumer only
+	};
+
+	class AsyncLogger_ final
+	{
+		public:
+			explicit AsyncLogger_( unsigned aMaxLinesPerSecond );
+			~AsyncLogger_();
+
+			AsyncLogger_( AsyncLogger_ const& ) = delete;
+			AsyncLogger_& operator= (AsyncLogger_ const&) = delete;
+
+		public:
+			void push( GLenum, GLenum, GLuint, GLenum, GLsizei, GLchar const* ) noexcept;
+
+		private:
+			void run_();
+			void drain_();
+			void summarize_();
+
+			struct Entry_
+			{
+				std::size_t total = 0;
+				std::size_t repeats = 0; // since the last summary
+
+				// Messages held back by the rate limit keep their text until
+				// a later summary has room to print it.
+				bool printed = false;
+				GLenum severity = 0;
+				std::string text;
+			};
+
+			MessageQueue_ mQueue;
+			std::atomic<std::size_t> mDropped{ 0 };
+			std::atomic<bool> mRunning{ true };
+
+			// Logger thread only
+			std::unordered_map<std::uint64_t,Entry_> mEntries;
+			unsigned mMaxLines;
+			unsigned mLines = 0; // since the last summary
+			std::size_t mLimited = 0; // entries waiting to be printed
+			std::size_t mReportedDrops = 0;
+
+			std::thread mThread;
+	};
+
+	char const* type_str_( GLenum ) noexcept;
+	char const* severity_str_( GLenum ) noexcept;
 #	endif // ~ !NDEBUG
 }
 
-void setup_gl_debug_output()
+void setup_gl_debug_output( GLDebugOptions const& aOptions )
 {
 #	if !defined(NDEBUG)
 	OGL_CHECKPOINT_ALWAYS();
@@ -26,18 +178,52 @@ void setup_gl_debug_output()
 	// Apple. The extension (ARB_debug_output), which predates standardization
 	// doesn't seem to exist on Apple either.
 #	if !defined(__APPLE__)
-	glDebugMessageCallback( &callback_gldebug_, nullptr );
-	glEnable( GL_DEBUG_OUTPUT );
+	for( auto const& filter : aOptions.disabled )
+		glDebugMessageControl( filter.source, filter.type, filter.severity, 0, nullptr, GL_FALSE );
+
+	if( aOptions.asynchronous )
+	{
+		if( !gAsyncLogger_ )
+			gAsyncLogger_ = new AsyncLogger_( aOptions.maxLinesPerSecond );
+
+		glDebugMessageCallback( &callback_gldebug_async_, gAsyncLogger_ );
+		glEnable( GL_DEBUG_OUTPUT );
+		glDisable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+	}
+	else
+	{
+		glDebugMessageCallback( &callback_gldebug_, nullptr );
+		glEnable( GL_DEBUG_OUTPUT );
 
-	// Make sure the callback is called synchronously and from the same thread.
-	// This makes the debugger more useful.
-	glEnable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+		// Make sure the callback is called synchronously and from the same
+		// thread. This makes the debugger more useful.
+		glEnable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+	}
 #	endif // ~ __APPLE__
 
 	OGL_CHECKPOINT_ALWAYS();
+#	else // NDEBUG
+	(void)aOptions;
 #	endif // ~ !NDEBUG
 }
 
+void shutdown_gl_debug_output()
+{
+#	if !defined(NDEBUG) && !defined(__APPLE__)
+	glDisable( GL_DEBUG_OUTPUT );
+	glDebugMessageCallback( nullptr, nullptr );
+
+	// In asynchronous mode, messages for earlier commands may still be on
+	// their way from the driver's threads. Let the driver finish those
+	// commands before the logger goes away.
+	if( gAsyncLogger_ )
+		glFinish();
+
+	delete gAsyncLogger_;
+	gAsyncLogger_ = nullptr;
+#	endif // ~ !NDEBUG && !__APPLE__
+}
+
 namespace
 {
 #	if !defined(NDEBUG)
@@ -73,19 +259,145 @@ namespace
 
 	void GLAPIENTRY callback_gldebug_( GLenum, GLenum aType, GLuint, GLenum aSeverity, GLsizei, GLchar const* aMessage, void const* /*aUser*/ )
 	{
-		// "Other" can be a bit spammy at times. However, it can include fairly
-		// interesting information on e.g. NVIDIA (such as in what memory VBOs
-		// are placed, or when shaders are being recompiled). Comment these two
-		// lines if you want to see this:
-		if( GL_DEBUG_TYPE_OTHER == aType )
-			return;
-
 		std::fprintf( stderr, "OpenGL Debug: %s [%s]: %s\n", severity_str_(aSeverity), type_str_(aType), aMessage );
 
+		// The callback is synchronous, so the most recently reached deferred
+		// checkpoint precedes the failing call.
+		if( GL_DEBUG_TYPE_ERROR == aType )
+		{
+			if( auto const* site = detail::last_gl_checkpoint() )
+				std::fprintf( stderr, "  after checkpoint %s:%d\n", site->file, site->line );
+		}
+
 		// For high severity errors, break into the debugger now.
 		if( GL_DEBUG_SEVERITY_HIGH == aSeverity )
 			assert( false );
 	}
+
+	void GLAPIENTRY callback_gldebug_async_( GLenum aSource, GLenum aType, GLuint aId, GLenum aSeverity, GLsizei aLength, GLchar const* aMessage, void const* aUser )
+	{
+		auto* logger = static_cast<AsyncLogger_*>(const_cast<void*>(aUser));
+		logger->push( aSource, aType, aId, aSeverity, aLength, aMessage );
+	}
+
+
+	AsyncLogger_::AsyncLogger_( unsigned aMaxLinesPerSecond )
+		: mMaxLines( aMaxLinesPerSecond )
+	{
+		// Start the thread last, once everything it uses exists.
+		mThread = std::thread( [this] { run_(); } );
+	}
+
+	AsyncLogger_::~AsyncLogger_()
+	{
+		mRunning.store( false, std::memory_order_relaxed );
+		mThread.join();
+	}
+
+	void AsyncLogger_::push( GLenum aSource, GLenum aType, GLuint aId, GLenum aSeverity, GLsizei aLength, GLchar const* aMessage ) noexcept
+	{
+		if( !mQueue.push( aSource, aType, aId, aSeverity, aLength, aMessage ) )
+			mDropped.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	void AsyncLogger_::run_()
+	{
+		using namespace std::chrono_literals;
+		constexpr auto kPollInterval = 10ms;
+		constexpr auto kSummaryInterval = 1s;
+
+		auto lastSummary = std::chrono::steady_clock::now();
+		while( mRunning.load( std::memory_order_relaxed ) )
+		{
+			drain_();
+
+			auto const now = std::chrono::steady_clock::now();
+			if( now - lastSummary >= kSummaryInterval )
+			{
+				summarize_();
+				lastSummary = now;
+			}
+
+			std::this_thread::sleep_for( kPollInterval );
+		}
+
+		drain_();
+		summarize_();
+	}
+
+	void AsyncLogger_::drain_()
+	{
+		MessageQueue_::Message msg;
+		while( mQueue.pop( msg ) )
+		{
+			auto const key = (std::uint64_t(msg.source & 0xffff) << 48)
+				| (std::uint64_t(msg.type & 0xffff) << 32)
+				| std::uint64_t(msg.id)
+			;
+
+			auto& entry = mEntries[key];
+			++entry.total;
+
+			if( entry.printed )
+			{
+				++entry.repeats;
+				continue;
+			}
+
+			if( !entry.text.empty() )
+				continue; // already waiting for the next summary
+
+			if( mLines >= mMaxLines )
+			{
+				entry.severity = msg.severity;
+				entry.text = msg.text;
+				++mLimited;
+				continue;
+			}
+
+			++mLines;
+			entry.printed = true;
+			std::fprintf( stderr, "OpenGL Debug: %s [%s] (id %u): %s\n", severity_str_(msg.severity), type_str_(msg.type), msg.id, msg.text );
+		}
+	}
+
+	void AsyncLogger_::summarize_()
+	{
+		mLines = 0;
+
+		for( auto& [key, entry] : mEntries )
+		{
+			auto const type = GLenum((key >> 32) & 0xffff);
+			auto const id = unsigned(key & 0xffffffffu);
+
+			if( !entry.printed && !entry.text.empty() && mLines < mMaxLines )
+			{
+				++mLines;
+				std::fprintf( stderr, "OpenGL Debug: %s [%s] (id %u, delayed, %zu time(s)): %s\n", severity_str_(entry.severity), type_str_(type), id, entry.total, entry.text.c_str() );
+
+				entry.printed = true;
+				entry.repeats = 0;
+				std::string().swap( entry.text );
+				--mLimited;
+				continue;
+			}
+
+			if( 0 == entry.repeats )
+				continue;
+
+			std::fprintf( stderr, "OpenGL Debug: [%s] (id %u) repeated %zu time(s), %zu total\n", type_str_(type), id, entry.repeats, entry.total );
+			entry.repeats = 0;
+		}
+
+		if( mLimited )
+			std::fprintf( stderr, "OpenGL Debug: %zu new message(s) delayed (more than %u per second)\n", mLimited, mMaxLines );
+
+		auto const dropped = mDropped.load( std::memory_order_relaxed );
+		if( dropped != mReportedDrops )
+		{
+			std::fprintf( stderr, "OpenGL Debug: %zu message(s) dropped (queue full)\n", dropped - mReportedDrops );
+			mReportedDrops = dropped;
+		}
+	}
 #	endif // ~ !NDEBUG
 }
-
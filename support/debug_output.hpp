@@ -1,6 +1,48 @@
 #ifndef DEBUG_OUTPUT_HPP_91C7C3DF_B7F1_4025_B682_2456DFD7C05D
 #define DEBUG_OUTPUT_HPP_91C7C3DF_B7F1_4025_B682_2456DFD7C05D
 
-void setup_gl_debug_output();
+#include <glad.h>
+
+#include <vector>
+
+// Messages to disable, see glDebugMessageControl(). GL_DONT_CARE matches
+// any value.
+struct GLDebugFilter
+{
+	GLenum source = GL_DONT_CARE;
+	GLenum type = GL_DONT_CARE;
+	GLenum severity = GL_DONT_CARE;
+};
+
+struct GLDebugOptions
+{
+	// Synchronous output (the default) prints each message from within the
+	// driver's callback, on the thread that made the failing call. This
+	// makes the debugger more useful (high severity messages break there).
+	//
+	// Asynchronous output lets the driver report messages whenever it
+	// likes. The callback only pushes messages into a lock-free queue (and
+	// drops them if the queue is full); a logger thread prints them. Each
+	// message (source, type and ID) is printed once; repeats are counted
+	// and summarized periodically. At most maxLinesPerSecond new messages
+	// are printed per second. The callback never blocks, so this is usable
+	// for long runs where timings matter.
+	bool asynchronous = false;
+	unsigned maxLinesPerSecond = 20;
+
+	// "Other" can be a bit spammy at times. However, it can include fairly
+	// interesting information on e.g. NVIDIA (such as in what memory VBOs
+	// are placed, or when shaders are being recompiled). Remove this filter
+	// if you want to see this.
+	std::vector<GLDebugFilter> disabled = {
+		GLDebugFilter{ GL_DONT_CARE, GL_DEBUG_TYPE_OTHER, GL_DONT_CARE }
+	};
+};
+
+void setup_gl_debug_output( GLDebugOptions const& = GLDebugOptions{} );
+
+// Unregisters the callback and, in asynchronous mode, stops the logger thread
+// after printing the remaining messages. Requires the context to be current.
+void shutdown_gl_debug_output();
 
 #endif // DEBUG_OUTPUT_HPP_91C7C3DF_B7F1_4025_B682_2456DFD7C05D
@@ -0,0 +1,94 @@
+#include "file_watcher.hpp"
+
+#include <utility>
+#include <algorithm>
+
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#	include <unistd.h>
+#	include <sys/inotify.h>
+#endif
+
+#include "error.hpp"
+
+#if defined(__linux__)
+FileWatcher::FileWatcher( std::string aDirectory )
+	: mDirectory( std::move(aDirectory) )
+	, mFd( inotify_init1( IN_NONBLOCK | IN_CLOEXEC ) )
+{
+	if( -1 == mFd )
+		throw Error( "FileWatcher: inotify_init1() failed: %s", std::strerror( errno ) );
+
+	// The watch is removed together with the inotify instance.
+	if( -1 == inotify_add_watch( mFd, mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO ) )
+	{
+		int const err = errno;
+		close( mFd );
+		throw Error( "FileWatcher: unable to watch '%s': %s", mDirectory.c_str(), std::strerror( err ) );
+	}
+}
+
+FileWatcher::~FileWatcher()
+{
+	if( -1 != mFd )
+		close( mFd );
+}
+
+std::vector<std::string> FileWatcher::poll()
+{
+	std::vector<std::string> ret;
+
+	alignas(inotify_event) char buffer[4096];
+	for( ;; )
+	{
+		auto const len = read( mFd, buffer, sizeof(buffer) );
+		if( len <= 0 )
+			break; // EAGAIN: no (more) events
+
+		for( char const* ptr = buffer; ptr < buffer + len; )
+		{
+			auto const* event = reinterpret_cast<inotify_event const*>(ptr);
+			if( event->len && !(event->mask & IN_ISDIR) )
+			{
+				std::string path = mDirectory + "/" + event->name;
+				if( ret.end() == std::find( ret.begin(), ret.end(), path ) )
+					ret.emplace_back( std::move(path) );
+			}
+
+			ptr += sizeof(inotify_event) + event->len;
+		}
+	}
+
+	return ret;
+}
+#else // !__linux__
+FileWatcher::FileWatcher( std::string aDirectory )
+	: mDirectory( std::move(aDirectory) )
+	, mFd( -1 )
+{}
+
+FileWatcher::~FileWatcher() = default;
+
+std::vector<std::string> FileWatcher::poll()
+{
+	return {};
+}
+#endif // ~ __linux__
+
+FileWatcher::FileWatcher( FileWatcher&& aOther ) noexcept
+	: mDirectory( std::move(aOther.mDirectory) )
+	, mFd( std::exchange( aOther.mFd, -1 ) )
+{}
+FileWatcher& FileWatcher::operator= (FileWatcher&& aOther) noexcept
+{
+	std::swap( mDirectory, aOther.mDirectory );
+	std::swap( mFd, aOther.mFd );
+	return *this;
+}
+
+std::string const& FileWatcher::directory() const noexcept
+{
+	return mDirectory;
+}
@@ -0,0 +1,44 @@
+#ifndef FILE_WATCHER_HPP_BB8CB3CB_30D1_4D76_B448_920EEBE4A71D
+#define FILE_WATCHER_HPP_BB8CB3CB_30D1_4D76_B448_920EEBE4A71D
+
+#include <string>
+#include <vector>
+
+/** FileWatcher: reports files that were modified in a directory
+ *
+ * Used to reload assets (e.g. shaders) while the program is running. On
+ * Linux, this uses inotify. Files count as modified when they are closed
+ * after writing, or when they are moved into the directory (editors often
+ * save by writing a temporary file and renaming it). Subdirectories are not
+ * watched.
+ *
+ * On other platforms, FileWatcher does nothing; poll() never reports any
+ * changes.
+ */
+class FileWatcher final
+{
+	public:
+		// Throws an Error if the directory cannot be watched.
+		explicit FileWatcher( std::string aDirectory );
+
+		~FileWatcher();
+
+		FileWatcher( FileWatcher const& ) = delete;
+		FileWatcher& operator= (FileWatcher const&) = delete;
+
+		FileWatcher( FileWatcher&& ) noexcept;
+		FileWatcher& operator= (FileWatcher&&) noexcept;
+
+	public:
+		// Returns the paths ("<directory>/<name>") of the files that were
+		// modified since the last call, without duplicates. Never blocks.
+		std::vector<std::string> poll();
+
+		std::string const& directory() const noexcept;
+
+	private:
+		std::string mDirectory;
+		int mFd; // inotify instance, or -1
+};
+
+#endif // FILE_WATCHER_HPP_BB8CB3CB_30D1_4D76_B448_920EEBE4A71D
@@ -0,0 +1,249 @@
+#include "gl_state.hpp"
+
+#include "error.hpp"
+
+namespace
+{
+	constexpr GLuint kUnknown_ = ~GLuint(0);
+
+	// Tracked capabilities. Others are passed through.
+	constexpr GLenum kCaps_[] = {
+		GL_BLEND,
+		GL_CULL_FACE,
+		GL_DEPTH_TEST,
+		GL_FRAMEBUFFER_SRGB,
+		GL_POLYGON_OFFSET_FILL,
+		GL_PRIMITIVE_RESTART,
+		GL_SCISSOR_TEST,
+		GL_STENCIL_TEST
+	};
+
+	std::size_t cap_index_( GLenum aCap ) noexcept
+	{
+		std::size_t i = 0;
+		for( ; i < sizeof(kCaps_)/sizeof(kCaps_[0]); ++i )
+		{
+			if( kCaps_[i] == aCap )
+				break;
+		}
+		return i;
+	}
+
+	// Binding query for texture targets that verify() knows about, or 0
+	GLenum texture_binding_( GLenum aTarget ) noexcept
+	{
+		switch( aTarget )
+		{
+			case GL_TEXTURE_1D: return GL_TEXTURE_BINDING_1D;
+			case GL_TEXTURE_2D: return GL_TEXTURE_BINDING_2D;
+			case GL_TEXTURE_3D: return GL_TEXTURE_BINDING_3D;
+			case GL_TEXTURE_2D_ARRAY: return GL_TEXTURE_BINDING_2D_ARRAY;
+			case GL_TEXTURE_CUBE_MAP: return GL_TEXTURE_BINDING_CUBE_MAP;
+			case GL_TEXTURE_BUFFER: return GL_TEXTURE_BINDING_BUFFER;
+		}
+		return 0;
+	}
+}
+
+GLStateCache::GLStateCache() noexcept
+	: mStats{ 0, 0 }
+{
+	static_assert( sizeof(kCaps_)/sizeof(kCaps_[0]) == kCapCount_ );
+
+	invalidate();
+}
+
+void GLStateCache::useProgram( GLuint aProgram ) noexcept
+{
+	if( skip_( mProgram == aProgram ) )
+		return;
+
+	glUseProgram( aProgram );
+	mProgram = aProgram;
+}
+
+void GLStateCache::bindVertexArray( GLuint aVertexArray ) noexcept
+{
+	if( skip_( mVertexArray == aVertexArray ) )
+		return;
+
+	glBindVertexArray( aVertexArray );
+	mVertexArray = aVertexArray;
+}
+
+void GLStateCache::bindTexture( GLuint aUnit, GLenum aTarget, GLuint aTexture ) noexcept
+{
+	if( aUnit < kMaxTextureUnits )
+	{
+		auto& tex = mTextures[aUnit];
+		if( skip_( tex.target == aTarget && tex.name == aTexture ) )
+			return;
+
+		tex.target = aTarget;
+		tex.name = aTexture;
+	}
+	else
+	{
+		++mStats.issued;
+	}
+
+	// Changing the active unit is part of the same (logical) state change,
+	// and is not counted separately.
+	if( mActiveUnit != aUnit )
+	{
+		glActiveTexture( GL_TEXTURE0 + aUnit );
+		mActiveUnit = aUnit;
+	}
+
+	glBindTexture( aTarget, aTexture );
+}
+
+void GLStateCache::enable( GLenum aCap ) noexcept
+{
+	setEnabled( aCap, true );
+}
+void GLStateCache::disable( GLenum aCap ) noexcept
+{
+	setEnabled( aCap, false );
+}
+void GLStateCache::setEnabled( GLenum aCap, bool aEnabled ) noexcept
+{
+	auto const value = aEnabled ? Tristate_::on : Tristate_::off;
+
+	std::size_t const idx = cap_index_( aCap );
+	if( idx < kCapCount_ )
+	{
+		if( skip_( mCaps[idx] == value ) )
+			return;
+
+		mCaps[idx] = value;
+	}
+	else
+	{
+		++mStats.issued;
+	}
+
+	if( aEnabled )
+		glEnable( aCap );
+	else
+		glDisable( aCap );
+}
+
+void GLStateCache::blendFunc( GLenum aSrc, GLenum aDst ) noexcept
+{
+	if( skip_( mBlendSrc == aSrc && mBlendDst == aDst ) )
+		return;
+
+	glBlendFunc( aSrc, aDst );
+	mBlendSrc = aSrc;
+	mBlendDst = aDst;
+}
+void GLStateCache::depthFunc( GLenum aFunc ) noexcept
+{
+	if( skip_( mDepthFunc == aFunc ) )
+		return;
+
+	glDepthFunc( aFunc );
+	mDepthFunc = aFunc;
+}
+void GLStateCache::depthMask( bool aWrite ) noexcept
+{
+	auto const value = aWrite ? Tristate_::on : Tristate_::off;
+	if( skip_( mDepthMask == value ) )
+		return;
+
+	glDepthMask( aWrite ? GL_TRUE : GL_FALSE );
+	mDepthMask = value;
+}
+
+void GLStateCache::invalidate() noexcept
+{
+	mProgram = kUnknown_;
+	mVertexArray = kUnknown_;
+
+	mActiveUnit = kUnknown_;
+	for( auto& tex : mTextures )
+		tex = Texture_{ kUnknown_, kUnknown_ };
+
+	for( auto& cap : mCaps )
+		cap = Tristate_::unknown;
+
+	mBlendSrc = mBlendDst = kUnknown_;
+	mDepthFunc = kUnknown_;
+	mDepthMask = Tristate_::unknown;
+}
+
+void GLStateCache::verify() const
+{
+	auto get_ = [] (GLenum aName) {
+		GLint value = 0;
+		glGetIntegerv( aName, &value );
+		return GLuint(value);
+	};
+
+	if( kUnknown_ != mProgram && get_( GL_CURRENT_PROGRAM ) != mProgram )
+		throw Error( "GLStateCache: program %u is current, but the cache assumes %u", get_( GL_CURRENT_PROGRAM ), mProgram );
+	if( kUnknown_ != mVertexArray && get_( GL_VERTEX_ARRAY_BINDING ) != mVertexArray )
+		throw Error( "GLStateCache: vertex array %u is bound, but the cache assumes %u", get_( GL_VERTEX_ARRAY_BINDING ), mVertexArray );
+
+	if( kUnknown_ != mActiveUnit )
+	{
+		if( get_( GL_ACTIVE_TEXTURE ) != GL_TEXTURE0 + mActiveUnit )
+			throw Error( "GLStateCache: texture unit %u is active, but the cache assumes %u", get_( GL_ACTIVE_TEXTURE ) - GL_TEXTURE0, mActiveUnit );
+	}
+
+	GLuint const active = get_( GL_ACTIVE_TEXTURE );
+	for( GLuint unit = 0; unit < kMaxTextureUnits; ++unit )
+	{
+		auto const& tex = mTextures[unit];
+		if( kUnknown_ == tex.name )
+			continue;
+
+		GLenum const binding = texture_binding_( tex.target );
+		if( 0 == binding )
+			continue;
+
+		glActiveTexture( GL_TEXTURE0 + unit );
+		GLuint const actual = get_( binding );
+		glActiveTexture( active );
+
+		if( actual != tex.name )
+			throw Error( "GLStateCache: texture %u is bound to unit %u, but the cache assumes %u", actual, unit, tex.name );
+	}
+
+	for( std::size_t i = 0; i < kCapCount_; ++i )
+	{
+		if( Tristate_::unknown == mCaps[i] )
+			continue;
+
+		bool const enabled = GL_TRUE == glIsEnabled( kCaps_[i] );
+		if( enabled != (Tristate_::on == mCaps[i]) )
+			throw Error( "GLStateCache: capability %#x is %s, but the cache assumes otherwise", unsigned(kCaps_[i]), enabled ? "enabled" : "disabled" );
+	}
+
+	if( kUnknown_ != mBlendSrc && (get_( GL_BLEND_SRC_RGB ) != mBlendSrc || get_( GL_BLEND_DST_RGB ) != mBlendDst) )
+		throw Error( "GLStateCache: blend function differs from the cached one" );
+	if( kUnknown_ != mDepthFunc && get_( GL_DEPTH_FUNC ) != mDepthFunc )
+		throw Error( "GLStateCache: depth function differs from the cached one" );
+	if( Tristate_::unknown != mDepthMask && (0 != get_( GL_DEPTH_WRITEMASK )) != (Tristate_::on == mDepthMask) )
+		throw Error( "GLStateCache: depth mask differs from the cached one" );
+}
+
+GLStateCache::Stats GLStateCache::stats() const noexcept
+{
+	return mStats;
+}
+void GLStateCache::resetStats() noexcept
+{
+	mStats = Stats{ 0, 0 };
+}
+
+bool GLStateCache::skip_( bool aRedundant ) noexcept
+{
+	if( aRedundant )
+		++mStats.skipped;
+	else
+		++mStats.issued;
+
+	return aRedundant;
+}
@@ -0,0 +1,102 @@
+#ifndef GL_STATE_HPP_04FA4D12_8D3C_41D2_9C65_810A73E56EBF
+#define GL_STATE_HPP_04FA4D12_8D3C_41D2_9C65_810A73E56EBF
+
+#include <glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/** GLStateCache: skips redundant OpenGL state changes
+ *
+ * Shadows the currently bound program, vertex array, textures and a few
+ * pieces of fixed-function state (capabilities such as GL_BLEND and
+ * GL_DEPTH_TEST, the blend function and the depth function and mask).
+ * Calls that would set the value that is already current are skipped. Each
+ * call is counted as either issued or skipped; see stats().
+ *
+ * The cache only knows about changes made through it. Code that changes
+ * the tracked state directly (e.g. binding a vertex array while creating
+ * it, or glBindTexture() when uploading a texture) must be followed by
+ * invalidate(). Deleting a bound vertex array or texture resets the binding
+ * to zero in GL; call invalidate() after that as well. In debug builds,
+ * verify() compares the shadowed state with GL's.
+ *
+ * Initially, all state is unknown, and the first call for each piece of
+ * state is always issued.
+ *
+ * One GLStateCache per OpenGL context. Requires that context to be current.
+ */
+class GLStateCache final
+{
+	public:
+		struct Stats
+		{
+			std::size_t issued;
+			std::size_t skipped;
+		};
+
+		// Texture units (and capabilities, see cpp) beyond these are not
+		// tracked; calls for them are always issued.
+		static constexpr std::size_t kMaxTextureUnits = 16;
+
+	public:
+		GLStateCache() noexcept;
+
+	public:
+		void useProgram( GLuint ) noexcept;
+		void bindVertexArray( GLuint ) noexcept;
+
+		// Binds aTexture to aTarget on texture unit aUnit (i.e., the unit is
+		// given as 0, 1, ..., not as GL_TEXTURE0+i). Changes the active
+		// texture unit if necessary.
+		void bindTexture( GLuint aUnit, GLenum aTarget, GLuint aTexture ) noexcept;
+
+		void enable( GLenum aCap ) noexcept;
+		void disable( GLenum aCap ) noexcept;
+		void setEnabled( GLenum aCap, bool aEnabled ) noexcept;
+
+		void blendFunc( GLenum aSrc, GLenum aDst ) noexcept;
+		void depthFunc( GLenum ) noexcept;
+		void depthMask( bool ) noexcept;
+
+		// Forget all shadowed state (see above)
+		void invalidate() noexcept;
+
+		// Throws an Error if the known state differs from GL's. Queries GL,
+		// so this is intended for debugging.
+		void verify() const;
+
+	public:
+		Stats stats() const noexcept;
+		void resetStats() noexcept;
+
+	private:
+		struct Texture_
+		{
+			GLenum target;
+			GLuint name;
+		};
+
+		enum class Tristate_ : std::uint8_t { unknown, off, on };
+
+		static constexpr std::size_t kCapCount_ = 8;
+
+		bool skip_( bool aRedundant ) noexcept;
+
+	private:
+		GLuint mProgram;
+		GLuint mVertexArray;
+
+		GLuint mActiveUnit;
+		Texture_ mTextures[kMaxTextureUnits];
+
+		Tristate_ mCaps[kCapCount_];
+
+		GLenum mBlendSrc, mBlendDst;
+		GLenum mDepthFunc;
+		Tristate_ mDepthMask;
+
+		Stats mStats;
+};
+
+#endif // GL_STATE_HPP_04FA4D12_8D3C_41D2_9C65_810A73E56EBF
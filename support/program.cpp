@@ -1,22 +1,72 @@
 #include "program.hpp"
 
+#include <string>
 #include <vector>
 #include <utility>
+#include <filesystem>
 
 #include <cstdio>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
 
 #include <glad.h>
 #include <GLFW/glfw3.h>
 
 #include "error.hpp"
 #include "checkpoint.hpp"
+#include "program_cache.hpp"
+#include "shader_preprocess.hpp"
 
 namespace
 {
-	GLuint load_shader_( 
+	// Only issues the compile; see check_shader_()
+	GLuint compile_shader_( 
 		GLenum aShaderType, 
-		char const* aSourcePath
+		std::string const& aSource
 	);
+	void check_shader_(
+		GLuint aShader,
+		GLenum aShaderType, 
+		char const* aSourcePath,
+		std::vector<std::string> const& aFiles
+	);
+
+	// KHR_parallel_shader_compile. The extension is not included in the
+	// glad loader, so the required bits are defined here. (The values are
+	// shared with ARB_parallel_shader_compile.)
+	constexpr GLenum kCompletionStatus_ = 0x91B1; // GL_COMPLETION_STATUS_KHR
+
+	using MaxShaderCompilerThreadsProc_ = void (APIENTRYP)( GLuint );
+
+	// Returns true if the extension is available. The first call enables
+	// parallel compilation with the driver's default number of threads.
+	bool parallel_compile_();
+
+	// Key for the ProgramBinaryCache (FNV-1a)
+	class ProgramKey_
+	{
+		public:
+			void add( void const* aData, std::size_t aSize ) noexcept
+			{
+				auto const* bytes = static_cast<unsigned char const*>(aData);
+				for( std::size_t i = 0; i < aSize; ++i )
+				{
+					mHash ^= bytes[i];
+					mHash *= 0x100000001b3ull;
+				}
+			}
+			void add( char const* aString ) noexcept
+			{
+				// Include the terminator, such that "ab"+"c" != "a"+"bc"
+				add( aString ? aString : "", std::strlen( aString ? aString : "" ) + 1 );
+			}
+
+			std::uint64_t value() const noexcept { return mHash; }
+
+		private:
+			std::uint64_t mHash = 0xcbf29ce484222325ull;
+	};
 
 	// lightweight std::experimental::scope_exit alternative
 	// Not the most complete or convenient implementation...
@@ -37,15 +87,18 @@ namespace
 	}
 }
 
-ShaderProgram::ShaderProgram( std::vector<ShaderSource> aShaderSources )
+ShaderProgram::ShaderProgram( std::vector<ShaderSource> aShaderSources, ProgramBinaryCache* aCache )
 	: mProgram( 0 )
 	, mSources( std::move(aShaderSources) )
+	, mCache( aCache )
 {
 	reload();
 }
 
 ShaderProgram::~ShaderProgram()
 {
+	discard_( mPending );
+
 	if( 0 != mProgram )
 		glDeleteProgram( mProgram );
 }
@@ -53,11 +106,19 @@ ShaderProgram::~ShaderProgram()
 ShaderProgram::ShaderProgram( ShaderProgram&& aOther ) noexcept
 	: mProgram( std::exchange( aOther.mProgram, 0 ) )
 	, mSources( std::move(aOther.mSources) )
+	, mCache( aOther.mCache )
+	, mFiles( std::move(aOther.mFiles) )
+	, mReflection( std::move(aOther.mReflection) )
+	, mPending( std::exchange( aOther.mPending, Pending_{} ) )
 {}
 ShaderProgram& ShaderProgram::operator= (ShaderProgram&& aOther) noexcept
 {
 	std::swap( mProgram, aOther.mProgram );
 	std::swap( mSources, aOther.mSources );
+	std::swap( mCache, aOther.mCache );
+	std::swap( mFiles, aOther.mFiles );
+	std::swap( mReflection, aOther.mReflection );
+	std::swap( mPending, aOther.mPending );
 	return *this;
 }
 
@@ -66,64 +127,181 @@ GLuint ShaderProgram::programId() const noexcept
 	return mProgram;
 }
 
+ProgramReflection const& ShaderProgram::reflection() const noexcept
+{
+	return mReflection;
+}
+
 void ShaderProgram::reload()
 {
-	// Space to hold the shaders when we load them
-	std::vector<GLuint> shaders;
-	shaders.reserve( mSources.size() );
-
-	// Ensure that shaders are cleaned up properly, regardless of how we leave
-	// the function (e.g., either by returning or by exception)
-	auto const scopeShaders_ = scope_exit_( [&shaders] {
-		for( auto const shader : shaders )
-			glDeleteShader( shader );
+	discard_( mPending );
+
+	// Ensure that the new shaders and program are cleaned up properly,
+	// regardless of how we leave the function (e.g., either by returning or
+	// by exception). If the new program was successfully linked, finish_()
+	// has already swapped it with the old one, and the old one is deleted.
+	Pending_ pending;
+	auto const scopePending_ = scope_exit_( [this,&pending] {
+		discard_( pending );
 	} );
 
-	// Load shaders
+	if( begin_( pending ) )
+		return;
+
+	finish_( pending );
+}
+
+bool ShaderProgram::reloadAsync()
+{
+	discard_( mPending );
+	return begin_( mPending );
+}
+
+bool ShaderProgram::poll()
+{
+	if( 0 == mPending.program )
+		return false;
+
+	if( parallel_compile_() )
+	{
+		// Checking the program is sufficient: linking can only complete once
+		// the shaders have been compiled.
+		GLint done = GL_FALSE;
+		glGetProgramiv( mPending.program, kCompletionStatus_, &done );
+
+		if( GL_FALSE == done )
+			return false;
+	}
+
+	// Without KHR_parallel_shader_compile, the queries in finish_() may block
+	// until the driver is done. (Many drivers still compile on a background
+	// thread, so deferring the queries to a later frame is still useful.)
+	auto const scopePending_ = scope_exit_( [this] {
+		discard_( mPending );
+	} );
+
+	finish_( mPending );
+	return true;
+}
+
+bool ShaderProgram::pending() const noexcept
+{
+	return 0 != mPending.program;
+}
+
+bool ShaderProgram::usesFile( std::string const& aPath ) const
+{
+	auto const path = std::filesystem::path( aPath ).lexically_normal().generic_string();
+	for( auto const& file : mFiles )
+	{
+		if( file == path )
+			return true;
+	}
+
+	return false;
+}
+
+bool ShaderProgram::begin_( Pending_& aPending )
+{
+	assert( 0 == aPending.program && aPending.shaders.empty() );
+
+	// Load and preprocess shader sources
+	std::vector<PreprocessedShader> sources;
+	sources.reserve( mSources.size() );
+
 	for( auto const& source : mSources )
-		shaders.emplace_back( load_shader_( source.type, source.sourcePath.c_str() ) );
+		sources.emplace_back( preprocess_shader( source.sourcePath, source.defines ) );
+
+	// Remember all files that went into the program, so that hot reloads
+	// also pick up changes to included files.
+	mFiles.clear();
+	for( auto const& source : sources )
+		mFiles.insert( mFiles.end(), source.files.begin(), source.files.end() );
+
+	// Try the binary cache first
+	if( mCache )
+	{
+		ProgramKey_ key;
+		key.add( reinterpret_cast<char const*>(glGetString( GL_RENDERER )) );
+		key.add( reinterpret_cast<char const*>(glGetString( GL_VERSION )) );
+		for( std::size_t i = 0; i < mSources.size(); ++i )
+		{
+			// The preprocessed source includes the defines and the contents
+			// of included files.
+			std::uint64_t const size = sources[i].source.size();
+			key.add( &mSources[i].type, sizeof(GLenum) );
+			key.add( &size, sizeof(size) );
+			key.add( sources[i].source.data(), sources[i].source.size() );
+		}
+
+		aPending.cacheKey = key.value();
+
+		if( GLuint const cached = mCache->load( aPending.cacheKey ) )
+		{
+			if( 0 != mProgram )
+				glDeleteProgram( mProgram );
+
+			mProgram = cached;
+			mReflection = ProgramReflection( mProgram );
+			OGL_CHECKPOINT_ALWAYS();
+			return true;
+		}
+	}
+
+	// Make sure that the driver compiles in parallel, if it can
+	parallel_compile_();
+
+	// Issue the compiles and the link. Their results are only queried in
+	// finish_(), which gives the driver a chance to process them in the
+	// background.
+	aPending.shaders.reserve( mSources.size() );
+	aPending.files.reserve( mSources.size() );
+	for( std::size_t i = 0; i < mSources.size(); ++i )
+	{
+		aPending.shaders.emplace_back( compile_shader_( mSources[i].type, sources[i].source ) );
+		aPending.files.emplace_back( std::move(sources[i].files) );
+	}
 
-	// Create program object
 	OGL_CHECKPOINT_ALWAYS();
 
-	GLuint prog = glCreateProgram();
-
-	// Ensure that the program is cleaned up. 
-
-	/* There is a small trick here. If we successfully compile and link the new
-	 * program, we will replace the value of the "prog" variable with the old
-	 * program's ID. In this case, the following will delete the old program
-	 * (if there was any). If we do not reach the end (e.g. exception thrown),
-	 * the new program ID will still be in the "prog" variable, and we will
-	 * delete it appropriately. (However, the old program in mProgram is left
-	 * intact).
-	 */
-	auto const scopeProgram_ = scope_exit_( [&prog] {
-		if( 0 != prog )
-			glDeleteProgram( prog );
-	} );
+	aPending.program = glCreateProgram();
 
-	// Link individual shaders to create the final shader program
-	for( auto const shader : shaders )
-		glAttachShader( prog, shader );
+	if( mCache )
+		glProgramParameteri( aPending.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
 
-	glLinkProgram( prog );
+	for( auto const shader : aPending.shaders )
+		glAttachShader( aPending.program, shader );
+
+	glLinkProgram( aPending.program );
+
+	OGL_CHECKPOINT_ALWAYS();
+	return false;
+}
+
+void ShaderProgram::finish_( Pending_& aPending )
+{
+	assert( 0 != aPending.program && aPending.shaders.size() == mSources.size() );
+
+	// Check the individual shaders first; their logs are more useful than
+	// the linker's if one of them failed.
+	for( std::size_t i = 0; i < mSources.size(); ++i )
+		check_shader_( aPending.shaders[i], mSources[i].type, mSources[i].sourcePath.c_str(), aPending.files[i] );
 
 	{
 		// Get info log
 		GLint logLength = 0;
-		glGetProgramiv( prog, GL_INFO_LOG_LENGTH, &logLength );
+		glGetProgramiv( aPending.program, GL_INFO_LOG_LENGTH, &logLength );
 
 		std::vector<GLchar> log;
 		if( logLength )
 		{
 			log.resize( logLength );
-			glGetProgramInfoLog( prog, GLsizei(log.size()), nullptr, log.data() );
+			glGetProgramInfoLog( aPending.program, GLsizei(log.size()), nullptr, log.data() );
 		}
 
 		// Check link status
 		GLint status = 0;
-		glGetProgramiv( prog, GL_LINK_STATUS, &status );
+		glGetProgramiv( aPending.program, GL_LINK_STATUS, &status );
 
 		if( GL_TRUE != status )
 			throw Error( "Shader program linking failed: \n%s\n", log.data() );
@@ -134,48 +312,30 @@ void ShaderProgram::reload()
 	
 	OGL_CHECKPOINT_ALWAYS();
 
-	// Replace the old shader program (if any) with the new one
-	std::swap( mProgram, prog );
+	if( mCache )
+		mCache->store( aPending.cacheKey, aPending.program );
+
+	// Replace the old shader program (if any) with the new one. The old one
+	// ends up in aPending, and is deleted by discard_().
+	std::swap( mProgram, aPending.program );
+	mReflection = ProgramReflection( mProgram );
 }
 
-namespace
+void ShaderProgram::discard_( Pending_& aPending ) noexcept
 {
-	GLuint load_shader_( GLenum aShaderType, char const* aSourcePath )
-	{
-		// Load the shader source code from file
-		std::vector<GLchar> source;
+	for( auto const shader : aPending.shaders )
+		glDeleteShader( shader );
 
-		if( std::FILE* fin = std::fopen( aSourcePath, "rb" ) )
-		{
-			auto const scopeFile_ = scope_exit_( [&fin] {
-				std::fclose( fin );
-			} );
-
-			std::fseek( fin, 0, SEEK_END );
-			auto const length = std::size_t(std::ftell( fin ));
-			std::fseek( fin, 0, SEEK_SET );
+	if( 0 != aPending.program )
+		glDeleteProgram( aPending.program );
 
-			source.resize( length );
-			for( std::size_t read = 0; read != length; )
-			{
-				auto const ret = std::fread( source.data()+read, 1, length-read, fin );
-
-				if( 0 == ret )
-				{
-					if( auto const err = std::ferror( fin ) )
-						throw Error( "load_shader_(): error while reading from '%s': %d (%zu bytes read, %zu total)", aSourcePath, err, read, length );
-					if( std::feof( fin ) )
-						throw Error( "load_shader_(): unexpected EOF in '%s' (%zu bytes read, %zu total)", aSourcePath, read, length );
-				}
-			
-				read += ret;
-			}
-		}
-		else
-		{
-			throw Error( "load_shader_(): unable to open input file '%s'", aSourcePath );
-		}
+	aPending = Pending_{};
+}
 
+namespace
+{
+	GLuint compile_shader_( GLenum aShaderType, std::string const& aSource )
+	{
 		// Create shader object
 		OGL_CHECKPOINT_ALWAYS();
 
@@ -183,10 +343,10 @@ namespace
 
 		// Compile shader
 		GLchar const* sources[] = {
-			source.data()
+			aSource.data()
 		};
 		GLsizei lengths[] = {
-			GLsizei(source.size())
+			GLsizei(aSource.size())
 		};
 
 		glShaderSource( shader, sizeof(sources)/sizeof(sources[0]), sources, lengths );
@@ -195,19 +355,24 @@ namespace
 
 		OGL_CHECKPOINT_ALWAYS();
 
+		return shader;
+	}
+
+	void check_shader_( GLuint aShader, GLenum aShaderType, char const* aSourcePath, std::vector<std::string> const& aFiles )
+	{
 		// Get compile info log
 		/* The compile log is mainly relevant if there is an error. However, on some
 		 * systems, it can include additional information even if compilation was
 		 * successful. This might include warnings and/or usage hints.
 		 */
 		GLint logLength = 0;
-		glGetShaderiv( shader, GL_INFO_LOG_LENGTH, &logLength );
+		glGetShaderiv( aShader, GL_INFO_LOG_LENGTH, &logLength );
 
 		std::vector<GLchar> log;
 		if( logLength )
 		{
 			log.resize( logLength );
-			glGetShaderInfoLog( shader, GLsizei(log.size()), nullptr, log.data() );
+			glGetShaderInfoLog( aShader, GLsizei(log.size()), nullptr, log.data() );
 		}
 
 		char const* shaderTypeName = "unknown shader";
@@ -223,19 +388,52 @@ namespace
 
 		// Check compile status
 		GLint status = 0;
-		glGetShaderiv( shader, GL_COMPILE_STATUS, &status );
+		glGetShaderiv( aShader, GL_COMPILE_STATUS, &status );
 
 		if( GL_TRUE != status )
 		{
-			glDeleteShader( shader );
-			throw Error( "%s \"%s\" compilation failed:\n%s\n", shaderTypeName, aSourcePath, log.data() );
+			// Source string numbers in the log refer to aFiles
+			std::string files;
+			for( std::size_t i = 0; i < aFiles.size(); ++i )
+				files += "  " + std::to_string( i ) + ": " + aFiles[i] + "\n";
+
+			throw Error( "%s \"%s\" compilation failed:\n%s\nSource files:\n%s", shaderTypeName, aSourcePath, log.data(), files.c_str() );
 		}
 
 		if( !log.empty() )
 			std::fprintf( stderr, "Note: %s \"%s\" log:\n%s\n", shaderTypeName, aSourcePath, log.data() );
 
 		OGL_CHECKPOINT_ALWAYS();
+	}
 
-		return shader;
+	bool parallel_compile_()
+	{
+		// Note: this assumes a single OpenGL context (or that all contexts
+		// support the same extensions).
+		static bool const available = [] {
+			GLint count = 0;
+			glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+
+			char const* name = nullptr;
+			for( GLint i = 0; i < count && !name; ++i )
+			{
+				auto const* ext = reinterpret_cast<char const*>(glGetStringi( GL_EXTENSIONS, GLuint(i) ));
+				if( 0 == std::strcmp( ext, "GL_KHR_parallel_shader_compile" ) )
+					name = "glMaxShaderCompilerThreadsKHR";
+				else if( 0 == std::strcmp( ext, "GL_ARB_parallel_shader_compile" ) )
+					name = "glMaxShaderCompilerThreadsARB";
+			}
+
+			if( !name )
+				return false;
+
+			// 0xffffffff = let the implementation decide
+			if( auto const maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc_>(glfwGetProcAddress( name )) )
+				maxThreads( 0xffffffffu );
+
+			return true;
+		}();
+
+		return available;
 	}
 }
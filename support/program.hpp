@@ -9,6 +9,31 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include "program_reflection.hpp"
+
+class ProgramBinaryCache;
+
+/** ShaderProgram: shader program loaded from source files
+ *
+ * If a ProgramBinaryCache is given, reload() first tries to restore the
+ * linked program from the cache, keyed by a hash of the shader types and
+ * sources and of GL_RENDERER and GL_VERSION. Otherwise (or if the driver
+ * rejects the cached binary), the program is compiled from source and the
+ * result is stored in the cache. The cache must outlive the ShaderProgram.
+ *
+ * Sources are passed through preprocess_shader() (support/shader_preprocess.hpp)
+ * first, which resolves #include and inserts the ShaderSource's defines.
+ *
+ * After linking, the active uniforms and blocks are queried once (see
+ * ProgramReflection). Use reflection() to look up uniform locations, block
+ * bindings and offsets without further GL calls.
+ *
+ * reload() compiles and links synchronously, and throws on errors. For
+ * reloads at run time, reloadAsync() only issues the compiles and the link;
+ * poll() later checks whether they have finished, without blocking if
+ * KHR_parallel_shader_compile is available. Until then, programId() keeps
+ * returning the previous program, so rendering can continue with it.
+ */
 class ShaderProgram final
 {
 	public:
@@ -16,11 +41,15 @@ class ShaderProgram final
 		{
 			GLenum type;
 			std::string sourcePath;
+
+			// Inserted after the #version line, see preprocess_shader()
+			std::vector<std::string> defines = {};
 		};
 
 	public:
 		explicit ShaderProgram( 
-			std::vector<ShaderSource> = {}
+			std::vector<ShaderSource> = {},
+			ProgramBinaryCache* = nullptr
 		);
 
 		~ShaderProgram();
@@ -34,11 +63,49 @@ class ShaderProgram final
 	public:
 		GLuint programId() const noexcept;
 
+		// Reflection data of the current program (i.e., of programId())
+		ProgramReflection const& reflection() const noexcept;
+
 		void reload();
 
+		// Starts an asynchronous reload. A reload that is still pending is
+		// discarded. Returns true if the program was restored from the binary
+		// cache immediately (nothing is pending in that case).
+		bool reloadAsync();
+
+		// Finishes a pending asynchronous reload if the driver is done with
+		// it. Returns true if the new program replaced the old one. If the new
+		// program fails to compile or link, the pending reload is discarded
+		// and an Error is thrown; the old program stays in use.
+		bool poll();
+
+		bool pending() const noexcept;
+
+		// True if aPath is one of the program's source files, or a file that
+		// they #include
+		bool usesFile( std::string const& aPath ) const;
+
+	private:
+		struct Pending_
+		{
+			GLuint program = 0;
+			std::vector<GLuint> shaders;
+			std::vector<std::vector<std::string>> files; // per shader
+			std::uint64_t cacheKey = 0;
+		};
+
+		bool begin_( Pending_& );
+		void finish_( Pending_& );
+		void discard_( Pending_& ) noexcept;
+
 	private:
 		GLuint mProgram;
 		std::vector<ShaderSource> mSources;
+		ProgramBinaryCache* mCache;
+		std::vector<std::string> mFiles;
+		ProgramReflection mReflection;
+
+		Pending_ mPending;
 };
 
 #endif // PROGRAM_HPP_39793FD2_7845_47A7_9E21_6DDAD42C9A09
@@ -0,0 +1,193 @@
+#include "program_cache.hpp"
+
+#include <vector>
+#include <fstream>
+#include <utility>
+#include <filesystem>
+
+#include <cstdio>
+#include <cstring>
+#include <cinttypes>
+
+#include "checkpoint.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr char kMagic_[8] = { 'V', 'M', 'L', 'P', 'R', 'O', 'G', '\0' };
+	constexpr std::uint32_t kVersion_ = 1;
+
+	struct Header_
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t binaryFormat; // GLenum
+		std::uint64_t key;
+		std::uint64_t binarySize;
+	};
+
+	bool is_supported_format_( GLenum aFormat )
+	{
+		GLint count = 0;
+		glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &count );
+		if( count <= 0 )
+			return false;
+
+		std::vector<GLint> formats( static_cast<std::size_t>(count) );
+		glGetIntegerv( GL_PROGRAM_BINARY_FORMATS, formats.data() );
+
+		for( auto const format : formats )
+		{
+			if( GLenum(format) == aFormat )
+				return true;
+		}
+
+		return false;
+	}
+}
+
+ProgramBinaryCache::ProgramBinaryCache( std::string aDirectory )
+	: mDirectory( std::move(aDirectory) )
+	, mStats{ 0, 0, 0, 0 }
+{}
+
+GLuint ProgramBinaryCache::load( std::uint64_t aKey )
+{
+	std::string const path = path_( aKey );
+
+	std::ifstream file( path, std::ios::binary );
+	if( !file )
+	{
+		++mStats.misses;
+		return 0;
+	}
+
+	// The header's binarySize must match the actual file, so that a
+	// corrupt header can't request an arbitrarily large allocation.
+	std::error_code ec;
+	auto const fileSize = fs::file_size( path, ec );
+
+	Header_ head{};
+	std::vector<char> binary;
+	if( file.read( reinterpret_cast<char*>(&head), sizeof(head) ) 
+		&& 0 == std::memcmp( head.magic, kMagic_, sizeof(kMagic_) )
+		&& kVersion_ == head.version 
+		&& aKey == head.key
+		&& !ec && fileSize >= sizeof(head)
+		&& head.binarySize == fileSize - sizeof(head)
+		&& is_supported_format_( GLenum(head.binaryFormat) ) )
+	{
+		binary.resize( std::size_t(head.binarySize) );
+		if( !file.read( binary.data(), std::streamsize(binary.size()) ) )
+			binary.clear();
+	}
+
+	file.close();
+
+	GLuint prog = 0;
+	if( !binary.empty() )
+	{
+		// Errors raised before this point belong to someone else; report
+		// them now rather than swallowing them below.
+		OGL_CHECKPOINT_ALWAYS();
+
+		prog = glCreateProgram();
+		glProgramBinary( prog, GLenum(head.binaryFormat), binary.data(), GLsizei(binary.size()) );
+
+		GLint status = 0;
+		glGetProgramiv( prog, GL_LINK_STATUS, &status );
+		if( GL_TRUE != status )
+		{
+			glDeleteProgram( prog );
+			prog = 0;
+
+			// A rejected binary may raise an error (e.g. GL_INVALID_ENUM for a
+			// format that the driver no longer accepts). Don't leave it for
+			// the next checkpoint, the fallback compiles the program instead.
+			glGetError();
+		}
+	}
+
+	if( 0 == prog )
+	{
+		std::fprintf( stderr, "Note: program binary '%s' rejected, recompiling\n", path.c_str() );
+
+		fs::remove( path, ec );
+
+		++mStats.rejected;
+		++mStats.misses;
+		return 0;
+	}
+
+	++mStats.hits;
+	return prog;
+}
+
+void ProgramBinaryCache::store( std::uint64_t aKey, GLuint aProgram )
+{
+	GLint length = 0;
+	glGetProgramiv( aProgram, GL_PROGRAM_BINARY_LENGTH, &length );
+	if( length <= 0 )
+		return; // No binary formats supported
+
+	std::vector<char> binary( static_cast<std::size_t>(length) );
+	GLenum format = 0;
+	glGetProgramBinary( aProgram, length, &length, &format, binary.data() );
+	binary.resize( std::size_t(length) );
+
+	Header_ head{};
+	std::memcpy( head.magic, kMagic_, sizeof(kMagic_) );
+	head.version = kVersion_;
+	head.binaryFormat = format;
+	head.key = aKey;
+	head.binarySize = binary.size();
+
+	// Write to a temporary first, such that a partially written file is never
+	// observed.
+	std::string const path = path_( aKey );
+	std::string const tmpPath = path + ".tmp";
+
+	std::error_code ec;
+	fs::create_directories( mDirectory, ec );
+
+	{
+		std::ofstream file( tmpPath, std::ios::binary | std::ios::trunc );
+		file.write( reinterpret_cast<char const*>(&head), sizeof(head) );
+		file.write( binary.data(), std::streamsize(binary.size()) );
+
+		if( !file )
+		{
+			std::fprintf( stderr, "Note: unable to write program binary '%s'\n", tmpPath.c_str() );
+			file.close();
+			fs::remove( tmpPath, ec );
+			return;
+		}
+	}
+
+	fs::rename( tmpPath, path, ec );
+	if( ec )
+	{
+		std::fprintf( stderr, "Note: unable to replace program binary '%s'\n", path.c_str() );
+		fs::remove( tmpPath, ec );
+		return;
+	}
+
+	++mStats.stores;
+}
+
+ProgramBinaryCache::Stats ProgramBinaryCache::stats() const noexcept
+{
+	return mStats;
+}
+std::string const& ProgramBinaryCache::directory() const noexcept
+{
+	return mDirectory;
+}
+
+std::string ProgramBinaryCache::path_( std::uint64_t aKey ) const
+{
+	char name[32];
+	std::snprintf( name, sizeof(name), "%016" PRIx64 ".progbin", aKey );
+	return (fs::path( mDirectory ) / name).string();
+}
@@ -0,0 +1,66 @@
+#ifndef PROGRAM_CACHE_HPP_9784AC01_9AF9_4500_8F78_4C5ADCC9452E
+#define PROGRAM_CACHE_HPP_9784AC01_9AF9_4500_8F78_4C5ADCC9452E
+
+#include <glad.h>
+
+#include <string>
+
+#include <cstddef>
+#include <cstdint>
+
+/** ProgramBinaryCache: on-disk cache of linked shader programs
+ *
+ * Compiling and linking shaders from source can take hundreds of
+ * milliseconds per program. Once linked, the driver can return the program
+ * in an implementation-specific binary format (glGetProgramBinary()), which
+ * can be loaded much faster later (glProgramBinary()).
+ *
+ * Programs are identified by a 64-bit key, which must cover everything that
+ * affects the result: the shader sources and types, and the driver
+ * (GL_RENDERER, GL_VERSION). ShaderProgram computes such a key. Each program
+ * is stored in a separate file, "<directory>/<key>.progbin".
+ *
+ * Drivers may reject binaries at any time (e.g. after a driver update that
+ * does not change GL_VERSION). load() then returns 0 and removes the file;
+ * the caller falls back to compiling from source and stores the new binary.
+ * load() throws (see OGL_CHECKPOINT_ALWAYS()) if GL errors are pending when
+ * it is called, as it would otherwise have to discard them.
+ *
+ * Requires a current OpenGL context for load() and store().
+ */
+class ProgramBinaryCache final
+{
+	public:
+		struct Stats
+		{
+			std::size_t hits;
+			std::size_t misses; // includes rejected binaries
+			std::size_t rejected;
+			std::size_t stores;
+		};
+
+	public:
+		explicit ProgramBinaryCache( std::string aDirectory );
+
+	public:
+		// Returns a linked program object, or 0 if the key is not cached
+		// (or the cached binary is unusable).
+		GLuint load( std::uint64_t aKey );
+
+		// Stores the binary of a linked program. The program should have been
+		// linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT. Failures are
+		// reported on stderr, but are otherwise ignored.
+		void store( std::uint64_t aKey, GLuint aProgram );
+
+		Stats stats() const noexcept;
+		std::string const& directory() const noexcept;
+
+	private:
+		std::string path_( std::uint64_t ) const;
+
+	private:
+		std::string mDirectory;
+		Stats mStats;
+};
+
+#endif // PROGRAM_CACHE_HPP_9784AC01_9AF9_4500_8F78_4C5ADCC9452E
@@ -0,0 +1,193 @@
+#include "program_reflection.hpp"
+
+#include <algorithm>
+
+#include "error.hpp"
+
+namespace
+{
+	std::string resource_name_( GLuint aProgram, GLenum aInterface, GLuint aIndex, std::vector<GLchar>& aBuffer );
+
+	ProgramReflection::Block query_block_( GLuint aProgram, GLenum aInterface, GLuint aIndex, std::vector<GLchar>& aBuffer );
+}
+
+ProgramReflection::ProgramReflection( GLuint aProgram )
+{
+	std::vector<GLchar> nameBuffer;
+
+	// Uniforms
+	GLint count = 0;
+	glGetProgramInterfaceiv( aProgram, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count );
+
+	for( GLint i = 0; i < count; ++i )
+	{
+		static constexpr GLenum kProps[] = {
+			GL_TYPE,
+			GL_ARRAY_SIZE,
+			GL_LOCATION,
+			GL_BLOCK_INDEX,
+			GL_OFFSET,
+			GL_ARRAY_STRIDE,
+			GL_MATRIX_STRIDE,
+			GL_IS_ROW_MAJOR
+		};
+		static constexpr GLsizei kPropCount = GLsizei(sizeof(kProps)/sizeof(kProps[0]));
+
+		GLint values[kPropCount]{};
+		glGetProgramResourceiv( aProgram, GL_UNIFORM, GLuint(i), kPropCount, kProps, kPropCount, nullptr, values );
+
+		Uniform uniform;
+		uniform.name = resource_name_( aProgram, GL_UNIFORM, GLuint(i), nameBuffer );
+		uniform.type = GLenum(values[0]);
+		uniform.arraySize = values[1];
+		uniform.location = values[2];
+		uniform.blockIndex = values[3];
+		uniform.offset = values[4];
+		uniform.arrayStride = values[5];
+		uniform.matrixStride = values[6];
+		uniform.rowMajor = 0 != values[7];
+
+		mUniforms.add( std::move(uniform) );
+	}
+
+	// Blocks
+	glGetProgramInterfaceiv( aProgram, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &count );
+	for( GLint i = 0; i < count; ++i )
+		mUniformBlocks.add( query_block_( aProgram, GL_UNIFORM_BLOCK, GLuint(i), nameBuffer ) );
+
+	glGetProgramInterfaceiv( aProgram, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count );
+	for( GLint i = 0; i < count; ++i )
+		mStorageBlocks.add( query_block_( aProgram, GL_SHADER_STORAGE_BLOCK, GLuint(i), nameBuffer ) );
+}
+
+
+ProgramReflection::Uniform const* ProgramReflection::uniform( ResourceNameHash aHash ) const noexcept
+{
+	return mUniforms.find( aHash );
+}
+ProgramReflection::Block const* ProgramReflection::uniformBlock( ResourceNameHash aHash ) const noexcept
+{
+	return mUniformBlocks.find( aHash );
+}
+ProgramReflection::Block const* ProgramReflection::storageBlock( ResourceNameHash aHash ) const noexcept
+{
+	return mStorageBlocks.find( aHash );
+}
+
+GLint ProgramReflection::location( ResourceNameHash aHash ) const noexcept
+{
+	auto const* u = mUniforms.find( aHash );
+	return u ? u->location : -1;
+}
+
+ProgramReflection::Uniform const* ProgramReflection::uniform( std::string_view aName ) const noexcept
+{
+	return uniform( resource_name_hash( aName ) );
+}
+ProgramReflection::Block const* ProgramReflection::uniformBlock( std::string_view aName ) const noexcept
+{
+	return uniformBlock( resource_name_hash( aName ) );
+}
+ProgramReflection::Block const* ProgramReflection::storageBlock( std::string_view aName ) const noexcept
+{
+	return storageBlock( resource_name_hash( aName ) );
+}
+GLint ProgramReflection::location( std::string_view aName ) const noexcept
+{
+	return location( resource_name_hash( aName ) );
+}
+
+std::size_t ProgramReflection::uniformCount() const noexcept
+{
+	return mUniforms.items.size();
+}
+std::size_t ProgramReflection::uniformBlockCount() const noexcept
+{
+	return mUniformBlocks.items.size();
+}
+std::size_t ProgramReflection::storageBlockCount() const noexcept
+{
+	return mStorageBlocks.items.size();
+}
+
+
+template< typename tItem >
+void ProgramReflection::Table_<tItem>::add( tItem aItem )
+{
+	std::size_t const idx = items.size();
+
+	auto insert = [&] (std::string_view aName) {
+		auto const hash = resource_name_hash( aName );
+		auto const it = std::lower_bound( index.begin(), index.end(), hash, [] (auto const& aEntry, ResourceNameHash aHash) {
+			return aEntry.first < aHash;
+		} );
+
+		if( index.end() != it && it->first == hash )
+		{
+			// Practically impossible with 64-bit hashes and the handful of
+			// names in a program, but would silently return the wrong
+			// resource.
+			throw Error( "ProgramReflection: hash collision between '%s' and '%s'", items[it->second].name.c_str(), std::string( aName ).c_str() );
+		}
+
+		index.emplace( it, hash, idx );
+	};
+
+	items.emplace_back( std::move(aItem) );
+
+	std::string_view const name = items.back().name;
+	insert( name );
+
+	// Arrays: "name[0]" is also available as "name"
+	if( name.size() > 3 && name.substr( name.size()-3 ) == "[0]" )
+		insert( name.substr( 0, name.size()-3 ) );
+}
+
+template< typename tItem >
+tItem const* ProgramReflection::Table_<tItem>::find( ResourceNameHash aHash ) const noexcept
+{
+	auto const it = std::lower_bound( index.begin(), index.end(), aHash, [] (auto const& aEntry, ResourceNameHash aHash) {
+		return aEntry.first < aHash;
+	} );
+
+	if( index.end() == it || it->first != aHash )
+		return nullptr;
+
+	return &items[it->second];
+}
+
+
+namespace
+{
+	std::string resource_name_( GLuint aProgram, GLenum aInterface, GLuint aIndex, std::vector<GLchar>& aBuffer )
+	{
+		GLenum const prop = GL_NAME_LENGTH;
+		GLint length = 0;
+		glGetProgramResourceiv( aProgram, aInterface, aIndex, 1, &prop, 1, nullptr, &length );
+
+		// GL_NAME_LENGTH includes the terminator
+		aBuffer.resize( std::size_t(std::max( length, 1 )) );
+		GLsizei written = 0;
+		glGetProgramResourceName( aProgram, aInterface, aIndex, GLsizei(aBuffer.size()), &written, aBuffer.data() );
+
+		return std::string( aBuffer.data(), std::size_t(written) );
+	}
+
+	ProgramReflection::Block query_block_( GLuint aProgram, GLenum aInterface, GLuint aIndex, std::vector<GLchar>& aBuffer )
+	{
+		static constexpr GLenum kProps[] = {
+			GL_BUFFER_BINDING,
+			GL_BUFFER_DATA_SIZE
+		};
+
+		GLint values[2]{};
+		glGetProgramResourceiv( aProgram, aInterface, aIndex, 2, kProps, 2, nullptr, values );
+
+		ProgramReflection::Block block;
+		block.name = resource_name_( aProgram, aInterface, aIndex, aBuffer );
+		block.index = aIndex;
+		block.binding = values[0];
+		block.dataSize = values[1];
+		return block;
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef PROGRAM_REFLECTION_HPP_AA63F82E_A85F_4FB8_9711_BB8B093A5696
+#define PROGRAM_REFLECTION_HPP_AA63F82E_A85F_4FB8_9711_BB8B093A5696
+
+#include <glad.h>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <string_view>
+
+#include <cstdint>
+
+/* Name hashes (64-bit FNV-1a)
+ *
+ * Resources are looked up by the hash of their name. The hash is constexpr,
+ * so names that are known in advance can be hashed at compile time:
+ *
+ *	constexpr auto kProj = resource_name_hash( "uProjection" );
+ *	glUniformMatrix4fv( prog.reflection().location( kProj ), ... );
+ */
+using ResourceNameHash = std::uint64_t;
+
+constexpr
+ResourceNameHash resource_name_hash( std::string_view aName ) noexcept
+{
+	std::uint64_t hash = 0xcbf29ce484222325ull;
+	for( char const c : aName )
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/** ProgramReflection: active uniforms and blocks of a linked program
+ *
+ * Queried once after linking with the program interface API
+ * (glGetProgramInterfaceiv(), glGetProgramResource*()), such that lookups
+ * later don't need any GL calls or string comparisons.
+ *
+ * Uniforms are found under their full name, e.g. "uLights[0].color" or
+ * "Frame.uProjection" (block members use the name that GL reports, which
+ * includes the block name only if the block has an instance name). For
+ * arrays, GL reports "name[0]"; these are additionally available as "name".
+ *
+ * Uniforms in the default block have a location and no offset. Uniforms in
+ * uniform blocks have an offset (std140 or other layouts, as reported by GL)
+ * and no location. Members of shader storage blocks are not included.
+ */
+class ProgramReflection final
+{
+	public:
+		struct Uniform
+		{
+			std::string name;
+			GLenum type;
+			GLint arraySize;
+			GLint location; // -1 for block members
+			GLint blockIndex; // -1 for the default block
+			GLint offset; // -1 for the default block
+			GLint arrayStride;
+			GLint matrixStride;
+			bool rowMajor;
+		};
+
+		struct Block
+		{
+			std::string name;
+			GLuint index;
+			GLint binding;
+			GLint dataSize;
+		};
+
+	public:
+		ProgramReflection() = default;
+		explicit ProgramReflection( GLuint aProgram );
+
+	public:
+		// nullptr if there is no such active resource
+		Uniform const* uniform( ResourceNameHash ) const noexcept;
+		Block const* uniformBlock( ResourceNameHash ) const noexcept;
+		Block const* storageBlock( ResourceNameHash ) const noexcept;
+
+		// Location of a uniform in the default block, or -1 (which the
+		// glUniform*() functions silently ignore)
+		GLint location( ResourceNameHash ) const noexcept;
+
+		// Convenience overloads that hash the name (no GL calls)
+		Uniform const* uniform( std::string_view ) const noexcept;
+		Block const* uniformBlock( std::string_view ) const noexcept;
+		Block const* storageBlock( std::string_view ) const noexcept;
+		GLint location( std::string_view ) const noexcept;
+
+		std::size_t uniformCount() const noexcept;
+		std::size_t uniformBlockCount() const noexcept;
+		std::size_t storageBlockCount() const noexcept;
+
+	private:
+		template< typename tItem >
+		struct Table_
+		{
+			std::vector<tItem> items;
+			std::vector<std::pair<ResourceNameHash,std::size_t>> index; // sorted
+
+			void add( tItem );
+			tItem const* find( ResourceNameHash ) const noexcept;
+		};
+
+	private:
+		Table_<Uniform> mUniforms;
+		Table_<Block> mUniformBlocks;
+		Table_<Block> mStorageBlocks;
+};
+
+#endif // PROGRAM_REFLECTION_HPP_AA63F82E_A85F_4FB8_9711_BB8B093A5696
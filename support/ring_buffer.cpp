@@ -0,0 +1,255 @@
+#include "ring_buffer.hpp"
+
+#include <utility>
+#include <algorithm>
+
+#include <cstring>
+
+#include <GLFW/glfw3.h>
+
+#include "error.hpp"
+
+namespace
+{
+	std::size_t align_up_( std::size_t aValue, std::size_t aAlignment ) noexcept
+	{
+		return (aValue + aAlignment - 1) / aAlignment * aAlignment;
+	}
+
+	std::size_t get_size_( GLenum aName )
+	{
+		GLint value = 0;
+		glGetIntegerv( aName, &value );
+		return std::size_t(std::max( value, 1 ));
+	}
+
+	// glBufferStorage() is core in OpenGL 4.4, and available on older
+	// contexts through GL_ARB_buffer_storage (same entry point name). glad
+	// only loads it for 4.4+ contexts. Returns null if neither applies.
+	//
+	// Note: this assumes a single OpenGL context (or that all contexts
+	// support the same extensions).
+	PFNGLBUFFERSTORAGEPROC buffer_storage_()
+	{
+		static PFNGLBUFFERSTORAGEPROC const proc = [] () -> PFNGLBUFFERSTORAGEPROC {
+			if( GLAD_GL_VERSION_4_4 )
+				return glBufferStorage;
+
+			GLint count = 0;
+			glGetIntegerv( GL_NUM_EXTENSIONS, &count );
+
+			for( GLint i = 0; i < count; ++i )
+			{
+				auto const* ext = reinterpret_cast<char const*>(glGetStringi( GL_EXTENSIONS, GLuint(i) ));
+				if( 0 == std::strcmp( ext, "GL_ARB_buffer_storage" ) )
+					return reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(glfwGetProcAddress( "glBufferStorage" ));
+			}
+
+			return nullptr;
+		}();
+
+		return proc;
+	}
+}
+
+void RingBuffer::Range::bind( GLenum aTarget, GLuint aIndex ) const noexcept
+{
+	glBindBufferRange( aTarget, aIndex, buffer, offset, size );
+}
+
+
+RingBuffer::RingBuffer() noexcept
+	: mBuffer( 0 )
+	, mMapped( nullptr )
+	, mRegionSize( 0 )
+	, mDefaultAlignment( 1 )
+	, mRegion( 0 )
+	, mHead( 0 )
+	, mFlushed( 0 )
+	, mFences{}
+	, mStats{ 0, 0, 0 }
+{}
+
+RingBuffer::RingBuffer( std::size_t aBytesPerFrame )
+	: RingBuffer()
+{
+	// The default alignment must work for all kinds of (indexed) bindings.
+	// Regions start at multiples of it.
+	mDefaultAlignment = std::max( {
+		std::size_t(16),
+		get_size_( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT ),
+		get_size_( GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT )
+	} );
+
+	mRegionSize = align_up_( std::max( aBytesPerFrame, std::size_t(1) ), mDefaultAlignment );
+	auto const total = GLsizeiptr(mRegionSize * kFrameCount);
+
+	// Start such that the first beginFrame() moves to region 0
+	mRegion = kFrameCount-1;
+
+	glGenBuffers( 1, &mBuffer );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, mBuffer );
+
+	if( auto const bufferStorage = buffer_storage_() )
+	{
+		GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		bufferStorage( GL_COPY_WRITE_BUFFER, total, nullptr, flags );
+		mMapped = static_cast<std::byte*>(glMapBufferRange( GL_COPY_WRITE_BUFFER, 0, total, flags ));
+
+		if( !mMapped )
+		{
+			glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+			release_();
+			throw Error( "RingBuffer: unable to map %zu bytes persistently", std::size_t(total) );
+		}
+	}
+	else
+	{
+		glBufferData( GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW );
+		mStaging.resize( mRegionSize );
+	}
+
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+}
+
+RingBuffer::~RingBuffer()
+{
+	release_();
+}
+
+RingBuffer::RingBuffer( RingBuffer&& aOther ) noexcept
+	: mBuffer( std::exchange( aOther.mBuffer, 0 ) )
+	, mMapped( std::exchange( aOther.mMapped, nullptr ) )
+	, mRegionSize( std::exchange( aOther.mRegionSize, 0 ) )
+	, mDefaultAlignment( aOther.mDefaultAlignment )
+	, mRegion( aOther.mRegion )
+	, mHead( std::exchange( aOther.mHead, 0 ) )
+	, mFlushed( std::exchange( aOther.mFlushed, 0 ) )
+	, mFences{}
+	, mStaging( std::move(aOther.mStaging) )
+	, mStats( aOther.mStats )
+{
+	for( std::size_t i = 0; i < kFrameCount; ++i )
+		mFences[i] = std::exchange( aOther.mFences[i], nullptr );
+}
+RingBuffer& RingBuffer::operator= (RingBuffer&& aOther) noexcept
+{
+	std::swap( mBuffer, aOther.mBuffer );
+	std::swap( mMapped, aOther.mMapped );
+	std::swap( mRegionSize, aOther.mRegionSize );
+	std::swap( mDefaultAlignment, aOther.mDefaultAlignment );
+	std::swap( mRegion, aOther.mRegion );
+	std::swap( mHead, aOther.mHead );
+	std::swap( mFlushed, aOther.mFlushed );
+	std::swap( mFences, aOther.mFences );
+	std::swap( mStaging, aOther.mStaging );
+	std::swap( mStats, aOther.mStats );
+	return *this;
+}
+
+void RingBuffer::beginFrame()
+{
+	mRegion = (mRegion + 1) % kFrameCount;
+	mHead = 0;
+	mFlushed = 0;
+	++mStats.frames;
+
+	if( GLsync const fence = std::exchange( mFences[mRegion], nullptr ) )
+	{
+		// Poll first, so that stalls can be counted
+		GLenum res = glClientWaitSync( fence, 0, 0 );
+		if( GL_TIMEOUT_EXPIRED == res )
+		{
+			++mStats.stalls;
+
+			do
+			{
+				res = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 /*ns*/ );
+			} while( GL_TIMEOUT_EXPIRED == res );
+		}
+
+		glDeleteSync( fence );
+
+		if( GL_WAIT_FAILED == res )
+			throw Error( "RingBuffer: glClientWaitSync() failed" );
+	}
+}
+
+RingBuffer::Range RingBuffer::allocate( std::size_t aSize, std::size_t aAlignment )
+{
+	std::size_t const alignment = aAlignment ? aAlignment : mDefaultAlignment;
+
+	// Align the absolute offset, in case aAlignment is not a divisor of the
+	// region size
+	std::size_t const base = mRegion * mRegionSize;
+	std::size_t const offset = align_up_( base + mHead, alignment ) - base;
+
+	if( offset + aSize > mRegionSize )
+		throw Error( "RingBuffer: out of space (%zu of %zu bytes in use, %zu requested)", mHead, mRegionSize, aSize );
+
+	mHead = offset + aSize;
+	mStats.peakBytes = std::max( mStats.peakBytes, mHead );
+
+	std::byte* const data = mMapped ? mMapped + base + offset : mStaging.data() + offset;
+	return Range{ data, mBuffer, GLintptr(base + offset), GLsizeiptr(aSize) };
+}
+
+void RingBuffer::flush()
+{
+	// The persistent mapping is coherent: writes are visible to commands
+	// issued afterwards.
+	if( mMapped || mHead == mFlushed )
+		return;
+
+	glBindBuffer( GL_COPY_WRITE_BUFFER, mBuffer );
+	glBufferSubData( GL_COPY_WRITE_BUFFER, GLintptr(mRegion * mRegionSize + mFlushed), GLsizeiptr(mHead - mFlushed), mStaging.data() + mFlushed );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+
+	mFlushed = mHead;
+}
+
+void RingBuffer::endFrame()
+{
+	if( mFences[mRegion] )
+		glDeleteSync( mFences[mRegion] );
+
+	mFences[mRegion] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+bool RingBuffer::persistent() const noexcept
+{
+	return nullptr != mMapped;
+}
+std::size_t RingBuffer::bytesPerFrame() const noexcept
+{
+	return mRegionSize;
+}
+
+RingBuffer::Stats RingBuffer::stats() const noexcept
+{
+	return mStats;
+}
+
+void RingBuffer::release_() noexcept
+{
+	for( auto& fence : mFences )
+	{
+		if( fence )
+			glDeleteSync( std::exchange( fence, nullptr ) );
+	}
+
+	if( 0 != mBuffer )
+	{
+		if( mMapped )
+		{
+			glBindBuffer( GL_COPY_WRITE_BUFFER, mBuffer );
+			glUnmapBuffer( GL_COPY_WRITE_BUFFER );
+			glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+		}
+
+		glDeleteBuffers( 1, &mBuffer );
+	}
+
+	mBuffer = 0;
+	mMapped = nullptr;
+}
@@ -0,0 +1,122 @@
+#ifndef RING_BUFFER_HPP_6AC060C1_079F_4BE9_88AB_973A5A46F4B9
+#define RING_BUFFER_HPP_6AC060C1_079F_4BE9_88AB_973A5A46F4B9
+
+#include <glad.h>
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+/** RingBuffer: streaming buffer for per-frame dynamic data
+ *
+ * Data that changes every frame (transforms, UI vertices, particles, ...)
+ * is written directly into a persistently mapped buffer (glBufferStorage()
+ * with GL_MAP_PERSISTENT_BIT and GL_MAP_COHERENT_BIT). The buffer is split
+ * into kFrameCount regions; each frame sub-allocates from the next region.
+ * A fence guards each region, so the CPU only waits if it gets more than
+ * kFrameCount-1 frames ahead of the GPU. Neither glBufferSubData() nor
+ * orphaning is involved, so there is no implicit synchronization and no
+ * driver-side copy.
+ *
+ * Usage, once per frame:
+ *
+ *	ring.beginFrame();
+ *	auto const range = ring.allocate( sizeof(Data) );
+ *	std::memcpy( range.data, &data, sizeof(Data) );
+ *	ring.flush();
+ *	range.bind( GL_UNIFORM_BUFFER, binding ); // or GL_SHADER_STORAGE_BUFFER
+ *	... draw ...
+ *	ring.endFrame();
+ *
+ * For vertex data, bind the buffer with glBindVertexBuffer( ..., buffer,
+ * offset, stride ).
+ *
+ * glBufferStorage() requires OpenGL 4.4 or GL_ARB_buffer_storage. Without
+ * either, the ring falls back to a CPU-side staging copy of the region that
+ * flush() uploads with a single glBufferSubData(). The fences still keep
+ * that upload from stalling.
+ *
+ * Requires a current OpenGL context.
+ */
+class RingBuffer final
+{
+	public:
+		static constexpr std::size_t kFrameCount = 3;
+
+		struct Range
+		{
+			void* data; // write-only (mapped memory)
+			GLuint buffer;
+			GLintptr offset;
+			GLsizeiptr size;
+
+			// glBindBufferRange() for indexed targets (UBO, SSBO)
+			void bind( GLenum aTarget, GLuint aIndex ) const noexcept;
+		};
+
+		struct Stats
+		{
+			std::size_t frames;
+			std::size_t stalls; // beginFrame() had to wait for the GPU
+			std::size_t peakBytes; // largest per-frame usage
+		};
+
+	public:
+		RingBuffer() noexcept;
+		explicit RingBuffer( std::size_t aBytesPerFrame );
+
+		~RingBuffer();
+
+		RingBuffer( RingBuffer const& ) = delete;
+		RingBuffer& operator= (RingBuffer const&) = delete;
+
+		RingBuffer( RingBuffer&& ) noexcept;
+		RingBuffer& operator= (RingBuffer&&) noexcept;
+
+	public:
+		// Moves to the next region, waiting for the GPU to finish with it
+		// if necessary.
+		void beginFrame();
+
+		// Sub-allocates aSize bytes from the current region. The default
+		// alignment satisfies both GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT and
+		// GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT. Throws an Error if the
+		// region is full.
+		Range allocate( std::size_t aSize, std::size_t aAlignment = 0 );
+
+		// Makes the data written so far visible to GL. Must be called before
+		// drawing with it.
+		void flush();
+
+		// Places the fence for the current region. Call after the last GL
+		// command that uses the region has been issued.
+		void endFrame();
+
+		bool persistent() const noexcept;
+		std::size_t bytesPerFrame() const noexcept;
+
+		Stats stats() const noexcept;
+
+	private:
+		void release_() noexcept;
+
+	private:
+		GLuint mBuffer;
+		std::byte* mMapped; // persistent mapping, or nullptr
+
+		std::size_t mRegionSize;
+		std::size_t mDefaultAlignment;
+
+		std::size_t mRegion;
+		std::size_t mHead; // within the current region
+		std::size_t mFlushed; // fallback: staged bytes already uploaded
+
+		GLsync mFences[kFrameCount];
+
+		std::vector<std::byte> mStaging; // fallback only
+
+		Stats mStats;
+};
+
+#endif // RING_BUFFER_HPP_6AC060C1_079F_4BE9_88AB_973A5A46F4B9
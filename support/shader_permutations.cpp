@@ -0,0 +1,119 @@
+#include "shader_permutations.hpp"
+
+#include <utility>
+#include <exception>
+
+#include "error.hpp"
+
+ShaderPermutations::ShaderPermutations( std::vector<ShaderProgram::ShaderSource> aSources, std::vector<std::string> aFeatures, ProgramBinaryCache* aCache )
+	: mSources( std::move(aSources) )
+	, mFeatures( std::move(aFeatures) )
+	, mCache( aCache )
+{
+	if( mFeatures.size() > kMaxFeatures )
+		throw Error( "ShaderPermutations: %zu features, but at most %zu are supported", mFeatures.size(), kMaxFeatures );
+}
+
+ShaderPermutations::Key ShaderPermutations::feature( std::string const& aName ) const
+{
+	for( std::size_t i = 0; i < mFeatures.size(); ++i )
+	{
+		if( mFeatures[i] == aName )
+			return Key(1) << i;
+	}
+
+	throw Error( "ShaderPermutations: unknown feature '%s'", aName.c_str() );
+}
+
+void ShaderPermutations::prepare( Key aKey )
+{
+	program( aKey );
+}
+
+ShaderProgram& ShaderPermutations::program( Key aKey )
+{
+	if( auto const it = mPrograms.find( aKey ); mPrograms.end() != it )
+		return it->second;
+
+	if( mFeatures.size() < kMaxFeatures && (aKey >> mFeatures.size()) )
+		throw Error( "ShaderPermutations: key %#x includes unknown features (%zu defined)", unsigned(aKey), mFeatures.size() );
+
+	// Add the enabled features to each stage's defines
+	auto sources = mSources;
+	for( auto& source : sources )
+	{
+		for( std::size_t i = 0; i < mFeatures.size(); ++i )
+		{
+			if( aKey & (Key(1) << i) )
+				source.defines.emplace_back( mFeatures[i] + " 1" );
+		}
+	}
+
+	ShaderProgram prog( std::move(sources), mCache );
+	return mPrograms.emplace( aKey, std::move(prog) ).first->second;
+}
+
+std::size_t ShaderPermutations::featureCount() const noexcept
+{
+	return mFeatures.size();
+}
+std::size_t ShaderPermutations::permutationCount() const noexcept
+{
+	return mPrograms.size();
+}
+
+bool ShaderPermutations::usesFile( std::string const& aPath ) const
+{
+	for( auto const& entry : mPrograms )
+	{
+		if( entry.second.usesFile( aPath ) )
+			return true;
+	}
+
+	return false;
+}
+
+void ShaderPermutations::reloadAsync()
+{
+	std::exception_ptr error;
+
+	for( auto& entry : mPrograms )
+	{
+		try
+		{
+			entry.second.reloadAsync();
+		}
+		catch( Error const& )
+		{
+			if( !error )
+				error = std::current_exception();
+		}
+	}
+
+	if( error )
+		std::rethrow_exception( error );
+}
+
+bool ShaderPermutations::poll()
+{
+	bool ret = false;
+	std::exception_ptr error;
+
+	for( auto& entry : mPrograms )
+	{
+		try
+		{
+			ret = entry.second.poll() || ret;
+		}
+		catch( Error const& )
+		{
+			if( !error )
+				error = std::current_exception();
+		}
+	}
+
+	if( error )
+		std::rethrow_exception( error );
+
+	return ret;
+}
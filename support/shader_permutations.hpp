@@ -0,0 +1,78 @@
+#ifndef SHADER_PERMUTATIONS_HPP_9C8AAD19_56AC_4270_A907_460EF66E9943
+#define SHADER_PERMUTATIONS_HPP_9C8AAD19_56AC_4270_A907_460EF66E9943
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <cstdint>
+
+#include "program.hpp"
+
+/** ShaderPermutations: statically specialized variants of a shader program
+ *
+ * Instead of branching on uniforms at run time, optional features are
+ * compiled in or out with the preprocessor. Each feature is a name, e.g.
+ * "WITH_TEXTURE". A permutation is identified by a Key, a bit mask with bit
+ * i set if feature i is enabled. The enabled features are defined (as 1) in
+ * all shader stages of the permutation, after the #version line (see
+ * preprocess_shader()). The shaders test for them with #if defined(...).
+ *
+ * Example:
+ *
+ *	ShaderPermutations perms( { ...sources... }, { "WITH_TEXTURE", "WITH_SHADOWS" } );
+ *	auto const kTextured = perms.feature( "WITH_TEXTURE" );
+ *	perms.prepare( 0 );
+ *	perms.prepare( kTextured );
+ *	...
+ *	glUseProgram( perms.program( textured ? kTextured : 0 ).programId() );
+ *
+ * Permutations are built (compiled and linked) on first use, and cached.
+ * Building a permutation stalls; use prepare() during loading for the
+ * permutations that will be needed.
+ */
+class ShaderPermutations final
+{
+	public:
+		using Key = std::uint32_t;
+
+		static constexpr std::size_t kMaxFeatures = 32;
+
+	public:
+		explicit ShaderPermutations(
+			std::vector<ShaderProgram::ShaderSource> = {},
+			std::vector<std::string> aFeatures = {},
+			ProgramBinaryCache* = nullptr
+		);
+
+	public:
+		// Bit of the named feature. Throws if there is no such feature.
+		Key feature( std::string const& ) const;
+
+		// Builds the permutation, unless it exists already
+		void prepare( Key );
+
+		// Returns the permutation, building it if necessary
+		ShaderProgram& program( Key );
+
+		std::size_t featureCount() const noexcept;
+		std::size_t permutationCount() const noexcept;
+
+		// Hot reload support; these apply to all permutations that have been
+		// built so far. See ShaderProgram. If any of the permutations fails
+		// to reload, reloadAsync() and poll() throw after all of them have
+		// been handled.
+		bool usesFile( std::string const& aPath ) const;
+
+		void reloadAsync();
+		bool poll();
+
+	private:
+		std::vector<ShaderProgram::ShaderSource> mSources;
+		std::vector<std::string> mFeatures;
+		ProgramBinaryCache* mCache;
+
+		std::unordered_map<Key,ShaderProgram> mPrograms;
+};
+
+#endif // SHADER_PERMUTATIONS_HPP_9C8AAD19_56AC_4270_A907_460EF66E9943
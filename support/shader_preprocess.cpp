@@ -0,0 +1,200 @@
+#include "shader_preprocess.hpp"
+
+#include <filesystem>
+
+#include <cstdio>
+#include <cstring>
+
+#include "error.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	struct State_
+	{
+		PreprocessedShader result;
+		std::vector<std::string> const* defines;
+
+		std::vector<std::size_t> active; // indices of the files being processed
+	};
+
+	std::string load_file_( char const* aPath );
+
+	void process_file_( State_&, std::string const& aPath, std::size_t aFileIndex, bool aTopLevel );
+
+	// Returns the directive's argument if aLine is "#<aDirective> ...",
+	// ignoring whitespace, or nullptr otherwise.
+	char const* match_directive_( char const* aLine, char const* aDirective ) noexcept;
+
+	void append_line_directive_( std::string&, std::size_t aLine, std::size_t aFile );
+	void append_include_guard_( std::string&, std::size_t aFile );
+	void append_defines_( std::string&, std::vector<std::string> const& );
+}
+
+PreprocessedShader preprocess_shader( std::string const& aSourcePath, std::vector<std::string> const& aDefines )
+{
+	State_ state;
+	state.defines = &aDefines;
+
+	state.result.files.emplace_back( fs::path( aSourcePath ).lexically_normal().generic_string() );
+	process_file_( state, aSourcePath, 0, true );
+
+	return std::move(state.result);
+}
+
+namespace
+{
+	void process_file_( State_& aState, std::string const& aPath, std::size_t aFileIndex, bool aTopLevel )
+	{
+		auto& files = aState.result.files;
+		auto& out = aState.result.source;
+
+		aState.active.emplace_back( aFileIndex );
+
+		std::string const text = load_file_( aPath.c_str() );
+
+		// Defines go after the #version line, which must be the first
+		// directive. Without one, they go to the very top.
+		bool pendingDefines = aTopLevel && !aState.defines->empty();
+		if( pendingDefines && std::string::npos == text.find( "#version" ) )
+		{
+			append_defines_( out, *aState.defines );
+			append_line_directive_( out, 1, aFileIndex );
+			pendingDefines = false;
+		}
+
+		std::size_t lineNumber = 0;
+		for( std::size_t pos = 0; pos < text.size(); )
+		{
+			std::size_t end = text.find( '\n', pos );
+			if( std::string::npos == end )
+				end = text.size();
+
+			std::string const line = text.substr( pos, end-pos );
+			pos = end + 1;
+			++lineNumber;
+
+			if( char const* arg = match_directive_( line.c_str(), "include" ) )
+			{
+				char const* const open = std::strchr( arg, '"' );
+				char const* const close = open ? std::strchr( open+1, '"' ) : nullptr;
+				if( !close || open+1 == close )
+					throw Error( "%s:%zu: malformed #include (expected #include \"name\")", aPath.c_str(), lineNumber );
+
+				auto const includePath = (fs::path( aPath ).parent_path() / std::string( open+1, close )).lexically_normal().generic_string();
+
+				std::size_t includeIndex = 0;
+				while( includeIndex < files.size() && files[includeIndex] != includePath )
+					++includeIndex;
+
+				// Include cycle: the file is already being processed
+				bool cycle = false;
+				for( auto const active : aState.active )
+					cycle = cycle || active == includeIndex;
+
+				if( cycle )
+				{
+					out += '\n'; // keeps the line numbers in sync
+					continue;
+				}
+
+				if( includeIndex == files.size() )
+					files.emplace_back( includePath );
+
+				// Repeated includes can't simply be dropped, as the first one
+				// may be in an inactive #if block. Instead, every copy is
+				// wrapped in a guard, which the GLSL compiler evaluates.
+				append_include_guard_( out, includeIndex );
+				append_line_directive_( out, 1, includeIndex );
+				process_file_( aState, includePath, includeIndex, false );
+				out += "#endif\n";
+				append_line_directive_( out, lineNumber+1, aFileIndex );
+				continue;
+			}
+
+			out += line;
+			out += '\n';
+
+			if( pendingDefines && match_directive_( line.c_str(), "version" ) )
+			{
+				append_defines_( out, *aState.defines );
+				append_line_directive_( out, lineNumber+1, aFileIndex );
+				pendingDefines = false;
+			}
+		}
+
+		aState.active.pop_back();
+	}
+
+	char const* match_directive_( char const* aLine, char const* aDirective ) noexcept
+	{
+		while( ' ' == *aLine || '\t' == *aLine )
+			++aLine;
+
+		if( '#' != *aLine++ )
+			return nullptr;
+
+		while( ' ' == *aLine || '\t' == *aLine )
+			++aLine;
+
+		std::size_t const len = std::strlen( aDirective );
+		if( 0 != std::strncmp( aLine, aDirective, len ) )
+			return nullptr;
+
+		// Must be followed by whitespace or the end of the line (so that
+		// #included doesn't match #include)
+		char const next = aLine[len];
+		if( '\0' != next && ' ' != next && '\t' != next && '\r' != next && '"' != next )
+			return nullptr;
+
+		return aLine + len;
+	}
+
+	void append_line_directive_( std::string& aOut, std::size_t aLine, std::size_t aFile )
+	{
+		char buffer[64];
+		std::snprintf( buffer, sizeof(buffer), "#line %zu %zu\n", aLine, aFile );
+		aOut += buffer;
+	}
+
+	void append_include_guard_( std::string& aOut, std::size_t aFile )
+	{
+		char buffer[128];
+		std::snprintf( buffer, sizeof(buffer), "#ifndef SHADER_PREPROCESS_INCLUDED_%zu\n#define SHADER_PREPROCESS_INCLUDED_%zu\n", aFile, aFile );
+		aOut += buffer;
+	}
+
+	void append_defines_( std::string& aOut, std::vector<std::string> const& aDefines )
+	{
+		for( auto const& define : aDefines )
+		{
+			aOut += "#define ";
+			aOut += define;
+			aOut += '\n';
+		}
+	}
+
+	std::string load_file_( char const* aPath )
+	{
+		std::string ret;
+
+		std::FILE* fin = std::fopen( aPath, "rb" );
+		if( !fin )
+			throw Error( "preprocess_shader(): unable to open input file '%s'", aPath );
+
+		std::fseek( fin, 0, SEEK_END );
+		auto const length = std::size_t(std::ftell( fin ));
+		std::fseek( fin, 0, SEEK_SET );
+
+		ret.resize( length );
+		std::size_t const read = std::fread( ret.data(), 1, length, fin );
+		int const err = std::ferror( fin );
+		std::fclose( fin );
+
+		if( read != length )
+			throw Error( "preprocess_shader(): error while reading from '%s': %d (%zu bytes read, %zu total)", aPath, err, read, length );
+
+		return ret;
+	}
+}
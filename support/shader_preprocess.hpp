@@ -0,0 +1,46 @@
+#ifndef SHADER_PREPROCESS_HPP_D79B530C_EF05_44FA_92A9_3AC34F1CA501
+#define SHADER_PREPROCESS_HPP_D79B530C_EF05_44FA_92A9_3AC34F1CA501
+
+#include <string>
+#include <vector>
+
+/* Minimal shader preprocessor
+ *
+ * GLSL itself has no #include (without ARB_shading_language_include), and
+ * defines can only be set by editing the source. preprocess_shader() loads
+ * a shader source file and
+ *
+ *  - replaces #include "name" lines with the contents of the named file.
+ *    The name is relative to the directory of the file that contains the
+ *    #include; for the shaders in assets/, includes are thus resolved from
+ *    assets/. Each file is included at most once (as if it contained
+ *    "#pragma once"), so shared declarations can be included freely. This
+ *    is implemented with generated include guards (named
+ *    SHADER_PREPROCESS_INCLUDED_<N>), so that it also works if the first
+ *    #include is in an inactive #if block. Include cycles are broken by
+ *    skipping the #include that closes the cycle.
+ *  - inserts a #define for each of aDefines directly after the #version
+ *    line (or at the top, if there is none). Entries are either "NAME" or
+ *    "NAME VALUE".
+ *
+ * #line directives keep the line numbers in compiler logs intact. The
+ * source string number N in a log ("N(line)" or "N:line", depending on the
+ * driver) refers to files[N]. Each file appears once in files, even if it is
+ * included several times.
+ *
+ * Only lines that start with #include (ignoring whitespace) are handled;
+ * they are expanded even inside block comments and inactive #if blocks. Errors (e.g.
+ * missing files) throw an Error.
+ */
+struct PreprocessedShader
+{
+	std::string source;
+	std::vector<std::string> files; // [0] is the shader itself
+};
+
+PreprocessedShader preprocess_shader(
+	std::string const& aSourcePath,
+	std::vector<std::string> const& aDefines = {}
+);
+
+#endif // SHADER_PREPROCESS_HPP_D79B530C_EF05_44FA_92A9_3AC34F1CA501
@@ -0,0 +1,72 @@
+#include "uniform_buffer.hpp"
+
+#include <utility>
+
+#include "error.hpp"
+#include "program_reflection.hpp"
+
+UniformBufferBase::UniformBufferBase( GLuint aBinding, std::size_t aSize )
+	: mBuffer( 0 )
+	, mBinding( aBinding )
+	, mSize( aSize )
+{
+	glGenBuffers( 1, &mBuffer );
+	glBindBuffer( GL_UNIFORM_BUFFER, mBuffer );
+	glBufferData( GL_UNIFORM_BUFFER, GLsizeiptr(mSize), nullptr, GL_DYNAMIC_DRAW );
+	glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+
+	bind();
+}
+
+UniformBufferBase::~UniformBufferBase()
+{
+	if( 0 != mBuffer )
+		glDeleteBuffers( 1, &mBuffer );
+}
+
+UniformBufferBase::UniformBufferBase( UniformBufferBase&& aOther ) noexcept
+	: mBuffer( std::exchange( aOther.mBuffer, 0 ) )
+	, mBinding( aOther.mBinding )
+	, mSize( aOther.mSize )
+{}
+UniformBufferBase& UniformBufferBase::operator= (UniformBufferBase&& aOther) noexcept
+{
+	std::swap( mBuffer, aOther.mBuffer );
+	std::swap( mBinding, aOther.mBinding );
+	std::swap( mSize, aOther.mSize );
+	return *this;
+}
+
+GLuint UniformBufferBase::bufferId() const noexcept
+{
+	return mBuffer;
+}
+GLuint UniformBufferBase::binding() const noexcept
+{
+	return mBinding;
+}
+
+void UniformBufferBase::bind() const noexcept
+{
+	glBindBufferBase( GL_UNIFORM_BUFFER, mBinding, mBuffer );
+}
+
+void UniformBufferBase::validate( ProgramReflection const& aReflection, char const* aBlockName ) const
+{
+	auto const* block = aReflection.uniformBlock( aBlockName );
+	if( !block )
+		return;
+
+	if( std::size_t(block->dataSize) != mSize )
+		throw Error( "Uniform block '%s' is %d bytes, but the buffer is %zu bytes (check the std140 padding)", aBlockName, block->dataSize, mSize );
+
+	if( GLuint(block->binding) != mBinding )
+		throw Error( "Uniform block '%s' uses binding %d, but the buffer is bound to %u", aBlockName, block->binding, mBinding );
+}
+
+void UniformBufferBase::upload_( void const* aData ) noexcept
+{
+	glBindBuffer( GL_UNIFORM_BUFFER, mBuffer );
+	glBufferSubData( GL_UNIFORM_BUFFER, 0, GLsizeiptr(mSize), aData );
+	glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+}
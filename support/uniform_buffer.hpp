@@ -0,0 +1,107 @@
+#ifndef UNIFORM_BUFFER_HPP_5FAD0AAE_5C6D_4DCB_9174_B727F2F24F4A
+#define UNIFORM_BUFFER_HPP_5FAD0AAE_5C6D_4DCB_9174_B727F2F24F4A
+
+#include <glad.h>
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+class ProgramReflection;
+
+/** UniformBuffer: typed uniform buffer object
+ *
+ * Holds a tData in a uniform buffer that is bound to a fixed binding point.
+ * Data that is the same for all programs (e.g. camera and light parameters)
+ * is written once per frame with update(), instead of being set with
+ * glUniform*() for each program. update() skips the upload if the data has
+ * not changed.
+ *
+ * tData must match the shader's block declaration in the std140 layout:
+ * vec3 members are padded to 16 bytes, and array elements are 16-byte
+ * aligned. Mat44f can be used for mat4 members if the block is declared
+ * row_major. validate() checks the block's size and binding against a
+ * program's reflection data.
+ *
+ * Requires a current OpenGL context.
+ */
+class UniformBufferBase
+{
+	public:
+		UniformBufferBase( GLuint aBinding, std::size_t aSize );
+		~UniformBufferBase();
+
+		UniformBufferBase( UniformBufferBase const& ) = delete;
+		UniformBufferBase& operator= (UniformBufferBase const&) = delete;
+
+		UniformBufferBase( UniformBufferBase&& ) noexcept;
+		UniformBufferBase& operator= (UniformBufferBase&&) noexcept;
+
+	public:
+		GLuint bufferId() const noexcept;
+		GLuint binding() const noexcept;
+
+		// (Re-)binds the buffer to its binding point. The constructor does so
+		// already; this is only necessary if the binding was changed since.
+		void bind() const noexcept;
+
+		// Throws an Error if aBlockName is active in the program, but doesn't
+		// match the buffer's size or binding. Blocks that are not active are
+		// accepted (the compiler may remove unused blocks).
+		void validate( ProgramReflection const&, char const* aBlockName ) const;
+
+	protected:
+		void upload_( void const* aData ) noexcept;
+
+	private:
+		GLuint mBuffer;
+		GLuint mBinding;
+		std::size_t mSize;
+};
+
+template< typename tData >
+class UniformBuffer final : public UniformBufferBase
+{
+	static_assert( std::is_trivially_copyable_v<tData> );
+	static_assert( 0 == sizeof(tData) % 16, "std140 blocks are padded to multiples of 16 bytes" );
+
+	public:
+		explicit UniformBuffer( GLuint aBinding );
+
+	public:
+		void update( tData const& );
+
+		tData const& data() const noexcept;
+
+	private:
+		tData mData;
+		bool mValid;
+};
+
+
+template< typename tData > inline
+UniformBuffer<tData>::UniformBuffer( GLuint aBinding )
+	: UniformBufferBase( aBinding, sizeof(tData) )
+	, mData{}
+	, mValid( false )
+{}
+
+template< typename tData > inline
+void UniformBuffer<tData>::update( tData const& aData )
+{
+	// Skip redundant uploads
+	if( mValid && 0 == std::memcmp( &mData, &aData, sizeof(tData) ) )
+		return;
+
+	mData = aData;
+	mValid = true;
+	upload_( &mData );
+}
+
+template< typename tData > inline
+tData const& UniformBuffer<tData>::data() const noexcept
+{
+	return mData;
+}
+
+#endif // UNIFORM_BUFFER_HPP_5FAD0AAE_5C6D_4DCB_9174_B727F2F24F4A
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <string>
+#include <typeinfo>
+#include <exception>
+
+#include <cstdio>
+#include <cstring>
+
+#include "../support/error.hpp"
+
+#include "../texlib/texture_cache.hpp"
+
+/* texbake: offline texture cache generation
+ *
+ * Converts images (anything stb_image can decode) into the texture cache
+ * format (see texlib/texture_cache.hpp), with a precomputed sRGB-correct mip
+ * chain and optional block compression. main generates missing caches on
+ * demand; this tool allows doing so ahead of time, e.g. as a build step.
+ */
+
+namespace
+{
+	void print_usage_( char const* aProgram )
+	{
+		std::fprintf( stderr, "Usage: %s [--format rgba8|bc1|bc7] [--force] <image> [output.texcache]\n", aProgram );
+		std::fprintf( stderr, "  --format  storage format (default: bc7)\n" );
+		std::fprintf( stderr, "  --force   regenerate the cache even if it is up to date\n" );
+		std::fprintf( stderr, "The output defaults to <image>.<format>.texcache. Only the default\n" );
+		std::fprintf( stderr, "location is picked up automatically by main.\n" );
+	}
+
+	bool parse_format_( char const* aName, TextureCacheFormat& aFormat ) noexcept
+	{
+		for( auto const fmt : { TextureCacheFormat::kRgba8Srgb, TextureCacheFormat::kBc1Srgb, TextureCacheFormat::kBc7Srgb } )
+		{
+			if( 0 == std::strcmp( aName, to_string( fmt ) ) )
+			{
+				aFormat = fmt;
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+int main( int aArgc, char* aArgv[] ) try
+{
+	bool force = false;
+	TextureCacheFormat format = TextureCacheFormat::kBc7Srgb;
+	char const* input = nullptr;
+	char const* output = nullptr;
+
+	for( int i = 1; i < aArgc; ++i )
+	{
+		if( 0 == std::strcmp( aArgv[i], "--force" ) )
+			force = true;
+		else if( 0 == std::strcmp( aArgv[i], "--format" ) && i+1 < aArgc )
+		{
+			if( !parse_format_( aArgv[++i], format ) )
+			{
+				print_usage_( aArgv[0] );
+				return 2;
+			}
+		}
+		else if( 0 == std::strcmp( aArgv[i], "--help" ) || 0 == std::strcmp( aArgv[i], "-h" ) )
+		{
+			print_usage_( aArgv[0] );
+			return 0;
+		}
+		else if( !input )
+			input = aArgv[i];
+		else if( !output )
+			output = aArgv[i];
+		else
+		{
+			print_usage_( aArgv[0] );
+			return 2;
+		}
+	}
+
+	if( !input )
+	{
+		print_usage_( aArgv[0] );
+		return 2;
+	}
+
+	std::string const outPath = output ? std::string(output) : texture_cache_path( input, format );
+
+	if( !force )
+	{
+		try
+		{
+			TextureCache const cache( outPath.c_str() );
+			if( cache.format() == format && is_texture_cache_current( cache ) )
+			{
+				std::printf( "%s: up to date\n", outPath.c_str() );
+				return 0;
+			}
+		}
+		catch( Error const& )
+		{
+			// Missing or invalid; regenerate below.
+		}
+	}
+
+	auto const start = std::chrono::steady_clock::now();
+	build_texture_cache( input, outPath.c_str(), format );
+	auto const end = std::chrono::steady_clock::now();
+
+	TextureCache const cache( outPath.c_str() );
+	std::printf( "%s: %ux%u, %zu levels, %s, %.2f MiB (%.1f ms)\n", 
+		outPath.c_str(),
+		cache.width(),
+		cache.height(),
+		cache.levelCount(),
+		to_string( cache.format() ),
+		cache.dataBytes() / (1024.0 * 1024.0),
+		std::chrono::duration<double, std::milli>( end - start ).count()
+	);
+
+	return 0;
+}
+catch( std::exception const& eErr )
+{
+	std::fprintf( stderr, "Top-level Exception (%s):\n", typeid(eErr).name() );
+	std::fprintf( stderr, "%s\n", eErr.what() );
+	std::fprintf( stderr, "Bye.\n" );
+	return 1;
+}
@@ -0,0 +1,530 @@
+#include "block_compress.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// Weights for 4-bit BC7 indices, out of 64
+	constexpr int kBc7Weights4_[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Principal axis of aCount points with aDim channels, by power
+	// iteration on the covariance matrix. Returns false for (near-)constant
+	// input. aMean receives the mean.
+	template< int tDim >
+	bool principal_axis_( std::uint8_t const* aRgba, float (&aMean)[tDim], float (&aAxis)[tDim] ) noexcept
+	{
+		for( int c = 0; c < tDim; ++c )
+		{
+			float sum = 0.f;
+			for( int i = 0; i < 16; ++i )
+				sum += float(aRgba[i*4+c]);
+			aMean[c] = sum / 16.f;
+		}
+
+		float cov[tDim][tDim] = {};
+		for( int i = 0; i < 16; ++i )
+		{
+			float d[tDim];
+			for( int c = 0; c < tDim; ++c )
+				d[c] = float(aRgba[i*4+c]) - aMean[c];
+
+			for( int r = 0; r < tDim; ++r )
+			{
+				for( int c = 0; c < tDim; ++c )
+					cov[r][c] += d[r] * d[c];
+			}
+		}
+
+		// Start with the channel that varies the most.
+		int maxc = 0;
+		for( int c = 1; c < tDim; ++c )
+		{
+			if( cov[c][c] > cov[maxc][maxc] )
+				maxc = c;
+		}
+
+		if( cov[maxc][maxc] < 1e-3f )
+			return false;
+
+		for( int c = 0; c < tDim; ++c )
+			aAxis[c] = cov[maxc][c];
+
+		for( int iter = 0; iter < 8; ++iter )
+		{
+			float next[tDim] = {};
+			float len2 = 0.f;
+			for( int r = 0; r < tDim; ++r )
+			{
+				for( int c = 0; c < tDim; ++c )
+					next[r] += cov[r][c] * aAxis[c];
+				len2 += next[r] * next[r];
+			}
+
+			if( len2 <= 0.f )
+				break;
+
+			float const rcp = 1.f / std::sqrt( len2 );
+			for( int c = 0; c < tDim; ++c )
+				aAxis[c] = next[c] * rcp;
+		}
+
+		return true;
+	}
+
+	// Endpoints of the line fit through the block: the extreme projections
+	// onto the principal axis.
+	template< int tDim >
+	void fit_line_( std::uint8_t const* aRgba, float (&aLo)[tDim], float (&aHi)[tDim] ) noexcept
+	{
+		float mean[tDim], axis[tDim];
+		if( !principal_axis_( aRgba, mean, axis ) )
+		{
+			for( int c = 0; c < tDim; ++c )
+				aLo[c] = aHi[c] = mean[c];
+			return;
+		}
+
+		float tmin = 0.f, tmax = 0.f;
+		for( int i = 0; i < 16; ++i )
+		{
+			float t = 0.f;
+			for( int c = 0; c < tDim; ++c )
+				t += (float(aRgba[i*4+c]) - mean[c]) * axis[c];
+
+			tmin = std::min( tmin, t );
+			tmax = std::max( tmax, t );
+		}
+
+		for( int c = 0; c < tDim; ++c )
+		{
+			aLo[c] = std::clamp( mean[c] + tmin * axis[c], 0.f, 255.f );
+			aHi[c] = std::clamp( mean[c] + tmax * axis[c], 0.f, 255.f );
+		}
+	}
+
+	int distance2_( std::uint8_t const* aA, std::uint8_t const* aB, int aChannels ) noexcept
+	{
+		int ret = 0;
+		for( int c = 0; c < aChannels; ++c )
+		{
+			int const d = int(aA[c]) - int(aB[c]);
+			ret += d*d;
+		}
+		return ret;
+	}
+
+	// BC1 helpers
+	std::uint16_t pack_565_( float const (&aRgb)[3] ) noexcept
+	{
+		auto const r = std::uint16_t(std::lround( aRgb[0] * (31.f/255.f) ));
+		auto const g = std::uint16_t(std::lround( aRgb[1] * (63.f/255.f) ));
+		auto const b = std::uint16_t(std::lround( aRgb[2] * (31.f/255.f) ));
+		return std::uint16_t((r << 11) | (g << 5) | b);
+	}
+	void unpack_565_( std::uint16_t aValue, std::uint8_t* aRgba ) noexcept
+	{
+		unsigned const r = (aValue >> 11) & 31, g = (aValue >> 5) & 63, b = aValue & 31;
+		aRgba[0] = std::uint8_t((r << 3) | (r >> 2));
+		aRgba[1] = std::uint8_t((g << 2) | (g >> 4));
+		aRgba[2] = std::uint8_t((b << 3) | (b >> 2));
+		aRgba[3] = 255;
+	}
+
+	void bc1_palette_( std::uint16_t aC0, std::uint16_t aC1, std::uint8_t (&aPalette)[4][4] ) noexcept
+	{
+		unpack_565_( aC0, aPalette[0] );
+		unpack_565_( aC1, aPalette[1] );
+
+		for( int c = 0; c < 3; ++c )
+		{
+			int const a = aPalette[0][c], b = aPalette[1][c];
+			if( aC0 > aC1 )
+			{
+				aPalette[2][c] = std::uint8_t((2*a + b) / 3);
+				aPalette[3][c] = std::uint8_t((a + 2*b) / 3);
+			}
+			else
+			{
+				aPalette[2][c] = std::uint8_t((a + b) / 2);
+				aPalette[3][c] = 0;
+			}
+		}
+
+		aPalette[2][3] = 255;
+		aPalette[3][3] = aC0 > aC1 ? 255 : 0;
+	}
+
+	// BC7 bit I/O. Blocks are little endian bit streams.
+	struct BitWriter_
+	{
+		std::uint8_t* out;
+		unsigned pos = 0;
+
+		void put( unsigned aValue, unsigned aBits ) noexcept
+		{
+			for( unsigned i = 0; i < aBits; ++i, ++pos )
+			{
+				if( (aValue >> i) & 1u )
+					out[pos/8] |= std::uint8_t(1u << (pos%8));
+			}
+		}
+	};
+	struct BitReader_
+	{
+		std::uint8_t const* in;
+		unsigned pos = 0;
+
+		unsigned get( unsigned aBits ) noexcept
+		{
+			unsigned ret = 0;
+			for( unsigned i = 0; i < aBits; ++i, ++pos )
+				ret |= unsigned((in[pos/8] >> (pos%8)) & 1u) << i;
+			return ret;
+		}
+	};
+
+	int bc7_interpolate_( int aE0, int aE1, int aWeight ) noexcept
+	{
+		return ((64 - aWeight) * aE0 + aWeight * aE1 + 32) >> 6;
+	}
+
+	// Quantizes an endpoint to 7 bits per channel plus a shared p-bit,
+	// choosing the p-bit with the lower error.
+	void bc7_quantize_endpoint_( float const (&aValue)[4], int (&aQ)[4], int& aP ) noexcept
+	{
+		float bestErr = 0.f;
+		for( int p = 0; p < 2; ++p )
+		{
+			int q[4];
+			float err = 0.f;
+			for( int c = 0; c < 4; ++c )
+			{
+				q[c] = std::clamp( int(std::lround( (aValue[c] - float(p)) * 0.5f )), 0, 127 );
+				float const d = float(q[c]*2 + p) - aValue[c];
+				err += d*d;
+			}
+
+			if( 0 == p || err < bestErr )
+			{
+				bestErr = err;
+				aP = p;
+				std::copy_n( q, 4, aQ );
+			}
+		}
+	}
+
+	struct Bc7Mode6_
+	{
+		int q[2][4]; // 7-bit endpoints
+		int p[2];
+		int index[16];
+	};
+
+	// Solid blocks can (almost) always be encoded exactly by interpolating
+	// between an even and an odd endpoint; the search below finds such a
+	// combination. Returns false if there is none.
+	bool bc7_fit_solid_( std::uint8_t const* aColor, Bc7Mode6_& aOut ) noexcept
+	{
+		for( int k = 0; k < 16; ++k )
+		{
+			for( int pc = 0; pc < 4; ++pc )
+			{
+				int const p0 = pc & 1, p1 = pc >> 1;
+
+				bool ok = true;
+				for( int c = 0; c < 4 && ok; ++c )
+				{
+					int const target = aColor[c];
+
+					ok = false;
+					for( int q0 = std::max( 0, target/2 - 4 ); q0 <= std::min( 127, target/2 + 4 ) && !ok; ++q0 )
+					{
+						for( int q1 = std::max( 0, target/2 - 4 ); q1 <= std::min( 127, target/2 + 4 ) && !ok; ++q1 )
+						{
+							if( bc7_interpolate_( q0*2 + p0, q1*2 + p1, kBc7Weights4_[k] ) == target )
+							{
+								aOut.q[0][c] = q0;
+								aOut.q[1][c] = q1;
+								ok = true;
+							}
+						}
+					}
+				}
+
+				if( ok )
+				{
+					aOut.p[0] = p0;
+					aOut.p[1] = p1;
+					std::fill_n( aOut.index, 16, k );
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	void bc7_fit_line_( std::uint8_t const* aRgba, Bc7Mode6_& aOut ) noexcept
+	{
+		float lo[4], hi[4];
+		fit_line_<4>( aRgba, lo, hi );
+
+		bc7_quantize_endpoint_( lo, aOut.q[0], aOut.p[0] );
+		bc7_quantize_endpoint_( hi, aOut.q[1], aOut.p[1] );
+
+		std::uint8_t e[2][4];
+		for( int c = 0; c < 4; ++c )
+		{
+			e[0][c] = std::uint8_t(aOut.q[0][c]*2 + aOut.p[0]);
+			e[1][c] = std::uint8_t(aOut.q[1][c]*2 + aOut.p[1]);
+		}
+
+		std::uint8_t palette[16][4];
+		for( int k = 0; k < 16; ++k )
+		{
+			for( int c = 0; c < 4; ++c )
+				palette[k][c] = std::uint8_t(bc7_interpolate_( e[0][c], e[1][c], kBc7Weights4_[k] ));
+		}
+
+		for( int i = 0; i < 16; ++i )
+		{
+			int best = 0, bestErr = distance2_( aRgba + i*4, palette[0], 4 );
+			for( int k = 1; k < 16; ++k )
+			{
+				int const err = distance2_( aRgba + i*4, palette[k], 4 );
+				if( err < bestErr )
+				{
+					best = k;
+					bestErr = err;
+				}
+			}
+			aOut.index[i] = best;
+		}
+	}
+
+	bool is_solid_( std::uint8_t const* aRgba ) noexcept
+	{
+		for( int i = 1; i < 16; ++i )
+		{
+			if( 0 != std::memcmp( aRgba, aRgba + i*4, 4 ) )
+				return false;
+		}
+		return true;
+	}
+
+	// Copies the 4x4 block at (aBx,aBy) into aOut, clamping at the edges.
+	void gather_block_( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight, std::uint32_t aBx, std::uint32_t aBy, std::uint8_t* aOut ) noexcept
+	{
+		for( std::uint32_t y = 0; y < 4; ++y )
+		{
+			std::uint32_t const sy = std::min( aBy*4 + y, aHeight-1 );
+			for( std::uint32_t x = 0; x < 4; ++x )
+			{
+				std::uint32_t const sx = std::min( aBx*4 + x, aWidth-1 );
+				std::memcpy( aOut + (y*4 + x)*4, aRgba + (std::size_t(sy)*aWidth + sx)*4, 4 );
+			}
+		}
+	}
+}
+
+std::size_t block_bytes( BlockFormat aFormat ) noexcept
+{
+	return BlockFormat::kBc1 == aFormat ? kBc1BlockBytes : kBc7BlockBytes;
+}
+
+std::size_t compressed_size( std::uint32_t aWidth, std::uint32_t aHeight, BlockFormat aFormat ) noexcept
+{
+	return std::size_t((aWidth+3)/4) * ((aHeight+3)/4) * block_bytes( aFormat );
+}
+
+
+void encode_bc1_block( std::uint8_t const* aRgba, std::uint8_t* aOut ) noexcept
+{
+	float lo[3], hi[3];
+	fit_line_<3>( aRgba, lo, hi );
+
+	// Inset the endpoints slightly; the extremes are rarely hit exactly after
+	// quantization, and pulling them in reduces the error of the interior.
+	for( int c = 0; c < 3; ++c )
+	{
+		float const inset = (hi[c] - lo[c]) / 16.f;
+		lo[c] += inset;
+		hi[c] -= inset;
+	}
+
+	std::uint16_t c0 = pack_565_( hi ), c1 = pack_565_( lo );
+	if( c0 < c1 )
+		std::swap( c0, c1 );
+
+	std::uint32_t indices = 0;
+	if( c0 != c1 )
+	{
+		std::uint8_t palette[4][4];
+		bc1_palette_( c0, c1, palette );
+
+		for( int i = 0; i < 16; ++i )
+		{
+			int best = 0, bestErr = distance2_( aRgba + i*4, palette[0], 3 );
+			for( int k = 1; k < 4; ++k )
+			{
+				int const err = distance2_( aRgba + i*4, palette[k], 3 );
+				if( err < bestErr )
+				{
+					best = k;
+					bestErr = err;
+				}
+			}
+			indices |= std::uint32_t(best) << (i*2);
+		}
+	}
+
+	// c0 == c1 selects the three-color mode, but index 0 (all zeros) is c0
+	// in both modes.
+	aOut[0] = std::uint8_t(c0 & 0xff);
+	aOut[1] = std::uint8_t(c0 >> 8);
+	aOut[2] = std::uint8_t(c1 & 0xff);
+	aOut[3] = std::uint8_t(c1 >> 8);
+	std::memcpy( aOut + 4, &indices, 4 );
+}
+
+void decode_bc1_block( std::uint8_t const* aBlock, std::uint8_t* aRgba ) noexcept
+{
+	auto const c0 = std::uint16_t(aBlock[0] | (aBlock[1] << 8));
+	auto const c1 = std::uint16_t(aBlock[2] | (aBlock[3] << 8));
+
+	std::uint32_t indices;
+	std::memcpy( &indices, aBlock + 4, 4 );
+
+	std::uint8_t palette[4][4];
+	bc1_palette_( c0, c1, palette );
+
+	for( int i = 0; i < 16; ++i )
+		std::memcpy( aRgba + i*4, palette[(indices >> (i*2)) & 3u], 4 );
+}
+
+
+void encode_bc7_block( std::uint8_t const* aRgba, std::uint8_t* aOut ) noexcept
+{
+	Bc7Mode6_ enc;
+	if( !is_solid_( aRgba ) || !bc7_fit_solid_( aRgba, enc ) )
+		bc7_fit_line_( aRgba, enc );
+
+	// The anchor (first) index is stored with one bit less; its MSB must be
+	// zero. Swapping the endpoints inverts the indices.
+	if( enc.index[0] >= 8 )
+	{
+		std::swap( enc.q[0], enc.q[1] );
+		std::swap( enc.p[0], enc.p[1] );
+		for( auto& idx : enc.index )
+			idx = 15 - idx;
+	}
+
+	std::memset( aOut, 0, kBc7BlockBytes );
+	BitWriter_ bits{ aOut };
+
+	bits.put( 1u << 6, 7 ); // mode 6
+	for( int c = 0; c < 4; ++c )
+	{
+		bits.put( unsigned(enc.q[0][c]), 7 );
+		bits.put( unsigned(enc.q[1][c]), 7 );
+	}
+	bits.put( unsigned(enc.p[0]), 1 );
+	bits.put( unsigned(enc.p[1]), 1 );
+
+	bits.put( unsigned(enc.index[0]), 3 );
+	for( int i = 1; i < 16; ++i )
+		bits.put( unsigned(enc.index[i]), 4 );
+}
+
+bool decode_bc7_block( std::uint8_t const* aBlock, std::uint8_t* aRgba ) noexcept
+{
+	BitReader_ bits{ aBlock };
+	if( (1u << 6) != bits.get( 7 ) )
+	{
+		for( int i = 0; i < 16; ++i )
+		{
+			aRgba[i*4+0] = 255;
+			aRgba[i*4+1] = 0;
+			aRgba[i*4+2] = 255;
+			aRgba[i*4+3] = 255;
+		}
+		return false;
+	}
+
+	int q[2][4];
+	for( int c = 0; c < 4; ++c )
+	{
+		q[0][c] = int(bits.get( 7 ));
+		q[1][c] = int(bits.get( 7 ));
+	}
+
+	int const p0 = int(bits.get( 1 ));
+	int const p1 = int(bits.get( 1 ));
+
+	for( int i = 0; i < 16; ++i )
+	{
+		int const idx = int(bits.get( 0 == i ? 3 : 4 ));
+		for( int c = 0; c < 4; ++c )
+			aRgba[i*4+c] = std::uint8_t(bc7_interpolate_( q[0][c]*2 + p0, q[1][c]*2 + p1, kBc7Weights4_[idx] ));
+	}
+
+	return true;
+}
+
+
+std::vector<std::uint8_t> compress_image( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight, BlockFormat aFormat )
+{
+	std::uint32_t const bw = (aWidth+3)/4, bh = (aHeight+3)/4;
+	std::size_t const bytes = block_bytes( aFormat );
+
+	std::vector<std::uint8_t> ret( compressed_size( aWidth, aHeight, aFormat ) );
+
+	std::uint8_t block[64];
+	for( std::uint32_t by = 0; by < bh; ++by )
+	{
+		for( std::uint32_t bx = 0; bx < bw; ++bx )
+		{
+			gather_block_( aRgba, aWidth, aHeight, bx, by, block );
+
+			std::uint8_t* out = ret.data() + (std::size_t(by)*bw + bx) * bytes;
+			if( BlockFormat::kBc1 == aFormat )
+				encode_bc1_block( block, out );
+			else
+				encode_bc7_block( block, out );
+		}
+	}
+
+	return ret;
+}
+
+std::vector<std::uint8_t> decompress_image( std::uint8_t const* aBlocks, std::uint32_t aWidth, std::uint32_t aHeight, BlockFormat aFormat )
+{
+	std::uint32_t const bw = (aWidth+3)/4, bh = (aHeight+3)/4;
+	std::size_t const bytes = block_bytes( aFormat );
+
+	std::vector<std::uint8_t> ret( std::size_t(aWidth) * aHeight * 4 );
+
+	std::uint8_t block[64];
+	for( std::uint32_t by = 0; by < bh; ++by )
+	{
+		for( std::uint32_t bx = 0; bx < bw; ++bx )
+		{
+			std::uint8_t const* in = aBlocks + (std::size_t(by)*bw + bx) * bytes;
+			if( BlockFormat::kBc1 == aFormat )
+				decode_bc1_block( in, block );
+			else
+				decode_bc7_block( in, block );
+
+			for( std::uint32_t y = 0; y < 4 && by*4 + y < aHeight; ++y )
+			{
+				for( std::uint32_t x = 0; x < 4 && bx*4 + x < aWidth; ++x )
+					std::memcpy( ret.data() + ((std::size_t(by*4 + y))*aWidth + bx*4 + x)*4, block + (y*4 + x)*4, 4 );
+			}
+		}
+	}
+
+	return ret;
+}
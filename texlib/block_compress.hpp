@@ -0,0 +1,55 @@
+#ifndef BLOCK_COMPRESS_HPP_2C7F4E1B_8A6D_4F35_93B2_D15E07A8C6F4
+#define BLOCK_COMPRESS_HPP_2C7F4E1B_8A6D_4F35_93B2_D15E07A8C6F4
+
+#include <vector>
+
+#include <cstddef>
+#include <cstdint>
+
+/* BC1 and BC7 block compression
+ *
+ * Both formats encode 4x4 pixel blocks. Blocks are fit in the encoded (sRGB)
+ * space; GL decodes the interpolated values with the sRGB variants of the
+ * formats (GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_ALPHA_BPTC_
+ * UNORM).
+ *
+ *  - BC1: 8 bytes per block (4 bits per pixel), RGB only. Always uses the
+ *    opaque four-color mode.
+ *  - BC7: 16 bytes per block (8 bits per pixel), RGBA. The encoder only uses
+ *    mode 6 (a single RGBA line with 4-bit indices). This is a fraction of
+ *    what BC7 can do, but compresses quickly and is a good fit for smooth
+ *    content. The decoder correspondingly only handles mode 6 blocks.
+ *
+ * Partial blocks at the right/bottom edges of an image are padded by
+ * repeating the last column/row.
+ *
+ * The encoders are intended for offline use (see texbake); they favour
+ * simplicity over quality. Blocks are stored in the same order as the image
+ * rows, which is what glCompressedTexSubImage2D() expects.
+ */
+
+enum class BlockFormat
+{
+	kBc1,
+	kBc7
+};
+
+constexpr std::size_t kBc1BlockBytes = 8;
+constexpr std::size_t kBc7BlockBytes = 16;
+
+std::size_t block_bytes( BlockFormat ) noexcept;
+std::size_t compressed_size( std::uint32_t aWidth, std::uint32_t aHeight, BlockFormat ) noexcept;
+
+// Single blocks. aRgba points to 16 RGBA8 pixels (64 bytes), in row order.
+void encode_bc1_block( std::uint8_t const* aRgba, std::uint8_t* aOut ) noexcept;
+void decode_bc1_block( std::uint8_t const* aBlock, std::uint8_t* aRgba ) noexcept;
+
+void encode_bc7_block( std::uint8_t const* aRgba, std::uint8_t* aOut ) noexcept;
+// Returns false (and writes opaque magenta) for modes other than mode 6.
+bool decode_bc7_block( std::uint8_t const* aBlock, std::uint8_t* aRgba ) noexcept;
+
+// Whole images (RGBA8, tightly packed).
+std::vector<std::uint8_t> compress_image( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight, BlockFormat );
+std::vector<std::uint8_t> decompress_image( std::uint8_t const* aBlocks, std::uint32_t aWidth, std::uint32_t aHeight, BlockFormat );
+
+#endif // BLOCK_COMPRESS_HPP_2C7F4E1B_8A6D_4F35_93B2_D15E07A8C6F4
@@ -0,0 +1,223 @@
+#include "mip_chain.hpp"
+
+#include <algorithm>
+
+#include <cmath>
+#include <cstring>
+
+#include "../vmlib/simd.hpp"
+
+namespace
+{
+	// sRGB8 -> linear float. Entries 256-511 are for alpha (i/255), such
+	// that a pixel's four channels can be looked up with the same table.
+	struct ToLinearTable_
+	{
+		ToLinearTable_() noexcept
+		{
+			for( int i = 0; i < 256; ++i )
+			{
+				float const c = float(i) / 255.f;
+				values[i] = c <= 0.04045f ? c / 12.92f : std::pow( (c + 0.055f) / 1.055f, 2.4f );
+				values[256+i] = c;
+			}
+		}
+
+		float values[512];
+	};
+
+	// Linear [0,1] quantized to 16 bits -> sRGB8. Entries 65536+ are for
+	// alpha. With 16 bits, the table's own quantization is well below half
+	// an sRGB step, even in the steep part of the curve near zero. Four
+	// bytes of padding allow 32-bit gathers at any index.
+	constexpr std::size_t kFromLinearSize_ = 65536;
+
+	struct FromLinearTable_
+	{
+		FromLinearTable_() noexcept
+		{
+			for( std::size_t i = 0; i < kFromLinearSize_; ++i )
+			{
+				float const l = float(i) / float(kFromLinearSize_-1);
+				float const s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow( l, 1.f/2.4f ) - 0.055f;
+				values[i] = std::uint8_t(std::lround( std::clamp( s, 0.f, 1.f ) * 255.f ));
+				values[kFromLinearSize_+i] = std::uint8_t(std::lround( l * 255.f ));
+			}
+
+			std::memset( values + 2*kFromLinearSize_, 0, 4 );
+		}
+
+		std::uint8_t values[2*kFromLinearSize_ + 4];
+	};
+
+	ToLinearTable_ const& to_linear_() noexcept
+	{
+		static ToLinearTable_ const table;
+		return table;
+	}
+	FromLinearTable_ const& from_linear_() noexcept
+	{
+		static FromLinearTable_ const table;
+		return table;
+	}
+
+	std::uint32_t from_linear_index_( float aValue ) noexcept
+	{
+		return std::uint32_t(std::clamp( aValue, 0.f, 1.f ) * float(kFromLinearSize_-1) + 0.5f);
+	}
+
+	// Converts aCount RGBA pixels to linear floats.
+	void row_to_linear_( std::uint8_t const* aIn, std::size_t aCount, float* aOut ) noexcept
+	{
+		float const* lut = to_linear_().values;
+
+		std::size_t i = 0;
+#	if VMLIB_SIMD_AVX2
+		__m256i const alphaOffset = _mm256_setr_epi32( 0, 0, 0, 256, 0, 0, 0, 256 );
+		for( ; i + 2 <= aCount; i += 2 )
+		{
+			__m128i const bytes = _mm_loadl_epi64( reinterpret_cast<__m128i const*>(aIn + i*4) );
+			__m256i const idx = _mm256_add_epi32( _mm256_cvtepu8_epi32( bytes ), alphaOffset );
+			_mm256_storeu_ps( aOut + i*4, _mm256_i32gather_ps( lut, idx, 4 ) );
+		}
+#	endif // ~ AVX2
+
+		for( ; i < aCount; ++i )
+		{
+			aOut[i*4+0] = lut[aIn[i*4+0]];
+			aOut[i*4+1] = lut[aIn[i*4+1]];
+			aOut[i*4+2] = lut[aIn[i*4+2]];
+			aOut[i*4+3] = lut[256 + aIn[i*4+3]];
+		}
+	}
+
+	void row_from_linear_( float const* aIn, std::size_t aCount, std::uint8_t* aOut ) noexcept
+	{
+		std::uint8_t const* lut = from_linear_().values;
+
+		std::size_t i = 0;
+#	if VMLIB_SIMD_AVX2
+		__m256 const zero = _mm256_setzero_ps();
+		__m256 const one = _mm256_set1_ps( 1.f );
+		__m256 const scale = _mm256_set1_ps( float(kFromLinearSize_-1) );
+		__m256 const half = _mm256_set1_ps( 0.5f );
+		__m256i const alphaOffset = _mm256_setr_epi32( 0, 0, 0, int(kFromLinearSize_), 0, 0, 0, int(kFromLinearSize_) );
+		__m256i const byteMask = _mm256_set1_epi32( 0xff );
+		for( ; i + 2 <= aCount; i += 2 )
+		{
+			__m256 v = _mm256_loadu_ps( aIn + i*4 );
+			v = _mm256_add_ps( _mm256_mul_ps( _mm256_min_ps( _mm256_max_ps( v, zero ), one ), scale ), half );
+
+			// Truncation after adding 0.5, as in from_linear_index_()
+			__m256i const idx = _mm256_add_epi32( _mm256_cvttps_epi32( v ), alphaOffset );
+			__m256i const vals = _mm256_and_si256( _mm256_i32gather_epi32( reinterpret_cast<int const*>(lut), idx, 1 ), byteMask );
+
+			__m128i const p16 = _mm_packus_epi32( _mm256_castsi256_si128( vals ), _mm256_extracti128_si256( vals, 1 ) );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>(aOut + i*4), _mm_packus_epi16( p16, p16 ) );
+		}
+#	endif // ~ AVX2
+
+		for( ; i < aCount; ++i )
+		{
+			aOut[i*4+0] = lut[from_linear_index_( aIn[i*4+0] )];
+			aOut[i*4+1] = lut[from_linear_index_( aIn[i*4+1] )];
+			aOut[i*4+2] = lut[from_linear_index_( aIn[i*4+2] )];
+			aOut[i*4+3] = lut[kFromLinearSize_ + from_linear_index_( aIn[i*4+3] )];
+		}
+	}
+
+	// aOut[i] = (a[2i] + a[2i+1] + b[2i] + b[2i+1]) / 4, per channel, for
+	// aCount output pixels. The scalar loop adds in the same order as the
+	// SIMD one, such that both produce identical results.
+	void box_filter_( float const* aRowA, float const* aRowB, std::size_t aCount, float* aOut ) noexcept
+	{
+		std::size_t i = 0;
+#	if VMLIB_SIMD_AVX
+		__m256 const quarter = _mm256_set1_ps( 0.25f );
+		for( ; i + 2 <= aCount; i += 2 )
+		{
+			// Four source pixels per row: (p0,p1) and (p2,p3)
+			__m256 const s01 = _mm256_add_ps( _mm256_loadu_ps( aRowA + i*8 ), _mm256_loadu_ps( aRowB + i*8 ) );
+			__m256 const s23 = _mm256_add_ps( _mm256_loadu_ps( aRowA + i*8 + 8 ), _mm256_loadu_ps( aRowB + i*8 + 8 ) );
+
+			__m256 const even = _mm256_permute2f128_ps( s01, s23, 0x20 ); // p0, p2
+			__m256 const odd = _mm256_permute2f128_ps( s01, s23, 0x31 );  // p1, p3
+
+			_mm256_storeu_ps( aOut + i*4, _mm256_mul_ps( _mm256_add_ps( even, odd ), quarter ) );
+		}
+#	endif // ~ AVX
+
+		for( ; i < aCount; ++i )
+		{
+			for( std::size_t c = 0; c < 4; ++c )
+				aOut[i*4+c] = ((aRowA[i*8+c] + aRowB[i*8+c]) + (aRowA[i*8+4+c] + aRowB[i*8+4+c])) * 0.25f;
+		}
+	}
+}
+
+float srgb8_to_linear( std::uint8_t aValue ) noexcept
+{
+	return to_linear_().values[aValue];
+}
+std::uint8_t linear_to_srgb8( float aValue ) noexcept
+{
+	return from_linear_().values[from_linear_index_( aValue )];
+}
+
+ImageLevel downsample_srgb( ImageLevel const& aSource )
+{
+	std::uint32_t const sw = aSource.width, sh = aSource.height;
+
+	ImageLevel ret;
+	ret.width = std::max( 1u, sw / 2 );
+	ret.height = std::max( 1u, sh / 2 );
+	ret.data.resize( std::size_t(ret.width) * ret.height * 4 );
+
+	// Source rows, converted to linear. They hold 2*width pixels; for 1-wide
+	// sources, the single column is duplicated.
+	std::size_t const rowPixels = std::size_t(ret.width) * 2;
+	std::vector<float> rowA( rowPixels*4 ), rowB( rowPixels*4 ), out( std::size_t(ret.width)*4 );
+
+	auto const load_row = [&] (std::uint32_t aY, std::vector<float>& aRow) {
+		std::uint8_t const* src = aSource.data.data() + std::size_t(aY) * sw * 4;
+		std::size_t const n = std::min<std::size_t>( rowPixels, sw );
+		row_to_linear_( src, n, aRow.data() );
+		for( std::size_t i = n; i < rowPixels; ++i )
+			std::copy_n( aRow.data() + (n-1)*4, 4, aRow.data() + i*4 );
+	};
+
+	for( std::uint32_t y = 0; y < ret.height; ++y )
+	{
+		load_row( 2*y, rowA );
+		load_row( std::min( 2*y+1, sh-1 ), rowB );
+
+		box_filter_( rowA.data(), rowB.data(), ret.width, out.data() );
+		row_from_linear_( out.data(), ret.width, ret.data.data() + std::size_t(y) * ret.width * 4 );
+	}
+
+	return ret;
+}
+
+std::vector<ImageLevel> build_mip_chain_srgb( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight )
+{
+	std::vector<ImageLevel> ret;
+	ret.reserve( mip_level_count( aWidth, aHeight ) );
+
+	ret.emplace_back( ImageLevel{ aWidth, aHeight, std::vector<std::uint8_t>( aRgba, aRgba + std::size_t(aWidth)*aHeight*4 ) } );
+	while( ret.back().width > 1 || ret.back().height > 1 )
+		ret.emplace_back( downsample_srgb( ret.back() ) );
+
+	return ret;
+}
+
+std::uint32_t mip_level_count( std::uint32_t aWidth, std::uint32_t aHeight ) noexcept
+{
+	std::uint32_t levels = 1;
+	while( aWidth > 1 || aHeight > 1 )
+	{
+		aWidth = std::max( 1u, aWidth / 2 );
+		aHeight = std::max( 1u, aHeight / 2 );
+		++levels;
+	}
+	return levels;
+}
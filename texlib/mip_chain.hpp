@@ -0,0 +1,39 @@
+#ifndef MIP_CHAIN_HPP_94E1A7C2_5F3B_4D08_B6E9_28C0D4F71A53
+#define MIP_CHAIN_HPP_94E1A7C2_5F3B_4D08_B6E9_28C0D4F71A53
+
+#include <vector>
+
+#include <cstdint>
+
+/* Gamma-correct mip chain generation
+ *
+ * Color textures are stored in sRGB (and sampled as GL_SRGB8_ALPHA8 or the
+ * compressed sRGB formats, such that GL linearizes them). Averaging the
+ * encoded values directly darkens the smaller levels; e.g. a black/white
+ * checkerboard averages to sRGB 128 (linear 0.22) instead of sRGB 188
+ * (linear 0.5). The functions below convert to linear space, filter there
+ * and convert back. Alpha is linear and filtered as-is.
+ *
+ * Each level is a 2x2 box filter of the previous one. With odd dimensions,
+ * the last row/column of the previous level is dropped.
+ */
+
+struct ImageLevel
+{
+	std::uint32_t width;
+	std::uint32_t height;
+	std::vector<std::uint8_t> data; // RGBA8 for uncompressed levels
+};
+
+float srgb8_to_linear( std::uint8_t ) noexcept;
+std::uint8_t linear_to_srgb8( float ) noexcept;
+
+ImageLevel downsample_srgb( ImageLevel const& );
+
+// Full chain, from aWidth x aHeight down to 1x1. The first element is a
+// copy of the input.
+std::vector<ImageLevel> build_mip_chain_srgb( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight );
+
+std::uint32_t mip_level_count( std::uint32_t aWidth, std::uint32_t aHeight ) noexcept;
+
+#endif // MIP_CHAIN_HPP_94E1A7C2_5F3B_4D08_B6E9_28C0D4F71A53
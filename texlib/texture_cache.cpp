@@ -0,0 +1,340 @@
+#include "texture_cache.hpp"
+
+#include <memory>
+#include <fstream>
+#include <filesystem>
+
+#include <cstdio>
+#include <cstring>
+
+#include <stb_image.h>
+
+#include "../support/error.hpp"
+
+#include "block_compress.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr char kMagic_[8] = { 'V', 'M', 'L', 'T', 'E', 'X', '\0', '\0' };
+
+	std::uint64_t align_( std::uint64_t aOffset ) noexcept
+	{
+		return (aOffset + kTextureCacheAlignment-1) & ~std::uint64_t(kTextureCacheAlignment-1);
+	}
+
+	bool is_valid_format_( TextureCacheFormat aFormat ) noexcept
+	{
+		switch( aFormat )
+		{
+			case TextureCacheFormat::kRgba8Srgb:
+			case TextureCacheFormat::kBc1Srgb:
+			case TextureCacheFormat::kBc7Srgb:
+				return true;
+		}
+		return false;
+	}
+
+	std::size_t level_size_( std::uint32_t aWidth, std::uint32_t aHeight, TextureCacheFormat aFormat ) noexcept
+	{
+		switch( aFormat )
+		{
+			case TextureCacheFormat::kRgba8Srgb: return std::size_t(aWidth) * aHeight * 4;
+			case TextureCacheFormat::kBc1Srgb: return compressed_size( aWidth, aHeight, BlockFormat::kBc1 );
+			case TextureCacheFormat::kBc7Srgb: return compressed_size( aWidth, aHeight, BlockFormat::kBc7 );
+		}
+		return 0;
+	}
+
+	bool check_dependencies_( TextureCache const& aCache, std::vector<std::size_t>& aTouched )
+	{
+		return check_file_dependencies( aCache.dependencies(), aCache.dependencyCount(), aCache.path().c_str(), aTouched );
+	}
+}
+
+TextureCache::TextureCache( char const* aPath )
+	: mFile( aPath )
+	, mPath( aPath )
+{
+	if( mFile.size() < sizeof(TextureCacheHeader) )
+		throw Error( "Texture cache '%s': file too small", aPath );
+
+	auto const& head = header();
+	if( 0 != std::memcmp( head.magic, kMagic_, sizeof(kMagic_) ) )
+		throw Error( "Texture cache '%s': not a texture cache", aPath );
+	if( kTextureCacheVersion != head.version || sizeof(TextureCacheHeader) != head.headerSize )
+		throw Error( "Texture cache '%s': version %u (expected %u)", aPath, head.version, kTextureCacheVersion );
+	if( !is_valid_format_( head.format ) )
+		throw Error( "Texture cache '%s': unknown format %u", aPath, std::uint32_t(head.format) );
+	if( mFile.size() != head.fileSize )
+		throw Error( "Texture cache '%s': truncated", aPath );
+
+	auto const check_range = [&] (std::uint64_t aOffset, std::uint64_t aCount, std::size_t aSize) {
+		if( aOffset % kTextureCacheAlignment || aOffset > head.fileSize || aCount * aSize > head.fileSize - aOffset )
+			throw Error( "Texture cache '%s': corrupt", aPath );
+	};
+
+	check_range( head.dependencyOffset, head.dependencyCount, sizeof(FileDependency) );
+	for( std::size_t i = 0; i < head.dependencyCount; ++i )
+	{
+		// The paths are used as C strings, see check_file_dependency()
+		auto const& dep = dependencies()[i];
+		if( !std::memchr( dep.path, '\0', sizeof(dep.path) ) )
+			throw Error( "Texture cache '%s': corrupt", aPath );
+	}
+
+	check_range( head.levelOffset, head.levelCount, sizeof(TextureCacheLevel) );
+
+	if( 0 == head.levelCount || 0 == head.width || 0 == head.height )
+		throw Error( "Texture cache '%s': empty", aPath );
+
+	auto const* lvls = levels();
+	for( std::size_t i = 0; i < head.levelCount; ++i )
+	{
+		if( lvls[i].size != level_size_( lvls[i].width, lvls[i].height, head.format ) )
+			throw Error( "Texture cache '%s': corrupt", aPath );
+
+		check_range( lvls[i].offset, lvls[i].size, 1 );
+	}
+}
+
+TextureCacheHeader const& TextureCache::header() const noexcept
+{
+	return *reinterpret_cast<TextureCacheHeader const*>(mFile.data());
+}
+
+TextureCacheFormat TextureCache::format() const noexcept
+{
+	return header().format;
+}
+std::uint32_t TextureCache::width() const noexcept
+{
+	return header().width;
+}
+std::uint32_t TextureCache::height() const noexcept
+{
+	return header().height;
+}
+
+TextureCacheLevel const* TextureCache::levels() const noexcept
+{
+	return at_<TextureCacheLevel>( header().levelOffset );
+}
+std::size_t TextureCache::levelCount() const noexcept
+{
+	return header().levelCount;
+}
+void const* TextureCache::levelData( std::size_t aLevel ) const noexcept
+{
+	return at_<std::byte>( levels()[aLevel].offset );
+}
+
+std::size_t TextureCache::dataBytes() const noexcept
+{
+	std::size_t ret = 0;
+	for( std::size_t i = 0; i < levelCount(); ++i )
+		ret += levels()[i].size;
+	return ret;
+}
+
+FileDependency const* TextureCache::dependencies() const noexcept
+{
+	return at_<FileDependency>( header().dependencyOffset );
+}
+std::size_t TextureCache::dependencyCount() const noexcept
+{
+	return header().dependencyCount;
+}
+
+std::string const& TextureCache::path() const noexcept
+{
+	return mPath;
+}
+
+template< typename tType >
+tType const* TextureCache::at_( std::uint64_t aOffset ) const noexcept
+{
+	return reinterpret_cast<tType const*>(mFile.data() + aOffset);
+}
+
+
+char const* to_string( TextureCacheFormat aFormat ) noexcept
+{
+	switch( aFormat )
+	{
+		case TextureCacheFormat::kRgba8Srgb: return "rgba8";
+		case TextureCacheFormat::kBc1Srgb: return "bc1";
+		case TextureCacheFormat::kBc7Srgb: return "bc7";
+	}
+	return "unknown";
+}
+
+std::string texture_cache_path( char const* aImagePath, TextureCacheFormat aFormat )
+{
+	return std::string(aImagePath) + "." + to_string( aFormat ) + ".texcache";
+}
+
+std::vector<ImageLevel> bake_texture( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight, TextureCacheFormat aFormat )
+{
+	auto levels = build_mip_chain_srgb( aRgba, aWidth, aHeight );
+	if( TextureCacheFormat::kRgba8Srgb == aFormat )
+		return levels;
+
+	BlockFormat const bf = TextureCacheFormat::kBc1Srgb == aFormat ? BlockFormat::kBc1 : BlockFormat::kBc7;
+	for( auto& level : levels )
+		level.data = compress_image( level.data.data(), level.width, level.height, bf );
+
+	return levels;
+}
+
+void write_texture_cache( char const* aCachePath, TextureCacheFormat aFormat, std::vector<ImageLevel> const& aLevels, std::vector<FileDependency> const& aDependencies )
+{
+	if( aLevels.empty() )
+		throw Error( "Texture cache '%s': no levels", aCachePath );
+
+	TextureCacheHeader head{};
+	std::memcpy( head.magic, kMagic_, sizeof(kMagic_) );
+	head.version = kTextureCacheVersion;
+	head.headerSize = sizeof(TextureCacheHeader);
+
+	head.format = aFormat;
+	head.width = aLevels.front().width;
+	head.height = aLevels.front().height;
+	head.levelCount = std::uint32_t(aLevels.size());
+	head.dependencyCount = std::uint32_t(aDependencies.size());
+
+	head.dependencyOffset = align_( sizeof(TextureCacheHeader) );
+	head.levelOffset = align_( head.dependencyOffset + head.dependencyCount * sizeof(FileDependency) );
+
+	std::vector<TextureCacheLevel> levels;
+	std::uint64_t offset = align_( head.levelOffset + head.levelCount * sizeof(TextureCacheLevel) );
+	for( auto const& level : aLevels )
+	{
+		if( level.data.size() != level_size_( level.width, level.height, aFormat ) )
+			throw Error( "Texture cache '%s': level %zu has unexpected size", aCachePath, levels.size() );
+
+		levels.emplace_back( TextureCacheLevel{ level.width, level.height, offset, level.data.size() } );
+		offset = align_( offset + level.data.size() );
+	}
+
+	head.fileSize = offset;
+
+	std::string const tmpPath = std::string(aCachePath) + ".tmp";
+
+	{
+		std::ofstream file( tmpPath, std::ios::binary | std::ios::trunc );
+		if( !file )
+			throw Error( "Unable to create texture cache '%s'", tmpPath.c_str() );
+
+		auto const write_at = [&] (std::uint64_t aOffset, void const* aData, std::size_t aSize) {
+			// Zero padding up to aOffset
+			static constexpr char kZeros[kTextureCacheAlignment] = {};
+			auto const pos = std::uint64_t(file.tellp());
+			file.write( kZeros, std::streamsize(aOffset - pos) );
+
+			if( aSize )
+				file.write( static_cast<char const*>(aData), std::streamsize(aSize) );
+		};
+
+		write_at( 0, &head, sizeof(head) );
+		write_at( head.dependencyOffset, aDependencies.data(), aDependencies.size() * sizeof(FileDependency) );
+		write_at( head.levelOffset, levels.data(), levels.size() * sizeof(TextureCacheLevel) );
+		for( std::size_t i = 0; i < aLevels.size(); ++i )
+			write_at( levels[i].offset, aLevels[i].data.data(), aLevels[i].data.size() );
+		write_at( head.fileSize, nullptr, 0 );
+
+		if( !file )
+			throw Error( "Unable to write texture cache '%s'", tmpPath.c_str() );
+	}
+
+	std::error_code ec;
+	fs::rename( tmpPath, aCachePath, ec );
+	if( ec )
+	{
+		fs::remove( tmpPath, ec );
+		throw Error( "Unable to replace texture cache '%s'", aCachePath );
+	}
+}
+
+bool is_texture_cache_current( TextureCache const& aCache )
+{
+	std::vector<std::size_t> touched;
+	return check_dependencies_( aCache, touched );
+}
+
+void build_texture_cache( char const* aImagePath, char const* aCachePath, TextureCacheFormat aFormat )
+{
+	// Decode from the mapped file, which is also what the dependency hashes.
+	MappedFile const source( aImagePath );
+	auto const dep = make_file_dependency( aImagePath, aCachePath, source );
+
+	// See load_image() in main/texture.cpp: use the per-thread setting.
+	stbi_set_flip_vertically_on_load_thread( 1 );
+
+	struct Free_ { void operator()( stbi_uc* aPixels ) const noexcept { stbi_image_free( aPixels ); } };
+
+	int w = 0, h = 0, channels = 0;
+	std::unique_ptr<stbi_uc, Free_> pixels( stbi_load_from_memory(
+		reinterpret_cast<stbi_uc const*>(source.data()),
+		int(source.size()),
+		&w, &h, &channels, 4
+	) );
+
+	if( !pixels )
+		throw Error( "Unable to load image '%s': %s", aImagePath, stbi_failure_reason() );
+
+	auto const levels = bake_texture( pixels.get(), std::uint32_t(w), std::uint32_t(h), aFormat );
+	write_texture_cache( aCachePath, aFormat, levels, { dep } );
+}
+
+TextureCache load_texture_cached( char const* aImagePath, TextureCacheFormat aFormat, bool* aRebuilt )
+{
+	std::string const cachePath = texture_cache_path( aImagePath, aFormat );
+
+	if( aRebuilt )
+		*aRebuilt = false;
+
+	std::error_code ec;
+	if( fs::exists( cachePath, ec ) )
+	{
+		try
+		{
+			std::vector<std::size_t> touched;
+			TextureCacheHeader head;
+			{
+				TextureCache cache( cachePath.c_str() );
+				if( cache.format() != aFormat )
+					throw Error( "'%s' has format %s", cachePath.c_str(), to_string( cache.format() ) );
+				if( !check_dependencies_( cache, touched ) )
+					throw Error( "'%s' is out of date", cachePath.c_str() );
+
+				if( touched.empty() )
+					return cache;
+
+				head = cache.header();
+			}
+
+			// See load_mesh_cached().
+			refresh_file_dependencies( cachePath.c_str(), head.dependencyOffset, head.dependencyCount, touched );
+			return TextureCache( cachePath.c_str() );
+		}
+		catch( Error const& eErr )
+		{
+			std::fprintf( stderr, "Note: ignoring texture cache: %s\n", eErr.what() );
+		}
+		catch( fs::filesystem_error const& eErr )
+		{
+			std::fprintf( stderr, "Note: ignoring texture cache: %s\n", eErr.what() );
+		}
+	}
+
+	std::fprintf( stderr, "Note: generating texture cache '%s'\n", cachePath.c_str() );
+
+	build_texture_cache( aImagePath, cachePath.c_str(), aFormat );
+
+	if( aRebuilt )
+		*aRebuilt = true;
+
+	return TextureCache( cachePath.c_str() );
+}
@@ -0,0 +1,141 @@
+#ifndef TEXTURE_CACHE_HPP_6E2B9D47_A15C_4C83_8F0E_3B7D92C4E815
+#define TEXTURE_CACHE_HPP_6E2B9D47_A15C_4C83_8F0E_3B7D92C4E815
+
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "mip_chain.hpp"
+
+#include "../meshlib/mapped_file.hpp"
+#include "../meshlib/file_dependency.hpp"
+
+/* Precomputed texture cache
+ *
+ * Decoding a large JPEG/PNG and generating mipmaps at startup is slow, and
+ * glGenerateMipmap() filters in whatever space the driver chooses. Instead,
+ * load_texture_cached() stores a fully baked mip chain in a binary cache
+ * file next to the image ("foo.jpg" -> "foo.jpg.bc7.texcache"). The levels
+ * are generated with build_mip_chain_srgb() and optionally block compressed
+ * (see block_compress.hpp). Later loads memory-map the cache; each level can
+ * be passed directly to glCompressedTexSubImage2D()/glTexSubImage2D().
+ *
+ * File layout (little endian, all blobs aligned to kTextureCacheAlignment):
+ *   TextureCacheHeader
+ *   FileDependency[dependencyCount]       - the source image
+ *   TextureCacheLevel[levelCount]
+ *   level data, largest level first
+ *
+ * Rows are stored bottom-to-top, as expected by OpenGL. Bump
+ * kTextureCacheVersion whenever the format or the processing change.
+ *
+ * Caches can also be generated offline with texbake.
+ */
+
+constexpr std::uint32_t kTextureCacheVersion = 1;
+constexpr std::size_t kTextureCacheAlignment = 64;
+
+enum class TextureCacheFormat : std::uint32_t
+{
+	kRgba8Srgb,
+	kBc1Srgb,
+	kBc7Srgb
+};
+
+struct TextureCacheHeader
+{
+	char magic[8]; // "VMLTEX\0\0"
+	std::uint32_t version;
+	std::uint32_t headerSize;
+
+	TextureCacheFormat format;
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint32_t levelCount;
+	std::uint32_t dependencyCount;
+	std::uint32_t reserved;
+
+	std::uint64_t dependencyOffset;
+	std::uint64_t levelOffset;
+	std::uint64_t fileSize;
+};
+
+struct TextureCacheLevel
+{
+	std::uint32_t width;
+	std::uint32_t height;
+	std::uint64_t offset;
+	std::uint64_t size;
+};
+
+static_assert( std::is_trivially_copyable_v<TextureCacheHeader> );
+static_assert( sizeof(TextureCacheLevel) == 24 );
+
+/** TextureCache: memory-mapped texture cache file
+ *
+ * The constructor maps the file and validates its structure (but not
+ * whether it is current; see is_texture_cache_current()). Throws Error if
+ * the file is missing or malformed. All returned pointers refer directly to
+ * the mapped file and remain valid for the lifetime of the TextureCache.
+ */
+class TextureCache final
+{
+	public:
+		explicit TextureCache( char const* aPath );
+
+	public:
+		TextureCacheHeader const& header() const noexcept;
+
+		TextureCacheFormat format() const noexcept;
+		std::uint32_t width() const noexcept;
+		std::uint32_t height() const noexcept;
+
+		TextureCacheLevel const* levels() const noexcept;
+		std::size_t levelCount() const noexcept;
+		void const* levelData( std::size_t aLevel ) const noexcept;
+
+		// Sum of all levels, i.e., roughly the texture's VRAM footprint.
+		std::size_t dataBytes() const noexcept;
+
+		FileDependency const* dependencies() const noexcept;
+		std::size_t dependencyCount() const noexcept;
+
+		std::string const& path() const noexcept;
+
+	private:
+		template< typename tType >
+		tType const* at_( std::uint64_t ) const noexcept;
+
+	private:
+		MappedFile mFile;
+		std::string mPath;
+};
+
+char const* to_string( TextureCacheFormat ) noexcept;
+
+// "foo.png" -> "foo.png.bc7.texcache"
+std::string texture_cache_path( char const* aImagePath, TextureCacheFormat );
+
+// Generates the mip chain for an RGBA8 image (sRGB color, linear alpha),
+// and compresses the levels to aFormat.
+std::vector<ImageLevel> bake_texture( std::uint8_t const* aRgba, std::uint32_t aWidth, std::uint32_t aHeight, TextureCacheFormat );
+
+// Writes a cache file. aLevels must be in aFormat, e.g. from bake_texture().
+// As with write_mesh_cache(), the file is written to a temporary first and
+// then renamed.
+void write_texture_cache( char const* aCachePath, TextureCacheFormat, std::vector<ImageLevel> const& aLevels, std::vector<FileDependency> const& );
+
+bool is_texture_cache_current( TextureCache const& );
+
+// Decodes aImagePath with stb_image, bakes it and writes the cache.
+void build_texture_cache( char const* aImagePath, char const* aCachePath, TextureCacheFormat );
+
+// Loads the cache for aImagePath. If the cache is missing, malformed or out
+// of date, it is (re-)generated first. If aRebuilt is non-null, it is set to
+// indicate whether that happened.
+TextureCache load_texture_cached( char const* aImagePath, TextureCacheFormat, bool* aRebuilt = nullptr );
+
+#endif // TEXTURE_CACHE_HPP_6E2B9D47_A15C_4C83_8F0E_3B7D92C4E815
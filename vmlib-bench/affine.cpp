@@ -0,0 +1,64 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/rigid.hpp"
+#include "../vmlib/affine.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Affine3f and RigidTransform", "[affine]" )
+{
+	auto const fs = make_random_floats( kObjectCount, 1 );
+	auto const ts = make_random_vec3s( kObjectCount, 2 );
+
+	std::vector<Affine3f> affines( kObjectCount );
+	std::vector<RigidTransform> rigids( kObjectCount );
+	for( std::size_t i = 0; i < kObjectCount; ++i )
+	{
+		Mat44f const rigid = make_translation( ts[i] ) * make_rotation_y( fs[i] ) * make_rotation_x( 0.5f*fs[i] );
+		rigids[i] = to_rigid( rigid );
+		affines[i] = to_affine( rigid * make_scaling( 1.f + fs[i]*fs[i], 1.f, 2.f ) );
+	}
+
+	std::vector<Affine3f> outAffine( kObjectCount );
+	std::vector<RigidTransform> outRigid( kObjectCount );
+	std::vector<Mat33f> out33( kObjectCount );
+	std::vector<Mat44f> out44( kObjectCount );
+
+	BENCHMARK( "Affine3f * Affine3f (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outAffine[i] = affines[i] * affines[kObjectCount-i-1];
+		return outAffine.back().v[0];
+	};
+	BENCHMARK( "invert(Affine3f) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outAffine[i] = invert( affines[i] );
+		return outAffine.back().v[0];
+	};
+	BENCHMARK( "normal_matrix(Affine3f) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out33[i] = normal_matrix( affines[i] );
+		return out33.back().v[0];
+	};
+	BENCHMARK( "to_mat44(Affine3f) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out44[i] = to_mat44( affines[i] );
+		return out44.back().v[0];
+	};
+
+	BENCHMARK( "RigidTransform * RigidTransform (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outRigid[i] = rigids[i] * rigids[kObjectCount-i-1];
+		return outRigid.back().rotation.v[0];
+	};
+	BENCHMARK( "invert(RigidTransform) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outRigid[i] = invert( rigids[i] );
+		return outRigid.back().rotation.v[0];
+	};
+}
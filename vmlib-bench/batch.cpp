@@ -0,0 +1,67 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/batch.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Vec3fStream kernels", "[batch]" )
+{
+	auto const aos = make_random_vec3s( kVertexCount, 1 );
+	auto const m = make_random_mat44s( 1, 2 ).front();
+
+	Vec3fStream const as = to_stream( aos.data(), aos.size() );
+	Vec3fStream const bs = to_stream( make_random_vec3s( kVertexCount, 3 ).data(), kVertexCount );
+	Vec3fStream out;
+	out.resize( kVertexCount );
+
+	std::vector<Vec3f> outAos( kVertexCount );
+	std::vector<float> outf( kVertexCount );
+
+	BENCHMARK( "to_stream() (100k)" )
+	{
+		return to_stream( aos.data(), aos.size() );
+	};
+	BENCHMARK( "from_stream() (100k)" )
+	{
+		from_stream( as, outAos.data() );
+		return outAos.back().x;
+	};
+
+	BENCHMARK( "transform_points() (100k)" )
+	{
+		transform_points( m, as, out );
+		return out.x.back();
+	};
+	BENCHMARK( "transform_points(), AoS Mat44f * Vec4f loop (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+		{
+			auto const r = m * Vec4f{ aos[i].x, aos[i].y, aos[i].z, 1.f };
+			outAos[i] = Vec3f{ r.x, r.y, r.z };
+		}
+		return outAos.back().x;
+	};
+	BENCHMARK( "transform_vectors() (100k)" )
+	{
+		transform_vectors( m, as, out );
+		return out.x.back();
+	};
+
+	BENCHMARK( "normalize() (100k)" )
+	{
+		normalize( as, out );
+		return out.x.back();
+	};
+	BENCHMARK( "normalize(), AoS loop (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			outAos[i] = normalize( aos[i] );
+		return outAos.back().x;
+	};
+
+	BENCHMARK( "dot() (100k)" )
+	{
+		dot( as, bs, outf.data() );
+		return outf.back();
+	};
+}
@@ -0,0 +1,70 @@
+#ifndef BENCH_DATA_HPP_81EF17D1_7663_4B5F_9ECD_32D61599AC7C
+#define BENCH_DATA_HPP_81EF17D1_7663_4B5F_9ECD_32D61599AC7C
+
+#include <random>
+#include <vector>
+
+#include <cstdlib>
+
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec4.hpp"
+#include "../vmlib/mat44.hpp"
+
+// Batch sizes used throughout the benchmarks. kObjectCount is roughly the
+// number of objects in a busy scene (one transform each); kVertexCount is in
+// the ballpark of a medium-sized mesh.
+constexpr std::size_t kObjectCount = 4096;
+constexpr std::size_t kVertexCount = 100000;
+
+// Deterministic pseudo-random test data. Values are kept in a modest range,
+// such that the generated matrices are reasonably conditioned.
+inline
+std::vector<float> make_random_floats( std::size_t aCount, unsigned aSeed = 1 )
+{
+	std::mt19937 rng( aSeed );
+	std::uniform_real_distribution<float> dist( -2.f, 2.f );
+
+	std::vector<float> ret( aCount );
+	for( auto& f : ret )
+		f = dist( rng );
+	return ret;
+}
+
+inline
+std::vector<Vec3f> make_random_vec3s( std::size_t aCount, unsigned aSeed = 1 )
+{
+	auto const fs = make_random_floats( aCount*3, aSeed );
+
+	std::vector<Vec3f> ret( aCount );
+	for( std::size_t i = 0; i < aCount; ++i )
+		ret[i] = Vec3f{ fs[i*3+0], fs[i*3+1], fs[i*3+2] };
+	return ret;
+}
+
+inline
+std::vector<Vec4f> make_random_vec4s( std::size_t aCount, unsigned aSeed = 1 )
+{
+	auto const fs = make_random_floats( aCount*4, aSeed );
+
+	std::vector<Vec4f> ret( aCount );
+	for( std::size_t i = 0; i < aCount; ++i )
+		ret[i] = Vec4f{ fs[i*4+0], fs[i*4+1], fs[i*4+2], fs[i*4+3] };
+	return ret;
+}
+
+// Random matrices, biased towards the diagonal to avoid singular ones.
+inline
+std::vector<Mat44f> make_random_mat44s( std::size_t aCount, unsigned aSeed = 1 )
+{
+	auto const fs = make_random_floats( aCount*16, aSeed );
+
+	std::vector<Mat44f> ret( aCount );
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		for( std::size_t j = 0; j < 16; ++j )
+			ret[i].v[j] = 0.25f * fs[i*16+j] + kIdentity44f.v[j];
+	}
+	return ret;
+}
+
+#endif // BENCH_DATA_HPP_81EF17D1_7663_4B5F_9ECD_32D61599AC7C
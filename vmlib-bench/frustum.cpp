@@ -0,0 +1,59 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/frustum.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Frustum tests", "[frustum]" )
+{
+	Mat44f const proj = make_perspective_projection( 0.5f * kPif, 16.f/9.f, 0.1f, 100.f );
+	Mat44f const view = make_translation( { 0.f, 0.f, -1.f } );
+	Frustum const frustum = extract_frustum( proj * view );
+
+	auto const centers = make_random_vec3s( kObjectCount, 1 );
+	auto const sizes = make_random_floats( kObjectCount, 2 );
+
+	Aabb3fStream boxes;
+	Sphere3fStream spheres;
+	std::vector<Aabb3f> aosBoxes;
+	for( std::size_t i = 0; i < kObjectCount; ++i )
+	{
+		// Scatter objects around the camera, such that roughly a third are
+		// visible.
+		Vec3f const c = 20.f * centers[i];
+		float const r = 0.5f + sizes[i] * sizes[i];
+
+		boxes.push_back( { c - Vec3f{ r, r, r }, c + Vec3f{ r, r, r } } );
+		spheres.push_back( { c, r } );
+		aosBoxes.push_back( boxes.get( i ) );
+	}
+
+	std::vector<std::uint8_t> mask( (kObjectCount+7)/8 );
+
+	BENCHMARK( "extract_frustum()" )
+	{
+		return extract_frustum( proj * view );
+	};
+
+	BENCHMARK( "test_visibility(Aabb3fStream) (4k)" )
+	{
+		test_visibility( frustum, boxes, mask.data() );
+		return mask.back();
+	};
+	BENCHMARK( "is_visible(Aabb3f) loop (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; i += 8 )
+		{
+			std::uint8_t bits = 0;
+			for( std::size_t j = 0; j < 8; ++j )
+				bits |= std::uint8_t(is_visible( frustum, aosBoxes[i+j] ) << j);
+			mask[i/8] = bits;
+		}
+		return mask.back();
+	};
+	BENCHMARK( "test_visibility(Sphere3fStream) (4k)" )
+	{
+		test_visibility( frustum, spheres, mask.data() );
+		return mask.back();
+	};
+}
@@ -0,0 +1,130 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/mat33.hpp"
+#include "../vmlib/mat44.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Mat44f products", "[mat44]" )
+{
+	auto const as = make_random_mat44s( kObjectCount, 1 );
+	auto const bs = make_random_mat44s( kObjectCount, 2 );
+	auto const vs = make_random_vec4s( kObjectCount, 3 );
+
+	std::vector<Mat44f> out( kObjectCount );
+	std::vector<Vec4f> outv( kObjectCount );
+
+	BENCHMARK( "Mat44f * Mat44f (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = as[i] * bs[i];
+		return out.back().v[0];
+	};
+	BENCHMARK( "Mat44f * Mat44f, scalar (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = detail::mat44_mul_scalar( as[i], bs[i] );
+		return out.back().v[0];
+	};
+
+	BENCHMARK( "Mat44f * Vec4f (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outv[i] = as[i] * vs[i];
+		return outv.back().x;
+	};
+	BENCHMARK( "Mat44f * Vec4f, scalar (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outv[i] = detail::mat44_mul_scalar( as[i], vs[i] );
+		return outv.back().x;
+	};
+}
+
+TEST_CASE( "Mat44f functions", "[mat44]" )
+{
+	auto const as = make_random_mat44s( kObjectCount, 1 );
+	auto const fs = make_random_floats( kObjectCount, 2 );
+	auto const ts = make_random_vec3s( kObjectCount, 3 );
+
+	std::vector<Mat44f> out( kObjectCount );
+	std::vector<Mat33f> out33( kObjectCount );
+
+	BENCHMARK( "invert() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = invert( as[i] );
+		return out.back().v[0];
+	};
+	BENCHMARK( "invert(), scalar (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = detail::invert_scalar( as[i] );
+		return out.back().v[0];
+	};
+
+	BENCHMARK( "transpose() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = transpose( as[i] );
+		return out.back().v[0];
+	};
+	BENCHMARK( "mat44_to_mat33() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out33[i] = mat44_to_mat33( as[i] );
+		return out33.back().v[0];
+	};
+
+	BENCHMARK( "make_rotation_x() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = make_rotation_x( fs[i] );
+		return out.back().v[0];
+	};
+	BENCHMARK( "make_rotation_y() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = make_rotation_y( fs[i] );
+		return out.back().v[0];
+	};
+	BENCHMARK( "make_rotation_z() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = make_rotation_z( fs[i] );
+		return out.back().v[0];
+	};
+	BENCHMARK( "make_translation() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = make_translation( ts[i] );
+		return out.back().v[0];
+	};
+	BENCHMARK( "make_scaling() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = make_scaling( ts[i].x, ts[i].y, ts[i].z );
+		return out.back().v[0];
+	};
+	BENCHMARK( "make_perspective_projection() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out[i] = make_perspective_projection( 1.f + 0.1f*fs[i], 16.f/9.f, 0.1f, 100.f );
+		return out.back().v[0];
+	};
+
+	// Typical per-object work: model-view-projection and normal matrix.
+	BENCHMARK( "MVP + normal matrix (4k)" )
+	{
+		Mat44f const proj = make_perspective_projection( 1.f, 16.f/9.f, 0.1f, 100.f );
+		Mat44f const view = make_translation( { 0.f, -1.f, -5.f } );
+		Mat44f const projView = proj * view;
+
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+		{
+			out[i] = projView * as[i];
+			out33[i] = mat44_to_mat33( transpose( invert( as[i] ) ) );
+		}
+		return out.back().v[0] + out33.back().v[0];
+	};
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+#include <algorithm>
+#include <filesystem>
+
+#include "../meshlib/mesh_optimize.hpp"
+
+namespace
+{
+	// 256x256 quad grid (terrain-like), as triangle soup in a random order.
+	MeshData make_terrain_soup_()
+	{
+		constexpr std::size_t kN = 256;
+
+		std::vector<std::uint32_t> tris;
+		for( std::size_t y = 0; y < kN; ++y )
+		{
+			for( std::size_t x = 0; x < kN; ++x )
+			{
+				auto const i = std::uint32_t(y*(kN+1) + x);
+				tris.insert( tris.end(), { i, i+1, std::uint32_t(i+kN+1) } );
+				tris.insert( tris.end(), { i+1, std::uint32_t(i+kN+2), std::uint32_t(i+kN+1) } );
+			}
+		}
+
+		std::vector<std::size_t> order( tris.size() / 3 );
+		for( std::size_t i = 0; i < order.size(); ++i )
+			order[i] = i;
+		std::shuffle( order.begin(), order.end(), std::mt19937( 1 ) );
+
+		MeshData ret;
+		for( auto const t : order )
+		{
+			for( std::size_t j = 0; j < 3; ++j )
+			{
+				auto const i = tris[t*3+j];
+				float const x = float(i % (kN+1)), y = float(i / (kN+1));
+
+				ret.indices.push_back( std::uint32_t(ret.vertices.size()) );
+				ret.vertices.push_back( MeshVertex{ { x, 0.f, y }, { 0.f, 1.f, 0.f }, { x, y } } );
+			}
+		}
+
+		ret.submeshes.push_back( { 0, std::uint32_t(ret.indices.size()), 0 } );
+		return ret;
+	}
+
+	void report_acmr_( char const* aName, MeshData aMesh )
+	{
+		float const soup = compute_acmr( aMesh );
+		deduplicate_vertices( aMesh );
+		float const indexed = compute_acmr( aMesh );
+		optimize_vertex_cache( aMesh );
+		float const optimized = compute_acmr( aMesh );
+		float const optimized32 = compute_acmr( aMesh, 32 );
+
+		WARN( aName << ": " << aMesh.indices.size()/3 << " triangles, " << aMesh.vertices.size() << " unique vertices; "
+			<< "ACMR (FIFO 16) soup " << soup << ", indexed " << indexed << ", optimized " << optimized
+			<< " (FIFO 32: " << optimized32 << ")" );
+	}
+}
+
+TEST_CASE( "Mesh optimization", "[meshlib]" )
+{
+	MeshData const terrain = make_terrain_soup_();
+	report_acmr_( "terrain grid", terrain );
+
+	// Real data, if run from the workspace directory (the default).
+	if( std::filesystem::exists( "assets/landingpad.obj" ) )
+		report_acmr_( "landingpad.obj", load_wavefront_obj( "assets/landingpad.obj" ) );
+
+	MeshData indexed = terrain;
+	deduplicate_vertices( indexed );
+	optimize_vertex_cache( indexed );
+
+	BENCHMARK( "deduplicate_vertices() (393k)" )
+	{
+		MeshData mesh = terrain;
+		deduplicate_vertices( mesh );
+		return mesh.vertices.size();
+	};
+
+	BENCHMARK( "optimize_vertex_cache() (131k triangles)" )
+	{
+		MeshData mesh = indexed;
+		optimize_vertex_cache( mesh );
+		return mesh.indices.front();
+	};
+
+	BENCHMARK( "optimize_vertex_fetch() (131k triangles)" )
+	{
+		MeshData mesh = indexed;
+		optimize_vertex_fetch( mesh );
+		return mesh.indices.front();
+	};
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <filesystem>
+
+#include "../meshlib/mesh_optimize.hpp"
+#include "../meshlib/mesh_simplify.hpp"
+
+namespace
+{
+	// 256x256 quad terrain patch (parlahti.obj is not part of the repo)
+	MeshData make_terrain_()
+	{
+		constexpr std::size_t kN = 256;
+
+		MeshData ret;
+		for( std::size_t z = 0; z <= kN; ++z )
+		{
+			for( std::size_t x = 0; x <= kN; ++x )
+			{
+				float const fx = float(x), fz = float(z);
+				float const h = 20.f * std::abs( std::sin( fx * 0.02f ) * std::cos( fz * 0.026f ) ) + 3.f * std::sin( fx * 0.15f + fz * 0.1f );
+				ret.vertices.push_back( MeshVertex{ { 2.f*fx, h, 2.f*fz }, { 0.f, 1.f, 0.f }, { fx / float(kN), fz / float(kN) } } );
+			}
+		}
+
+		for( std::size_t z = 0; z < kN; ++z )
+		{
+			for( std::size_t x = 0; x < kN; ++x )
+			{
+				auto const i = std::uint32_t(z*(kN+1) + x), w = std::uint32_t(kN+1);
+				ret.indices.insert( ret.indices.end(), { i, i+w, i+1, i+1, i+w, i+w+1 } );
+			}
+		}
+
+		ret.submeshes.push_back( { 0, std::uint32_t(ret.indices.size()), 0 } );
+		return ret;
+	}
+
+	void report_lods_( char const* aName, MeshData aMesh )
+	{
+		build_lod_chain( aMesh );
+
+		for( std::size_t i = 0; i < aMesh.lods.size(); ++i )
+		{
+			auto const& lod = aMesh.lods[i];
+
+			std::size_t tris = 0;
+			for( std::size_t s = lod.firstSubmesh; s < lod.firstSubmesh + lod.submeshCount; ++s )
+				tris += aMesh.submeshes[s].indexCount / 3;
+
+			WARN( aName << ": LOD " << i << ": " << tris << " triangles, error " << lod.error );
+		}
+	}
+}
+
+TEST_CASE( "Mesh simplification", "[meshlib]" )
+{
+	MeshData const terrain = make_terrain_();
+	report_lods_( "terrain grid", terrain );
+
+	// Real data, if run from the workspace directory (the default).
+	if( std::filesystem::exists( "assets/landingpad.obj" ) )
+	{
+		auto landingPad = load_wavefront_obj( "assets/landingpad.obj" );
+		deduplicate_vertices( landingPad );
+		report_lods_( "landingpad.obj", landingPad );
+
+		BENCHMARK( "simplify_mesh() (landingpad.obj, 50%)" )
+		{
+			return simplify_mesh( landingPad ).indices.size();
+		};
+	}
+
+	BENCHMARK( "simplify_mesh() (131k triangles, 50%)" )
+	{
+		return simplify_mesh( terrain ).indices.size();
+	};
+
+	BENCHMARK( "build_lod_chain() (131k triangles, 4 levels)" )
+	{
+		MeshData mesh = terrain;
+		build_lod_chain( mesh );
+		return mesh.lods.size();
+	};
+}
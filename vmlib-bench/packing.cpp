@@ -0,0 +1,51 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/packing.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Vertex packing", "[packing]" )
+{
+	auto const positions = make_random_vec3s( kVertexCount, 1 );
+	auto const normalsRaw = make_random_vec3s( kVertexCount, 2 );
+	auto const texcoords = make_random_floats( kVertexCount*2, 3 );
+
+	std::vector<Vec3f> normals( kVertexCount );
+	for( std::size_t i = 0; i < kVertexCount; ++i )
+		normals[i] = normalize( normalsRaw[i] );
+
+	Aabb3f bounds = kEmptyAabb3f;
+	for( auto const& p : positions )
+		bounds = expand( bounds, p );
+
+	std::vector<QuantizedPosition> qpos( kVertexCount );
+	std::vector<std::uint32_t> packed( kVertexCount );
+	std::vector<std::uint16_t> halves( kVertexCount*2 );
+
+	BENCHMARK( "quantize_position() (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			qpos[i] = quantize_position( positions[i], bounds );
+		return qpos.back().x;
+	};
+
+	BENCHMARK( "pack_normal_oct16() (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			packed[i] = pack_normal_oct16( normals[i] );
+		return packed.back();
+	};
+	BENCHMARK( "pack_snorm_10_10_10_2() (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			packed[i] = pack_snorm_10_10_10_2( { normals[i].x, normals[i].y, normals[i].z, 0.f } );
+		return packed.back();
+	};
+
+	BENCHMARK( "float_to_half() (200k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount*2; ++i )
+			halves[i] = float_to_half( texcoords[i] );
+		return halves.back();
+	};
+}
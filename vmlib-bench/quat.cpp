@@ -0,0 +1,82 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/quat.hpp"
+#include "../vmlib/dualquat.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Quatf and DualQuatf", "[quat]" )
+{
+	auto const fs = make_random_floats( kObjectCount, 1 );
+	auto const ts = make_random_vec3s( kObjectCount, 2 );
+	auto const vs = make_random_vec3s( kObjectCount, 3 );
+
+	std::vector<Quatf> qs( kObjectCount );
+	std::vector<DualQuatf> dqs( kObjectCount );
+	for( std::size_t i = 0; i < kObjectCount; ++i )
+	{
+		qs[i] = make_quat_axis_angle( normalize( ts[i] ), fs[i] );
+		dqs[i] = make_dual_quat( qs[i], vs[i] );
+	}
+
+	std::vector<Quatf> outQ( kObjectCount );
+	std::vector<DualQuatf> outDQ( kObjectCount );
+	std::vector<Vec3f> outV( kObjectCount );
+	std::vector<Mat44f> out44( kObjectCount );
+
+	BENCHMARK( "make_quat_axis_angle() (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outQ[i] = make_quat_axis_angle( vs[i], fs[i] );
+		return outQ.back().w;
+	};
+	BENCHMARK( "Quatf * Quatf (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outQ[i] = qs[i] * qs[kObjectCount-i-1];
+		return outQ.back().w;
+	};
+	BENCHMARK( "rotate(Quatf, Vec3f) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outV[i] = rotate( qs[i], vs[i] );
+		return outV.back().x;
+	};
+	BENCHMARK( "nlerp(Quatf) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outQ[i] = nlerp( qs[i], qs[kObjectCount-i-1], 0.3f );
+		return outQ.back().w;
+	};
+	BENCHMARK( "slerp(Quatf) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outQ[i] = slerp( qs[i], qs[kObjectCount-i-1], 0.3f );
+		return outQ.back().w;
+	};
+	BENCHMARK( "to_mat44(Quatf) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out44[i] = to_mat44( qs[i] );
+		return out44.back().v[0];
+	};
+
+	BENCHMARK( "DualQuatf * DualQuatf (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outDQ[i] = dqs[i] * dqs[kObjectCount-i-1];
+		return outDQ.back().real.w;
+	};
+	BENCHMARK( "transform_point(DualQuatf) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			outV[i] = transform_point( dqs[i], vs[i] );
+		return outV.back().x;
+	};
+	BENCHMARK( "to_mat44(DualQuatf) (4k)" )
+	{
+		for( std::size_t i = 0; i < kObjectCount; ++i )
+			out44[i] = to_mat44( dqs[i] );
+		return out44.back().v[0];
+	};
+}
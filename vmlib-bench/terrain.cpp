@@ -0,0 +1,95 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+
+#include "../meshlib/terrain.hpp"
+
+#include "../vmlib/mat44.hpp"
+
+namespace
+{
+	// Ridged multi-octave sine terrain; 1025^2 samples at 2m spacing is
+	// roughly a 2km x 2km area (parlahti.obj is not part of the repo).
+	HeightField make_landscape_( std::uint32_t aSize )
+	{
+		HeightField ret;
+		ret.width = ret.depth = aSize;
+		ret.spacingX = ret.spacingZ = 2.f;
+
+		ret.heights.resize( std::size_t(aSize) * aSize );
+		for( std::uint32_t z = 0; z < aSize; ++z )
+		{
+			for( std::uint32_t x = 0; x < aSize; ++x )
+			{
+				float h = 0.f, amp = 60.f, freq = 0.004f;
+				for( int o = 0; o < 6; ++o )
+				{
+					h += amp * std::abs( std::sin( float(x) * freq + float(o) ) * std::cos( float(z) * freq * 1.3f - float(o) ) );
+					amp *= 0.45f;
+					freq *= 2.1f;
+				}
+				ret.heights[std::size_t(z)*aSize + x] = h;
+			}
+		}
+		return ret;
+	}
+
+	// Camera along a straight line across the terrain, looking forward and
+	// slightly down.
+	TerrainView make_view_( TerrainData const& aTerrain, float aT, Frustum& aFrustum )
+	{
+		Vec3f const from{ 50.f, 120.f, 50.f };
+		Vec3f const to{ aTerrain.bounds.max.x - 50.f, 120.f, aTerrain.bounds.max.z - 50.f };
+		Vec3f const pos = from + aT * (to - from);
+
+		float const fov = 1.2f;
+		Mat44f const proj = make_perspective_projection( fov, 16.f/9.f, 0.5f, 5000.f );
+		Mat44f const view = make_rotation_x( 0.3f ) * make_rotation_y( 2.356f ) * make_translation( -pos );
+		aFrustum = extract_frustum( proj * view );
+
+		TerrainView ret{ pos, terrain_error_scale( fov, 1080.f ) };
+		ret.frustum = &aFrustum;
+		return ret;
+	}
+}
+
+TEST_CASE( "Terrain LOD", "[meshlib]" )
+{
+	auto const field = make_landscape_( 1025 );
+	auto const terrain = build_terrain( field );
+
+	std::size_t maxTriangles = 0, sumTriangles = 0, maxChunks = 0;
+	constexpr int kSteps = 32;
+	for( int i = 0; i < kSteps; ++i )
+	{
+		Frustum frustum;
+		std::vector<std::uint32_t> chunks;
+		select_terrain_chunks( terrain, make_view_( terrain, float(i) / float(kSteps-1), frustum ), chunks );
+
+		std::size_t triangles = 0;
+		for( auto const c : chunks )
+			triangles += terrain.chunks[c].indexCount / 3;
+
+		maxTriangles = std::max( maxTriangles, triangles );
+		maxChunks = std::max( maxChunks, chunks.size() );
+		sumTriangles += triangles;
+	}
+
+	WARN( "Terrain 1025^2: " << terrain.chunks.size() << " chunks in " << terrain.levelCount << " levels, "
+		<< terrain.fullResolutionTriangles << " triangles at full resolution; flyover (" << kSteps << " views, 2px): "
+		<< "avg " << sumTriangles / kSteps << ", max " << maxTriangles << " triangles incl. skirts, max " << maxChunks << " chunks" );
+
+	BENCHMARK( "build_terrain() (1025^2)" )
+	{
+		return build_terrain( field ).chunks.size();
+	};
+
+	std::vector<std::uint32_t> chunks;
+	BENCHMARK( "select_terrain_chunks() (1025^2, flyover midpoint)" )
+	{
+		Frustum frustum;
+		chunks.clear();
+		select_terrain_chunks( terrain, make_view_( terrain, 0.5f, frustum ), chunks );
+		return chunks.size();
+	};
+}
@@ -0,0 +1,117 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <memory>
+#include <random>
+#include <filesystem>
+
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+#include "../texlib/mip_chain.hpp"
+#include "../texlib/block_compress.hpp"
+#include "../texlib/texture_cache.hpp"
+
+namespace
+{
+	constexpr std::uint32_t kImageSize = 2048;
+
+	// Smooth gradients plus noise; roughly photo-like as far as JPEG
+	// decoding is concerned.
+	std::vector<std::uint8_t> make_image_( std::uint32_t aSize )
+	{
+		std::mt19937 rng( 1 );
+		std::uniform_int_distribution<int> noise( -24, 24 );
+
+		std::vector<std::uint8_t> ret( std::size_t(aSize) * aSize * 4 );
+		for( std::uint32_t y = 0; y < aSize; ++y )
+		{
+			for( std::uint32_t x = 0; x < aSize; ++x )
+			{
+				std::size_t const i = (std::size_t(y)*aSize + x) * 4;
+				int const base[3] = { int(x * 200 / aSize), int(y * 200 / aSize), int((x + y) * 100 / aSize) };
+				for( std::size_t c = 0; c < 3; ++c )
+					ret[i+c] = std::uint8_t(std::clamp( base[c] + 28 + noise( rng ), 0, 255 ));
+				ret[i+3] = 255;
+			}
+		}
+		return ret;
+	}
+
+	// Reads one byte per page, such that the whole mapping is faulted in
+	// (which an upload would do as well).
+	std::size_t touch_levels_( TextureCache const& aCache )
+	{
+		std::size_t sum = 0;
+		for( std::size_t i = 0; i < aCache.levelCount(); ++i )
+		{
+			auto const* bytes = static_cast<unsigned char const*>(aCache.levelData( i ));
+			for( std::size_t j = 0; j < aCache.levels()[i].size; j += 4096 )
+				sum += bytes[j];
+		}
+		return sum;
+	}
+
+	double mib_( std::size_t aBytes )
+	{
+		return double(aBytes) / (1024.0 * 1024.0);
+	}
+}
+
+TEST_CASE( "Texture cache", "[texlib]" )
+{
+	// The source image is generated, as there are no large textures in
+	// assets/. The caches are built once up front; the benchmarks then
+	// measure warm loads (the OS page cache is not dropped between runs).
+	auto const dir = std::filesystem::temp_directory_path() / "vmlib-bench-texcache";
+	std::filesystem::create_directories( dir );
+	std::string const jpgPath = (dir / "synthetic.jpg").string();
+
+	auto const pixels = make_image_( kImageSize );
+	REQUIRE( stbi_write_jpg( jpgPath.c_str(), int(kImageSize), int(kImageSize), 4, pixels.data(), 90 ) );
+
+	auto const rgba8 = load_texture_cached( jpgPath.c_str(), TextureCacheFormat::kRgba8Srgb );
+	auto const bc1 = load_texture_cached( jpgPath.c_str(), TextureCacheFormat::kBc1Srgb );
+	auto const bc7 = load_texture_cached( jpgPath.c_str(), TextureCacheFormat::kBc7Srgb );
+
+	// glGenerateMipmap() with GL_SRGB8_ALPHA8 needs the same 4/3 of the base
+	// level as the precomputed RGBA8 chain.
+	std::size_t const stbVram = std::size_t(kImageSize) * kImageSize * 4 * 4 / 3;
+	WARN( "VRAM (" << kImageSize << "^2, full chain): stb_image + glGenerateMipmap " << mib_( stbVram ) << " MiB; "
+		<< "cache rgba8 " << mib_( rgba8.dataBytes() ) << " MiB, bc1 " << mib_( bc1.dataBytes() ) << " MiB, bc7 " << mib_( bc7.dataBytes() ) << " MiB; "
+		<< "JPEG " << mib_( std::filesystem::file_size( jpgPath ) ) << " MiB"
+	);
+
+	BENCHMARK( "stb_image decode (2048^2 JPEG)" )
+	{
+		stbi_set_flip_vertically_on_load_thread( 1 );
+
+		int w, h, c;
+		stbi_uc* data = stbi_load( jpgPath.c_str(), &w, &h, &c, 4 );
+		std::size_t const ret = data ? data[0] : 0;
+		stbi_image_free( data );
+		return ret;
+	};
+
+	BENCHMARK( "TextureCache load (2048^2 rgba8)" )
+	{
+		return touch_levels_( TextureCache( texture_cache_path( jpgPath.c_str(), TextureCacheFormat::kRgba8Srgb ).c_str() ) );
+	};
+	BENCHMARK( "TextureCache load (2048^2 bc7)" )
+	{
+		return touch_levels_( TextureCache( texture_cache_path( jpgPath.c_str(), TextureCacheFormat::kBc7Srgb ).c_str() ) );
+	};
+
+	BENCHMARK( "build_mip_chain_srgb() (2048^2)" )
+	{
+		return build_mip_chain_srgb( pixels.data(), kImageSize, kImageSize ).size();
+	};
+
+	BENCHMARK( "compress_image() BC1 (512^2)" )
+	{
+		return compress_image( pixels.data(), 512, 512, BlockFormat::kBc1 ).size();
+	};
+	BENCHMARK( "compress_image() BC7 (512^2)" )
+	{
+		return compress_image( pixels.data(), 512, 512, BlockFormat::kBc7 ).size();
+	};
+}
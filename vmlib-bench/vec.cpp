@@ -0,0 +1,96 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/vec2.hpp"
+#include "../vmlib/vec3.hpp"
+#include "../vmlib/vec4.hpp"
+
+#include "bench_data.hpp"
+
+TEST_CASE( "Vec3f operations", "[vec3]" )
+{
+	auto const as = make_random_vec3s( kVertexCount, 1 );
+	auto const bs = make_random_vec3s( kVertexCount, 2 );
+	std::vector<Vec3f> out( kVertexCount );
+	std::vector<float> outf( kVertexCount );
+
+	BENCHMARK( "Vec3f + Vec3f (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			out[i] = as[i] + bs[i];
+		return out.back().x;
+	};
+	BENCHMARK( "float * Vec3f (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			out[i] = 0.5f * as[i];
+		return out.back().x;
+	};
+	BENCHMARK( "dot(Vec3f) (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			outf[i] = dot( as[i], bs[i] );
+		return outf.back();
+	};
+	BENCHMARK( "length(Vec3f) (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			outf[i] = length( as[i] );
+		return outf.back();
+	};
+	BENCHMARK( "normalize(Vec3f) (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			out[i] = normalize( as[i] );
+		return out.back().x;
+	};
+}
+
+TEST_CASE( "Vec4f operations", "[vec4]" )
+{
+	auto const as = make_random_vec4s( kVertexCount, 1 );
+	auto const bs = make_random_vec4s( kVertexCount, 2 );
+	std::vector<Vec4f> out( kVertexCount );
+	std::vector<float> outf( kVertexCount );
+
+	BENCHMARK( "Vec4f + Vec4f (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			out[i] = as[i] + bs[i];
+		return out.back().x;
+	};
+	BENCHMARK( "float * Vec4f (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			out[i] = 0.5f * as[i];
+		return out.back().x;
+	};
+	BENCHMARK( "dot(Vec4f) (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			outf[i] = dot( as[i], bs[i] );
+		return outf.back();
+	};
+	BENCHMARK( "length(Vec4f) (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			outf[i] = length( as[i] );
+		return outf.back();
+	};
+}
+
+TEST_CASE( "Vec2f operations", "[vec2]" )
+{
+	auto const fs = make_random_floats( kVertexCount*2 );
+	std::vector<Vec2f> as( kVertexCount );
+	for( std::size_t i = 0; i < kVertexCount; ++i )
+		as[i] = Vec2f{ fs[i*2+0], fs[i*2+1] };
+
+	std::vector<float> outf( kVertexCount );
+
+	BENCHMARK( "length(Vec2f) (100k)" )
+	{
+		for( std::size_t i = 0; i < kVertexCount; ++i )
+			outf[i] = length( as[i] );
+		return outf.back();
+	};
+}
@@ -0,0 +1,90 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/rigid.hpp"
+#include "../vmlib/affine.hpp"
+
+namespace
+{
+	void require_mat44_near_( Mat44f const& aA, Mat44f const& aB, float aEps = 1e-5f )
+	{
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE_THAT( aA.v[i], Catch::Matchers::WithinAbs( aB.v[i], aEps ) );
+	}
+	void require_vec3_near_( Vec3f aA, Vec3f aB, float aEps = 1e-5f )
+	{
+		REQUIRE_THAT( aA.x, Catch::Matchers::WithinAbs( aB.x, aEps ) );
+		REQUIRE_THAT( aA.y, Catch::Matchers::WithinAbs( aB.y, aEps ) );
+		REQUIRE_THAT( aA.z, Catch::Matchers::WithinAbs( aB.z, aEps ) );
+	}
+}
+
+TEST_CASE( "Affine3f", "[affine]" )
+{
+	Mat44f const m = make_translation( { 1.f, -2.f, 3.f } )
+		* make_rotation_y( 0.7f )
+		* make_scaling( 2.f, 0.5f, 3.f )
+	;
+	Affine3f const a = to_affine( m );
+
+	SECTION( "Conversion round trip" )
+	{
+		require_mat44_near_( to_mat44( a ), m, 0.f );
+	}
+
+	SECTION( "Composition matches Mat44f" )
+	{
+		Mat44f const m2 = make_rotation_x( -0.3f ) * make_translation( { 0.f, 5.f, 0.f } );
+		require_mat44_near_( to_mat44( a * to_affine( m2 ) ), m * m2 );
+	}
+
+	SECTION( "Point and vector transforms" )
+	{
+		Vec3f const p{ 0.5f, 1.f, -2.f };
+
+		auto const refP = m * Vec4f{ p.x, p.y, p.z, 1.f };
+		auto const refV = m * Vec4f{ p.x, p.y, p.z, 0.f };
+
+		require_vec3_near_( transform_point( a, p ), { refP.x, refP.y, refP.z } );
+		require_vec3_near_( transform_vector( a, p ), { refV.x, refV.y, refV.z } );
+	}
+
+	SECTION( "Inverse matches invert(Mat44f)" )
+	{
+		require_mat44_near_( to_mat44( invert( a ) ), invert( m ) );
+		require_mat44_near_( to_mat44( a * invert( a ) ), kIdentity44f );
+	}
+
+	SECTION( "Normal matrix" )
+	{
+		Mat33f const ref = mat44_to_mat33( transpose( invert( m ) ) );
+		Mat33f const n = normal_matrix( a );
+		for( std::size_t i = 0; i < 9; ++i )
+			REQUIRE_THAT( n.v[i], Catch::Matchers::WithinAbs( ref.v[i], 1e-5f ) );
+	}
+}
+
+TEST_CASE( "RigidTransform", "[affine]" )
+{
+	Mat44f const m = make_translation( { 4.f, 0.f, -1.f } ) * make_rotation_z( 1.1f ) * make_rotation_x( 0.4f );
+	RigidTransform const r = to_rigid( m );
+
+	SECTION( "Conversion round trip" )
+	{
+		require_mat44_near_( to_mat44( r ), m, 0.f );
+	}
+
+	SECTION( "Composition matches Mat44f" )
+	{
+		Mat44f const m2 = make_translation( { 0.f, 1.f, 2.f } ) * make_rotation_y( 2.f );
+		require_mat44_near_( to_mat44( r * to_rigid( m2 ) ), m * m2 );
+	}
+
+	SECTION( "Inverse" )
+	{
+		require_mat44_near_( to_mat44( invert( r ) ), invert( m ) );
+
+		Vec3f const p{ 1.f, 2.f, 3.f };
+		require_vec3_near_( transform_point( invert( r ), transform_point( r, p ) ), p );
+		require_vec3_near_( transform_vector( invert( r ), transform_vector( r, p ) ), p );
+	}
+}
@@ -0,0 +1,104 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/batch.hpp"
+
+namespace
+{
+	// 8-wide kernels plus a few remainder elements.
+	constexpr std::size_t kCount = 19;
+
+	Vec3fStream make_test_stream_()
+	{
+		Vec3fStream ret;
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			float const f = float(i);
+			ret.push_back( { 1.f + f, 0.5f * f - 3.f, 2.f - 0.25f * f } );
+		}
+		return ret;
+	}
+
+	constexpr Mat44f kTestM = { {
+		0.f, -1.f, 0.f, 2.f,
+		2.f, 0.f, 0.f, -1.f,
+		0.f, 0.f, 0.5f, 3.f,
+		0.f, 0.f, 0.f, 1.f
+	} };
+}
+
+TEST_CASE( "Vec3fStream batch kernels", "[batch]" )
+{
+	Vec3fStream const in = make_test_stream_();
+	REQUIRE( in.size() == kCount );
+
+	SECTION( "AoS round trip" )
+	{
+		std::vector<Vec3f> aos( kCount );
+		from_stream( in, aos.data() );
+
+		auto const out = to_stream( aos.data(), aos.size() );
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			REQUIRE( out.get(i).x == in.get(i).x );
+			REQUIRE( out.get(i).y == in.get(i).y );
+			REQUIRE( out.get(i).z == in.get(i).z );
+		}
+	}
+
+	SECTION( "transform_points()" )
+	{
+		Vec3fStream out;
+		transform_points( kTestM, in, out );
+		REQUIRE( out.size() == kCount );
+
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			auto const p = in.get(i);
+			auto const ref = kTestM * Vec4f{ p.x, p.y, p.z, 1.f };
+			REQUIRE_THAT( out.x[i], Catch::Matchers::WithinAbs( ref.x, 1e-5f ) );
+			REQUIRE_THAT( out.y[i], Catch::Matchers::WithinAbs( ref.y, 1e-5f ) );
+			REQUIRE_THAT( out.z[i], Catch::Matchers::WithinAbs( ref.z, 1e-5f ) );
+		}
+	}
+
+	SECTION( "transform_vectors() in place" )
+	{
+		Vec3fStream inout = in;
+		transform_vectors( kTestM, inout, inout );
+
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			auto const p = in.get(i);
+			auto const ref = kTestM * Vec4f{ p.x, p.y, p.z, 0.f };
+			REQUIRE_THAT( inout.x[i], Catch::Matchers::WithinAbs( ref.x, 1e-5f ) );
+			REQUIRE_THAT( inout.y[i], Catch::Matchers::WithinAbs( ref.y, 1e-5f ) );
+			REQUIRE_THAT( inout.z[i], Catch::Matchers::WithinAbs( ref.z, 1e-5f ) );
+		}
+	}
+
+	SECTION( "normalize()" )
+	{
+		Vec3fStream out;
+		normalize( in, out );
+
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			auto const ref = normalize( in.get(i) );
+			REQUIRE_THAT( out.x[i], Catch::Matchers::WithinAbs( ref.x, 1e-6f ) );
+			REQUIRE_THAT( out.y[i], Catch::Matchers::WithinAbs( ref.y, 1e-6f ) );
+			REQUIRE_THAT( out.z[i], Catch::Matchers::WithinAbs( ref.z, 1e-6f ) );
+		}
+	}
+
+	SECTION( "dot()" )
+	{
+		Vec3fStream other;
+		transform_vectors( kTestM, in, other );
+
+		std::vector<float> out( kCount );
+		dot( in, other, out.data() );
+
+		for( std::size_t i = 0; i < kCount; ++i )
+			REQUIRE_THAT( out[i], Catch::Matchers::WithinRel( dot( in.get(i), other.get(i) ), 1e-6f ) );
+	}
+}
@@ -0,0 +1,62 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+
+#include "../vmlib/quat.hpp"
+#include "../vmlib/mat44.hpp"
+#include "../vmlib/cxmath.hpp"
+
+namespace
+{
+	// These are evaluated at compile time. If any of the builders were not
+	// constexpr, this would fail to compile.
+	constexpr Mat44f kPadTransforms[] = {
+		make_translation( { 10.f, 0.f, -3.f } ) * make_rotation_y( 0.5f * kPif ),
+		make_translation( { -4.f, 1.f, 2.f } ) * make_rotation_x( kPif ) * make_scaling( 2.f, 2.f, 2.f ),
+		make_rotation_z( -0.25f * kPif )
+	};
+
+	constexpr Mat44f kProjection = make_perspective_projection( 0.5f * kPif, 16.f/9.f, 0.1f, 100.f );
+
+	constexpr bool near_( float aA, float aB, float aEps = 1e-6f )
+	{
+		return aA - aB <= aEps && aB - aA <= aEps;
+	}
+}
+
+static_assert( near_( kPadTransforms[0](0,0), 0.f ) && near_( kPadTransforms[0](0,2), 1.f ) );
+static_assert( kPadTransforms[0](0,3) == 10.f && kPadTransforms[0](2,3) == -3.f );
+static_assert( near_( kPadTransforms[1](1,1), -2.f ) && near_( kPadTransforms[1](0,0), 2.f ) );
+static_assert( near_( kPadTransforms[2](0,0), 0.70710678f ) && near_( kPadTransforms[2](1,0), -0.70710678f ) );
+static_assert( near_( kProjection(1,1), 1.f ) && near_( kProjection(0,0), 9.f/16.f ) );
+static_assert( near_( constexpr_sin( 0.5f * kPif ), 1.f ) && near_( constexpr_cos( kPif ), -1.f ) );
+static_assert( make_quat_axis_angle( { 0.f, 0.f, 1.f }, kPif ).z == 1.f );
+
+TEST_CASE( "constexpr trigonometry", "[cxmath]" )
+{
+	SECTION( "Compile-time path is within 1 ulp" )
+	{
+		// Call the compile-time implementation at run time, in order to check
+		// many values against the (double precision) standard functions.
+		for( float x = -1000.f; x <= 1000.f; x += 0.137f )
+		{
+			float const refSin = float(std::sin( double(x) ));
+			float const refCos = float(std::cos( double(x) ));
+
+			REQUIRE_THAT( float(detail::cx_sin( x )), Catch::Matchers::WithinULP( refSin, 1 ) );
+			REQUIRE_THAT( float(detail::cx_cos( x )), Catch::Matchers::WithinULP( refCos, 1 ) );
+		}
+
+		REQUIRE_THAT( float(detail::cx_sin( 1e5f )), Catch::Matchers::WithinULP( float(std::sin( 1e5 )), 1 ) );
+	}
+
+	SECTION( "Matches run-time builders" )
+	{
+		// Run-time evaluation uses std::sin() etc.
+		float angle = 0.5f * kPif;
+		Mat44f const rt = make_translation( { 10.f, 0.f, -3.f } ) * make_rotation_y( angle );
+
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE_THAT( rt.v[i], Catch::Matchers::WithinAbs( kPadTransforms[0].v[i], 1e-6f ) );
+	}
+}
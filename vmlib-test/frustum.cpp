@@ -0,0 +1,88 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <random>
+
+#include "../vmlib/frustum.hpp"
+
+namespace
+{
+	// Camera at (0,0,5), looking down -Z.
+	Frustum make_test_frustum_()
+	{
+		Mat44f const proj = make_perspective_projection( 0.5f * kPif, 1.f, 1.f, 100.f );
+		Mat44f const view = make_translation( { 0.f, 0.f, -5.f } );
+		return extract_frustum( proj * view );
+	}
+}
+
+TEST_CASE( "Frustum", "[frustum]" )
+{
+	Frustum const frustum = make_test_frustum_();
+
+	SECTION( "Points" )
+	{
+		REQUIRE( is_visible( frustum, Vec3f{ 0.f, 0.f, 0.f } ) );
+		REQUIRE( is_visible( frustum, Vec3f{ 0.f, 0.f, -90.f } ) );
+		REQUIRE( !is_visible( frustum, Vec3f{ 0.f, 0.f, 4.5f } ) );   // before near
+		REQUIRE( !is_visible( frustum, Vec3f{ 0.f, 0.f, -100.f } ) ); // beyond far
+		REQUIRE( !is_visible( frustum, Vec3f{ 10.f, 0.f, 0.f } ) );    // 90 deg FOV
+		REQUIRE( is_visible( frustum, Vec3f{ 4.f, 0.f, 0.f } ) );
+		REQUIRE( !is_visible( frustum, Vec3f{ 0.f, -6.f, 0.f } ) );
+	}
+
+	SECTION( "Boxes and spheres" )
+	{
+		REQUIRE( is_visible( frustum, Aabb3f{ { 4.f, -1.f, -1.f }, { 6.f, 1.f, 1.f } } ) );
+		REQUIRE( !is_visible( frustum, Aabb3f{ { 7.f, -1.f, -1.f }, { 9.f, 1.f, 1.f } } ) );
+
+		REQUIRE( is_visible( frustum, Sphere3f{ { 6.f, 0.f, 0.f }, 1.f } ) );
+		REQUIRE( !is_visible( frustum, Sphere3f{ { 8.f, 0.f, 0.f }, 1.f } ) );
+		REQUIRE( !is_visible( frustum, Sphere3f{ { 0.f, 0.f, 10.f }, 1.f } ) );
+	}
+
+	SECTION( "Batch tests match single tests" )
+	{
+		// 8-wide kernels plus a few remainder elements.
+		constexpr std::size_t kCount = 8*9 + 5;
+
+		std::mt19937 rng( 42 );
+		std::uniform_real_distribution<float> pos( -60.f, 60.f );
+		std::uniform_real_distribution<float> size( 0.1f, 8.f );
+
+		Aabb3fStream boxes;
+		Sphere3fStream spheres;
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			Vec3f const c{ pos( rng ), pos( rng ), pos( rng ) };
+			Vec3f const e{ size( rng ), size( rng ), size( rng ) };
+			boxes.push_back( { c - e, c + e } );
+			spheres.push_back( { c, e.x } );
+		}
+
+		std::vector<std::uint8_t> boxMask( (kCount+7)/8, 0xff );
+		std::vector<std::uint8_t> sphereMask( (kCount+7)/8, 0xff );
+
+		test_visibility( frustum, boxes, boxMask.data() );
+		test_visibility( frustum, spheres, sphereMask.data() );
+
+		std::size_t visibleBoxes = 0;
+		for( std::size_t i = 0; i < kCount; ++i )
+		{
+			bool const boxBit = 0 != (boxMask[i/8] & (1u << (i%8)));
+			bool const sphereBit = 0 != (sphereMask[i/8] & (1u << (i%8)));
+
+			REQUIRE( boxBit == is_visible( frustum, boxes.get(i) ) );
+			REQUIRE( sphereBit == is_visible( frustum, spheres.get(i) ) );
+
+			visibleBoxes += boxBit;
+		}
+
+		// Sanity check on the test data: some are visible, some are not.
+		REQUIRE( visibleBoxes > 0 );
+		REQUIRE( visibleBoxes < kCount );
+
+		// Unused bits in the last byte are cleared.
+		REQUIRE( 0 == (boxMask.back() >> (kCount%8)) );
+		REQUIRE( 0 == (sphereMask.back() >> (kCount%8)) );
+	}
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/mat44.hpp"
+
+namespace
+{
+	constexpr Mat44f kTestA = { {
+		1.f, 2.f, 3.f, 4.f,
+		-2.f, 0.5f, 1.f, 0.f,
+		0.f, 3.f, -1.f, 2.f,
+		0.f, 0.f, 0.f, 1.f
+	} };
+	constexpr Mat44f kTestB = { {
+		0.5f, 0.f, -1.f, 2.f,
+		1.f, 1.f, 0.f, -3.f,
+		2.f, -0.25f, 4.f, 1.f,
+		0.f, 1.f, 0.f, 1.f
+	} };
+}
+
+TEST_CASE( "Mat44f * Mat44f", "[mat44]" )
+{
+	// Evaluated at compile time -> scalar reference path.
+	constexpr Mat44f ref = kTestA * kTestB;
+	static_assert( ref(0,0) == 8.5f && ref(3,3) == 1.f );
+
+	// Evaluated at run time -> SIMD path (if enabled)
+	Mat44f const a = kTestA, b = kTestB;
+	Mat44f const res = a * b;
+
+	for( std::size_t i = 0; i < 16; ++i )
+		REQUIRE_THAT( res.v[i], Catch::Matchers::WithinRel( ref.v[i], 1e-6f ) || Catch::Matchers::WithinAbs( ref.v[i], 1e-6f ) );
+
+	SECTION( "Identity" )
+	{
+		Mat44f const id = kIdentity44f * a;
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE( id.v[i] == a.v[i] );
+	}
+}
+
+TEST_CASE( "Mat44f * Vec4f", "[mat44]" )
+{
+	constexpr Vec4f v{ 1.f, -2.f, 0.5f, 1.f };
+
+	constexpr Vec4f ref = kTestA * v;
+	static_assert( ref.x == 2.5f && ref.w == 1.f );
+
+	Mat44f const a = kTestA;
+	Vec4f const vv = v;
+	Vec4f const res = a * vv;
+
+	REQUIRE_THAT( res.x, Catch::Matchers::WithinAbs( ref.x, 1e-6f ) );
+	REQUIRE_THAT( res.y, Catch::Matchers::WithinAbs( ref.y, 1e-6f ) );
+	REQUIRE_THAT( res.z, Catch::Matchers::WithinAbs( ref.z, 1e-6f ) );
+	REQUIRE_THAT( res.w, Catch::Matchers::WithinAbs( ref.w, 1e-6f ) );
+}
+
+TEST_CASE( "invert()", "[mat44]" )
+{
+	SECTION( "Matches scalar reference" )
+	{
+		Mat44f const ref = detail::invert_scalar( kTestA );
+		Mat44f const res = invert( kTestA );
+
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE_THAT( res.v[i], Catch::Matchers::WithinAbs( ref.v[i], 1e-5f ) );
+	}
+
+	SECTION( "M * inv(M) is identity" )
+	{
+		for( auto const& m : { kTestA, kTestB } )
+		{
+			Mat44f const res = m * invert( m );
+			for( std::size_t i = 0; i < 16; ++i )
+				REQUIRE_THAT( res.v[i], Catch::Matchers::WithinAbs( kIdentity44f.v[i], 1e-5f ) );
+		}
+	}
+}
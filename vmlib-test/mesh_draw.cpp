@@ -0,0 +1,58 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <filesystem>
+
+#include "../meshlib/mesh_draw.hpp"
+
+namespace
+{
+	MeshMaterial make_material_( char const* aName, float aValue )
+	{
+		return MeshMaterial{ aName, { aValue, 0.f, 0.f }, { 0.f, aValue, 0.f }, { 0.f, 0.f, aValue }, { aValue, aValue, 0.f }, 10.f * aValue, {} };
+	}
+}
+
+TEST_CASE( "Multi-draw batches", "[meshlib]" )
+{
+	// Two levels of detail. Submeshes use materials 0, 2 (LOD 0) and 2 (LOD
+	// 1); the empty submesh produces no command.
+	MeshData mesh;
+	mesh.vertices.resize( 4 );
+	mesh.indices = { 0, 1, 2, 0, 2, 3, 1, 2, 3, 0, 1, 2 };
+	mesh.submeshes = { { 0, 6, 0 }, { 6, 3, 2 }, { 9, 3, 2 }, { 12, 0, 1 } };
+	mesh.materials = { make_material_( "a", 1.f ), make_material_( "b", 2.f ), make_material_( "c", 3.f ) };
+	mesh.lods = { { 0, 2, 0.f }, { 2, 2, 0.5f } };
+
+	auto const path = (std::filesystem::temp_directory_path() / "vmlib-test-draw.meshcache").string();
+	write_mesh_cache( path.c_str(), mesh, {} );
+
+	{
+		MeshCache const cache( path.c_str() );
+		auto const batch = make_draw_batch( cache );
+
+		REQUIRE( batch.lodFirstCommand == std::vector<std::uint32_t>{ 0, 2, 3 } );
+		REQUIRE( batch.commands.size() == 3 );
+		REQUIRE( batch.drawMaterials == std::vector<std::uint32_t>{ 0, 2, 2 } );
+
+		for( std::size_t i = 0; i < batch.commands.size(); ++i )
+		{
+			auto const& cmd = batch.commands[i];
+			REQUIRE( cmd.baseInstance == i );
+			REQUIRE( cmd.instanceCount == 1 );
+			REQUIRE( cmd.baseVertex == 0 );
+			REQUIRE( cmd.firstIndex == mesh.submeshes[i].firstIndex );
+			REQUIRE( cmd.count == mesh.submeshes[i].indexCount );
+		}
+
+		REQUIRE( batch.materials.size() == 3 );
+		auto const& m = batch.materials[2];
+		REQUIRE( m.ambient[0] == 3.f );
+		REQUIRE( m.diffuse[1] == 3.f );
+		REQUIRE( m.specular[2] == 3.f );
+		REQUIRE( m.emissive[0] == 3.f );
+		REQUIRE( m.emissive[1] == 3.f );
+		REQUIRE( m.shininess == 30.f );
+	}
+
+	std::filesystem::remove( path );
+}
@@ -0,0 +1,156 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <array>
+#include <random>
+#include <algorithm>
+
+#include "../meshlib/mesh_optimize.hpp"
+
+namespace
+{
+	// Regular grid of aN x aN quads, as triangle soup in a shuffled order.
+	MeshData make_grid_soup_( std::size_t aN, unsigned aSeed )
+	{
+		struct Tri { std::size_t a, b, c; };
+		std::vector<Tri> tris;
+		for( std::size_t y = 0; y < aN; ++y )
+		{
+			for( std::size_t x = 0; x < aN; ++x )
+			{
+				std::size_t const i = y*(aN+1) + x;
+				tris.push_back( { i, i+1, i+aN+1 } );
+				tris.push_back( { i+1, i+aN+2, i+aN+1 } );
+			}
+		}
+
+		std::mt19937 rng( aSeed );
+		std::shuffle( tris.begin(), tris.end(), rng );
+
+		auto const vertex = [&] (std::size_t aI) {
+			float const x = float(aI % (aN+1)), y = float(aI / (aN+1));
+			return MeshVertex{ { x, 0.f, y }, { 0.f, 1.f, 0.f }, { x / float(aN), y / float(aN) } };
+		};
+
+		MeshData ret;
+		for( auto const& t : tris )
+		{
+			for( auto const i : { t.a, t.b, t.c } )
+			{
+				ret.indices.push_back( std::uint32_t(ret.vertices.size()) );
+				ret.vertices.push_back( vertex( i ) );
+			}
+		}
+
+		ret.submeshes.push_back( { 0, std::uint32_t(ret.indices.size()), 0 } );
+		return ret;
+	}
+
+	// Triangles as vertex positions, in a canonical order, to check that the
+	// processing only reorders.
+	std::vector<std::array<float,9>> canonical_triangles_( MeshData const& aMesh )
+	{
+		std::vector<std::array<float,9>> ret;
+		for( std::size_t i = 0; i < aMesh.indices.size(); i += 3 )
+		{
+			std::array<std::array<float,3>,3> corners;
+			for( std::size_t j = 0; j < 3; ++j )
+			{
+				auto const& p = aMesh.vertices[aMesh.indices[i+j]].position;
+				corners[j] = { p.x, p.y, p.z };
+			}
+
+			// Rotate (keeping the winding) such that the smallest is first
+			auto const first = std::min_element( corners.begin(), corners.end() );
+			std::rotate( corners.begin(), first, corners.end() );
+
+			std::array<float,9> tri;
+			for( std::size_t j = 0; j < 3; ++j )
+				std::copy( corners[j].begin(), corners[j].end(), tri.begin() + 3*j );
+			ret.push_back( tri );
+		}
+
+		std::sort( ret.begin(), ret.end() );
+		return ret;
+	}
+}
+
+TEST_CASE( "Mesh optimization", "[meshlib]" )
+{
+	MeshData const soup = make_grid_soup_( 32, 42 );
+
+	SECTION( "ACMR" )
+	{
+		// Soup: every vertex is a miss.
+		REQUIRE( 3.f == compute_acmr( soup ) );
+
+		// Two triangles sharing an edge: 4 misses
+		std::uint32_t const quad[] = { 0, 1, 2, 1, 3, 2 };
+		REQUIRE( 2.f == compute_acmr( quad, 6, 4 ) );
+
+		// A vertex is evicted after aCacheSize other vertices
+		std::uint32_t const evict[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+		REQUIRE( 3.f == compute_acmr( evict, 9, 6, 4 ) );
+		REQUIRE( 2.f == compute_acmr( evict, 9, 6, 6 ) );
+	}
+
+	SECTION( "Deduplication" )
+	{
+		MeshData mesh = soup;
+		deduplicate_vertices( mesh );
+
+		REQUIRE( 33*33 == mesh.vertices.size() );
+		REQUIRE( soup.indices.size() == mesh.indices.size() );
+		REQUIRE( canonical_triangles_( soup ) == canonical_triangles_( mesh ) );
+	}
+
+	SECTION( "Full pipeline" )
+	{
+		MeshData mesh = soup;
+
+		deduplicate_vertices( mesh );
+		float const dedupAcmr = compute_acmr( mesh );
+
+		optimize_vertex_cache( mesh );
+		float const cacheAcmr = compute_acmr( mesh );
+
+		optimize_vertex_fetch( mesh );
+
+		// Shuffled triangles have poor locality. Forsyth gets a regular
+		// grid well below one miss per triangle.
+		REQUIRE( cacheAcmr < dedupAcmr );
+		REQUIRE( cacheAcmr < 0.9f );
+
+		// Fetch optimization does not change the triangle order.
+		REQUIRE( cacheAcmr == compute_acmr( mesh ) );
+
+		// Vertices are in the order of first use
+		bool inOrder = true;
+		std::uint32_t next = 0;
+		for( auto const idx : mesh.indices )
+		{
+			inOrder = inOrder && idx <= next;
+			if( idx == next )
+				++next;
+		}
+		REQUIRE( inOrder );
+		REQUIRE( next == mesh.vertices.size() );
+
+		REQUIRE( canonical_triangles_( soup ) == canonical_triangles_( mesh ) );
+	}
+
+	SECTION( "Submeshes stay separate" )
+	{
+		MeshData mesh = soup;
+		std::uint32_t const half = std::uint32_t(mesh.indices.size() / 6 * 3);
+		mesh.submeshes = { { 0, half, 0 }, { half, std::uint32_t(mesh.indices.size()) - half, 1 } };
+
+		MeshData firstHalf = soup;
+		firstHalf.indices.resize( half );
+
+		optimize_mesh( mesh );
+
+		MeshData optFirst = mesh;
+		optFirst.indices.resize( half );
+		REQUIRE( canonical_triangles_( firstHalf ) == canonical_triangles_( optFirst ) );
+	}
+}
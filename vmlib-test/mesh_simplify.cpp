@@ -0,0 +1,273 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <set>
+#include <cmath>
+#include <filesystem>
+
+#include "../meshlib/terrain.hpp"
+#include "../meshlib/mesh_cache.hpp"
+#include "../meshlib/mesh_simplify.hpp"
+
+namespace
+{
+	// Indexed grid of aN x aN quads in the XZ plane. Heights come from
+	// aHeight(x,z). If aSeam is set, the vertices at x = aN/2 are duplicated
+	// (different texture coordinates on either side). If aSplit is set, the
+	// quads with x >= aN/2 use a second material (but share the vertices).
+	template< typename tHeight >
+	MeshData make_grid_( std::size_t aN, tHeight&& aHeight, bool aSeam = false, bool aSplit = false )
+	{
+		std::size_t const half = aN / 2;
+
+		MeshData ret;
+		auto const vertex = [&] (std::size_t aX, std::size_t aZ, bool aRight) {
+			float const x = float(aX), z = float(aZ);
+			return MeshVertex{ { x, aHeight( x, z ), z }, { 0.f, 1.f, 0.f }, { aRight ? x + 100.f : x, z } };
+		};
+
+		// Left vertices, then the duplicated seam column
+		for( std::size_t z = 0; z <= aN; ++z )
+		{
+			for( std::size_t x = 0; x <= aN; ++x )
+				ret.vertices.push_back( vertex( x, z, aSeam && x > half ) );
+		}
+		for( std::size_t z = 0; z <= aN; ++z )
+			ret.vertices.push_back( vertex( half, z, true ) );
+
+		auto const index = [&] (std::size_t aX, std::size_t aZ, bool aRight) {
+			if( aSeam && aRight && aX == half )
+				return std::uint32_t((aN+1)*(aN+1) + aZ);
+			return std::uint32_t(aZ*(aN+1) + aX);
+		};
+
+		for( std::size_t side = 0; side < 2; ++side )
+		{
+			auto const first = std::uint32_t(ret.indices.size());
+			for( std::size_t z = 0; z < aN; ++z )
+			{
+				for( std::size_t x = side ? half : 0; x < (side ? aN : half); ++x )
+				{
+					bool const right = 0 != side;
+					ret.indices.insert( ret.indices.end(), { index( x, z, right ), index( x, z+1, right ), index( x+1, z, right ) } );
+					ret.indices.insert( ret.indices.end(), { index( x+1, z, right ), index( x, z+1, right ), index( x+1, z+1, right ) } );
+				}
+			}
+
+			if( aSplit || 0 == side )
+				ret.submeshes.push_back( { first, 0, std::uint32_t(aSplit ? side : 0) } );
+			ret.submeshes.back().indexCount += std::uint32_t(ret.indices.size()) - first;
+		}
+
+		return ret;
+	}
+
+	float flat_( float, float ) noexcept
+	{
+		return 0.f;
+	}
+	float bumpy_( float aX, float aZ ) noexcept
+	{
+		return 2.f * std::sin( aX * 0.3f ) * std::cos( aZ * 0.2f );
+	}
+
+	// Positions at x = aX used by the triangles in [aFirst, aFirst+aCount)
+	std::set<float> column_( MeshData const& aMesh, std::vector<std::uint32_t> const& aIndices, std::size_t aFirst, std::size_t aCount, float aX )
+	{
+		std::set<float> ret;
+		for( std::size_t i = aFirst; i < aFirst+aCount; ++i )
+		{
+			auto const& p = aMesh.vertices[aIndices[i]].position;
+			if( aX == p.x )
+				ret.insert( p.z );
+		}
+		return ret;
+	}
+}
+
+TEST_CASE( "Mesh simplification", "[meshlib]" )
+{
+	constexpr std::size_t kN = 32;
+
+	SECTION( "Flat grid" )
+	{
+		auto const mesh = make_grid_( kN, flat_ );
+
+		SimplifyOptions opts;
+		opts.targetRatio = 0.1f;
+		auto const res = simplify_mesh( mesh, opts );
+
+		REQUIRE( res.indices.size() / 3 <= std::size_t(0.1f * float(mesh.indices.size() / 3)) );
+		REQUIRE( res.indices.size() > 0 );
+		REQUIRE( res.error == Catch::Approx( 0.f ).margin( 1e-4f ) );
+
+		// The outline is unchanged
+		Aabb3f bounds = kEmptyAabb3f;
+		float area = 0.f;
+		for( std::size_t i = 0; i < res.indices.size(); i += 3 )
+		{
+			Vec3f const p[3] = { mesh.vertices[res.indices[i]].position, mesh.vertices[res.indices[i+1]].position, mesh.vertices[res.indices[i+2]].position };
+			for( auto const& q : p )
+				bounds = expand( bounds, q );
+
+			Vec3f const n = cross( p[1] - p[0], p[2] - p[0] );
+			REQUIRE( n.y > 0.f ); // no flips
+			area += 0.5f * length( n );
+		}
+
+		REQUIRE( bounds.min.x == 0.f );
+		REQUIRE( bounds.min.z == 0.f );
+		REQUIRE( bounds.max.x == float(kN) );
+		REQUIRE( bounds.max.z == float(kN) );
+		REQUIRE( area == Catch::Approx( float(kN*kN) ) );
+	}
+
+	SECTION( "UV seam" )
+	{
+		auto const mesh = make_grid_( kN, bumpy_, true );
+
+		SimplifyOptions opts;
+		opts.targetRatio = 0.25f;
+		auto const res = simplify_mesh( mesh, opts );
+		REQUIRE( res.indices.size() / 3 <= mesh.indices.size() / 3 / 2 );
+
+		// Triangles never mix the sides, and both sides still meet at the
+		// same positions (no cracks).
+		std::vector<std::uint32_t> left, right;
+		for( std::size_t i = 0; i < res.indices.size(); i += 3 )
+		{
+			int sides = 0;
+			for( std::size_t j = 0; j < 3; ++j )
+			{
+				auto const& v = mesh.vertices[res.indices[i+j]];
+				if( v.position.x != float(kN/2) )
+					sides |= v.texcoord.x >= 100.f ? 2 : 1;
+			}
+
+			REQUIRE( 3 != sides );
+			auto& out = 2 == sides ? right : left;
+			out.insert( out.end(), res.indices.begin() + std::ptrdiff_t(i), res.indices.begin() + std::ptrdiff_t(i+3) );
+
+			for( std::size_t j = 0; j < 3; ++j )
+			{
+				auto const& v = mesh.vertices[res.indices[i+j]];
+				if( v.position.x == float(kN/2) )
+					REQUIRE( (v.texcoord.x >= 100.f) == (2 == sides) );
+			}
+		}
+
+		auto const seamLeft = column_( mesh, left, 0, left.size(), float(kN/2) );
+		auto const seamRight = column_( mesh, right, 0, right.size(), float(kN/2) );
+		REQUIRE( seamLeft.size() < kN+1 );
+		REQUIRE( seamLeft == seamRight );
+	}
+
+	SECTION( "Material boundary" )
+	{
+		auto const mesh = make_grid_( kN, bumpy_, false, true );
+
+		SimplifyOptions opts;
+		opts.targetRatio = 0.25f;
+		auto const res = simplify_mesh( mesh, opts );
+
+		REQUIRE( res.submeshes.size() == 2 );
+		REQUIRE( res.submeshes[0].materialIndex == 0 );
+		REQUIRE( res.submeshes[1].materialIndex == 1 );
+
+		// Vertices on the boundary are locked
+		auto const& a = res.submeshes[0];
+		auto const& b = res.submeshes[1];
+		auto const colA = column_( mesh, res.indices, a.firstIndex, a.indexCount, float(kN/2) );
+		auto const colB = column_( mesh, res.indices, b.firstIndex, b.indexCount, float(kN/2) );
+		REQUIRE( colA.size() == kN+1 );
+		REQUIRE( colA == colB );
+	}
+
+	SECTION( "Error threshold" )
+	{
+		auto const mesh = make_grid_( kN, bumpy_ );
+
+		SimplifyOptions opts;
+		opts.targetRatio = 0.f;
+		auto const coarse = simplify_mesh( mesh, opts );
+
+		opts.maxError = 0.05f;
+		auto const fine = simplify_mesh( mesh, opts );
+
+		REQUIRE( fine.error <= 0.05f );
+		REQUIRE( fine.indices.size() < mesh.indices.size() );
+		REQUIRE( fine.indices.size() > coarse.indices.size() );
+		REQUIRE( coarse.error > fine.error );
+	}
+
+	SECTION( "LOD chain" )
+	{
+		auto mesh = make_grid_( kN, bumpy_, true );
+		std::size_t const triangles = mesh.indices.size() / 3;
+
+		LodChainOptions opts;
+		opts.maxLevels = 4;
+		build_lod_chain( mesh, opts );
+
+		REQUIRE( mesh.lods.size() == 4 );
+		REQUIRE( mesh.lods[0].firstSubmesh == 0 );
+		REQUIRE( mesh.lods[0].error == 0.f );
+
+		std::size_t prev = triangles + 1;
+		for( std::size_t i = 0; i < mesh.lods.size(); ++i )
+		{
+			auto const& lod = mesh.lods[i];
+			REQUIRE( lod.firstSubmesh + lod.submeshCount <= mesh.submeshes.size() );
+			if( i > 0 )
+			{
+				REQUIRE( lod.firstSubmesh == mesh.lods[i-1].firstSubmesh + mesh.lods[i-1].submeshCount );
+				REQUIRE( lod.error >= mesh.lods[i-1].error );
+			}
+
+			std::size_t tris = 0;
+			for( std::size_t s = lod.firstSubmesh; s < lod.firstSubmesh + lod.submeshCount; ++s )
+			{
+				auto const& sm = mesh.submeshes[s];
+				REQUIRE( sm.firstIndex + sm.indexCount <= mesh.indices.size() );
+				tris += sm.indexCount / 3;
+			}
+
+			REQUIRE( tris < prev );
+			prev = tris;
+		}
+
+		REQUIRE( prev <= triangles / 8 + triangles / 16 );
+
+		SECTION( "Mesh cache" )
+		{
+			auto const path = (std::filesystem::temp_directory_path() / "vmlib-test-lods.meshcache").string();
+			write_mesh_cache( path.c_str(), mesh, {} );
+
+			{
+				MeshCache const cache( path.c_str() );
+				REQUIRE( cache.lodCount() == mesh.lods.size() );
+				for( std::size_t i = 0; i < cache.lodCount(); ++i )
+				{
+					REQUIRE( cache.lods()[i].firstSubmesh == mesh.lods[i].firstSubmesh );
+					REQUIRE( cache.lods()[i].submeshCount == mesh.lods[i].submeshCount );
+					REQUIRE( cache.lods()[i].error == mesh.lods[i].error );
+				}
+
+				// Coarser with distance
+				float const scale = terrain_error_scale( 1.f, 1000.f );
+				REQUIRE( select_mesh_lod( cache, 0.f, scale ) == 0 );
+				REQUIRE( select_mesh_lod( cache, 1e9f, scale ) == cache.lodCount()-1 );
+
+				std::size_t last = 0;
+				for( float d = 1.f; d < 1e5f; d *= 2.f )
+				{
+					auto const lod = select_mesh_lod( cache, d, scale );
+					REQUIRE( lod >= last );
+					REQUIRE( cache.lods()[lod].error * scale / d <= 1.f );
+					last = lod;
+				}
+			}
+
+			std::filesystem::remove( path );
+		}
+	}
+}
@@ -0,0 +1,212 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <limits>
+#include <random>
+
+#include <cmath>
+
+#include "../vmlib/packing.hpp"
+
+TEST_CASE( "Half floats", "[packing]" )
+{
+	static constexpr float kEps_ = 1e-6f;
+
+	using namespace Catch::Matchers;
+
+	SECTION( "Known values" )
+	{
+		REQUIRE( 0x0000 == float_to_half( 0.f ) );
+		REQUIRE( 0x8000 == float_to_half( -0.f ) );
+		REQUIRE( 0x3c00 == float_to_half( 1.f ) );
+		REQUIRE( 0xc000 == float_to_half( -2.f ) );
+		REQUIRE( 0x3555 == float_to_half( 1.f / 3.f ) );
+		REQUIRE( 0x7bff == float_to_half( 65504.f ) );   // largest half
+		REQUIRE( 0x0400 == float_to_half( 6.103515625e-05f ) ); // smallest normal
+		REQUIRE( 0x0001 == float_to_half( 5.9604645e-08f ) );   // smallest subnormal
+
+		REQUIRE_THAT( half_to_float( 0x3555 ), WithinAbs( 0.333251953f, kEps_ ) );
+		REQUIRE( 65504.f == half_to_float( 0x7bff ) );
+		REQUIRE( 5.9604645e-08f == half_to_float( 0x0001 ) );
+	}
+
+	SECTION( "Rounding" )
+	{
+		// 1 + 2^-11 is halfway between 1 and the next half; ties go to even.
+		REQUIRE( 0x3c00 == float_to_half( 1.f + 0.00048828125f ) );
+		REQUIRE( 0x3c02 == float_to_half( 1.f + 3.f * 0.00048828125f ) );
+
+		REQUIRE( 0x7c00 == float_to_half( 65520.f ) ); // rounds to infinity
+		REQUIRE( 0x7bff == float_to_half( 65519.f ) );
+	}
+
+	SECTION( "Special values" )
+	{
+		float const inf = std::numeric_limits<float>::infinity();
+		REQUIRE( 0x7c00 == float_to_half( inf ) );
+		REQUIRE( 0xfc00 == float_to_half( -inf ) );
+		REQUIRE( 0x7c00 == float_to_half( 1e10f ) );
+		REQUIRE( 0x0000 == float_to_half( 1e-10f ) );
+
+		REQUIRE( std::isinf( half_to_float( 0x7c00 ) ) );
+		REQUIRE( std::isnan( half_to_float( float_to_half( std::numeric_limits<float>::quiet_NaN() ) ) ) );
+	}
+
+	SECTION( "All halves round trip" )
+	{
+		std::size_t mismatches = 0;
+		for( std::uint32_t h = 0; h <= 0xffffu; ++h )
+		{
+			auto const half = std::uint16_t(h);
+			if( (half & 0x7c00u) == 0x7c00u && (half & 0x3ffu) ) // NaN
+				continue;
+
+			if( float_to_half( half_to_float( half ) ) != half )
+				++mismatches;
+		}
+
+		REQUIRE( 0 == mismatches );
+	}
+}
+
+TEST_CASE( "Normalized integers", "[packing]" )
+{
+	static constexpr float kEps_ = 1e-6f;
+
+	using namespace Catch::Matchers;
+
+	SECTION( "snorm16" )
+	{
+		REQUIRE( 32767 == pack_snorm16( 1.f ) );
+		REQUIRE( -32767 == pack_snorm16( -1.f ) );
+		REQUIRE( -32767 == pack_snorm16( -2.f ) );
+		REQUIRE( 0 == pack_snorm16( 0.f ) );
+
+		REQUIRE( -1.f == unpack_snorm16( -32768 ) );
+		REQUIRE_THAT( unpack_snorm16( pack_snorm16( 0.25f ) ), WithinAbs( 0.25f, 1.f/32767.f ) );
+	}
+
+	SECTION( "10_10_10_2" )
+	{
+		Vec4f const v{ 0.5f, -0.25f, 1.f, -1.f };
+		std::uint32_t const p = pack_snorm_10_10_10_2( v );
+
+		// Layout matches GL_INT_2_10_10_10_REV
+		REQUIRE( 256u == (p & 0x3ffu) );
+		REQUIRE( 511u == ((p >> 20) & 0x3ffu) );
+		REQUIRE( 3u == (p >> 30) ); // -1 in two bits
+
+		Vec4f const s = unpack_snorm_10_10_10_2( p );
+		REQUIRE_THAT( s.x, WithinAbs( v.x, 0.5f/511.f ) );
+		REQUIRE_THAT( s.y, WithinAbs( v.y, 0.5f/511.f ) );
+		REQUIRE_THAT( s.z, WithinAbs( v.z, kEps_ ) );
+		REQUIRE_THAT( s.w, WithinAbs( v.w, kEps_ ) );
+
+		Vec4f const u = unpack_unorm_10_10_10_2( pack_unorm_10_10_10_2( { 0.f, 0.3f, 1.f, 0.6666667f } ) );
+		REQUIRE_THAT( u.x, WithinAbs( 0.f, kEps_ ) );
+		REQUIRE_THAT( u.y, WithinAbs( 0.3f, 0.5f/1023.f ) );
+		REQUIRE_THAT( u.z, WithinAbs( 1.f, kEps_ ) );
+		REQUIRE_THAT( u.w, WithinAbs( 0.6666667f, kEps_ ) );
+	}
+}
+
+TEST_CASE( "Octahedral normals", "[packing]" )
+{
+	static constexpr float kEps_ = 1e-6f;
+
+	using namespace Catch::Matchers;
+
+	SECTION( "Axes are exact" )
+	{
+		Vec3f const axes[] = {
+			{ 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f },
+			{ 0.f, 1.f, 0.f }, { 0.f, -1.f, 0.f },
+			{ 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f }
+		};
+
+		for( auto const& a : axes )
+		{
+			Vec3f const n = unpack_normal_oct16( pack_normal_oct16( a ) );
+			REQUIRE_THAT( n.x, WithinAbs( a.x, kEps_ ) );
+			REQUIRE_THAT( n.y, WithinAbs( a.y, kEps_ ) );
+			REQUIRE_THAT( n.z, WithinAbs( a.z, kEps_ ) );
+		}
+	}
+
+	SECTION( "Random normals" )
+	{
+		std::mt19937 rng( 42 );
+		std::normal_distribution<float> dist;
+
+		// With 16 bits per component, the angular error stays around 0.01
+		// degrees (~2e-4 radians). For small angles, the distance between the
+		// unit vectors approximates the angle.
+		float worst = 0.f;
+		for( int i = 0; i < 10000; ++i )
+		{
+			Vec3f const n = normalize( Vec3f{ dist( rng ), dist( rng ), dist( rng ) } );
+			Vec3f const d = unpack_normal_oct16( pack_normal_oct16( n ) );
+
+			float const err = length( n - d );
+			worst = err > worst ? err : worst;
+		}
+
+		REQUIRE( worst < 2e-4f );
+	}
+}
+
+TEST_CASE( "Quantized positions", "[packing]" )
+{
+	static constexpr float kEps_ = 1e-6f;
+
+	using namespace Catch::Matchers;
+
+	Aabb3f const bounds{ { -100.f, 2.f, -5.f }, { 300.f, 10.f, 5.f } };
+
+	SECTION( "Corners" )
+	{
+		auto const lo = quantize_position( bounds.min, bounds );
+		auto const hi = quantize_position( bounds.max, bounds );
+		REQUIRE( (0 == lo.x && 0 == lo.y && 0 == lo.z) );
+		REQUIRE( (65535 == hi.x && 65535 == hi.y && 65535 == hi.z) );
+	}
+
+	SECTION( "Error bound" )
+	{
+		std::mt19937 rng( 42 );
+		std::uniform_real_distribution<float> t( 0.f, 1.f );
+
+		Vec3f const ext = bounds.max - bounds.min;
+		for( int i = 0; i < 1000; ++i )
+		{
+			Vec3f const p = bounds.min + Vec3f{ t( rng ) * ext.x, t( rng ) * ext.y, t( rng ) * ext.z };
+			Vec3f const q = dequantize_position( quantize_position( p, bounds ), bounds );
+
+			// Half a quantization step, plus some slack for float rounding
+			REQUIRE_THAT( q.x, WithinAbs( p.x, 0.5f * ext.x / 65535.f + 1e-4f ) );
+			REQUIRE_THAT( q.y, WithinAbs( p.y, 0.5f * ext.y / 65535.f + 1e-5f ) );
+			REQUIRE_THAT( q.z, WithinAbs( p.z, 0.5f * ext.z / 65535.f + 1e-5f ) );
+		}
+	}
+
+	SECTION( "Dequantization transform" )
+	{
+		Vec3f const p{ 20.f, 3.f, -1.f };
+		auto const q = quantize_position( p, bounds );
+
+		// Emulate GL's normalized unsigned short fetch
+		Vec4f const fetched{ unpack_unorm16( q.x ), unpack_unorm16( q.y ), unpack_unorm16( q.z ), 1.f };
+		Vec4f const r = make_dequantization_transform( bounds ) * fetched;
+		Vec3f const d = dequantize_position( q, bounds );
+
+		REQUIRE_THAT( r.x, WithinAbs( d.x, 1e-4f ) );
+		REQUIRE_THAT( r.y, WithinAbs( d.y, kEps_ ) );
+		REQUIRE_THAT( r.z, WithinAbs( d.z, kEps_ ) );
+	}
+
+	SECTION( "Flat bounds" )
+	{
+		Aabb3f const flat{ { 0.f, 1.f, 0.f }, { 10.f, 1.f, 10.f } };
+		Vec3f const d = dequantize_position( quantize_position( { 5.f, 1.f, 5.f }, flat ), flat );
+		REQUIRE_THAT( d.y, WithinAbs( 1.f, kEps_ ) );
+	}
+}
@@ -0,0 +1,137 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include "../vmlib/quat.hpp"
+#include "../vmlib/dualquat.hpp"
+
+namespace
+{
+	constexpr Vec3f kAxisX{ 1.f, 0.f, 0.f };
+	constexpr Vec3f kAxisY{ 0.f, 1.f, 0.f };
+	constexpr Vec3f kAxisZ{ 0.f, 0.f, 1.f };
+
+	void require_mat44_near_( Mat44f const& aA, Mat44f const& aB, float aEps = 1e-5f )
+	{
+		for( std::size_t i = 0; i < 16; ++i )
+			REQUIRE_THAT( aA.v[i], Catch::Matchers::WithinAbs( aB.v[i], aEps ) );
+	}
+	void require_vec3_near_( Vec3f aA, Vec3f aB, float aEps = 1e-5f )
+	{
+		REQUIRE_THAT( aA.x, Catch::Matchers::WithinAbs( aB.x, aEps ) );
+		REQUIRE_THAT( aA.y, Catch::Matchers::WithinAbs( aB.y, aEps ) );
+		REQUIRE_THAT( aA.z, Catch::Matchers::WithinAbs( aB.z, aEps ) );
+	}
+}
+
+TEST_CASE( "Quatf", "[quat]" )
+{
+	SECTION( "constexpr" )
+	{
+		constexpr Quatf q = kIdentityQuatf * kIdentityQuatf;
+		static_assert( q.w == 1.f && q.x == 0.f );
+
+		constexpr Vec3f v = rotate( Quatf{ 0.f, 0.f, 1.f, 0.f }, kAxisX ); // 180° around Z
+		static_assert( v.x == -1.f && v.y == 0.f );
+	}
+
+	SECTION( "Axis-angle matches make_rotation_*()" )
+	{
+		require_mat44_near_( to_mat44( make_quat_axis_angle( kAxisX, 0.8f ) ), make_rotation_x( 0.8f ) );
+		require_mat44_near_( to_mat44( make_quat_axis_angle( kAxisY, -1.3f ) ), make_rotation_y( -1.3f ) );
+		require_mat44_near_( to_mat44( make_quat_axis_angle( kAxisZ, 2.5f ) ), make_rotation_z( 2.5f ) );
+	}
+
+	SECTION( "Composition matches matrix product" )
+	{
+		Quatf const a = make_quat_axis_angle( kAxisY, 0.6f );
+		Quatf const b = make_quat_axis_angle( kAxisX, -0.4f );
+
+		require_mat44_near_( to_mat44( a * b ), make_rotation_y( 0.6f ) * make_rotation_x( -0.4f ) );
+	}
+
+	SECTION( "rotate()" )
+	{
+		Quatf const q = normalize( Quatf{ 0.3f, -0.5f, 0.1f, 0.8f } );
+		Vec3f const v{ 1.f, 2.f, -3.f };
+
+		require_vec3_near_( rotate( q, v ), to_mat33( q ) * v );
+		require_vec3_near_( rotate( invert( q ), rotate( q, v ) ), v );
+	}
+
+	SECTION( "Matrix round trip" )
+	{
+		for( auto const& q : {
+			normalize( Quatf{ 0.3f, -0.5f, 0.1f, 0.8f } ),
+			make_quat_axis_angle( kAxisX, 3.1f ),
+			make_quat_axis_angle( kAxisY, 3.1f ),
+			make_quat_axis_angle( kAxisZ, -3.1f )
+		} )
+		{
+			Quatf r = to_quat( to_mat33( q ) );
+			if( dot( q, r ) < 0.f )
+				r = -r;
+
+			REQUIRE_THAT( dot( q, r ), Catch::Matchers::WithinAbs( 1.f, 1e-5f ) );
+		}
+	}
+
+	SECTION( "slerp() and nlerp()" )
+	{
+		Quatf const a = make_quat_axis_angle( kAxisZ, 0.2f );
+		Quatf const b = make_quat_axis_angle( kAxisZ, 1.4f );
+
+		REQUIRE_THAT( dot( slerp( a, b, 0.f ), a ), Catch::Matchers::WithinAbs( 1.f, 1e-6f ) );
+		REQUIRE_THAT( dot( slerp( a, b, 1.f ), b ), Catch::Matchers::WithinAbs( 1.f, 1e-6f ) );
+
+		Quatf const mid = make_quat_axis_angle( kAxisZ, 0.8f );
+		REQUIRE_THAT( dot( slerp( a, b, 0.5f ), mid ), Catch::Matchers::WithinAbs( 1.f, 1e-6f ) );
+		REQUIRE_THAT( dot( nlerp( a, b, 0.5f ), mid ), Catch::Matchers::WithinAbs( 1.f, 1e-6f ) );
+
+		Quatf const quarter = make_quat_axis_angle( kAxisZ, 0.5f );
+		REQUIRE_THAT( dot( slerp( a, b, 0.25f ), quarter ), Catch::Matchers::WithinAbs( 1.f, 1e-6f ) );
+
+		// Shortest path: -b represents the same rotation.
+		REQUIRE_THAT( dot( slerp( a, -b, 0.5f ), mid ), Catch::Matchers::WithinAbs( 1.f, 1e-6f ) );
+	}
+}
+
+TEST_CASE( "DualQuatf", "[quat]" )
+{
+	Quatf const ra = make_quat_axis_angle( kAxisY, 0.9f );
+	Vec3f const ta{ 1.f, 2.f, 3.f };
+	DualQuatf const a = make_dual_quat( ra, ta );
+
+	Mat44f const ma = make_translation( ta ) * make_rotation_y( 0.9f );
+
+	SECTION( "Matches Mat44f" )
+	{
+		require_mat44_near_( to_mat44( a ), ma );
+		require_vec3_near_( translation_part( a ), ta );
+
+		Vec3f const p{ -1.f, 0.5f, 2.f };
+		auto const ref = ma * Vec4f{ p.x, p.y, p.z, 1.f };
+		require_vec3_near_( transform_point( a, p ), { ref.x, ref.y, ref.z } );
+	}
+
+	SECTION( "Composition and inverse" )
+	{
+		DualQuatf const b = make_dual_quat( make_quat_axis_angle( kAxisX, -0.3f ), { 0.f, -4.f, 1.f } );
+		Mat44f const mb = make_translation( { 0.f, -4.f, 1.f } ) * make_rotation_x( -0.3f );
+
+		require_mat44_near_( to_mat44( a * b ), ma * mb );
+		require_mat44_near_( to_mat44( a * invert( a ) ), kIdentity44f );
+	}
+
+	SECTION( "RigidTransform round trip" )
+	{
+		DualQuatf const r = make_dual_quat( to_rigid( a ) );
+		require_mat44_near_( to_mat44( r ), ma );
+	}
+
+	SECTION( "nlerp() endpoints" )
+	{
+		DualQuatf const b = make_dual_quat( make_quat_axis_angle( kAxisY, 1.5f ), { -2.f, 0.f, 0.f } );
+
+		require_mat44_near_( to_mat44( nlerp( a, b, 0.f ) ), to_mat44( a ) );
+		require_mat44_near_( to_mat44( nlerp( a, b, 1.f ) ), to_mat44( b ) );
+	}
+}
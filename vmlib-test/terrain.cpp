@@ -0,0 +1,161 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+#include "../meshlib/terrain.hpp"
+
+namespace
+{
+	HeightField make_field_( std::uint32_t aWidth, std::uint32_t aDepth )
+	{
+		HeightField ret;
+		ret.width = aWidth;
+		ret.depth = aDepth;
+		ret.originX = -10.f;
+		ret.originZ = 5.f;
+		ret.spacingX = 2.f;
+		ret.spacingZ = 1.f;
+
+		for( std::uint32_t z = 0; z < aDepth; ++z )
+		{
+			for( std::uint32_t x = 0; x < aWidth; ++x )
+				ret.heights.push_back( 3.f * std::sin( float(x) * 0.13f ) * std::cos( float(z) * 0.07f ) + 0.01f * float(x*z % 17) );
+		}
+		return ret;
+	}
+
+	// Triangle count of the quads only (excluding skirts)
+	std::size_t quad_area_( HeightField const& aField, TerrainChunk const& aChunk )
+	{
+		float const dx = (aChunk.bounds.max.x - aChunk.bounds.min.x) / aField.spacingX;
+		float const dz = (aChunk.bounds.max.z - aChunk.bounds.min.z) / aField.spacingZ;
+		return std::size_t(std::lround( dx * dz ));
+	}
+}
+
+TEST_CASE( "Terrain LOD", "[meshlib]" )
+{
+	SECTION( "Height field from a mesh" )
+	{
+		// Plane y = 0.5x - 0.25z + 1, as two triangles
+		auto const plane = [] (float aX, float aZ) { return 0.5f*aX - 0.25f*aZ + 1.f; };
+
+		MeshData mesh;
+		for( auto const& p : { Vec3f{ 0.f, 0.f, 0.f }, Vec3f{ 0.f, 0.f, 8.f }, Vec3f{ 4.f, 0.f, 8.f }, Vec3f{ 4.f, 0.f, 0.f } } )
+			mesh.vertices.push_back( MeshVertex{ Vec3f{ p.x, plane( p.x, p.z ), p.z }, {}, {} } );
+		mesh.indices = { 0, 1, 2, 0, 2, 3 };
+
+		auto const field = make_height_field( mesh, 17 );
+		REQUIRE( 9 == field.width );
+		REQUIRE( 17 == field.depth );
+		REQUIRE( 0.5f == field.spacingX );
+		REQUIRE( 0.5f == field.spacingZ );
+
+		for( std::uint32_t z = 0; z < field.depth; ++z )
+		{
+			for( std::uint32_t x = 0; x < field.width; ++x )
+				REQUIRE_THAT( field.at( x, z ), Catch::Matchers::WithinAbs( plane( float(x) * 0.5f, float(z) * 0.5f ), 1e-5f ) );
+		}
+	}
+
+	SECTION( "Quadtree structure" )
+	{
+		// 129 samples (128 quads) in x: 4 leaves of 32 quads per row. z only
+		// needs 2 rows of leaves, the other children are empty.
+		auto const field = make_field_( 129, 50 );
+		auto const terrain = build_terrain( field, 32 );
+
+		REQUIRE( 3 == terrain.levelCount );
+		REQUIRE( 1 + 2 + 8 == terrain.chunks.size() );
+		REQUIRE( 128*49*2 == terrain.fullResolutionTriangles );
+
+		std::size_t leafArea = 0;
+		for( auto const& chunk : terrain.chunks )
+		{
+			bool const leaf = 2 == chunk.level;
+			for( auto const child : chunk.children )
+			{
+				if( kNoTerrainChunk == child )
+					continue;
+
+				REQUIRE( !leaf );
+				REQUIRE( terrain.chunks[child].level == chunk.level+1 );
+				REQUIRE( terrain.chunks[child].geometricError <= chunk.geometricError );
+			}
+
+			if( leaf )
+			{
+				REQUIRE( 0.f == chunk.geometricError );
+				leafArea += quad_area_( field, chunk );
+			}
+			else
+				REQUIRE( chunk.geometricError > 0.f );
+
+			REQUIRE( chunk.baseVertex + chunk.vertexCount <= terrain.vertices.size() );
+			for( std::uint32_t i = 0; i < chunk.indexCount; ++i )
+				REQUIRE( terrain.indices[chunk.firstIndex + i] < chunk.vertexCount );
+		}
+
+		REQUIRE( 128*49 == leafArea );
+	}
+
+	SECTION( "Skirts" )
+	{
+		// Neighbours may differ by more than one level, so each skirt must
+		// reach the root's error below its edge.
+		auto const field = make_field_( 257, 257 );
+		auto const terrain = build_terrain( field, 32 );
+		REQUIRE( 4 == terrain.levelCount );
+
+		float const rootError = terrain.chunks[0].geometricError;
+		for( auto const& chunk : terrain.chunks )
+		{
+			if( terrain.levelCount-1 != chunk.level )
+				continue;
+
+			auto const x0 = std::uint32_t(std::lround( (chunk.bounds.min.x - field.originX) / field.spacingX ));
+			auto const x1 = std::uint32_t(std::lround( (chunk.bounds.max.x - field.originX) / field.spacingX ));
+			auto const z0 = std::uint32_t(std::lround( (chunk.bounds.min.z - field.originZ) / field.spacingZ ));
+			auto const z1 = std::uint32_t(std::lround( (chunk.bounds.max.z - field.originZ) / field.spacingZ ));
+
+			float edgeMin = field.at( x0, z0 );
+			for( std::uint32_t x = x0; x <= x1; ++x )
+				edgeMin = std::min( { edgeMin, field.at( x, z0 ), field.at( x, z1 ) } );
+			for( std::uint32_t z = z0; z <= z1; ++z )
+				edgeMin = std::min( { edgeMin, field.at( x0, z ), field.at( x1, z ) } );
+
+			REQUIRE( chunk.bounds.min.y <= edgeMin - rootError );
+		}
+	}
+
+	SECTION( "Selection" )
+	{
+		auto const field = make_field_( 257, 257 );
+		auto const terrain = build_terrain( field, 32 );
+		float const scale = terrain_error_scale( 1.f, 1080.f );
+
+		// Far away: the root is sufficient
+		std::vector<std::uint32_t> chunks;
+		select_terrain_chunks( terrain, TerrainView{ Vec3f{ 0.f, 1e6f, 0.f }, scale }, chunks );
+		REQUIRE( 1 == chunks.size() );
+		REQUIRE( 0 == chunks[0] );
+
+		// Close to one corner: fine chunks there, coarse ones elsewhere.
+		// The selection covers the terrain exactly once.
+		chunks.clear();
+		select_terrain_chunks( terrain, TerrainView{ Vec3f{ -10.f, 5.f, 5.f }, scale }, chunks );
+
+		std::size_t area = 0, maxLevel = 0, minLevel = terrain.levelCount;
+		for( auto const index : chunks )
+		{
+			area += quad_area_( field, terrain.chunks[index] );
+			maxLevel = std::max<std::size_t>( maxLevel, terrain.chunks[index].level );
+			minLevel = std::min<std::size_t>( minLevel, terrain.chunks[index].level );
+		}
+
+		REQUIRE( 256*256 == area );
+		REQUIRE( terrain.levelCount-1 == maxLevel );
+		REQUIRE( minLevel < maxLevel );
+	}
+}
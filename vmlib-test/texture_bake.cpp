@@ -0,0 +1,156 @@
+#include <catch2/catch_amalgamated.hpp>
+
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include <cstdlib>
+
+#include "../texlib/mip_chain.hpp"
+#include "../texlib/block_compress.hpp"
+
+namespace
+{
+	std::vector<std::uint8_t> make_solid_( std::uint32_t aW, std::uint32_t aH, std::uint8_t aR, std::uint8_t aG, std::uint8_t aB, std::uint8_t aA )
+	{
+		std::vector<std::uint8_t> ret( std::size_t(aW) * aH * 4 );
+		for( std::size_t i = 0; i < ret.size(); i += 4 )
+		{
+			ret[i+0] = aR;
+			ret[i+1] = aG;
+			ret[i+2] = aB;
+			ret[i+3] = aA;
+		}
+		return ret;
+	}
+
+	int max_abs_error_( std::vector<std::uint8_t> const& aA, std::vector<std::uint8_t> const& aB, std::size_t aChannels = 4 )
+	{
+		int ret = 0;
+		for( std::size_t i = 0; i < aA.size(); ++i )
+		{
+			if( i % 4 < aChannels )
+				ret = std::max( ret, std::abs( int(aA[i]) - int(aB[i]) ) );
+		}
+		return ret;
+	}
+}
+
+TEST_CASE( "Mip chains", "[texlib]" )
+{
+	SECTION( "sRGB round trip" )
+	{
+		for( int i = 0; i < 256; ++i )
+			REQUIRE( i == linear_to_srgb8( srgb8_to_linear( std::uint8_t(i) ) ) );
+
+		REQUIRE( 0.f == srgb8_to_linear( 0 ) );
+		REQUIRE( 1.f == srgb8_to_linear( 255 ) );
+	}
+
+	SECTION( "Filtering in linear space" )
+	{
+		// Black/white checkerboard. Averaging the encoded values would give
+		// 127/128; the correct (linear 0.5) result is sRGB 188.
+		std::vector<std::uint8_t> checker( 8*8*4 );
+		for( std::size_t y = 0; y < 8; ++y )
+		{
+			for( std::size_t x = 0; x < 8; ++x )
+			{
+				std::uint8_t const v = (x + y) % 2 ? 255 : 0;
+				std::size_t const i = (y*8 + x) * 4;
+				checker[i+0] = checker[i+1] = checker[i+2] = v;
+				checker[i+3] = v; // alpha is linear: 127.5
+			}
+		}
+
+		auto const half = downsample_srgb( ImageLevel{ 8, 8, checker } );
+		REQUIRE( 4 == half.width );
+		REQUIRE( 4 == half.height );
+		for( std::size_t i = 0; i < half.data.size(); i += 4 )
+		{
+			REQUIRE( 188 == half.data[i+0] );
+			REQUIRE( 188 == half.data[i+1] );
+			REQUIRE( 188 == half.data[i+2] );
+			REQUIRE( (127 == half.data[i+3] || 128 == half.data[i+3]) );
+		}
+	}
+
+	SECTION( "Chain sizes" )
+	{
+		auto const pixels = make_solid_( 13, 5, 10, 20, 30, 40 );
+		auto const chain = build_mip_chain_srgb( pixels.data(), 13, 5 );
+
+		REQUIRE( mip_level_count( 13, 5 ) == chain.size() );
+		REQUIRE( 4 == chain.size() );
+
+		std::uint32_t const expected[][2] = { { 13, 5 }, { 6, 2 }, { 3, 1 }, { 1, 1 } };
+		for( std::size_t i = 0; i < chain.size(); ++i )
+		{
+			REQUIRE( expected[i][0] == chain[i].width );
+			REQUIRE( expected[i][1] == chain[i].height );
+			REQUIRE( chain[i].width * chain[i].height * 4 == chain[i].data.size() );
+
+			// Constant images stay constant
+			REQUIRE( pixels.front() == chain[i].data.front() );
+			REQUIRE( 0 == max_abs_error_( make_solid_( chain[i].width, chain[i].height, 10, 20, 30, 40 ), chain[i].data ) );
+		}
+	}
+}
+
+TEST_CASE( "Block compression", "[texlib]" )
+{
+	SECTION( "Sizes" )
+	{
+		REQUIRE( 8 == compressed_size( 1, 1, BlockFormat::kBc1 ) );
+		REQUIRE( 16 == compressed_size( 1, 1, BlockFormat::kBc7 ) );
+		REQUIRE( 2*3*8 == compressed_size( 5, 12, BlockFormat::kBc1 ) );
+		REQUIRE( 2*3*16 == compressed_size( 8, 9, BlockFormat::kBc7 ) );
+	}
+
+	SECTION( "BC1 solid colors" )
+	{
+		// Colors that are exactly representable in RGB565
+		for( auto const& c : { std::array<std::uint8_t,3>{ 255, 0, 0 }, { 0, 255, 255 }, { 132, 130, 66 } } )
+		{
+			auto const pixels = make_solid_( 6, 6, c[0], c[1], c[2], 255 );
+			auto const blocks = compress_image( pixels.data(), 6, 6, BlockFormat::kBc1 );
+			REQUIRE( pixels == decompress_image( blocks.data(), 6, 6, BlockFormat::kBc1 ) );
+		}
+	}
+
+	SECTION( "BC7 solid colors" )
+	{
+		// Mode 6 shares one p-bit per endpoint; mixed parities are still
+		// exact (e.g. 254 and 255 below).
+		for( auto const& c : { std::array<std::uint8_t,4>{ 254, 255, 1, 255 }, { 13, 200, 77, 128 }, { 1, 2, 3, 4 } } )
+		{
+			auto const pixels = make_solid_( 6, 6, c[0], c[1], c[2], c[3] );
+			auto const blocks = compress_image( pixels.data(), 6, 6, BlockFormat::kBc7 );
+			REQUIRE( pixels == decompress_image( blocks.data(), 6, 6, BlockFormat::kBc7 ) );
+		}
+	}
+
+	SECTION( "Gradients" )
+	{
+		// Both formats interpolate along a line in color space per block, so
+		// a gradient along x is (nearly) ideal.
+		std::vector<std::uint8_t> pixels( 16*16*4 );
+		for( std::size_t y = 0; y < 16; ++y )
+		{
+			for( std::size_t x = 0; x < 16; ++x )
+			{
+				std::size_t const i = (y*16 + x) * 4;
+				pixels[i+0] = std::uint8_t(x * 16);
+				pixels[i+1] = std::uint8_t(255 - x*16);
+				pixels[i+2] = std::uint8_t(64 + x*8);
+				pixels[i+3] = std::uint8_t(255 - y*2);
+			}
+		}
+
+		auto const bc1 = compress_image( pixels.data(), 16, 16, BlockFormat::kBc1 );
+		REQUIRE( max_abs_error_( pixels, decompress_image( bc1.data(), 16, 16, BlockFormat::kBc1 ), 3 ) <= 12 );
+
+		auto const bc7 = compress_image( pixels.data(), 16, 16, BlockFormat::kBc7 );
+		REQUIRE( max_abs_error_( pixels, decompress_image( bc7.data(), 16, 16, BlockFormat::kBc7 ) ) <= 4 );
+	}
+}
@@ -0,0 +1,168 @@
+#ifndef AFFINE_HPP_317E1B92_0451_4CE5_A6F5_77DA44FA6A95
+#define AFFINE_HPP_317E1B92_0451_4CE5_A6F5_77DA44FA6A95
+
+#include <cmath>
+#include <cassert>
+#include <cstdlib>
+
+#include "vec3.hpp"
+#include "mat33.hpp"
+#include "mat44.hpp"
+
+/** Affine3f: affine transform stored as a 3x4 matrix
+ *
+ * Most transforms we build (translations, rotations, scalings and their
+ * products) are affine, i.e., the last row of the equivalent Mat44f is
+ * always ( 0 0 0 1 ). Affine3f simply does not store that row. This saves a
+ * quarter of the storage, and makes composition and inversion considerably
+ * cheaper (the inverse only needs a 3x3 inverse).
+ *
+ * Like Mat44f, the matrix is stored in row-major order and elements are
+ * accessed with operator ():
+ *
+ *   ⎛ 0,0  0,1  0,2  0,3 ⎞
+ *   ⎜ 1,0  1,1  1,2  1,3 ⎟
+ *   ⎝ 2,0  2,1  2,2  2,3 ⎠
+ *
+ * The left 3x3 block is the linear part, the last column the translation.
+ * Use to_mat44() to get a Mat44f for uploading to OpenGL.
+ */
+struct Affine3f
+{
+	float v[12];
+
+	constexpr
+	float& operator() (std::size_t aI, std::size_t aJ) noexcept
+	{
+		assert( aI < 3 && aJ < 4 );
+		return v[aI*4 + aJ];
+	}
+	constexpr
+	float const& operator() (std::size_t aI, std::size_t aJ) const noexcept
+	{
+		assert( aI < 3 && aJ < 4 );
+		return v[aI*4 + aJ];
+	}
+};
+
+// Identity transform
+constexpr Affine3f kIdentityAffine3f = { {
+	1.f, 0.f, 0.f, 0.f,
+	0.f, 1.f, 0.f, 0.f,
+	0.f, 0.f, 1.f, 0.f
+} };
+
+// Composition: (aLeft * aRight) applies aRight first, like Mat44f.
+constexpr
+Affine3f operator*( Affine3f const& aLeft, Affine3f const& aRight ) noexcept
+{
+	Affine3f ret{};
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 4; ++j )
+		{
+			ret(i,j) = aLeft(i,0) * aRight(0,j)
+				+ aLeft(i,1) * aRight(1,j)
+				+ aLeft(i,2) * aRight(2,j)
+			;
+		}
+
+		ret(i,3) += aLeft(i,3);
+	}
+	return ret;
+}
+
+// Functions:
+
+// Transforms a point (implied w = 1).
+constexpr
+Vec3f transform_point( Affine3f const& aT, Vec3f aPoint ) noexcept
+{
+	return Vec3f{
+		aT(0,0) * aPoint.x + aT(0,1) * aPoint.y + aT(0,2) * aPoint.z + aT(0,3),
+		aT(1,0) * aPoint.x + aT(1,1) * aPoint.y + aT(1,2) * aPoint.z + aT(1,3),
+		aT(2,0) * aPoint.x + aT(2,1) * aPoint.y + aT(2,2) * aPoint.z + aT(2,3)
+	};
+}
+
+// Transforms a direction (implied w = 0), i.e., ignores the translation.
+// Note: normals should be transformed with normal_matrix() instead.
+constexpr
+Vec3f transform_vector( Affine3f const& aT, Vec3f aVector ) noexcept
+{
+	return Vec3f{
+		aT(0,0) * aVector.x + aT(0,1) * aVector.y + aT(0,2) * aVector.z,
+		aT(1,0) * aVector.x + aT(1,1) * aVector.y + aT(1,2) * aVector.z,
+		aT(2,0) * aVector.x + aT(2,1) * aVector.y + aT(2,2) * aVector.z
+	};
+}
+
+constexpr
+Mat33f linear_part( Affine3f const& aT ) noexcept
+{
+	return { {
+		aT(0,0), aT(0,1), aT(0,2),
+		aT(1,0), aT(1,1), aT(1,2),
+		aT(2,0), aT(2,1), aT(2,2)
+	} };
+}
+
+constexpr
+Vec3f translation_part( Affine3f const& aT ) noexcept
+{
+	return Vec3f{ aT(0,3), aT(1,3), aT(2,3) };
+}
+
+constexpr
+Affine3f make_affine( Mat33f const& aLinear, Vec3f aTranslation ) noexcept
+{
+	return { {
+		aLinear(0,0), aLinear(0,1), aLinear(0,2), aTranslation.x,
+		aLinear(1,0), aLinear(1,1), aLinear(1,2), aTranslation.y,
+		aLinear(2,0), aLinear(2,1), aLinear(2,2), aTranslation.z
+	} };
+}
+
+// Conversion from Mat44f. The last row of aM must be ( 0 0 0 1 ); i.e., this
+// works with the results of make_translation(), make_rotation_*() and
+// make_scaling() and their products, but not with projections.
+constexpr
+Affine3f to_affine( Mat44f const& aM ) noexcept
+{
+	assert( 0.f == aM(3,0) && 0.f == aM(3,1) && 0.f == aM(3,2) && 1.f == aM(3,3) );
+	return { {
+		aM(0,0), aM(0,1), aM(0,2), aM(0,3),
+		aM(1,0), aM(1,1), aM(1,2), aM(1,3),
+		aM(2,0), aM(2,1), aM(2,2), aM(2,3)
+	} };
+}
+
+constexpr
+Mat44f to_mat44( Affine3f const& aT ) noexcept
+{
+	return { {
+		aT(0,0), aT(0,1), aT(0,2), aT(0,3),
+		aT(1,0), aT(1,1), aT(1,2), aT(1,3),
+		aT(2,0), aT(2,1), aT(2,2), aT(2,3),
+		0.f, 0.f, 0.f, 1.f
+	} };
+}
+
+// Inverse of an affine transform:
+//   inv( L | t ) = ( inv(L) | -inv(L) t )
+// Only needs a 3x3 inverse, compared to the general 4x4 invert().
+constexpr
+Affine3f invert( Affine3f const& aT ) noexcept
+{
+	Mat33f const linv = invert( linear_part( aT ) );
+	return make_affine( linv, -(linv * translation_part( aT )) );
+}
+
+// Normal matrix, transpose( inverse( L ) ), where L is the linear part of aT.
+constexpr
+Mat33f normal_matrix( Affine3f const& aT ) noexcept
+{
+	return transpose( invert( linear_part( aT ) ) );
+}
+
+#endif // AFFINE_HPP_317E1B92_0451_4CE5_A6F5_77DA44FA6A95
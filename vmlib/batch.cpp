@@ -0,0 +1,177 @@
+#include "batch.hpp"
+
+#include "simd.hpp"
+
+namespace
+{
+	// Shared by transform_points() and transform_vectors(). For points, the
+	// implied fourth component is 1, so the translation column is added.
+	template< bool tPoints >
+	void transform_( Mat44f const& aM, Vec3fStream const& aIn, Vec3fStream& aOut )
+	{
+		std::size_t const count = aIn.size();
+		aOut.resize( count );
+
+		float const* ix = aIn.x.data();
+		float const* iy = aIn.y.data();
+		float const* iz = aIn.z.data();
+		float* ox = aOut.x.data();
+		float* oy = aOut.y.data();
+		float* oz = aOut.z.data();
+
+		std::size_t i = 0;
+
+#		if VMLIB_SIMD_AVX
+		__m256 const m00 = _mm256_set1_ps( aM(0,0) ), m01 = _mm256_set1_ps( aM(0,1) ), m02 = _mm256_set1_ps( aM(0,2) ), m03 = _mm256_set1_ps( aM(0,3) );
+		__m256 const m10 = _mm256_set1_ps( aM(1,0) ), m11 = _mm256_set1_ps( aM(1,1) ), m12 = _mm256_set1_ps( aM(1,2) ), m13 = _mm256_set1_ps( aM(1,3) );
+		__m256 const m20 = _mm256_set1_ps( aM(2,0) ), m21 = _mm256_set1_ps( aM(2,1) ), m22 = _mm256_set1_ps( aM(2,2) ), m23 = _mm256_set1_ps( aM(2,3) );
+
+		for( ; i + 8 <= count; i += 8 )
+		{
+			__m256 const x = _mm256_loadu_ps( ix+i );
+			__m256 const y = _mm256_loadu_ps( iy+i );
+			__m256 const z = _mm256_loadu_ps( iz+i );
+
+			__m256 rx = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( m00, x ), _mm256_mul_ps( m01, y ) ), _mm256_mul_ps( m02, z ) );
+			__m256 ry = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( m10, x ), _mm256_mul_ps( m11, y ) ), _mm256_mul_ps( m12, z ) );
+			__m256 rz = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( m20, x ), _mm256_mul_ps( m21, y ) ), _mm256_mul_ps( m22, z ) );
+
+			if constexpr( tPoints )
+			{
+				rx = _mm256_add_ps( rx, m03 );
+				ry = _mm256_add_ps( ry, m13 );
+				rz = _mm256_add_ps( rz, m23 );
+			}
+
+			_mm256_storeu_ps( ox+i, rx );
+			_mm256_storeu_ps( oy+i, ry );
+			_mm256_storeu_ps( oz+i, rz );
+		}
+#		endif // ~ AVX
+
+		for( ; i < count; ++i )
+		{
+			float const x = ix[i], y = iy[i], z = iz[i];
+
+			float rx = aM(0,0) * x + aM(0,1) * y + aM(0,2) * z;
+			float ry = aM(1,0) * x + aM(1,1) * y + aM(1,2) * z;
+			float rz = aM(2,0) * x + aM(2,1) * y + aM(2,2) * z;
+
+			if constexpr( tPoints )
+			{
+				rx += aM(0,3);
+				ry += aM(1,3);
+				rz += aM(2,3);
+			}
+
+			ox[i] = rx;
+			oy[i] = ry;
+			oz[i] = rz;
+		}
+	}
+}
+
+Vec3fStream to_stream( Vec3f const* aVecs, std::size_t aCount )
+{
+	Vec3fStream ret;
+	ret.resize( aCount );
+
+	for( std::size_t i = 0; i < aCount; ++i )
+	{
+		ret.x[i] = aVecs[i].x;
+		ret.y[i] = aVecs[i].y;
+		ret.z[i] = aVecs[i].z;
+	}
+
+	return ret;
+}
+
+void from_stream( Vec3fStream const& aStream, Vec3f* aOut ) noexcept
+{
+	std::size_t const count = aStream.size();
+	for( std::size_t i = 0; i < count; ++i )
+		aOut[i] = Vec3f{ aStream.x[i], aStream.y[i], aStream.z[i] };
+}
+
+
+void transform_points( Mat44f const& aM, Vec3fStream const& aIn, Vec3fStream& aOut )
+{
+	transform_<true>( aM, aIn, aOut );
+}
+
+void transform_vectors( Mat44f const& aM, Vec3fStream const& aIn, Vec3fStream& aOut )
+{
+	transform_<false>( aM, aIn, aOut );
+}
+
+void normalize( Vec3fStream const& aIn, Vec3fStream& aOut )
+{
+	std::size_t const count = aIn.size();
+	aOut.resize( count );
+
+	float const* ix = aIn.x.data();
+	float const* iy = aIn.y.data();
+	float const* iz = aIn.z.data();
+	float* ox = aOut.x.data();
+	float* oy = aOut.y.data();
+	float* oz = aOut.z.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_AVX
+	// Note: this intentionally uses a full-precision sqrt and division rather
+	// than _mm256_rsqrt_ps(), such that results match normalize(Vec3f).
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256 const x = _mm256_loadu_ps( ix+i );
+		__m256 const y = _mm256_loadu_ps( iy+i );
+		__m256 const z = _mm256_loadu_ps( iz+i );
+
+		__m256 const len = _mm256_sqrt_ps( _mm256_add_ps(
+			_mm256_add_ps( _mm256_mul_ps( x, x ), _mm256_mul_ps( y, y ) ),
+			_mm256_mul_ps( z, z )
+		) );
+
+		_mm256_storeu_ps( ox+i, _mm256_div_ps( x, len ) );
+		_mm256_storeu_ps( oy+i, _mm256_div_ps( y, len ) );
+		_mm256_storeu_ps( oz+i, _mm256_div_ps( z, len ) );
+	}
+#	endif // ~ AVX
+
+	for( ; i < count; ++i )
+	{
+		auto const n = normalize( Vec3f{ ix[i], iy[i], iz[i] } );
+		ox[i] = n.x;
+		oy[i] = n.y;
+		oz[i] = n.z;
+	}
+}
+
+void dot( Vec3fStream const& aLeft, Vec3fStream const& aRight, float* aOut ) noexcept
+{
+	assert( aLeft.size() == aRight.size() );
+	std::size_t const count = aLeft.size();
+
+	float const* lx = aLeft.x.data();
+	float const* ly = aLeft.y.data();
+	float const* lz = aLeft.z.data();
+	float const* rx = aRight.x.data();
+	float const* ry = aRight.y.data();
+	float const* rz = aRight.z.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_AVX
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256 const xx = _mm256_mul_ps( _mm256_loadu_ps( lx+i ), _mm256_loadu_ps( rx+i ) );
+		__m256 const yy = _mm256_mul_ps( _mm256_loadu_ps( ly+i ), _mm256_loadu_ps( ry+i ) );
+		__m256 const zz = _mm256_mul_ps( _mm256_loadu_ps( lz+i ), _mm256_loadu_ps( rz+i ) );
+
+		_mm256_storeu_ps( aOut+i, _mm256_add_ps( _mm256_add_ps( xx, yy ), zz ) );
+	}
+#	endif // ~ AVX
+
+	for( ; i < count; ++i )
+		aOut[i] = lx[i] * rx[i] + ly[i] * ry[i] + lz[i] * rz[i];
+}
@@ -0,0 +1,105 @@
+#ifndef BATCH_HPP_E5C8D9D2_9FAF_4747_9228_DB71012BFD78
+#define BATCH_HPP_E5C8D9D2_9FAF_4747_9228_DB71012BFD78
+
+#include <vector>
+
+#include <cassert>
+#include <cstdlib>
+
+#include "vec3.hpp"
+#include "mat44.hpp"
+
+/** Vec3fStream: many Vec3fs in structure-of-arrays (SoA) layout
+ *
+ * Vec3f is an array-of-structures (AoS) type, which is convenient for
+ * individual vectors but gets in the way of vectorization when processing
+ * large numbers of them. Vec3fStream keeps the x, y and z components in
+ * separate arrays, such that the batch kernels below can process eight
+ * vectors per AVX instruction.
+ *
+ * Example:
+ *   Vec3fStream points = to_stream( positions.data(), positions.size() );
+ *   transform_points( model2world, points, points );
+ */
+struct Vec3fStream
+{
+	std::vector<float> x, y, z;
+
+	std::size_t size() const noexcept
+	{
+		assert( x.size() == y.size() && x.size() == z.size() );
+		return x.size();
+	}
+
+	void resize( std::size_t aCount )
+	{
+		x.resize( aCount );
+		y.resize( aCount );
+		z.resize( aCount );
+	}
+
+	void reserve( std::size_t aCount )
+	{
+		x.reserve( aCount );
+		y.reserve( aCount );
+		z.reserve( aCount );
+	}
+
+	void clear() noexcept
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+	}
+
+	void push_back( Vec3f aVec )
+	{
+		x.push_back( aVec.x );
+		y.push_back( aVec.y );
+		z.push_back( aVec.z );
+	}
+
+	Vec3f get( std::size_t aI ) const noexcept
+	{
+		assert( aI < size() );
+		return { x[aI], y[aI], z[aI] };
+	}
+	void set( std::size_t aI, Vec3f aVec ) noexcept
+	{
+		assert( aI < size() );
+		x[aI] = aVec.x;
+		y[aI] = aVec.y;
+		z[aI] = aVec.z;
+	}
+};
+
+// Conversion from/to AoS data.
+Vec3fStream to_stream( Vec3f const* aVecs, std::size_t aCount );
+void from_stream( Vec3fStream const& aStream, Vec3f* aOut ) noexcept;
+
+// Batch kernels
+//
+// The kernels use 8-wide AVX when available; the remaining (count % 8)
+// elements, or all elements without AVX, are processed by the equivalent
+// scalar code. Results match the corresponding single-vector operations.
+//
+// The output stream is resized to match the input. Input and output may be
+// the same stream (in-place operation).
+
+// Transform points: aOut[i] = (aM * Vec4f{ aIn[i], 1 }).xyz
+// No perspective divide is performed, so aM should be affine.
+void transform_points( Mat44f const& aM, Vec3fStream const& aIn, Vec3fStream& aOut );
+
+// Transform directions: aOut[i] = (aM * Vec4f{ aIn[i], 0 }).xyz
+// For normals, pass the normal matrix, i.e., transpose(invert(M)).
+void transform_vectors( Mat44f const& aM, Vec3fStream const& aIn, Vec3fStream& aOut );
+
+// Normalize: aOut[i] = normalize( aIn[i] )
+void normalize( Vec3fStream const& aIn, Vec3fStream& aOut );
+
+// Dot products: aOut[i] = dot( aLeft[i], aRight[i] )
+// aLeft and aRight must have the same size. aOut must have room for
+// aLeft.size() elements.
+void dot( Vec3fStream const& aLeft, Vec3fStream const& aRight, float* aOut ) noexcept;
+
+#endif // BATCH_HPP_E5C8D9D2_9FAF_4747_9228_DB71012BFD78
@@ -0,0 +1,155 @@
+#ifndef BOUNDS_HPP_934B7327_2E16_44D4_A18A_02CCB3298020
+#define BOUNDS_HPP_934B7327_2E16_44D4_A18A_02CCB3298020
+
+#include <vector>
+
+#include <cassert>
+#include <cstdlib>
+
+#include "vec3.hpp"
+#include "batch.hpp"
+
+/** Aabb3f: axis-aligned bounding box
+ *
+ * Stored as the minimum and maximum corners. A box is empty if any
+ * component of min is larger than the corresponding component of max; see
+ * kEmptyAabb3f, which is handy as the initial value when accumulating
+ * points with expand().
+ */
+struct Aabb3f
+{
+	Vec3f min;
+	Vec3f max;
+};
+
+constexpr Aabb3f kEmptyAabb3f = {
+	Vec3f{ 3.402823466e+38f, 3.402823466e+38f, 3.402823466e+38f },
+	Vec3f{ -3.402823466e+38f, -3.402823466e+38f, -3.402823466e+38f }
+};
+
+/** Sphere3f: bounding sphere
+ */
+struct Sphere3f
+{
+	Vec3f center;
+	float radius;
+};
+
+// Functions:
+
+constexpr
+Aabb3f expand( Aabb3f const& aBox, Vec3f aPoint ) noexcept
+{
+	return Aabb3f{
+		Vec3f{
+			aPoint.x < aBox.min.x ? aPoint.x : aBox.min.x,
+			aPoint.y < aBox.min.y ? aPoint.y : aBox.min.y,
+			aPoint.z < aBox.min.z ? aPoint.z : aBox.min.z
+		},
+		Vec3f{
+			aPoint.x > aBox.max.x ? aPoint.x : aBox.max.x,
+			aPoint.y > aBox.max.y ? aPoint.y : aBox.max.y,
+			aPoint.z > aBox.max.z ? aPoint.z : aBox.max.z
+		}
+	};
+}
+
+constexpr
+Aabb3f merge( Aabb3f const& aLeft, Aabb3f const& aRight ) noexcept
+{
+	return expand( expand( aLeft, aRight.min ), aRight.max );
+}
+
+constexpr
+bool contains( Aabb3f const& aBox, Vec3f aPoint ) noexcept
+{
+	return aPoint.x >= aBox.min.x && aPoint.x <= aBox.max.x
+		&& aPoint.y >= aBox.min.y && aPoint.y <= aBox.max.y
+		&& aPoint.z >= aBox.min.z && aPoint.z <= aBox.max.z
+	;
+}
+
+constexpr
+Vec3f center( Aabb3f const& aBox ) noexcept
+{
+	return 0.5f * (aBox.min + aBox.max);
+}
+
+constexpr
+Vec3f extents( Aabb3f const& aBox ) noexcept
+{
+	return 0.5f * (aBox.max - aBox.min);
+}
+
+// Smallest sphere centered on the box's center that contains the box.
+inline
+Sphere3f bounding_sphere( Aabb3f const& aBox ) noexcept
+{
+	return Sphere3f{ center( aBox ), length( extents( aBox ) ) };
+}
+
+
+/** Aabb3fStream, Sphere3fStream: many bounding volumes in SoA layout
+ *
+ * See Vec3fStream (batch.hpp). Used by the batch frustum tests in
+ * frustum.hpp.
+ */
+struct Aabb3fStream
+{
+	Vec3fStream min;
+	Vec3fStream max;
+
+	std::size_t size() const noexcept
+	{
+		assert( min.size() == max.size() );
+		return min.size();
+	}
+
+	void clear() noexcept
+	{
+		min.clear();
+		max.clear();
+	}
+
+	void push_back( Aabb3f const& aBox )
+	{
+		min.push_back( aBox.min );
+		max.push_back( aBox.max );
+	}
+
+	Aabb3f get( std::size_t aI ) const noexcept
+	{
+		return Aabb3f{ min.get( aI ), max.get( aI ) };
+	}
+};
+
+struct Sphere3fStream
+{
+	Vec3fStream center;
+	std::vector<float> radius;
+
+	std::size_t size() const noexcept
+	{
+		assert( center.size() == radius.size() );
+		return radius.size();
+	}
+
+	void clear() noexcept
+	{
+		center.clear();
+		radius.clear();
+	}
+
+	void push_back( Sphere3f const& aSphere )
+	{
+		center.push_back( aSphere.center );
+		radius.push_back( aSphere.radius );
+	}
+
+	Sphere3f get( std::size_t aI ) const noexcept
+	{
+		return Sphere3f{ center.get( aI ), radius[aI] };
+	}
+};
+
+#endif // BOUNDS_HPP_934B7327_2E16_44D4_A18A_02CCB3298020
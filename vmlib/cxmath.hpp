@@ -0,0 +1,143 @@
+#ifndef CXMATH_HPP_646DF558_B375_4C1C_B13C_9DBE2C078F8D
+#define CXMATH_HPP_646DF558_B375_4C1C_B13C_9DBE2C078F8D
+
+#include <cmath>
+#include <limits>
+
+#include "simd.hpp" // detail::is_constant_evaluated()
+
+/* constexpr trigonometry
+ *
+ * The standard functions (std::sin() etc) are not constexpr in C++17. The
+ * functions below can be evaluated at compile time, which allows building
+ * fixed transforms as constexpr Mat44f tables.
+ *
+ * At run time, the functions forward to the standard library (assuming that
+ * detail::is_constant_evaluated() works, see simd.hpp). At compile time, the
+ * result is computed in double precision: the argument is reduced to
+ * [-pi/4, pi/4] and evaluated with a Taylor series. The compile-time results
+ * are within 1 ulp (float) of the correctly rounded value for |x| <= 1e5.
+ * Larger arguments lose accuracy in the range reduction.
+ */
+
+constexpr float kPif = 3.14159265358979323846f;
+
+namespace detail
+{
+	constexpr double kCxPi = 3.14159265358979323846;
+
+	// pi/2 split into two parts (Cody-Waite), for a more accurate reduction.
+	constexpr double kCxHalfPiHi = 1.57079632679489655800e+00;
+	constexpr double kCxHalfPiLo = 6.12323399573676603587e-17;
+
+	// Reduce aX to r in [-pi/4, pi/4] such that aX = r + k pi/2. Returns r and
+	// stores k mod 4 in aQuadrant.
+	constexpr
+	double cx_reduce( double aX, int& aQuadrant ) noexcept
+	{
+		double const fk = aX * (2.0 / kCxPi);
+		long long const k = static_cast<long long>( fk < 0.0 ? fk - 0.5 : fk + 0.5 );
+
+		aQuadrant = static_cast<int>( k & 3 );
+
+		double const dk = static_cast<double>( k );
+		return (aX - dk * kCxHalfPiHi) - dk * kCxHalfPiLo;
+	}
+
+	// Series for |aX| <= pi/4. The first omitted term is below 1e-16.
+	constexpr
+	double cx_sin_kernel( double aX ) noexcept
+	{
+		double const x2 = aX * aX;
+		double term = aX, sum = aX;
+		for( int n = 1; n <= 8; ++n )
+		{
+			term *= -x2 / double( (2*n) * (2*n+1) );
+			sum += term;
+		}
+		return sum;
+	}
+	constexpr
+	double cx_cos_kernel( double aX ) noexcept
+	{
+		double const x2 = aX * aX;
+		double term = 1.0, sum = 1.0;
+		for( int n = 1; n <= 9; ++n )
+		{
+			term *= -x2 / double( (2*n-1) * (2*n) );
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr
+	bool cx_is_finite( double aX ) noexcept
+	{
+		return aX == aX
+			&& aX <= std::numeric_limits<double>::max()
+			&& aX >= -std::numeric_limits<double>::max()
+		;
+	}
+
+	constexpr
+	double cx_sin( double aX ) noexcept
+	{
+		if( !cx_is_finite( aX ) )
+			return std::numeric_limits<double>::quiet_NaN();
+
+		int q = 0;
+		double const r = cx_reduce( aX, q );
+		switch( q )
+		{
+			case 0: return cx_sin_kernel( r );
+			case 1: return cx_cos_kernel( r );
+			case 2: return -cx_sin_kernel( r );
+			default: return -cx_cos_kernel( r );
+		}
+	}
+	constexpr
+	double cx_cos( double aX ) noexcept
+	{
+		if( !cx_is_finite( aX ) )
+			return std::numeric_limits<double>::quiet_NaN();
+
+		int q = 0;
+		double const r = cx_reduce( aX, q );
+		switch( q )
+		{
+			case 0: return cx_cos_kernel( r );
+			case 1: return -cx_sin_kernel( r );
+			case 2: return -cx_cos_kernel( r );
+			default: return cx_sin_kernel( r );
+		}
+	}
+}
+
+constexpr
+float constexpr_sin( float aX ) noexcept
+{
+	if( !detail::is_constant_evaluated() )
+		return std::sin( aX );
+
+	return float(detail::cx_sin( aX ));
+}
+
+constexpr
+float constexpr_cos( float aX ) noexcept
+{
+	if( !detail::is_constant_evaluated() )
+		return std::cos( aX );
+
+	return float(detail::cx_cos( aX ));
+}
+
+constexpr
+float constexpr_tan( float aX ) noexcept
+{
+	if( !detail::is_constant_evaluated() )
+		return std::tan( aX );
+
+	return float(detail::cx_sin( aX ) / detail::cx_cos( aX ));
+}
+
+#endif // CXMATH_HPP_646DF558_B375_4C1C_B13C_9DBE2C078F8D
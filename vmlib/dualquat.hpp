@@ -0,0 +1,127 @@
+#ifndef DUALQUAT_HPP_F5258B16_93F8_4E08_9158_37DA81CEE9F2
+#define DUALQUAT_HPP_F5258B16_93F8_4E08_9158_37DA81CEE9F2
+
+#include <cmath>
+
+#include "vec3.hpp"
+#include "quat.hpp"
+#include "mat44.hpp"
+#include "rigid.hpp"
+
+/** DualQuatf: dual quaternion with floats
+ *
+ * A unit dual quaternion represents a rigid motion (rotation followed by a
+ * translation) in 8 floats. Like Quatf for rotations, dual quaternions
+ * compose cheaply, can be blended (nlerp()) and re-normalized, which makes
+ * them handy for chains of rigid transforms (e.g., animated hierarchies).
+ *
+ * For a rotation r and translation t,
+ *   real = r
+ *   dual = 1/2 (t,0) r
+ * see make_dual_quat().
+ */
+struct DualQuatf
+{
+	Quatf real;
+	Quatf dual;
+};
+
+constexpr DualQuatf kIdentityDualQuatf = {
+	kIdentityQuatf,
+	Quatf{ 0.f, 0.f, 0.f, 0.f }
+};
+
+// Composition: (aLeft * aRight) applies aRight first.
+constexpr
+DualQuatf operator*( DualQuatf const& aLeft, DualQuatf const& aRight ) noexcept
+{
+	return DualQuatf{
+		aLeft.real * aRight.real,
+		aLeft.real * aRight.dual + aLeft.dual * aRight.real
+	};
+}
+
+// Functions:
+
+// Rotation by aRotation (unit quaternion), followed by a translation.
+constexpr
+DualQuatf make_dual_quat( Quatf aRotation, Vec3f aTranslation ) noexcept
+{
+	Quatf const t{ aTranslation.x, aTranslation.y, aTranslation.z, 0.f };
+	return DualQuatf{ aRotation, 0.5f * (t * aRotation) };
+}
+
+constexpr
+Vec3f translation_part( DualQuatf const& aDQ ) noexcept
+{
+	Quatf const t = 2.f * (aDQ.dual * conjugate( aDQ.real ));
+	return Vec3f{ t.x, t.y, t.z };
+}
+
+constexpr
+Vec3f transform_point( DualQuatf const& aDQ, Vec3f aPoint ) noexcept
+{
+	return rotate( aDQ.real, aPoint ) + translation_part( aDQ );
+}
+
+constexpr
+Vec3f transform_vector( DualQuatf const& aDQ, Vec3f aVector ) noexcept
+{
+	return rotate( aDQ.real, aVector );
+}
+
+// Inverse of a unit dual quaternion.
+constexpr
+DualQuatf invert( DualQuatf const& aDQ ) noexcept
+{
+	return DualQuatf{ conjugate( aDQ.real ), conjugate( aDQ.dual ) };
+}
+
+// Normalizes aDQ, such that real is a unit quaternion and dual is orthogonal
+// to it.
+inline
+DualQuatf normalize( DualQuatf const& aDQ ) noexcept
+{
+	float const rcpLen = 1.f / length( aDQ.real );
+
+	Quatf const real = rcpLen * aDQ.real;
+	Quatf const dual = rcpLen * aDQ.dual;
+	return DualQuatf{ real, dual - dot( real, dual ) * real };
+}
+
+// Dual quaternion linear blending. Takes the shortest path.
+inline
+DualQuatf nlerp( DualQuatf const& aFrom, DualQuatf const& aTo, float aT ) noexcept
+{
+	float const sign = dot( aFrom.real, aTo.real ) < 0.f ? -1.f : 1.f;
+	return normalize( DualQuatf{
+		(1.f - aT) * aFrom.real + (sign * aT) * aTo.real,
+		(1.f - aT) * aFrom.dual + (sign * aT) * aTo.dual
+	} );
+}
+
+// Conversions
+constexpr
+Mat44f to_mat44( DualQuatf const& aDQ ) noexcept
+{
+	Mat44f ret = to_mat44( aDQ.real );
+	Vec3f const t = translation_part( aDQ );
+	ret(0,3) = t.x;
+	ret(1,3) = t.y;
+	ret(2,3) = t.z;
+	return ret;
+}
+
+constexpr
+RigidTransform to_rigid( DualQuatf const& aDQ ) noexcept
+{
+	return RigidTransform{ to_mat33( aDQ.real ), translation_part( aDQ ) };
+}
+
+inline
+DualQuatf make_dual_quat( RigidTransform const& aT ) noexcept
+{
+	return make_dual_quat( to_quat( aT.rotation ), aT.translation );
+}
+
+#endif // DUALQUAT_HPP_F5258B16_93F8_4E08_9158_37DA81CEE9F2
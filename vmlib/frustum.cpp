@@ -0,0 +1,225 @@
+#include "frustum.hpp"
+
+#include <cmath>
+
+#include "simd.hpp"
+
+namespace
+{
+	Vec4f normalize_plane_( Vec4f aPlane ) noexcept
+	{
+		float const len = std::sqrt( aPlane.x*aPlane.x + aPlane.y*aPlane.y + aPlane.z*aPlane.z );
+		return aPlane / len;
+	}
+
+	// Signed distance. Keep the order of operations in sync with the SIMD
+	// versions below, such that both agree exactly.
+	inline
+	float plane_distance_( Vec4f const& aPlane, float aX, float aY, float aZ ) noexcept
+	{
+		return aPlane.x * aX + aPlane.y * aY + aPlane.z * aZ + aPlane.w;
+	}
+
+	bool is_box_visible_( Frustum const& aFrustum, float aMinX, float aMinY, float aMinZ, float aMaxX, float aMaxY, float aMaxZ ) noexcept
+	{
+		for( auto const& plane : aFrustum.planes )
+		{
+			// Test the corner that is furthest along the plane's normal. If
+			// that one is outside, the whole box is.
+			float const px = plane.x >= 0.f ? aMaxX : aMinX;
+			float const py = plane.y >= 0.f ? aMaxY : aMinY;
+			float const pz = plane.z >= 0.f ? aMaxZ : aMinZ;
+
+			if( !(plane_distance_( plane, px, py, pz ) >= 0.f) )
+				return false;
+		}
+
+		return true;
+	}
+
+	bool is_sphere_visible_( Frustum const& aFrustum, float aX, float aY, float aZ, float aRadius ) noexcept
+	{
+		for( auto const& plane : aFrustum.planes )
+		{
+			if( !(plane_distance_( plane, aX, aY, aZ ) + aRadius >= 0.f) )
+				return false;
+		}
+
+		return true;
+	}
+
+	// Handles the elements [aBegin, aCount) that the SIMD loop did not
+	// process. aBegin is a multiple of 8.
+	template< typename tTest >
+	void write_tail_bits_( std::size_t aBegin, std::size_t aCount, std::uint8_t* aVisible, tTest&& aTest ) noexcept
+	{
+		if( aBegin == aCount )
+			return;
+
+		std::uint8_t bits = 0;
+		for( std::size_t i = aBegin; i < aCount; ++i )
+		{
+			if( aTest( i ) )
+				bits |= std::uint8_t(1u << (i % 8));
+		}
+
+		aVisible[aBegin / 8] = bits;
+	}
+}
+
+Frustum extract_frustum( Mat44f const& aProjView ) noexcept
+{
+	// See "Fast Extraction of Viewing Frustum Planes from the World-View-
+	// Projection Matrix" by G. Gribb and K. Hartmann. A clip-space point is
+	// inside if -w <= x,y,z <= w; each inequality becomes a plane made from
+	// the rows of the matrix.
+	Vec4f const r0{ aProjView(0,0), aProjView(0,1), aProjView(0,2), aProjView(0,3) };
+	Vec4f const r1{ aProjView(1,0), aProjView(1,1), aProjView(1,2), aProjView(1,3) };
+	Vec4f const r2{ aProjView(2,0), aProjView(2,1), aProjView(2,2), aProjView(2,3) };
+	Vec4f const r3{ aProjView(3,0), aProjView(3,1), aProjView(3,2), aProjView(3,3) };
+
+	Frustum ret;
+	ret.planes[Frustum::kLeft] = normalize_plane_( r3 + r0 );
+	ret.planes[Frustum::kRight] = normalize_plane_( r3 - r0 );
+	ret.planes[Frustum::kBottom] = normalize_plane_( r3 + r1 );
+	ret.planes[Frustum::kTop] = normalize_plane_( r3 - r1 );
+	ret.planes[Frustum::kNear] = normalize_plane_( r3 + r2 );
+	ret.planes[Frustum::kFar] = normalize_plane_( r3 - r2 );
+	return ret;
+}
+
+bool is_visible( Frustum const& aFrustum, Vec3f aPoint ) noexcept
+{
+	return is_sphere_visible_( aFrustum, aPoint.x, aPoint.y, aPoint.z, 0.f );
+}
+bool is_visible( Frustum const& aFrustum, Aabb3f const& aBox ) noexcept
+{
+	return is_box_visible_( aFrustum, aBox.min.x, aBox.min.y, aBox.min.z, aBox.max.x, aBox.max.y, aBox.max.z );
+}
+bool is_visible( Frustum const& aFrustum, Sphere3f const& aSphere ) noexcept
+{
+	return is_sphere_visible_( aFrustum, aSphere.center.x, aSphere.center.y, aSphere.center.z, aSphere.radius );
+}
+
+
+void test_visibility( Frustum const& aFrustum, Aabb3fStream const& aBoxes, std::uint8_t* aVisible ) noexcept
+{
+	std::size_t const count = aBoxes.size();
+
+	float const* minX = aBoxes.min.x.data();
+	float const* minY = aBoxes.min.y.data();
+	float const* minZ = aBoxes.min.z.data();
+	float const* maxX = aBoxes.max.x.data();
+	float const* maxY = aBoxes.max.y.data();
+	float const* maxZ = aBoxes.max.z.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_AVX
+	// The plane normals are the same for all boxes, so which corner to test
+	// (see is_box_visible_()) can be decided once per plane.
+	struct PlaneSetup
+	{
+		__m256 nx, ny, nz, d;
+		float const* px;
+		float const* py;
+		float const* pz;
+	} setup[Frustum::kPlaneCount];
+
+	for( std::size_t p = 0; p < Frustum::kPlaneCount; ++p )
+	{
+		auto const& plane = aFrustum.planes[p];
+		setup[p].nx = _mm256_set1_ps( plane.x );
+		setup[p].ny = _mm256_set1_ps( plane.y );
+		setup[p].nz = _mm256_set1_ps( plane.z );
+		setup[p].d = _mm256_set1_ps( plane.w );
+		setup[p].px = plane.x >= 0.f ? maxX : minX;
+		setup[p].py = plane.y >= 0.f ? maxY : minY;
+		setup[p].pz = plane.z >= 0.f ? maxZ : minZ;
+	}
+
+	__m256 const zero = _mm256_setzero_ps();
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256 visible = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+		for( auto const& s : setup )
+		{
+			__m256 dist = _mm256_mul_ps( s.nx, _mm256_loadu_ps( s.px+i ) );
+			dist = _mm256_add_ps( dist, _mm256_mul_ps( s.ny, _mm256_loadu_ps( s.py+i ) ) );
+			dist = _mm256_add_ps( dist, _mm256_mul_ps( s.nz, _mm256_loadu_ps( s.pz+i ) ) );
+			dist = _mm256_add_ps( dist, s.d );
+
+			visible = _mm256_and_ps( visible, _mm256_cmp_ps( dist, zero, _CMP_GE_OQ ) );
+		}
+
+		aVisible[i / 8] = std::uint8_t(_mm256_movemask_ps( visible ));
+	}
+#	else // !AVX
+	for( ; i + 8 <= count; i += 8 )
+	{
+		std::uint8_t bits = 0;
+		for( std::size_t j = 0; j < 8; ++j )
+		{
+			if( is_box_visible_( aFrustum, minX[i+j], minY[i+j], minZ[i+j], maxX[i+j], maxY[i+j], maxZ[i+j] ) )
+				bits |= std::uint8_t(1u << j);
+		}
+		aVisible[i / 8] = bits;
+	}
+#	endif // ~ AVX
+
+	write_tail_bits_( i, count, aVisible, [&] (std::size_t aI) {
+		return is_box_visible_( aFrustum, minX[aI], minY[aI], minZ[aI], maxX[aI], maxY[aI], maxZ[aI] );
+	} );
+}
+
+void test_visibility( Frustum const& aFrustum, Sphere3fStream const& aSpheres, std::uint8_t* aVisible ) noexcept
+{
+	std::size_t const count = aSpheres.size();
+
+	float const* cx = aSpheres.center.x.data();
+	float const* cy = aSpheres.center.y.data();
+	float const* cz = aSpheres.center.z.data();
+	float const* rad = aSpheres.radius.data();
+
+	std::size_t i = 0;
+
+#	if VMLIB_SIMD_AVX
+	__m256 const zero = _mm256_setzero_ps();
+	for( ; i + 8 <= count; i += 8 )
+	{
+		__m256 const x = _mm256_loadu_ps( cx+i );
+		__m256 const y = _mm256_loadu_ps( cy+i );
+		__m256 const z = _mm256_loadu_ps( cz+i );
+		__m256 const r = _mm256_loadu_ps( rad+i );
+
+		__m256 visible = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+		for( auto const& plane : aFrustum.planes )
+		{
+			__m256 dist = _mm256_mul_ps( _mm256_set1_ps( plane.x ), x );
+			dist = _mm256_add_ps( dist, _mm256_mul_ps( _mm256_set1_ps( plane.y ), y ) );
+			dist = _mm256_add_ps( dist, _mm256_mul_ps( _mm256_set1_ps( plane.z ), z ) );
+			dist = _mm256_add_ps( dist, _mm256_set1_ps( plane.w ) );
+			dist = _mm256_add_ps( dist, r );
+
+			visible = _mm256_and_ps( visible, _mm256_cmp_ps( dist, zero, _CMP_GE_OQ ) );
+		}
+
+		aVisible[i / 8] = std::uint8_t(_mm256_movemask_ps( visible ));
+	}
+#	else // !AVX
+	for( ; i + 8 <= count; i += 8 )
+	{
+		std::uint8_t bits = 0;
+		for( std::size_t j = 0; j < 8; ++j )
+		{
+			if( is_sphere_visible_( aFrustum, cx[i+j], cy[i+j], cz[i+j], rad[i+j] ) )
+				bits |= std::uint8_t(1u << j);
+		}
+		aVisible[i / 8] = bits;
+	}
+#	endif // ~ AVX
+
+	write_tail_bits_( i, count, aVisible, [&] (std::size_t aI) {
+		return is_sphere_visible_( aFrustum, cx[aI], cy[aI], cz[aI], rad[aI] );
+	} );
+}
@@ -0,0 +1,58 @@
+#ifndef FRUSTUM_HPP_4CC19E80_DA58_458C_B38C_535B1A392219
+#define FRUSTUM_HPP_4CC19E80_DA58_458C_B38C_535B1A392219
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat44.hpp"
+#include "bounds.hpp"
+
+/** Frustum: view frustum as six planes
+ *
+ * Each plane is stored as a Vec4f (n.x, n.y, n.z, d), with a unit-length
+ * normal n pointing into the frustum. A point p is inside the half-space if
+ *   dot( n, p ) + d >= 0.
+ *
+ * Use extract_frustum() to get the frustum from a combined
+ * projection * view matrix (or projection * view * model, which yields the
+ * frustum in model space).
+ */
+struct Frustum
+{
+	enum Plane : std::size_t
+	{
+		kLeft, kRight,
+		kBottom, kTop,
+		kNear, kFar,
+		kPlaneCount
+	};
+
+	Vec4f planes[kPlaneCount];
+};
+
+// Functions:
+
+// Gribb-Hartmann plane extraction. Works with the OpenGL-style projections
+// from make_perspective_projection().
+Frustum extract_frustum( Mat44f const& aProjView ) noexcept;
+
+// Conservative visibility tests: return false only if the volume is
+// completely outside of (at least) one of the planes. Volumes near the
+// frustum corners may be reported as visible even if they are not.
+bool is_visible( Frustum const& aFrustum, Vec3f aPoint ) noexcept;
+bool is_visible( Frustum const& aFrustum, Aabb3f const& aBox ) noexcept;
+bool is_visible( Frustum const& aFrustum, Sphere3f const& aSphere ) noexcept;
+
+// Batch visibility tests
+//
+// These test all volumes against the six planes, eight at a time with AVX,
+// and write the results to the bitmask aVisible. Bit (i % 8) of
+// aVisible[i / 8] is set if the i-th volume is visible (same criterion as
+// is_visible() above). aVisible must have room for (count+7)/8 bytes; unused
+// bits in the last byte are cleared.
+void test_visibility( Frustum const& aFrustum, Aabb3fStream const& aBoxes, std::uint8_t* aVisible ) noexcept;
+void test_visibility( Frustum const& aFrustum, Sphere3fStream const& aSpheres, std::uint8_t* aVisible ) noexcept;
+
+#endif // FRUSTUM_HPP_4CC19E80_DA58_458C_B38C_535B1A392219
@@ -53,21 +53,78 @@ constexpr Mat33f kIdentity33f = { {
 
 // Common operators for Mat33f.
 
+constexpr
+Mat33f operator*( Mat33f const& aLeft, Mat33f const& aRight ) noexcept
+{
+	Mat33f ret{};
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+		{
+			ret(i,j) = aLeft(i,0) * aRight(0,j)
+				+ aLeft(i,1) * aRight(1,j)
+				+ aLeft(i,2) * aRight(2,j)
+			;
+		}
+	}
+	return ret;
+}
+
 constexpr
 Vec3f operator*( Mat33f const& aLeft, Vec3f const& aRight ) noexcept
 {
-	//TODO: your implementation goes here
-	//TODO: remove the following when you start your implementation
-	(void)aLeft;   // Avoid warnings about unused arguments until the function
-	(void)aRight;  // is properly implemented.
-	return { 0.f, 0.f, 0.f };
+	return Vec3f{
+		aLeft(0,0) * aRight.x + aLeft(0,1) * aRight.y + aLeft(0,2) * aRight.z,
+		aLeft(1,0) * aRight.x + aLeft(1,1) * aRight.y + aLeft(1,2) * aRight.z,
+		aLeft(2,0) * aRight.x + aLeft(2,1) * aRight.y + aLeft(2,2) * aRight.z
+	};
 }
 
 // Functions:
-inline
-Mat33f mat44_to_mat33( Mat44f const& aM )
+
+constexpr
+Mat33f transpose( Mat33f const& aM ) noexcept
+{
+	Mat33f ret{};
+	for( std::size_t i = 0; i < 3; ++i )
+	{
+		for( std::size_t j = 0; j < 3; ++j )
+			ret(j,i) = aM(i,j);
+	}
+	return ret;
+}
+
+// Inverse of a general 3x3 matrix via the adjugate.
+constexpr
+Mat33f invert( Mat33f const& aM ) noexcept
+{
+	Mat33f adj{ {
+		aM(1,1)*aM(2,2) - aM(1,2)*aM(2,1),
+		aM(0,2)*aM(2,1) - aM(0,1)*aM(2,2),
+		aM(0,1)*aM(1,2) - aM(0,2)*aM(1,1),
+
+		aM(1,2)*aM(2,0) - aM(1,0)*aM(2,2),
+		aM(0,0)*aM(2,2) - aM(0,2)*aM(2,0),
+		aM(0,2)*aM(1,0) - aM(0,0)*aM(1,2),
+
+		aM(1,0)*aM(2,1) - aM(1,1)*aM(2,0),
+		aM(0,1)*aM(2,0) - aM(0,0)*aM(2,1),
+		aM(0,0)*aM(1,1) - aM(0,1)*aM(1,0)
+	} };
+
+	float const det = aM(0,0) * adj(0,0) + aM(0,1) * adj(1,0) + aM(0,2) * adj(2,0);
+	float const rcpDet = 1.f / det;
+
+	for( auto& v : adj.v )
+		v *= rcpDet;
+
+	return adj;
+}
+
+constexpr
+Mat33f mat44_to_mat33( Mat44f const& aM ) noexcept
 {
-	Mat33f ret;
+	Mat33f ret{};
 	for( std::size_t i = 0; i < 3; ++i )
 	{
 		for( std::size_t j = 0; j < 3; ++j )
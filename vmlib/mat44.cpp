@@ -1,6 +1,132 @@
 #include "mat44.hpp"
 
+namespace
+{
+#	if VMLIB_SIMD_SSE
+	// Shuffle helpers. Note that the arguments are in "reading order", i.e.,
+	// the reverse of _MM_SHUFFLE().
+	template< int tX, int tY, int tZ, int tW > inline
+	__m128 swizzle_( __m128 aV ) noexcept
+	{
+		return _mm_shuffle_ps( aV, aV, _MM_SHUFFLE( tW, tZ, tY, tX ) );
+	}
+	template< int tX, int tY, int tZ, int tW > inline
+	__m128 shuffle_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_shuffle_ps( aA, aB, _MM_SHUFFLE( tW, tZ, tY, tX ) );
+	}
+
+	// 2x2 matrix helpers. A __m128 holds a row-major 2x2 matrix (a0 a1 ; a2 a3).
+	// A# denotes the adjugate of A.
+
+	// A * B
+	inline
+	__m128 mat22_mul_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_add_ps( 
+			_mm_mul_ps( aA, swizzle_<0,3,0,3>( aB ) ),
+			_mm_mul_ps( swizzle_<1,0,3,2>( aA ), swizzle_<2,1,2,1>( aB ) )
+		);
+	}
+	// A# * B
+	inline
+	__m128 mat22_adj_mul_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps( swizzle_<3,3,0,0>( aA ), aB ),
+			_mm_mul_ps( swizzle_<1,1,2,2>( aA ), swizzle_<2,3,0,1>( aB ) )
+		);
+	}
+	// A * B#
+	inline
+	__m128 mat22_mul_adj_( __m128 aA, __m128 aB ) noexcept
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps( aA, swizzle_<3,0,3,0>( aB ) ),
+			_mm_mul_ps( swizzle_<1,0,3,2>( aA ), swizzle_<2,1,2,1>( aB ) )
+		);
+	}
+#	endif // ~ VMLIB_SIMD_SSE
+}
+
 Mat44f invert( Mat44f const& aM ) noexcept
+{
+#	if VMLIB_SIMD_SSE
+	return detail::invert_simd( aM );
+#	else
+	return detail::invert_scalar( aM );
+#	endif
+}
+
+#if VMLIB_SIMD_SSE
+Mat44f detail::invert_simd( Mat44f const& aM ) noexcept
+{
+	// Block-wise inversion. The 4x4 matrix is split into four 2x2 blocks
+	//
+	//   M = | A  B |
+	//       | C  D |
+	//
+	// and the inverse is assembled from 2x2 products and adjugates, which map
+	// nicely onto SSE registers. See e.g.
+	// https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+	__m128 const r0 = _mm_loadu_ps( aM.v+0 );
+	__m128 const r1 = _mm_loadu_ps( aM.v+4 );
+	__m128 const r2 = _mm_loadu_ps( aM.v+8 );
+	__m128 const r3 = _mm_loadu_ps( aM.v+12 );
+
+	__m128 const A = _mm_movelh_ps( r0, r1 );
+	__m128 const B = _mm_movehl_ps( r1, r0 );
+	__m128 const C = _mm_movelh_ps( r2, r3 );
+	__m128 const D = _mm_movehl_ps( r3, r2 );
+
+	// Determinants of the blocks: ( |A| |B| |C| |D| )
+	__m128 const detSub = _mm_sub_ps(
+		_mm_mul_ps( shuffle_<0,2,0,2>( r0, r2 ), shuffle_<1,3,1,3>( r1, r3 ) ),
+		_mm_mul_ps( shuffle_<1,3,1,3>( r0, r2 ), shuffle_<0,2,0,2>( r1, r3 ) )
+	);
+	__m128 const detA = swizzle_<0,0,0,0>( detSub );
+	__m128 const detB = swizzle_<1,1,1,1>( detSub );
+	__m128 const detC = swizzle_<2,2,2,2>( detSub );
+	__m128 const detD = swizzle_<3,3,3,3>( detSub );
+
+	// The inverse is 1/|M| * ( X Y ; Z W ). Compute the adjugates of X..W.
+	__m128 const DC = mat22_adj_mul_( D, C );
+	__m128 const AB = mat22_adj_mul_( A, B );
+
+	__m128 X = _mm_sub_ps( _mm_mul_ps( detD, A ), mat22_mul_( B, DC ) );
+	__m128 W = _mm_sub_ps( _mm_mul_ps( detA, D ), mat22_mul_( C, AB ) );
+	__m128 Y = _mm_sub_ps( _mm_mul_ps( detB, C ), mat22_mul_adj_( D, AB ) );
+	__m128 Z = _mm_sub_ps( _mm_mul_ps( detC, B ), mat22_mul_adj_( A, DC ) );
+
+	// |M| = |A||D| + |B||C| - tr( (A#B)(D#C) )
+	__m128 tr = _mm_mul_ps( AB, swizzle_<0,2,1,3>( DC ) );
+	tr = _mm_add_ps( tr, swizzle_<2,3,0,1>( tr ) );
+	tr = _mm_add_ps( tr, swizzle_<1,0,3,2>( tr ) );
+
+	__m128 const detM = _mm_sub_ps( 
+		_mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) ),
+		tr
+	);
+
+	// The signs account for the final adjugate.
+	__m128 const rcpDetM = _mm_div_ps( _mm_setr_ps( 1.f, -1.f, -1.f, 1.f ), detM );
+
+	X = _mm_mul_ps( X, rcpDetM );
+	Y = _mm_mul_ps( Y, rcpDetM );
+	Z = _mm_mul_ps( Z, rcpDetM );
+	W = _mm_mul_ps( W, rcpDetM );
+
+	// Undo the adjugate and reassemble the rows in one go.
+	Mat44f ret;
+	_mm_storeu_ps( ret.v+0, shuffle_<3,1,3,1>( X, Y ) );
+	_mm_storeu_ps( ret.v+4, shuffle_<2,0,2,0>( X, Y ) );
+	_mm_storeu_ps( ret.v+8, shuffle_<3,1,3,1>( Z, W ) );
+	_mm_storeu_ps( ret.v+12, shuffle_<2,0,2,0>( Z, W ) );
+	return ret;
+}
+#endif // ~ VMLIB_SIMD_SSE
+
+Mat44f detail::invert_scalar( Mat44f const& aM ) noexcept
 {
 	// We could implement this with any number of methods, including Gaussian
 	// Elimination or similar. However, a straigth line solution exists for
@@ -0,0 +1,83 @@
+// SIMD kernels for Mat44f. Included from mat44.hpp; do not include directly.
+//
+// Mat44f is row-major, so each row maps onto a single __m128. The products
+// are computed as linear combinations of the rows of the right-hand matrix
+// (respectively the columns of the left-hand matrix for Mat44f * Vec4f),
+// which keeps the order of the additions identical to the scalar code.
+
+#if VMLIB_SIMD_SSE
+namespace detail
+{
+	inline
+	Mat44f mat44_mul_simd( Mat44f const& aLeft, Mat44f const& aRight ) noexcept
+	{
+		Mat44f ret;
+
+#		if VMLIB_SIMD_AVX
+		// Process two rows of the result at once. Each 128-bit lane holds one
+		// row, and the rows of aRight are duplicated into both lanes.
+		__m128 const r0 = _mm_loadu_ps( aRight.v+0 );
+		__m128 const r1 = _mm_loadu_ps( aRight.v+4 );
+		__m128 const r2 = _mm_loadu_ps( aRight.v+8 );
+		__m128 const r3 = _mm_loadu_ps( aRight.v+12 );
+
+		__m256 const b0 = _mm256_insertf128_ps( _mm256_castps128_ps256( r0 ), r0, 1 );
+		__m256 const b1 = _mm256_insertf128_ps( _mm256_castps128_ps256( r1 ), r1, 1 );
+		__m256 const b2 = _mm256_insertf128_ps( _mm256_castps128_ps256( r2 ), r2, 1 );
+		__m256 const b3 = _mm256_insertf128_ps( _mm256_castps128_ps256( r3 ), r3, 1 );
+
+		for( std::size_t i = 0; i < 16; i += 8 )
+		{
+			__m256 const a = _mm256_loadu_ps( aLeft.v+i );
+
+			__m256 acc = _mm256_mul_ps( _mm256_shuffle_ps( a, a, 0x00 ), b0 );
+			acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_shuffle_ps( a, a, 0x55 ), b1 ) );
+			acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_shuffle_ps( a, a, 0xaa ), b2 ) );
+			acc = _mm256_add_ps( acc, _mm256_mul_ps( _mm256_shuffle_ps( a, a, 0xff ), b3 ) );
+
+			_mm256_storeu_ps( ret.v+i, acc );
+		}
+#		else // !AVX
+		__m128 const b0 = _mm_loadu_ps( aRight.v+0 );
+		__m128 const b1 = _mm_loadu_ps( aRight.v+4 );
+		__m128 const b2 = _mm_loadu_ps( aRight.v+8 );
+		__m128 const b3 = _mm_loadu_ps( aRight.v+12 );
+
+		for( std::size_t i = 0; i < 16; i += 4 )
+		{
+			__m128 acc = _mm_mul_ps( _mm_set1_ps( aLeft.v[i+0] ), b0 );
+			acc = _mm_add_ps( acc, _mm_mul_ps( _mm_set1_ps( aLeft.v[i+1] ), b1 ) );
+			acc = _mm_add_ps( acc, _mm_mul_ps( _mm_set1_ps( aLeft.v[i+2] ), b2 ) );
+			acc = _mm_add_ps( acc, _mm_mul_ps( _mm_set1_ps( aLeft.v[i+3] ), b3 ) );
+
+			_mm_storeu_ps( ret.v+i, acc );
+		}
+#		endif // ~ AVX
+
+		return ret;
+	}
+
+	inline
+	Vec4f mat44_mul_simd( Mat44f const& aLeft, Vec4f const& aRight ) noexcept
+	{
+		__m128 c0 = _mm_loadu_ps( aLeft.v+0 );
+		__m128 c1 = _mm_loadu_ps( aLeft.v+4 );
+		__m128 c2 = _mm_loadu_ps( aLeft.v+8 );
+		__m128 c3 = _mm_loadu_ps( aLeft.v+12 );
+
+		// Rows -> columns
+		_MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+
+		__m128 acc = _mm_mul_ps( c0, _mm_set1_ps( aRight.x ) );
+		acc = _mm_add_ps( acc, _mm_mul_ps( c1, _mm_set1_ps( aRight.y ) ) );
+		acc = _mm_add_ps( acc, _mm_mul_ps( c2, _mm_set1_ps( aRight.z ) ) );
+		acc = _mm_add_ps( acc, _mm_mul_ps( c3, _mm_set1_ps( aRight.w ) ) );
+
+		float res[4];
+		_mm_storeu_ps( res, acc );
+		return { res[0], res[1], res[2], res[3] };
+	}
+
+	Mat44f invert_simd( Mat44f const& ) noexcept;
+}
+#endif // ~ VMLIB_SIMD_SSE
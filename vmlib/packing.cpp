@@ -0,0 +1,252 @@
+#include "packing.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	std::uint32_t float_bits_( float aValue ) noexcept
+	{
+		std::uint32_t ret;
+		std::memcpy( &ret, &aValue, sizeof(ret) );
+		return ret;
+	}
+	float bits_float_( std::uint32_t aBits ) noexcept
+	{
+		float ret;
+		std::memcpy( &ret, &aBits, sizeof(ret) );
+		return ret;
+	}
+
+	float clamp_( float aValue, float aMin, float aMax ) noexcept
+	{
+		return aValue < aMin ? aMin : (aValue > aMax ? aMax : aValue);
+	}
+
+	// Sign that maps 0 to +1 (octahedral encoding needs this)
+	float sign_not_zero_( float aValue ) noexcept
+	{
+		return aValue >= 0.f ? 1.f : -1.f;
+	}
+
+	// Signed/unsigned normalized integers with aBits bits.
+	std::uint32_t pack_snorm_bits_( float aValue, unsigned aBits ) noexcept
+	{
+		float const scale = float((1u << (aBits-1)) - 1);
+		auto const v = std::int32_t(std::lround( clamp_( aValue, -1.f, 1.f ) * scale ));
+		return std::uint32_t(v) & ((1u << aBits) - 1);
+	}
+	float unpack_snorm_bits_( std::uint32_t aValue, unsigned aBits ) noexcept
+	{
+		// Sign-extend
+		std::int32_t const shift = 32 - std::int32_t(aBits);
+		std::int32_t const v = std::int32_t(aValue << shift) >> shift;
+
+		float const scale = float((1u << (aBits-1)) - 1);
+		return clamp_( float(v) / scale, -1.f, 1.f );
+	}
+
+	std::uint32_t pack_unorm_bits_( float aValue, unsigned aBits ) noexcept
+	{
+		float const scale = float((1u << aBits) - 1);
+		return std::uint32_t(std::lround( clamp_( aValue, 0.f, 1.f ) * scale ));
+	}
+	float unpack_unorm_bits_( std::uint32_t aValue, unsigned aBits ) noexcept
+	{
+		float const scale = float((1u << aBits) - 1);
+		return float(aValue & ((1u << aBits) - 1)) / scale;
+	}
+
+	// Quantization helpers. Degenerate (flat) bounds would result in a
+	// division by zero; any scale works in that case.
+	float safe_extent_( float aMin, float aMax ) noexcept
+	{
+		float const ext = aMax - aMin;
+		return ext > 0.f ? ext : 1.f;
+	}
+}
+
+std::uint16_t float_to_half( float aValue ) noexcept
+{
+	// Based on F. Giesen's float_to_half_fast3_rtne(), see
+	// https://gist.github.com/rygorous/2156668
+	std::uint32_t bits = float_bits_( aValue );
+
+	std::uint32_t const sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	std::uint32_t ret;
+	if( bits >= (127u + 16u) << 23 ) // too large for a half: Inf or NaN
+	{
+		ret = bits > (255u << 23) ? 0x7e00u : 0x7c00u;
+	}
+	else if( bits < (113u << 23) ) // subnormal half or zero
+	{
+		// Adding the magic value aligns the 10 mantissa bits at the bottom of
+		// the float; FP addition takes care of rounding.
+		std::uint32_t const magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+		ret = float_bits_( bits_float_( bits ) + bits_float_( magic ) ) - magic;
+	}
+	else
+	{
+		std::uint32_t const mantOdd = (bits >> 13) & 1u;
+
+		// Rebias exponent, and round to nearest even
+		bits += (std::uint32_t(15 - 127) << 23) + 0xfffu;
+		bits += mantOdd;
+
+		ret = bits >> 13;
+	}
+
+	return std::uint16_t(ret | (sign >> 16));
+}
+
+float half_to_float( std::uint16_t aValue ) noexcept
+{
+	std::uint32_t const shiftedExp = 0x7c00u << 13;
+
+	std::uint32_t bits = (std::uint32_t(aValue) & 0x7fffu) << 13;
+	std::uint32_t const exp = bits & shiftedExp;
+	bits += (127u - 15u) << 23;
+
+	if( exp == shiftedExp ) // Inf or NaN
+	{
+		bits += (128u - 16u) << 23;
+	}
+	else if( 0 == exp ) // zero or subnormal: renormalize
+	{
+		bits += 1u << 23;
+		bits = float_bits_( bits_float_( bits ) - bits_float_( 113u << 23 ) );
+	}
+
+	bits |= (std::uint32_t(aValue) & 0x8000u) << 16;
+	return bits_float_( bits );
+}
+
+
+std::int16_t pack_snorm16( float aValue ) noexcept
+{
+	return std::int16_t(std::lround( clamp_( aValue, -1.f, 1.f ) * 32767.f ));
+}
+float unpack_snorm16( std::int16_t aValue ) noexcept
+{
+	return clamp_( float(aValue) / 32767.f, -1.f, 1.f );
+}
+
+std::uint16_t pack_unorm16( float aValue ) noexcept
+{
+	return std::uint16_t(std::lround( clamp_( aValue, 0.f, 1.f ) * 65535.f ));
+}
+float unpack_unorm16( std::uint16_t aValue ) noexcept
+{
+	return float(aValue) / 65535.f;
+}
+
+
+Vec2f oct_encode( Vec3f aNormal ) noexcept
+{
+	float const l1 = std::abs( aNormal.x ) + std::abs( aNormal.y ) + std::abs( aNormal.z );
+	Vec2f ret{ aNormal.x / l1, aNormal.y / l1 };
+
+	if( aNormal.z < 0.f )
+	{
+		// Fold the lower hemisphere over the diagonals.
+		ret = Vec2f{
+			(1.f - std::abs( ret.y )) * sign_not_zero_( ret.x ),
+			(1.f - std::abs( ret.x )) * sign_not_zero_( ret.y )
+		};
+	}
+
+	return ret;
+}
+
+Vec3f oct_decode( Vec2f aEncoded ) noexcept
+{
+	Vec3f ret{ aEncoded.x, aEncoded.y, 1.f - std::abs( aEncoded.x ) - std::abs( aEncoded.y ) };
+
+	float const t = clamp_( -ret.z, 0.f, 1.f );
+	ret.x += ret.x >= 0.f ? -t : t;
+	ret.y += ret.y >= 0.f ? -t : t;
+
+	return normalize( ret );
+}
+
+std::uint32_t pack_normal_oct16( Vec3f aNormal ) noexcept
+{
+	Vec2f const e = oct_encode( aNormal );
+	return std::uint32_t(std::uint16_t(pack_snorm16( e.x )))
+		| (std::uint32_t(std::uint16_t(pack_snorm16( e.y ))) << 16)
+	;
+}
+Vec3f unpack_normal_oct16( std::uint32_t aValue ) noexcept
+{
+	return oct_decode( Vec2f{
+		unpack_snorm16( std::int16_t(aValue & 0xffffu) ),
+		unpack_snorm16( std::int16_t(aValue >> 16) )
+	} );
+}
+
+
+std::uint32_t pack_snorm_10_10_10_2( Vec4f aValue ) noexcept
+{
+	return pack_snorm_bits_( aValue.x, 10 )
+		| (pack_snorm_bits_( aValue.y, 10 ) << 10)
+		| (pack_snorm_bits_( aValue.z, 10 ) << 20)
+		| (pack_snorm_bits_( aValue.w, 2 ) << 30)
+	;
+}
+Vec4f unpack_snorm_10_10_10_2( std::uint32_t aValue ) noexcept
+{
+	return Vec4f{
+		unpack_snorm_bits_( aValue & 0x3ffu, 10 ),
+		unpack_snorm_bits_( (aValue >> 10) & 0x3ffu, 10 ),
+		unpack_snorm_bits_( (aValue >> 20) & 0x3ffu, 10 ),
+		unpack_snorm_bits_( aValue >> 30, 2 )
+	};
+}
+
+std::uint32_t pack_unorm_10_10_10_2( Vec4f aValue ) noexcept
+{
+	return pack_unorm_bits_( aValue.x, 10 )
+		| (pack_unorm_bits_( aValue.y, 10 ) << 10)
+		| (pack_unorm_bits_( aValue.z, 10 ) << 20)
+		| (pack_unorm_bits_( aValue.w, 2 ) << 30)
+	;
+}
+Vec4f unpack_unorm_10_10_10_2( std::uint32_t aValue ) noexcept
+{
+	return Vec4f{
+		unpack_unorm_bits_( aValue, 10 ),
+		unpack_unorm_bits_( aValue >> 10, 10 ),
+		unpack_unorm_bits_( aValue >> 20, 10 ),
+		unpack_unorm_bits_( aValue >> 30, 2 )
+	};
+}
+
+
+QuantizedPosition quantize_position( Vec3f aPosition, Aabb3f const& aBounds ) noexcept
+{
+	return QuantizedPosition{
+		pack_unorm16( (aPosition.x - aBounds.min.x) / safe_extent_( aBounds.min.x, aBounds.max.x ) ),
+		pack_unorm16( (aPosition.y - aBounds.min.y) / safe_extent_( aBounds.min.y, aBounds.max.y ) ),
+		pack_unorm16( (aPosition.z - aBounds.min.z) / safe_extent_( aBounds.min.z, aBounds.max.z ) )
+	};
+}
+
+Vec3f dequantize_position( QuantizedPosition aPosition, Aabb3f const& aBounds ) noexcept
+{
+	return Vec3f{
+		aBounds.min.x + unpack_unorm16( aPosition.x ) * safe_extent_( aBounds.min.x, aBounds.max.x ),
+		aBounds.min.y + unpack_unorm16( aPosition.y ) * safe_extent_( aBounds.min.y, aBounds.max.y ),
+		aBounds.min.z + unpack_unorm16( aPosition.z ) * safe_extent_( aBounds.min.z, aBounds.max.z )
+	};
+}
+
+Mat44f make_dequantization_transform( Aabb3f const& aBounds ) noexcept
+{
+	return make_translation( aBounds.min ) * make_scaling(
+		safe_extent_( aBounds.min.x, aBounds.max.x ),
+		safe_extent_( aBounds.min.y, aBounds.max.y ),
+		safe_extent_( aBounds.min.z, aBounds.max.z )
+	);
+}
@@ -0,0 +1,80 @@
+#ifndef PACKING_HPP_E5D26EAB_5BB5_47FD_849E_ED63575D2BEC
+#define PACKING_HPP_E5D26EAB_5BB5_47FD_849E_ED63575D2BEC
+
+#include <cstdint>
+
+#include "vec2.hpp"
+#include "vec3.hpp"
+#include "vec4.hpp"
+#include "mat44.hpp"
+#include "bounds.hpp"
+
+/* Packing utilities for compressed vertex formats
+ *
+ * These convert float data into the smaller formats that OpenGL can fetch
+ * natively as vertex attributes:
+ *
+ *  - half floats (GL_HALF_FLOAT), e.g. for texture coordinates
+ *  - snorm16 octahedral normals (2x GL_SHORT, normalized). The shader must
+ *    decode these with oct_decode() from assets/packing.glsl.
+ *  - 10_10_10_2 (GL_INT_2_10_10_10_REV / GL_UNSIGNED_INT_2_10_10_10_REV,
+ *    normalized), decoded by GL.
+ *  - unorm16 positions quantized relative to a bounding box (3x
+ *    GL_UNSIGNED_SHORT, normalized). GL returns values in [0,1]; the
+ *    transform from make_dequantization_transform() maps them back. The
+ *    scale is generally non-uniform, so the shader applies it to the
+ *    position only (dequantize_position() in assets/packing.glsl) instead
+ *    of folding it into the model matrix, which would distort normals.
+ *
+ * The decode functions mirror what GL/the shader do, and are mainly useful
+ * for testing.
+ */
+
+// Half floats. Conversion rounds to nearest even. Values that are too large
+// become infinity; NaNs are preserved (as quiet NaNs).
+std::uint16_t float_to_half( float ) noexcept;
+float half_to_float( std::uint16_t ) noexcept;
+
+// Normalized integers. The snorm conversions follow the OpenGL 4.2+ rules,
+// i.e., -1, 0 and 1 are represented exactly.
+std::int16_t pack_snorm16( float ) noexcept;
+float unpack_snorm16( std::int16_t ) noexcept;
+
+std::uint16_t pack_unorm16( float ) noexcept;
+float unpack_unorm16( std::uint16_t ) noexcept;
+
+// Octahedral normal encoding. Maps the unit sphere onto the [-1,1]^2 square
+// by projecting onto an octahedron and unfolding its lower half. aNormal
+// must be normalized.
+Vec2f oct_encode( Vec3f aNormal ) noexcept;
+Vec3f oct_decode( Vec2f aEncoded ) noexcept;
+
+// Octahedral normal, stored as two snorm16 values (x in the low 16 bits).
+std::uint32_t pack_normal_oct16( Vec3f aNormal ) noexcept;
+Vec3f unpack_normal_oct16( std::uint32_t ) noexcept;
+
+// 10_10_10_2 packing, matching GL's *_2_10_10_10_REV layouts: x in bits
+// 0-9, y in 10-19, z in 20-29 and w in bits 30-31.
+std::uint32_t pack_snorm_10_10_10_2( Vec4f ) noexcept;
+Vec4f unpack_snorm_10_10_10_2( std::uint32_t ) noexcept;
+
+std::uint32_t pack_unorm_10_10_10_2( Vec4f ) noexcept;
+Vec4f unpack_unorm_10_10_10_2( std::uint32_t ) noexcept;
+
+// Positions quantized to unorm16 relative to aBounds (e.g. the mesh's AABB).
+// The maximum error is half of a quantization step, i.e.,
+//   (aBounds.max - aBounds.min) / 65535 / 2
+// per axis.
+struct QuantizedPosition
+{
+	std::uint16_t x, y, z;
+};
+
+QuantizedPosition quantize_position( Vec3f aPosition, Aabb3f const& aBounds ) noexcept;
+Vec3f dequantize_position( QuantizedPosition aPosition, Aabb3f const& aBounds ) noexcept;
+
+// Maps normalized quantized positions (in [0,1]^3) back into the space of
+// aBounds: translation( min ) * scaling( max - min ).
+Mat44f make_dequantization_transform( Aabb3f const& aBounds ) noexcept;
+
+#endif // PACKING_HPP_E5D26EAB_5BB5_47FD_849E_ED63575D2BEC
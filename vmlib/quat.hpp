@@ -0,0 +1,236 @@
+#ifndef QUAT_HPP_D7AC23E6_CD04_40AE_9317_400295E6DF52
+#define QUAT_HPP_D7AC23E6_CD04_40AE_9317_400295E6DF52
+
+#include <cmath>
+#include <cassert>
+#include <cstdlib>
+
+#include "vec3.hpp"
+#include "mat33.hpp"
+#include "mat44.hpp"
+#include "cxmath.hpp"
+
+/** Quatf: quaternion with floats
+ *
+ * Used to represent rotations. Compared to rotation matrices, quaternions
+ * are smaller (4 vs 9 floats), cheaper to compose, can be interpolated
+ * (nlerp(), slerp()), and are trivial to re-normalize. The latter avoids the
+ * drift that repeatedly multiplied rotation matrices accumulate.
+ *
+ * (x,y,z) is the vector part and w is the scalar part. Rotations are
+ * represented by unit quaternions:
+ *   q = ( sin(a/2) * axis, cos(a/2) )
+ * see make_quat_axis_angle(). The conventions match make_rotation_x() and
+ * friends, i.e., to_mat44(make_quat_axis_angle({1,0,0}, a)) equals
+ * make_rotation_x(a).
+ *
+ * Like Vec3f, Quatf is a POD type and can be initialized with braces:
+ *   Quatf q{ 0.f, 0.f, 0.f, 1.f }; // identity
+ */
+struct Quatf
+{
+	float x, y, z, w;
+};
+
+constexpr Quatf kIdentityQuatf = { 0.f, 0.f, 0.f, 1.f };
+
+constexpr
+Quatf operator-( Quatf aQ ) noexcept
+{
+	return { -aQ.x, -aQ.y, -aQ.z, -aQ.w };
+}
+
+constexpr
+Quatf operator+( Quatf aLeft, Quatf aRight ) noexcept
+{
+	return Quatf{
+		aLeft.x + aRight.x,
+		aLeft.y + aRight.y,
+		aLeft.z + aRight.z,
+		aLeft.w + aRight.w
+	};
+}
+constexpr
+Quatf operator-( Quatf aLeft, Quatf aRight ) noexcept
+{
+	return Quatf{
+		aLeft.x - aRight.x,
+		aLeft.y - aRight.y,
+		aLeft.z - aRight.z,
+		aLeft.w - aRight.w
+	};
+}
+
+constexpr
+Quatf operator*( float aScalar, Quatf aQ ) noexcept
+{
+	return Quatf{ aScalar * aQ.x, aScalar * aQ.y, aScalar * aQ.z, aScalar * aQ.w };
+}
+constexpr
+Quatf operator*( Quatf aQ, float aScalar ) noexcept
+{
+	return aScalar * aQ;
+}
+
+// Hamilton product. As with matrices, (aLeft * aRight) rotates by aRight
+// first and then by aLeft.
+constexpr
+Quatf operator*( Quatf aLeft, Quatf aRight ) noexcept
+{
+	return Quatf{
+		aLeft.w * aRight.x + aLeft.x * aRight.w + aLeft.y * aRight.z - aLeft.z * aRight.y,
+		aLeft.w * aRight.y - aLeft.x * aRight.z + aLeft.y * aRight.w + aLeft.z * aRight.x,
+		aLeft.w * aRight.z + aLeft.x * aRight.y - aLeft.y * aRight.x + aLeft.z * aRight.w,
+		aLeft.w * aRight.w - aLeft.x * aRight.x - aLeft.y * aRight.y - aLeft.z * aRight.z
+	};
+}
+
+// Functions:
+
+constexpr
+float dot( Quatf aLeft, Quatf aRight ) noexcept
+{
+	return aLeft.x * aRight.x
+		+ aLeft.y * aRight.y
+		+ aLeft.z * aRight.z
+		+ aLeft.w * aRight.w
+	;
+}
+
+inline
+float length( Quatf aQ ) noexcept
+{
+	return std::sqrt( dot( aQ, aQ ) );
+}
+
+inline
+Quatf normalize( Quatf aQ ) noexcept
+{
+	return (1.f / length( aQ )) * aQ;
+}
+
+constexpr
+Quatf conjugate( Quatf aQ ) noexcept
+{
+	return { -aQ.x, -aQ.y, -aQ.z, aQ.w };
+}
+
+// For unit quaternions (i.e., rotations), this is equal to conjugate().
+constexpr
+Quatf invert( Quatf aQ ) noexcept
+{
+	return (1.f / dot( aQ, aQ )) * conjugate( aQ );
+}
+
+// Rotation by aAngle radians around aAxis. aAxis must be normalized.
+constexpr
+Quatf make_quat_axis_angle( Vec3f aAxis, float aAngle ) noexcept
+{
+	float const s = constexpr_sin( aAngle * 0.5f );
+	float const c = constexpr_cos( aAngle * 0.5f );
+	return { s * aAxis.x, s * aAxis.y, s * aAxis.z, c };
+}
+
+// Rotates aVec by the unit quaternion aQ. This is equivalent to the vector
+// part of aQ * (aVec,0) * conjugate(aQ), but cheaper.
+constexpr
+Vec3f rotate( Quatf aQ, Vec3f aVec ) noexcept
+{
+	Vec3f const qv{ aQ.x, aQ.y, aQ.z };
+	Vec3f const t = 2.f * cross( qv, aVec );
+	return aVec + aQ.w * t + cross( qv, t );
+}
+
+// Conversions. aQ must be a unit quaternion.
+constexpr
+Mat33f to_mat33( Quatf aQ ) noexcept
+{
+	float const xx = aQ.x * aQ.x, yy = aQ.y * aQ.y, zz = aQ.z * aQ.z;
+	float const xy = aQ.x * aQ.y, xz = aQ.x * aQ.z, yz = aQ.y * aQ.z;
+	float const wx = aQ.w * aQ.x, wy = aQ.w * aQ.y, wz = aQ.w * aQ.z;
+
+	return { {
+		1.f - 2.f*(yy + zz), 2.f*(xy - wz), 2.f*(xz + wy),
+		2.f*(xy + wz), 1.f - 2.f*(xx + zz), 2.f*(yz - wx),
+		2.f*(xz - wy), 2.f*(yz + wx), 1.f - 2.f*(xx + yy)
+	} };
+}
+
+constexpr
+Mat44f to_mat44( Quatf aQ ) noexcept
+{
+	Mat33f const r = to_mat33( aQ );
+	return { {
+		r(0,0), r(0,1), r(0,2), 0.f,
+		r(1,0), r(1,1), r(1,2), 0.f,
+		r(2,0), r(2,1), r(2,2), 0.f,
+		0.f, 0.f, 0.f, 1.f
+	} };
+}
+
+// Conversion from a rotation matrix. aM must be orthonormal.
+inline
+Quatf to_quat( Mat33f const& aM ) noexcept
+{
+	// Pick the numerically most stable branch, based on the largest of the
+	// diagonal elements and the trace.
+	float const tr = aM(0,0) + aM(1,1) + aM(2,2);
+	if( tr > 0.f )
+	{
+		float const s = 2.f * std::sqrt( tr + 1.f );
+		return { (aM(2,1) - aM(1,2)) / s, (aM(0,2) - aM(2,0)) / s, (aM(1,0) - aM(0,1)) / s, 0.25f * s };
+	}
+	else if( aM(0,0) > aM(1,1) && aM(0,0) > aM(2,2) )
+	{
+		float const s = 2.f * std::sqrt( 1.f + aM(0,0) - aM(1,1) - aM(2,2) );
+		return { 0.25f * s, (aM(0,1) + aM(1,0)) / s, (aM(0,2) + aM(2,0)) / s, (aM(2,1) - aM(1,2)) / s };
+	}
+	else if( aM(1,1) > aM(2,2) )
+	{
+		float const s = 2.f * std::sqrt( 1.f + aM(1,1) - aM(0,0) - aM(2,2) );
+		return { (aM(0,1) + aM(1,0)) / s, 0.25f * s, (aM(1,2) + aM(2,1)) / s, (aM(0,2) - aM(2,0)) / s };
+	}
+	else
+	{
+		float const s = 2.f * std::sqrt( 1.f + aM(2,2) - aM(0,0) - aM(1,1) );
+		return { (aM(0,2) + aM(2,0)) / s, (aM(1,2) + aM(2,1)) / s, 0.25f * s, (aM(1,0) - aM(0,1)) / s };
+	}
+}
+
+// Interpolation. Both take the shortest path (q and -q represent the same
+// rotation).
+//
+// nlerp() interpolates linearly and re-normalizes. It is cheap, but the
+// angular velocity is not constant. slerp() has constant angular velocity.
+inline
+Quatf nlerp( Quatf aFrom, Quatf aTo, float aT ) noexcept
+{
+	if( dot( aFrom, aTo ) < 0.f )
+		aTo = -aTo;
+
+	return normalize( (1.f - aT) * aFrom + aT * aTo );
+}
+
+inline
+Quatf slerp( Quatf aFrom, Quatf aTo, float aT ) noexcept
+{
+	float d = dot( aFrom, aTo );
+	if( d < 0.f )
+	{
+		aTo = -aTo;
+		d = -d;
+	}
+
+	// Nearly parallel: sin(theta) -> 0. nlerp() is accurate enough here.
+	if( d > 0.9995f )
+		return nlerp( aFrom, aTo, aT );
+
+	float const theta = std::acos( d );
+	float const rcpSin = 1.f / std::sin( theta );
+
+	float const wf = std::sin( (1.f - aT) * theta ) * rcpSin;
+	float const wt = std::sin( aT * theta ) * rcpSin;
+	return wf * aFrom + wt * aTo;
+}
+
+#endif // QUAT_HPP_D7AC23E6_CD04_40AE_9317_400295E6DF52
@@ -0,0 +1,88 @@
+#ifndef RIGID_HPP_3EE60706_917F_4B3B_9EF6_E7D19AA9ED6E
+#define RIGID_HPP_3EE60706_917F_4B3B_9EF6_E7D19AA9ED6E
+
+#include "vec3.hpp"
+#include "mat33.hpp"
+#include "mat44.hpp"
+#include "affine.hpp"
+
+/** RigidTransform: rotation followed by a translation
+ *
+ * A rigid transform preserves lengths and angles (no scaling or shearing).
+ * This is the case for e.g. camera/view transforms and most object
+ * placements. The rotation is orthonormal, so its inverse is simply its
+ * transpose:
+ *   inv( R | t ) = ( R^T | -R^T t )
+ * and normals can be transformed with R directly.
+ *
+ * The caller is responsible for keeping `rotation` orthonormal. Composing
+ * many transforms accumulates rounding errors; re-orthonormalize
+ * occasionally if transforms are updated incrementally.
+ */
+struct RigidTransform
+{
+	Mat33f rotation;
+	Vec3f translation;
+};
+
+constexpr RigidTransform kIdentityRigidTransform = {
+	kIdentity33f,
+	Vec3f{ 0.f, 0.f, 0.f }
+};
+
+// Composition: (aLeft * aRight) applies aRight first.
+constexpr
+RigidTransform operator*( RigidTransform const& aLeft, RigidTransform const& aRight ) noexcept
+{
+	return RigidTransform{
+		aLeft.rotation * aRight.rotation,
+		aLeft.rotation * aRight.translation + aLeft.translation
+	};
+}
+
+// Functions:
+
+constexpr
+Vec3f transform_point( RigidTransform const& aT, Vec3f aPoint ) noexcept
+{
+	return aT.rotation * aPoint + aT.translation;
+}
+
+// Transforms directions. Since the transform is rigid, this is also valid
+// for normals.
+constexpr
+Vec3f transform_vector( RigidTransform const& aT, Vec3f aVector ) noexcept
+{
+	return aT.rotation * aVector;
+}
+
+constexpr
+RigidTransform invert( RigidTransform const& aT ) noexcept
+{
+	Mat33f const rt = transpose( aT.rotation );
+	return RigidTransform{ rt, -(rt * aT.translation) };
+}
+
+constexpr
+Affine3f to_affine( RigidTransform const& aT ) noexcept
+{
+	return make_affine( aT.rotation, aT.translation );
+}
+
+constexpr
+Mat44f to_mat44( RigidTransform const& aT ) noexcept
+{
+	return to_mat44( to_affine( aT ) );
+}
+
+// Conversion from Mat44f. aM must be rigid (see to_affine() for the
+// requirements on the last row; additionally the upper 3x3 block must be
+// orthonormal).
+constexpr
+RigidTransform to_rigid( Mat44f const& aM ) noexcept
+{
+	Affine3f const aff = to_affine( aM );
+	return RigidTransform{ linear_part( aff ), translation_part( aff ) };
+}
+
+#endif // RIGID_HPP_3EE60706_917F_4B3B_9EF6_E7D19AA9ED6E
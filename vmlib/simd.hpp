@@ -0,0 +1,78 @@
+#ifndef SIMD_HPP_BA2498C9_7C36_4E45_8C91_4584CAB0FA5D
+#define SIMD_HPP_BA2498C9_7C36_4E45_8C91_4584CAB0FA5D
+
+/* SIMD configuration for vmlib
+ *
+ * A few hot paths in vmlib (Mat44f products, invert(), batch kernels) have
+ * SSE/AVX implementations. The plain scalar code is always kept around and is
+ * used as a fallback:
+ *   - when the expression is evaluated at compile time (constexpr),
+ *   - when the target does not support the instruction set, or
+ *   - when VMLIB_NO_SIMD is defined (e.g., for debugging).
+ *
+ * With GCC/clang, premake passes -march=native, so the feature macros follow
+ * the host CPU. MSVC always has SSE2 on x64; AVX requires /arch:AVX or
+ * /arch:AVX2 (which define __AVX__ and __AVX2__).
+ */
+
+#if !defined(VMLIB_NO_SIMD)
+#	if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#		define VMLIB_SIMD_SSE 1
+#	endif
+#	if defined(__AVX__)
+#		define VMLIB_SIMD_AVX 1
+#	endif
+#	if defined(__AVX2__)
+#		define VMLIB_SIMD_AVX2 1
+#	endif
+#endif // ~ !VMLIB_NO_SIMD
+
+#if !defined(VMLIB_SIMD_SSE)
+#	define VMLIB_SIMD_SSE 0
+#endif
+#if !defined(VMLIB_SIMD_AVX)
+#	define VMLIB_SIMD_AVX 0
+#endif
+#if !defined(VMLIB_SIMD_AVX2)
+#	define VMLIB_SIMD_AVX2 0
+#endif
+
+#if VMLIB_SIMD_AVX
+#	include <immintrin.h>
+#elif VMLIB_SIMD_SSE
+#	include <emmintrin.h>
+#endif
+
+// C++17 lacks std::is_constant_evaluated(), but all our compilers provide
+// the underlying builtin. Without it, we cannot tell compile-time from
+// run-time evaluation, and the constexpr functions stay scalar throughout.
+#if defined(__has_builtin)
+#	if __has_builtin(__builtin_is_constant_evaluated)
+#		define VMLIB_HAS_IS_CONSTANT_EVALUATED 1
+#	endif
+#endif
+#if !defined(VMLIB_HAS_IS_CONSTANT_EVALUATED)
+#	if (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#		define VMLIB_HAS_IS_CONSTANT_EVALUATED 1
+#	else
+#		define VMLIB_HAS_IS_CONSTANT_EVALUATED 0
+#	endif
+#endif
+
+namespace detail
+{
+	// Returns true when evaluated in a constant expression. Conservatively
+	// returns true if this cannot be determined, which selects the scalar
+	// code paths.
+	constexpr
+	bool is_constant_evaluated() noexcept
+	{
+#		if VMLIB_HAS_IS_CONSTANT_EVALUATED
+		return __builtin_is_constant_evaluated();
+#		else
+		return true;
+#		endif
+	}
+}
+
+#endif // SIMD_HPP_BA2498C9_7C36_4E45_8C91_4584CAB0FA5D